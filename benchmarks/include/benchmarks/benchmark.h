@@ -0,0 +1,66 @@
+#ifndef BENCHMARKS_BENCHMARK_H
+#define BENCHMARKS_BENCHMARK_H
+
+#include "util/pstdint.h"
+#include "util/time.h"
+
+/*!
+ * @brief List of all benchmarks. Every entry X(name) must have a matching
+ * function void benchmark_name(void) defined somewhere in src/.
+ */
+#define BENCHMARK_LIST \
+    X(bst_find_insert) \
+    X(bstv_build) \
+    X(bstv_read_optimised) \
+    X(hash) \
+    X(hashmap) \
+    X(heap) \
+    X(id_allocator) \
+    X(key_search) \
+    X(mpmc_queue) \
+    X(ordered_vector_range) \
+    X(ptree_wide) \
+    X(ring_buffer) \
+    X(small_vector_event_fire) \
+    X(small_vector_ptree_load) \
+    X(soa_vector_segments) \
+    X(string_pool) \
+    X(thread_pool) \
+    X(typed_vector)
+
+#define X(name) void benchmark_##name(void);
+BENCHMARK_LIST
+#undef X
+
+/*!
+ * @brief Prints a single result line.
+ * @param[in] what Short description of what was measured.
+ * @param[in] n The problem size (typically the number of elements).
+ * @param[in] ops How many operations were timed. Used to compute the time per
+ * operation.
+ * @param[in] microseconds The total time it took.
+ */
+void
+benchmark_report(const char* what, uint32_t n, uint32_t ops, int64_t microseconds);
+
+/*!
+ * @brief Simple xorshift random number generator so results are reproducible
+ * across platforms.
+ */
+uint32_t
+benchmark_rand(void);
+
+/*!
+ * @brief Resets the random number generator to its initial state.
+ */
+void
+benchmark_rand_reset(void);
+
+/*!
+ * @brief Prevents the compiler from optimising away the computation of a
+ * value.
+ */
+void
+benchmark_do_not_optimise(const void* p);
+
+#endif /* BENCHMARKS_BENCHMARK_H */
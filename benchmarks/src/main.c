@@ -0,0 +1,70 @@
+#include "benchmarks/benchmark.h"
+#include "util/memory.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t g_rand_state = 2463534242u;
+static volatile const void* g_sink;
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_report(const char* what, uint32_t n, uint32_t ops, int64_t microseconds)
+{
+    printf("  %-48s n=%-9u %10.3f ms  %10.2f ns/op\n",
+           what,
+           n,
+           (double)microseconds / 1000.0,
+           ops ? (double)microseconds * 1000.0 / (double)ops : 0.0);
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+benchmark_rand(void)
+{
+    g_rand_state ^= g_rand_state << 13;
+    g_rand_state ^= g_rand_state >> 17;
+    g_rand_state ^= g_rand_state << 5;
+    return g_rand_state;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_rand_reset(void)
+{
+    g_rand_state = 2463534242u;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_do_not_optimise(const void* p)
+{
+    g_sink = p;
+}
+
+/* ------------------------------------------------------------------------- */
+int
+main(int argc, char** argv)
+{
+    memory_init();
+
+    /*
+     * With no arguments, run everything. Otherwise only run benchmarks whose
+     * name contains one of the arguments.
+     */
+#define X(name) do {                                                    \
+        int i, run = (argc < 2);                                        \
+        for(i = 1; i < argc; ++i)                                       \
+            if(strstr(#name, argv[i]))                                  \
+                run = 1;                                                \
+        if(run)                                                         \
+        {                                                               \
+            printf("%s\n", #name);                                      \
+            benchmark_rand_reset();                                     \
+            benchmark_##name();                                         \
+        }                                                               \
+    } while(0);
+    BENCHMARK_LIST
+#undef X
+
+    return memory_deinit() == 0 ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include "benchmarks/benchmark.h"
+#include "util/bst_vector.h"
+#include "util/bst_hashed_vector.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+#define LOOKUPS 2000000
+#define KEY_LENGTH 16
+
+static const uint32_t g_sizes[] = {16, 256, 4096, 65536};
+
+/* ------------------------------------------------------------------------- */
+static void
+bstv_find_insert(uint32_t n, const uint32_t* hashes, uint32_t* queries)
+{
+    struct bstv_t bstv;
+    uintptr_t found = 0;
+    uint32_t i;
+    int64_t start;
+
+    bstv_init(&bstv);
+    start = get_time_in_microseconds();
+    for(i = 0; i != n; ++i)
+        bstv_insert(&bstv, hashes[i], (void*)(hashes + i));
+    benchmark_report("bstv_insert", n, n, get_time_in_microseconds() - start);
+
+    /* half of the lookups hit */
+    for(i = 0; i != LOOKUPS; ++i)
+        queries[i] = (i & 1) ? hashes[benchmark_rand() % n] : benchmark_rand() & 0x7FFFFFFF;
+
+    start = get_time_in_microseconds();
+    for(i = 0; i != LOOKUPS; ++i)
+        found += (uintptr_t)bstv_find(&bstv, queries[i]);
+    benchmark_report("bstv_find", n, LOOKUPS, get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(&found);
+
+    bstv_clear_free(&bstv);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+bsthv_find_insert(uint32_t n, const char* keys, uint32_t* queries)
+{
+    struct bsthv_t bsthv;
+    uintptr_t found = 0;
+    uint32_t i;
+    int64_t start;
+
+    bsthv_init(&bsthv);
+    start = get_time_in_microseconds();
+    for(i = 0; i != n; ++i)
+        bsthv_insert(&bsthv, keys + i * KEY_LENGTH, (void*)(keys + i * KEY_LENGTH));
+    benchmark_report("bsthv_insert", n, n, get_time_in_microseconds() - start);
+
+    /* queries index the key table, every lookup hits */
+    for(i = 0; i != LOOKUPS; ++i)
+        queries[i] = benchmark_rand() % n;
+
+    start = get_time_in_microseconds();
+    for(i = 0; i != LOOKUPS; ++i)
+        found += (uintptr_t)bsthv_find(&bsthv, keys + queries[i] * KEY_LENGTH);
+    benchmark_report("bsthv_find", n, LOOKUPS, get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(&found);
+
+    bsthv_clear_free(&bsthv);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_bst_find_insert(void)
+{
+    uint32_t* queries;
+    uint32_t s, i;
+
+    queries = (uint32_t*)MALLOC(sizeof(uint32_t) * LOOKUPS, "benchmark_bst_find_insert()");
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        uint32_t* hashes = (uint32_t*)MALLOC(sizeof(uint32_t) * n, "benchmark_bst_find_insert()");
+        char* keys = (char*)MALLOC(KEY_LENGTH * n, "benchmark_bst_find_insert()");
+
+        benchmark_rand_reset();
+        for(i = 0; i != n; ++i)
+        {
+            hashes[i] = benchmark_rand() & 0x7FFFFFFF;
+            sprintf(keys + i * KEY_LENGTH, "key.%u", i);
+        }
+
+        bstv_find_insert(n, hashes, queries);
+        bsthv_find_insert(n, keys, queries);
+
+        FREE(keys);
+        FREE(hashes);
+    }
+
+    FREE(queries);
+}
@@ -0,0 +1,58 @@
+#include "benchmarks/benchmark.h"
+#include "util/bst_vector.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+static const uint32_t g_sizes[] = {10000, 100000, 1000000};
+
+/*
+ * bstv_insert() shifts on average half of the vector, so filling a bstv
+ * element by element is O(n^2). Beyond this size it takes minutes.
+ */
+#define MAX_INSERT_COUNT 200000
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_bstv_build(void)
+{
+    struct bstv_hash_value_t* pairs;
+    uint32_t s, i;
+    int64_t start;
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        struct bstv_t inserted, built;
+
+        pairs = (struct bstv_hash_value_t*)MALLOC(sizeof(*pairs) * n, "benchmark_bstv_build()");
+        benchmark_rand_reset();
+        for(i = 0; i != n; ++i)
+        {
+            pairs[i].hash = benchmark_rand() & 0x7FFFFFFF;
+            pairs[i].value = pairs + i;
+        }
+
+        bstv_init(&built);
+        start = get_time_in_microseconds();
+        bstv_build_from_unsorted(&built, pairs, n);
+        benchmark_report("bstv_build_from_unsorted", n, n, get_time_in_microseconds() - start);
+
+        if(n <= MAX_INSERT_COUNT)
+        {
+            bstv_init(&inserted);
+            start = get_time_in_microseconds();
+            for(i = 0; i != n; ++i)
+                bstv_insert(&inserted, pairs[i].hash, pairs[i].value);
+            benchmark_report("bstv_insert (one at a time)", n, n, get_time_in_microseconds() - start);
+
+            if(bstv_count(&inserted) != bstv_count(&built))
+                fprintf(stderr, "bstv_build: results differ\n");
+            bstv_clear_free(&inserted);
+        }
+        else
+            printf("  %-48s n=%-9u skipped, O(n^2)\n", "bstv_insert (one at a time)", n);
+
+        bstv_clear_free(&built);
+        FREE(pairs);
+    }
+}
@@ -0,0 +1,67 @@
+#include "benchmarks/benchmark.h"
+#include "util/bst_vector.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+#define LOOKUPS 2000000
+
+static const uint32_t g_sizes[] = {1000, 10000, 100000, 1000000, 4000000};
+
+/* ------------------------------------------------------------------------- */
+static void
+lookup(const struct bstv_t* bstv, const uint32_t* queries, const char* what, uint32_t n)
+{
+    uintptr_t found = 0;
+    uint32_t i;
+    int64_t start;
+
+    start = get_time_in_microseconds();
+    for(i = 0; i != LOOKUPS; ++i)
+        found += (uintptr_t)bstv_find(bstv, queries[i]);
+    benchmark_report(what, n, LOOKUPS, get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(&found);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_bstv_read_optimised(void)
+{
+    struct bstv_hash_value_t* pairs;
+    uint32_t* queries;
+    uint32_t s, i;
+    int64_t start;
+
+    queries = (uint32_t*)MALLOC(sizeof(uint32_t) * LOOKUPS, "benchmark_bstv_read_optimised()");
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        struct bstv_t bstv;
+
+        pairs = (struct bstv_hash_value_t*)MALLOC(sizeof(*pairs) * n, "benchmark_bstv_read_optimised()");
+        benchmark_rand_reset();
+        for(i = 0; i != n; ++i)
+        {
+            pairs[i].hash = benchmark_rand() & 0x7FFFFFFF;
+            pairs[i].value = pairs + i;
+        }
+
+        /* 3 out of 4 lookups hit, like pointers being looked up in the memory report */
+        for(i = 0; i != LOOKUPS; ++i)
+            queries[i] = (i & 3) ? pairs[benchmark_rand() % n].hash : benchmark_rand() & 0x7FFFFFFF;
+
+        bstv_init(&bstv);
+        bstv_build_from_unsorted(&bstv, pairs, n);
+        lookup(&bstv, queries, "bstv_find (sorted)", n);
+
+        start = get_time_in_microseconds();
+        bstv_optimise_for_reads(&bstv);
+        benchmark_report("bstv_optimise_for_reads", n, n, get_time_in_microseconds() - start);
+        lookup(&bstv, queries, "bstv_find (eytzinger)", n);
+
+        bstv_clear_free(&bstv);
+        FREE(pairs);
+    }
+
+    FREE(queries);
+}
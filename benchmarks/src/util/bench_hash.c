@@ -0,0 +1,104 @@
+#include "benchmarks/benchmark.h"
+#include "util/hash.h"
+#include "util/bst_hashed_vector.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+#define BYTES_HASHED (64 * 1024 * 1024)
+#define LOOKUPS 2000000
+#define LOOKUP_KEYS 1024
+
+static const uint32_t g_lengths[] = {4, 8, 16, 24, 32, 64, 128, 256};
+
+static const struct
+{
+    uint32_t(*func)(const char*, uint32_t);
+    const char* name;
+} g_funcs[] = {
+    {hash_jenkins_oaat, "jenkins_oaat"},
+    {hash_wyhash32,     "wyhash32"}
+};
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_hash(void)
+{
+    char* data;
+    char* keys;
+    uint32_t* queries;
+    uint32_t l, f, i;
+
+    /* +1 so keys starting at odd offsets can be hashed too */
+    data = (char*)MALLOC(BYTES_HASHED + 1, "benchmark_hash()");
+    benchmark_rand_reset();
+    for(i = 0; i != BYTES_HASHED + 1; ++i)
+        data[i] = (char)benchmark_rand();
+
+    /* Raw hashing speed. n is the key length, one op is one key */
+    for(l = 0; l != sizeof(g_lengths) / sizeof(*g_lengths); ++l)
+    {
+        uint32_t len = g_lengths[l];
+        uint32_t count = BYTES_HASHED / len;
+        for(f = 0; f != sizeof(g_funcs) / sizeof(*g_funcs); ++f)
+        {
+            char what[64];
+            uint32_t sum = 0;
+            int64_t start = get_time_in_microseconds();
+            for(i = 0; i != count; ++i)
+                sum += g_funcs[f].func(data + 1 + i * len, len);
+            sprintf(what, "%s (unaligned)", g_funcs[f].name);
+            benchmark_report(what, len, count, get_time_in_microseconds() - start);
+            benchmark_do_not_optimise(&sum);
+        }
+    }
+
+    FREE(data);
+
+    /* bsthv lookups with each hash function. n is the key length */
+    keys = (char*)MALLOC(LOOKUP_KEYS * 257, "benchmark_hash()");
+    queries = (uint32_t*)MALLOC(sizeof(uint32_t) * LOOKUPS, "benchmark_hash()");
+    for(i = 0; i != LOOKUPS; ++i)
+        queries[i] = benchmark_rand() % LOOKUP_KEYS;
+
+    for(l = 0; l != sizeof(g_lengths) / sizeof(*g_lengths); ++l)
+    {
+        uint32_t len = g_lengths[l];
+        for(i = 0; i != LOOKUP_KEYS; ++i)
+        {
+            /* unique prefix, padded to the key length */
+            char* key = keys + i * 257;
+            uint32_t c;
+            for(c = 0; c != len; ++c)
+                key[c] = (char)('a' + (c + i) % 26);
+            sprintf(key, "%03x", i);
+            key[3] = 'x';
+            key[len] = '\0';
+        }
+
+        for(f = 0; f != sizeof(g_funcs) / sizeof(*g_funcs); ++f)
+        {
+            char what[64];
+            struct bsthv_t bsthv;
+            uintptr_t found = 0;
+            int64_t start;
+
+            bsthv_set_string_hash_func(g_funcs[f].func);
+            bsthv_init(&bsthv);
+            for(i = 0; i != LOOKUP_KEYS; ++i)
+                bsthv_insert(&bsthv, keys + i * 257, keys + i * 257);
+
+            start = get_time_in_microseconds();
+            for(i = 0; i != LOOKUPS; ++i)
+                found += (uintptr_t)bsthv_find(&bsthv, keys + queries[i] * 257);
+            sprintf(what, "bsthv_find (%s)", g_funcs[f].name);
+            benchmark_report(what, len, LOOKUPS, get_time_in_microseconds() - start);
+            benchmark_do_not_optimise(&found);
+
+            bsthv_clear_free(&bsthv);
+        }
+    }
+
+    bsthv_restore_default_hash_func();
+    FREE(queries);
+    FREE(keys);
+}
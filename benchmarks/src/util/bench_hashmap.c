@@ -0,0 +1,77 @@
+#include "benchmarks/benchmark.h"
+#include "util/hashmap.h"
+#include "util/bst_hashed_vector.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+#define LOOKUPS 2000000
+#define KEY_LENGTH 24
+
+static const uint32_t g_sizes[] = {16, 256, 4096, 65536, 262144};
+
+/*
+ * Both containers are driven through the same set of macros so the timed
+ * loops are identical.
+ */
+#define RUN(prefix, map, n, keys, queries) do {                                  \
+    uintptr_t found = 0;                                                         \
+    uint32_t i;                                                                  \
+    int64_t start;                                                               \
+                                                                                 \
+    prefix##_init(&map);                                                         \
+    start = get_time_in_microseconds();                                          \
+    for(i = 0; i != n; ++i)                                                      \
+        prefix##_insert(&map, keys + i * KEY_LENGTH, (void*)(keys + i * KEY_LENGTH)); \
+    benchmark_report(#prefix "_insert", n, n, get_time_in_microseconds() - start); \
+                                                                                 \
+    start = get_time_in_microseconds();                                          \
+    for(i = 0; i != LOOKUPS; ++i)                                                \
+        found += (uintptr_t)prefix##_find(&map, keys + queries[i] * KEY_LENGTH); \
+    benchmark_report(#prefix "_find (hit)", n, LOOKUPS, get_time_in_microseconds() - start); \
+                                                                                 \
+    start = get_time_in_microseconds();                                          \
+    for(i = 0; i != LOOKUPS; ++i)                                                \
+        found += (uintptr_t)prefix##_find(&map, keys + (n + queries[i]) * KEY_LENGTH); \
+    benchmark_report(#prefix "_find (miss)", n, LOOKUPS, get_time_in_microseconds() - start); \
+                                                                                 \
+    start = get_time_in_microseconds();                                          \
+    for(i = 0; i != n; ++i)                                                      \
+        found += (uintptr_t)prefix##_erase(&map, keys + i * KEY_LENGTH);         \
+    benchmark_report(#prefix "_erase", n, n, get_time_in_microseconds() - start); \
+                                                                                 \
+    benchmark_do_not_optimise(&found);                                           \
+    prefix##_clear_free(&map);                                                   \
+} while(0)
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_hashmap(void)
+{
+    uint32_t* queries;
+    uint32_t s, i;
+
+    queries = (uint32_t*)MALLOC(sizeof(uint32_t) * LOOKUPS, "benchmark_hashmap()");
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        struct bsthv_t bsthv;
+        struct hashmap_t hashmap;
+
+        /* twice as many keys, the second half is used for misses */
+        char* keys = (char*)MALLOC(KEY_LENGTH * n * 2, "benchmark_hashmap()");
+        for(i = 0; i != n * 2; ++i)
+            sprintf(keys + i * KEY_LENGTH, "node.child.%u", i);
+
+        benchmark_rand_reset();
+        for(i = 0; i != LOOKUPS; ++i)
+            queries[i] = benchmark_rand() % n;
+
+        RUN(bsthv, bsthv, n, keys, queries);
+        RUN(hashmap, hashmap, n, keys, queries);
+
+        FREE(keys);
+    }
+
+    FREE(queries);
+}
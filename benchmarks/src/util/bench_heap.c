@@ -0,0 +1,104 @@
+#include "benchmarks/benchmark.h"
+#include "util/heap.h"
+#include "util/ordered_vector.h"
+#include "util/memory.h"
+
+#define OPS 200000
+
+static const uint32_t g_sizes[] = {100, 1000, 10000, 100000};
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Baseline: priorities kept sorted in descending order, so the smallest one
+ * can be popped from the back and inserting has to shift everything after
+ * the insertion point.
+ */
+static void
+sorted_vector_push(struct ordered_vector_t* vector, int64_t priority)
+{
+    const int64_t* data = (const int64_t*)vector->data;
+    uint32_t first = 0, count = vector->count;
+    while(count)
+    {
+        uint32_t half = count / 2;
+        if(data[first + half] > priority)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+            count = half;
+    }
+    ordered_vector_insert(vector, first, &priority);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_heap(void)
+{
+    uint32_t s, i;
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        struct heap_t heap;
+        struct ordered_vector_t sorted;
+        struct heap_item_t* items;
+        int64_t sum = 0;
+        int64_t start;
+
+        /* "hold" model of a timer queue: pop the earliest, push a later one */
+        heap_init(&heap);
+        benchmark_rand_reset();
+        for(i = 0; i != n; ++i)
+            heap_push(&heap, benchmark_rand() % n, NULL, NULL);
+        start = get_time_in_microseconds();
+        for(i = 0; i != OPS; ++i)
+        {
+            int64_t now = heap_peek_priority(&heap);
+            heap_pop(&heap);
+            heap_push(&heap, now + benchmark_rand() % n, NULL, NULL);
+            sum += now;
+        }
+        benchmark_report("heap pop + push", n, OPS, get_time_in_microseconds() - start);
+
+        ordered_vector_init(&sorted, sizeof(int64_t));
+        benchmark_rand_reset();
+        for(i = 0; i != n; ++i)
+            sorted_vector_push(&sorted, benchmark_rand() % n);
+        start = get_time_in_microseconds();
+        for(i = 0; i != OPS; ++i)
+        {
+            int64_t now = *(int64_t*)ordered_vector_pop(&sorted);
+            sorted_vector_push(&sorted, now + benchmark_rand() % n);
+            sum += now;
+        }
+        benchmark_report("sorted vector pop + insert", n, OPS, get_time_in_microseconds() - start);
+        ordered_vector_clear_free(&sorted);
+
+        /* building from an array against pushing one by one */
+        items = (struct heap_item_t*)MALLOC(sizeof(struct heap_item_t) * n, "benchmark_heap()");
+        benchmark_rand_reset();
+        for(i = 0; i != n; ++i)
+        {
+            items[i].priority = benchmark_rand();
+            items[i].value = NULL;
+        }
+        heap_reserve(&heap, n);
+        start = get_time_in_microseconds();
+        heap_build(&heap, items, n, NULL);
+        benchmark_report("heap build", n, n, get_time_in_microseconds() - start);
+        sum += heap_peek_priority(&heap);
+
+        heap_clear(&heap);
+        start = get_time_in_microseconds();
+        for(i = 0; i != n; ++i)
+            heap_push(&heap, items[i].priority, NULL, NULL);
+        benchmark_report("heap push one by one", n, n, get_time_in_microseconds() - start);
+        sum += heap_peek_priority(&heap);
+
+        FREE(items);
+        heap_clear_free(&heap);
+        benchmark_do_not_optimise(&sum);
+    }
+}
@@ -0,0 +1,55 @@
+#include "benchmarks/benchmark.h"
+#include "util/id_allocator.h"
+#include "util/bst_vector.h"
+
+#define OPS 200000
+
+static const uint32_t g_sizes[] = {100, 1000, 10000};
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_id_allocator(void)
+{
+    uint32_t s, i;
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        struct id_allocator_t ids;
+        struct bstv_t bstv;
+        uint32_t sum = 0;
+        int64_t start;
+
+        /* n IDs in use, then repeatedly release a random one and allocate a new one */
+        id_allocator_init(&ids);
+        for(i = 0; i != n; ++i)
+            id_allocator_alloc(&ids);
+        benchmark_rand_reset();
+        start = get_time_in_microseconds();
+        for(i = 0; i != OPS; ++i)
+        {
+            id_allocator_release(&ids, benchmark_rand() % n);
+            sum += id_allocator_alloc(&ids);
+        }
+        benchmark_report("id_allocator release + alloc", n, OPS, get_time_in_microseconds() - start);
+        id_allocator_clear_free(&ids);
+
+        bstv_init(&bstv);
+        for(i = 0; i != n; ++i)
+            bstv_insert(&bstv, i, NULL);
+        benchmark_rand_reset();
+        start = get_time_in_microseconds();
+        for(i = 0; i != OPS; ++i)
+        {
+            uint32_t id;
+            bstv_erase(&bstv, benchmark_rand() % n);
+            id = bstv_find_unused_hash(&bstv);
+            bstv_insert(&bstv, id, NULL);
+            sum += id;
+        }
+        benchmark_report("bstv erase + find_unused_hash + insert", n, OPS, get_time_in_microseconds() - start);
+        bstv_clear_free(&bstv);
+
+        benchmark_do_not_optimise(&sum);
+    }
+}
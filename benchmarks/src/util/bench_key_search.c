@@ -0,0 +1,71 @@
+#include "benchmarks/benchmark.h"
+#include "util/key_search.h"
+#include "util/memory.h"
+#include <stdlib.h>
+
+#define LOOKUPS 4000000
+
+static const uint32_t g_sizes[] = {8, 32, 128, 1024, 65536, 1048576};
+
+static const struct
+{
+    key_search_impl_e impl;
+    const char* name;
+} g_impls[] = {
+    {KEY_SEARCH_SCALAR, "key_search (scalar)"},
+    {KEY_SEARCH_SSE2,   "key_search (sse2)"},
+    {KEY_SEARCH_AVX2,   "key_search (avx2)"}
+};
+
+/* ------------------------------------------------------------------------- */
+static int
+compare_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_key_search(void)
+{
+    key_search_impl_e old_impl = key_search_get_impl();
+    uint32_t* queries;
+    uint32_t s, m, i;
+
+    queries = (uint32_t*)MALLOC(sizeof(uint32_t) * LOOKUPS, "benchmark_key_search()");
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        uint32_t* keys = (uint32_t*)MALLOC(sizeof(uint32_t) * n, "benchmark_key_search()");
+
+        benchmark_rand_reset();
+        for(i = 0; i != n; ++i)
+            keys[i] = benchmark_rand();
+        qsort(keys, n, sizeof(uint32_t), compare_u32);
+        for(i = 0; i != LOOKUPS; ++i)
+            queries[i] = (i & 1) ? keys[benchmark_rand() % n] : benchmark_rand();
+
+        for(m = 0; m != sizeof(g_impls) / sizeof(*g_impls); ++m)
+        {
+            uintptr_t sum = 0;
+            int64_t start;
+
+            if(!key_search_set_impl(g_impls[m].impl))
+                continue;
+
+            start = get_time_in_microseconds();
+            for(i = 0; i != LOOKUPS; ++i)
+                sum += key_search_lower_bound(keys, n, queries[i]);
+            benchmark_report(g_impls[m].name, n, LOOKUPS, get_time_in_microseconds() - start);
+            benchmark_do_not_optimise(&sum);
+        }
+
+        FREE(keys);
+    }
+
+    key_search_set_impl(old_impl);
+    FREE(queries);
+}
@@ -0,0 +1,217 @@
+#include "benchmarks/benchmark.h"
+#include "util/mpmc_queue.h"
+#include "util/atomic.h"
+#include "util/thread.h"
+#include "util/memory.h"
+
+#define TRANSFER_COUNT 1000000
+#define CAPACITY 1024
+#define MAX_THREADS 16
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Baseline: a plain ring buffer protected by a single mutex, with condition
+ * variables for waiting. This is what the queue replaces.
+ */
+struct locked_queue_t
+{
+    struct mutex_t* mutex;
+    struct cond_t* not_empty;
+    struct cond_t* not_full;
+    uint32_t data[CAPACITY];
+    uint32_t read, write;
+    char closed;
+};
+
+static void
+locked_queue_enqueue(struct locked_queue_t* queue, uint32_t value)
+{
+    mutex_lock(queue->mutex);
+    while(queue->write - queue->read == CAPACITY)
+        cond_wait(queue->not_full, queue->mutex);
+    queue->data[queue->write++ % CAPACITY] = value;
+    cond_signal(queue->not_empty);
+    mutex_unlock(queue->mutex);
+}
+
+static char
+locked_queue_dequeue(struct locked_queue_t* queue, uint32_t* value)
+{
+    mutex_lock(queue->mutex);
+    while(queue->write == queue->read && !queue->closed)
+        cond_wait(queue->not_empty, queue->mutex);
+    if(queue->write == queue->read)
+    {
+        mutex_unlock(queue->mutex);
+        return 0;
+    }
+    *value = queue->data[queue->read++ % CAPACITY];
+    cond_signal(queue->not_full);
+    mutex_unlock(queue->mutex);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+struct bench_state_t
+{
+    struct mpmc_queue_t queue;
+    struct locked_queue_t* locked;
+    uint32_t items_per_producer;
+    volatile uint32_t sum;
+};
+
+static void
+mpmc_producer(void* arg)
+{
+    struct bench_state_t* state = (struct bench_state_t*)arg;
+    uint32_t i;
+    for(i = 0; i != state->items_per_producer; ++i)
+        mpmc_queue_enqueue(&state->queue, &i);
+}
+
+static void
+mpmc_consumer(void* arg)
+{
+    struct bench_state_t* state = (struct bench_state_t*)arg;
+    uint32_t value, sum = 0;
+    while(mpmc_queue_dequeue(&state->queue, &value))
+        sum += value;
+    ATOMIC_FETCH_ADD(&state->sum, sum);
+}
+
+static void
+locked_producer(void* arg)
+{
+    struct bench_state_t* state = (struct bench_state_t*)arg;
+    uint32_t i;
+    for(i = 0; i != state->items_per_producer; ++i)
+        locked_queue_enqueue(state->locked, i);
+}
+
+static void
+locked_consumer(void* arg)
+{
+    struct bench_state_t* state = (struct bench_state_t*)arg;
+    uint32_t value, sum = 0;
+    while(locked_queue_dequeue(state->locked, &value))
+        sum += value;
+    ATOMIC_FETCH_ADD(&state->sum, sum);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+close_locked(struct locked_queue_t* queue)
+{
+    mutex_lock(queue->mutex);
+    queue->closed = 1;
+    cond_broadcast(queue->not_empty);
+    mutex_unlock(queue->mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+static int64_t
+run(struct bench_state_t* state, uint32_t producers, uint32_t consumers,
+    thread_func produce, thread_func consume, char use_locked)
+{
+    struct thread_t* threads[MAX_THREADS];
+    uint32_t i;
+    int64_t start = get_time_in_microseconds();
+
+    for(i = 0; i != consumers; ++i)
+        threads[i] = thread_create(consume, state);
+    for(i = 0; i != producers; ++i)
+        threads[consumers + i] = thread_create(produce, state);
+
+    for(i = 0; i != producers; ++i)
+        thread_join(threads[consumers + i]);
+    if(use_locked)
+        close_locked(state->locked);
+    else
+        mpmc_queue_close(&state->queue);
+    for(i = 0; i != consumers; ++i)
+        thread_join(threads[i]);
+
+    return get_time_in_microseconds() - start;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * One thread fills the queue and then drains it again, so nothing is ever
+ * contended. This is the baseline for the other thread counts.
+ */
+static int64_t
+run_single(struct bench_state_t* state, char use_locked)
+{
+    uint32_t i, j, value, sum = 0;
+    int64_t start = get_time_in_microseconds();
+
+    for(i = 0; i < TRANSFER_COUNT; i += CAPACITY)
+    {
+        uint32_t batch = TRANSFER_COUNT - i < CAPACITY ? TRANSFER_COUNT - i : CAPACITY;
+        if(use_locked)
+        {
+            for(j = 0; j != batch; ++j)
+                locked_queue_enqueue(state->locked, j);
+            for(j = 0; j != batch; ++j)
+                if(locked_queue_dequeue(state->locked, &value))
+                    sum += value;
+        }
+        else
+        {
+            for(j = 0; j != batch; ++j)
+                mpmc_queue_enqueue(&state->queue, &j);
+            for(j = 0; j != batch; ++j)
+                if(mpmc_queue_dequeue(&state->queue, &value))
+                    sum += value;
+        }
+    }
+
+    state->sum = sum;
+    return get_time_in_microseconds() - start;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_mpmc_queue(void)
+{
+    static const uint32_t thread_counts[] = {1, 2, 4, 8, 16};
+    uint32_t t;
+
+    /* half the threads produce, the other half consume. A single thread
+     * does both, one after the other */
+    for(t = 0; t != sizeof(thread_counts) / sizeof(*thread_counts); ++t)
+    {
+        uint32_t threads = thread_counts[t];
+        struct bench_state_t state;
+        int64_t time;
+
+        state.items_per_producer = threads == 1 ? TRANSFER_COUNT : TRANSFER_COUNT / (threads / 2);
+        state.sum = 0;
+
+        mpmc_queue_init(&state.queue, sizeof(uint32_t), CAPACITY);
+        if(threads == 1)
+            time = run_single(&state, 0);
+        else
+            time = run(&state, threads / 2, threads / 2, mpmc_producer, mpmc_consumer, 0);
+        benchmark_report("mpmc queue", threads, TRANSFER_COUNT, time);
+        mpmc_queue_clear_free(&state.queue);
+
+        state.locked = (struct locked_queue_t*)MALLOC(sizeof *state.locked, "benchmark_mpmc_queue()");
+        state.locked->mutex = mutex_create();
+        state.locked->not_empty = cond_create();
+        state.locked->not_full = cond_create();
+        state.locked->read = state.locked->write = 0;
+        state.locked->closed = 0;
+        if(threads == 1)
+            time = run_single(&state, 1);
+        else
+            time = run(&state, threads / 2, threads / 2, locked_producer, locked_consumer, 1);
+        benchmark_report("mutex + condition variable queue", threads, TRANSFER_COUNT, time);
+        cond_destroy(state.locked->not_full);
+        cond_destroy(state.locked->not_empty);
+        mutex_destroy(state.locked->mutex);
+        FREE(state.locked);
+
+        benchmark_do_not_optimise((const void*)&state.sum);
+    }
+}
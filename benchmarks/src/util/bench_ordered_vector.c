@@ -0,0 +1,98 @@
+#include "benchmarks/benchmark.h"
+#include "util/ordered_vector.h"
+#include <stdio.h>
+
+#define BATCH_SIZE 1000
+#define ERASE_EVERY 1000
+
+static const uint32_t g_sizes[] = {10000, 100000, 1000000};
+
+/* ------------------------------------------------------------------------- */
+static void
+fill(struct ordered_vector_t* vector, uint32_t n)
+{
+    uint32_t i;
+    ordered_vector_clear(vector);
+    for(i = 0; i != n; ++i)
+        *(uint32_t*)ordered_vector_push_emplace(vector) = i;
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+is_multiple_of_erase_every(const void* element, void* user_data)
+{
+    return (*(const uint32_t*)element % ERASE_EVERY) == 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_ordered_vector_range(void)
+{
+    struct ordered_vector_t vector;
+    uint32_t batch[BATCH_SIZE];
+    uint32_t s, i;
+    int64_t start;
+
+    for(i = 0; i != BATCH_SIZE; ++i)
+        batch[i] = benchmark_rand();
+
+    ordered_vector_init(&vector, sizeof(uint32_t));
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        uint32_t erased;
+
+        /* insert a batch into the middle, one element at a time */
+        fill(&vector, n);
+        start = get_time_in_microseconds();
+        for(i = 0; i != BATCH_SIZE; ++i)
+            ordered_vector_insert(&vector, n / 2 + i, &batch[i]);
+        benchmark_report("insert (element by element)", n, BATCH_SIZE,
+                         get_time_in_microseconds() - start);
+
+        /* insert the same batch with a single call */
+        fill(&vector, n);
+        start = get_time_in_microseconds();
+        ordered_vector_insert_range(&vector, n / 2, batch, BATCH_SIZE);
+        benchmark_report("insert_range", n, BATCH_SIZE,
+                         get_time_in_microseconds() - start);
+
+        /* erase a batch from the middle, one element at a time */
+        fill(&vector, n);
+        start = get_time_in_microseconds();
+        for(i = 0; i != BATCH_SIZE; ++i)
+            ordered_vector_erase_index(&vector, n / 2);
+        benchmark_report("erase_index (element by element)", n, BATCH_SIZE,
+                         get_time_in_microseconds() - start);
+
+        /* erase the same batch with a single call */
+        fill(&vector, n);
+        start = get_time_in_microseconds();
+        ordered_vector_erase_range(&vector, n / 2, n / 2 + BATCH_SIZE);
+        benchmark_report("erase_range", n, BATCH_SIZE,
+                         get_time_in_microseconds() - start);
+
+        /* erase every Nth element by scanning and erasing matches */
+        fill(&vector, n);
+        erased = 0;
+        start = get_time_in_microseconds();
+        for(i = 0; i < ordered_vector_count(&vector); ++i)
+            if(is_multiple_of_erase_every(ordered_vector_get_element(&vector, i), NULL))
+            {
+                ordered_vector_erase_index(&vector, i--);
+                ++erased;
+            }
+        benchmark_report("erase_index loop (every 1000th)", n, erased,
+                         get_time_in_microseconds() - start);
+
+        /* same thing with a single compaction pass */
+        fill(&vector, n);
+        start = get_time_in_microseconds();
+        erased = ordered_vector_erase_if(&vector, is_multiple_of_erase_every, NULL);
+        benchmark_report("erase_if (every 1000th)", n, erased,
+                         get_time_in_microseconds() - start);
+    }
+
+    ordered_vector_clear_free(&vector);
+}
@@ -0,0 +1,48 @@
+#include "benchmarks/benchmark.h"
+#include "util/ptree.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+static const uint32_t g_sizes[] = {100, 1000, 10000, 50000};
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_ptree_wide(void)
+{
+    uint32_t s, i;
+    char key[16];
+
+    for(s = 0; s != sizeof(g_sizes) / sizeof(*g_sizes); ++s)
+    {
+        uint32_t n = g_sizes[s];
+        struct ptree_t* tree = ptree_create(NULL);
+        struct ptree_t** nodes = (struct ptree_t**)MALLOC(sizeof(struct ptree_t*) * n, "benchmark_ptree_wide()");
+        struct ptree_t* other = ptree_create(NULL);
+        int64_t start;
+
+        for(i = 0; i != n; ++i)
+        {
+            sprintf(key, "node%u", i);
+            nodes[i] = ptree_set(tree, key, NULL);
+        }
+
+        /* every node knows its key, moving it doesn't have to search for it */
+        start = get_time_in_microseconds();
+        for(i = 0; i != n; ++i)
+        {
+            sprintf(key, "node%u", i);
+            ptree_set_parent(nodes[i], other, key);
+        }
+        benchmark_report("ptree_set_parent (move all children)", n, n, get_time_in_microseconds() - start);
+
+        /* destroying a node removes it from its parent */
+        start = get_time_in_microseconds();
+        for(i = 0; i != n; ++i)
+            ptree_destroy(nodes[i]);
+        benchmark_report("ptree_destroy (each child)", n, n, get_time_in_microseconds() - start);
+
+        FREE(nodes);
+        ptree_destroy(other);
+        ptree_destroy(tree);
+    }
+}
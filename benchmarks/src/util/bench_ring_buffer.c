@@ -0,0 +1,110 @@
+#include "benchmarks/benchmark.h"
+#include "util/ring_buffer.h"
+#include "util/thread.h"
+
+#define TRANSFER_COUNT 4000000
+#define BATCH_SIZE 64
+
+struct producer_args_t
+{
+    struct ring_buffer_t* rb;
+    uint32_t batch;
+};
+
+/* ------------------------------------------------------------------------- */
+static void
+producer(void* arg)
+{
+    struct producer_args_t* args = (struct producer_args_t*)arg;
+    uint32_t buffer[BATCH_SIZE];
+    uint32_t next = 0;
+
+    while(next != TRANSFER_COUNT)
+    {
+        uint32_t i, count, sent;
+
+        if(args->batch == 1)
+        {
+            if(ring_buffer_enqueue(args->rb, &next))
+                ++next;
+            else
+                thread_yield();
+            continue;
+        }
+
+        count = TRANSFER_COUNT - next;
+        if(count > args->batch)
+            count = args->batch;
+        for(i = 0; i != count; ++i)
+            buffer[i] = next + i;
+        for(sent = 0; sent != count; )
+        {
+            uint32_t n = ring_buffer_enqueue_n(args->rb, buffer + sent, count - sent);
+            if(n == 0)
+                thread_yield();
+            sent += n;
+        }
+        next += count;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+static uint32_t
+consume(struct ring_buffer_t* rb, uint32_t batch)
+{
+    uint32_t buffer[BATCH_SIZE];
+    uint32_t received = 0, sum = 0;
+
+    while(received != TRANSFER_COUNT)
+    {
+        uint32_t i, count = ring_buffer_dequeue_n(rb, buffer, batch);
+        if(count == 0)
+            thread_yield();
+        for(i = 0; i != count; ++i)
+            sum += buffer[i];
+        received += count;
+    }
+
+    return sum;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_ring_buffer(void)
+{
+    static const uint32_t batches[] = {1, 8, BATCH_SIZE};
+    uint32_t b;
+
+    /*
+     * Either side yields when the buffer is full (or empty), so this also
+     * gives sensible numbers when both threads share a single core.
+     */
+    for(b = 0; b != sizeof(batches) / sizeof(*batches); ++b)
+    {
+        struct ring_buffer_t rb;
+        struct producer_args_t args;
+        struct thread_t* thread;
+        uint32_t sum;
+        int64_t start;
+
+        ring_buffer_init_with_capacity(&rb, sizeof(uint32_t), 1024);
+        args.rb = &rb;
+        args.batch = batches[b];
+
+        start = get_time_in_microseconds();
+        if(!(thread = thread_create(producer, &args)))
+        {
+            ring_buffer_clear_free(&rb);
+            return;
+        }
+        sum = consume(&rb, batches[b]);
+        thread_join(thread);
+        benchmark_report(b == 0 ? "ring buffer enqueue/dequeue" :
+                         b == 1 ? "ring buffer batches of 8" :
+                                  "ring buffer batches of 64",
+                         batches[b], TRANSFER_COUNT, get_time_in_microseconds() - start);
+
+        benchmark_do_not_optimise(&sum);
+        ring_buffer_clear_free(&rb);
+    }
+}
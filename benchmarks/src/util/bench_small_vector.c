@@ -0,0 +1,185 @@
+#include "benchmarks/benchmark.h"
+#include "util/unordered_vector.h"
+#include "util/ptree.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+#define EVENT_COUNT 100000
+#define FIRE_ROUNDS 10
+#define INLINE_LISTENERS 4
+
+static const uint32_t g_ptree_sizes[] = {1000, 10000, 100000};
+
+/*
+ * Same layout as event_t in the game library. The listener vector either
+ * allocates its memory separately or uses the inline array.
+ */
+typedef void (*listener_func)(void* event, void* data);
+struct listener_t
+{
+    listener_func callback;
+};
+struct event_t
+{
+    char* name;
+    void* game;
+    struct unordered_vector_t listeners;
+    struct listener_t listeners_inline[INLINE_LISTENERS];
+};
+
+static uint32_t g_calls;
+
+/* ------------------------------------------------------------------------- */
+static void on_event_1(void* event, void* data) { ++g_calls; }
+static void on_event_2(void* event, void* data) { g_calls += 2; }
+static void on_event_3(void* event, void* data) { g_calls += 3; }
+static void on_event_4(void* event, void* data) { g_calls += 4; }
+static const listener_func g_callbacks[] = {on_event_1, on_event_2, on_event_3, on_event_4};
+
+/* ------------------------------------------------------------------------- */
+static struct event_t**
+create_events(const uint32_t* order, char use_inline_storage)
+{
+    struct event_t** events;
+    uint32_t i, l;
+
+    events = (struct event_t**)MALLOC(sizeof(struct event_t*) * EVENT_COUNT, "create_events()");
+    for(i = 0; i != EVENT_COUNT; ++i)
+    {
+        struct event_t* event = (struct event_t*)MALLOC(sizeof *event, "create_events()");
+        if(use_inline_storage)
+            unordered_vector_init_inline(&event->listeners, sizeof(struct listener_t),
+                                         event->listeners_inline, INLINE_LISTENERS);
+        else
+            unordered_vector_init(&event->listeners, sizeof(struct listener_t));
+        events[i] = event;
+    }
+
+    /*
+     * Listeners register one at a time in no particular order, like systems
+     * subscribing to events during start-up. Most events end up with between
+     * 1 and 4 listeners.
+     */
+    for(l = 0; l != INLINE_LISTENERS; ++l)
+        for(i = 0; i != EVENT_COUNT; ++i)
+        {
+            struct event_t* event = events[order[i]];
+            if(l > order[i] % INLINE_LISTENERS)
+                continue;
+            ((struct listener_t*)unordered_vector_push_emplace(&event->listeners))->callback = g_callbacks[l];
+        }
+
+    return events;
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+destroy_events(struct event_t** events)
+{
+    uint32_t i;
+    for(i = 0; i != EVENT_COUNT; ++i)
+    {
+        unordered_vector_clear_free(&events[i]->listeners);
+        FREE(events[i]);
+    }
+    FREE(events);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+fire_events(struct event_t** events, const uint32_t* order, const char* what)
+{
+    uint32_t round, i;
+    int64_t start;
+
+    g_calls = 0;
+    start = get_time_in_microseconds();
+    for(round = 0; round != FIRE_ROUNDS; ++round)
+        for(i = 0; i != EVENT_COUNT; ++i)
+        {
+            struct event_t* event = events[order[i]];
+            UNORDERED_VECTOR_FOR_EACH(&event->listeners, struct listener_t, listener)
+                listener->callback(event, NULL);
+            UNORDERED_VECTOR_END_EACH
+        }
+    benchmark_report(what, EVENT_COUNT, EVENT_COUNT * FIRE_ROUNDS,
+                     get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(&g_calls);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_small_vector_event_fire(void)
+{
+    struct event_t** events;
+    uint32_t* order;
+    uint32_t i;
+    int64_t start;
+
+    /* fire events in random order, like a game would */
+    order = (uint32_t*)MALLOC(sizeof(uint32_t) * EVENT_COUNT, "benchmark_small_vector_event_fire()");
+    for(i = 0; i != EVENT_COUNT; ++i)
+        order[i] = i;
+    for(i = EVENT_COUNT - 1; i > 0; --i)
+    {
+        uint32_t j = benchmark_rand() % (i + 1);
+        uint32_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    start = get_time_in_microseconds();
+    events = create_events(order, 0);
+    benchmark_report("register listeners (heap)", EVENT_COUNT, EVENT_COUNT,
+                     get_time_in_microseconds() - start);
+    fire_events(events, order, "event_fire (heap)");
+    destroy_events(events);
+
+    start = get_time_in_microseconds();
+    events = create_events(order, 1);
+    benchmark_report("register listeners (inline)", EVENT_COUNT, EVENT_COUNT,
+                     get_time_in_microseconds() - start);
+    fire_events(events, order, "event_fire (inline)");
+    destroy_events(events);
+
+    FREE(order);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_small_vector_ptree_load(void)
+{
+    uint32_t s, i;
+    char key[64];
+    int64_t start;
+
+    for(s = 0; s != sizeof(g_ptree_sizes) / sizeof(*g_ptree_sizes); ++s)
+    {
+        uint32_t n = g_ptree_sizes[s];
+        struct ptree_t* tree = ptree_create(NULL);
+
+        /*
+         * Config files are wide and shallow: many sections, each with a few
+         * groups holding a few values.
+         */
+        start = get_time_in_microseconds();
+        for(i = 0; i != n; ++i)
+        {
+            sprintf(key, "section%u.group%u.value%u", i / 12, (i / 4) % 3, i % 4);
+            ptree_set(tree, key, NULL);
+        }
+        benchmark_report("ptree_set", n, n, get_time_in_microseconds() - start);
+
+        start = get_time_in_microseconds();
+        for(i = 0; i != n; ++i)
+        {
+            sprintf(key, "section%u.group%u.value%u", i / 12, (i / 4) % 3, i % 4);
+            benchmark_do_not_optimise(ptree_get_node(tree, key));
+        }
+        benchmark_report("ptree_get_node", n, n, get_time_in_microseconds() - start);
+
+        start = get_time_in_microseconds();
+        ptree_destroy(tree);
+        benchmark_report("ptree_destroy", n, n, get_time_in_microseconds() - start);
+    }
+}
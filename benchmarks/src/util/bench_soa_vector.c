@@ -0,0 +1,163 @@
+#include "benchmarks/benchmark.h"
+#include "util/ordered_vector.h"
+#include "util/soa_vector.h"
+#include <stdio.h>
+
+#define SEGMENT_COUNT 100000
+#define ROUNDS 100
+
+/*
+ * A snake segment as it would be stored in an array of structs. The
+ * position update only needs the position and direction, everything else
+ * is dragged through the cache for nothing.
+ */
+struct segment_t
+{
+    float x, y;
+    float dir_x, dir_y;
+    float radius;
+    float target_x, target_y;
+    uint32_t colour;
+    void* snake;
+    uint32_t flags;
+    float age;
+};
+
+enum segment_column_e
+{
+    SEGMENT_X,
+    SEGMENT_Y,
+    SEGMENT_DIR_X,
+    SEGMENT_DIR_Y,
+    SEGMENT_RADIUS,
+    SEGMENT_TARGET_X,
+    SEGMENT_TARGET_Y,
+    SEGMENT_COLOUR,
+    SEGMENT_SNAKE,
+    SEGMENT_FLAGS,
+    SEGMENT_AGE,
+
+    SEGMENT_COLUMN_COUNT
+};
+
+static const uint32_t g_segment_column_sizes[SEGMENT_COLUMN_COUNT] = {
+    sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(float),
+    sizeof(float), sizeof(float), sizeof(uint32_t), sizeof(void*),
+    sizeof(uint32_t), sizeof(float)
+};
+
+/* ------------------------------------------------------------------------- */
+static float
+random_float(void)
+{
+    return (float)(benchmark_rand() % 2000) / 1000.0f - 1.0f;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_soa_vector_segments(void)
+{
+    struct ordered_vector_t aos;
+    struct soa_vector_t soa;
+    uint32_t i, round;
+    float sum;
+    const float speed = 0.016f;
+    int64_t start;
+
+    ordered_vector_init(&aos, sizeof(struct segment_t));
+    soa_vector_init(&soa, SEGMENT_COLUMN_COUNT, g_segment_column_sizes);
+
+    benchmark_rand_reset();
+    for(i = 0; i != SEGMENT_COUNT; ++i)
+    {
+        struct segment_t* segment = (struct segment_t*)ordered_vector_push_emplace(&aos);
+        segment->x = random_float();
+        segment->y = random_float();
+        segment->dir_x = random_float();
+        segment->dir_y = random_float();
+        segment->radius = 1.0f;
+        segment->target_x = 0.0f;
+        segment->target_y = 0.0f;
+        segment->colour = 0;
+        segment->snake = NULL;
+        segment->flags = 0;
+        segment->age = 0.0f;
+
+        soa_vector_push_emplace(&soa);
+        *(float*)soa_vector_get(&soa, SEGMENT_X, i) = segment->x;
+        *(float*)soa_vector_get(&soa, SEGMENT_Y, i) = segment->y;
+        *(float*)soa_vector_get(&soa, SEGMENT_DIR_X, i) = segment->dir_x;
+        *(float*)soa_vector_get(&soa, SEGMENT_DIR_Y, i) = segment->dir_y;
+        *(float*)soa_vector_get(&soa, SEGMENT_RADIUS, i) = segment->radius;
+        *(float*)soa_vector_get(&soa, SEGMENT_TARGET_X, i) = segment->target_x;
+        *(float*)soa_vector_get(&soa, SEGMENT_TARGET_Y, i) = segment->target_y;
+        *(uint32_t*)soa_vector_get(&soa, SEGMENT_COLOUR, i) = segment->colour;
+        *(void**)soa_vector_get(&soa, SEGMENT_SNAKE, i) = segment->snake;
+        *(uint32_t*)soa_vector_get(&soa, SEGMENT_FLAGS, i) = segment->flags;
+        *(float*)soa_vector_get(&soa, SEGMENT_AGE, i) = segment->age;
+    }
+
+    /* position update, array of structs */
+    start = get_time_in_microseconds();
+    for(round = 0; round != ROUNDS; ++round)
+    {
+        struct segment_t* segment = (struct segment_t*)aos.data;
+        for(i = 0; i != SEGMENT_COUNT; ++i)
+        {
+            segment[i].x += segment[i].dir_x * speed;
+            segment[i].y += segment[i].dir_y * speed;
+        }
+    }
+    benchmark_report("position update (AoS)", SEGMENT_COUNT, SEGMENT_COUNT * ROUNDS,
+                     get_time_in_microseconds() - start);
+
+    /* position update, structure of arrays */
+    start = get_time_in_microseconds();
+    for(round = 0; round != ROUNDS; ++round)
+    {
+        float* x = (float*)soa_vector_column(&soa, SEGMENT_X);
+        float* y = (float*)soa_vector_column(&soa, SEGMENT_Y);
+        const float* dir_x = (const float*)soa_vector_column(&soa, SEGMENT_DIR_X);
+        const float* dir_y = (const float*)soa_vector_column(&soa, SEGMENT_DIR_Y);
+        for(i = 0; i != SEGMENT_COUNT; ++i)
+        {
+            x[i] += dir_x[i] * speed;
+            y[i] += dir_y[i] * speed;
+        }
+    }
+    benchmark_report("position update (SoA)", SEGMENT_COUNT, SEGMENT_COUNT * ROUNDS,
+                     get_time_in_microseconds() - start);
+
+    /* both layouts must have computed the same thing */
+    sum = 0.0f;
+    for(i = 0; i != SEGMENT_COUNT; ++i)
+    {
+        struct segment_t* segment = (struct segment_t*)ordered_vector_get_element(&aos, i);
+        sum += segment->x - *(float*)soa_vector_get(&soa, SEGMENT_X, i);
+        sum += segment->y - *(float*)soa_vector_get(&soa, SEGMENT_Y, i);
+    }
+    if(sum != 0.0f)
+        fprintf(stderr, "soa_vector_segments: AoS and SoA results differ\n");
+    benchmark_do_not_optimise(&sum);
+
+    /* swap-remove a tenth of the segments, like snakes dying */
+    start = get_time_in_microseconds();
+    for(i = 0; i != SEGMENT_COUNT / 10; ++i)
+    {
+        uint32_t index = benchmark_rand() % aos.count;
+        struct segment_t* last = (struct segment_t*)ordered_vector_back(&aos);
+        *(struct segment_t*)ordered_vector_get_element(&aos, index) = *last;
+        ordered_vector_pop(&aos);
+    }
+    benchmark_report("swap-remove (AoS)", SEGMENT_COUNT, SEGMENT_COUNT / 10,
+                     get_time_in_microseconds() - start);
+
+    start = get_time_in_microseconds();
+    for(i = 0; i != SEGMENT_COUNT / 10; ++i)
+        soa_vector_erase_index(&soa, benchmark_rand() % soa_vector_count(&soa));
+    benchmark_report("swap-remove (SoA)", SEGMENT_COUNT, SEGMENT_COUNT / 10,
+                     get_time_in_microseconds() - start);
+
+    soa_vector_clear_free(&soa);
+    ordered_vector_clear_free(&aos);
+}
@@ -0,0 +1,59 @@
+#include "benchmarks/benchmark.h"
+#include "util/bst_hashed_vector.h"
+#include "util/string_pool.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+#define MAPS 20000
+#define KEYS_PER_MAP 8
+
+static const char* g_keys[KEYS_PER_MAP] = {
+    "name", "position", "rotation", "scale", "mesh", "material", "parent", "tag"
+};
+
+/*
+ * Simulates loading a document where many nodes have the same handful of
+ * keys: MAPS small maps, each with KEYS_PER_MAP entries.
+ */
+static void
+run(const char* what, struct string_pool_t* shared_pool, char private_pool)
+{
+    struct bsthv_t* maps;
+    uint32_t m, k;
+    int64_t start;
+    int value = 0;
+
+    maps = (struct bsthv_t*)MALLOC(sizeof(struct bsthv_t) * MAPS, "benchmark_string_pool()");
+
+    start = get_time_in_microseconds();
+    for(m = 0; m != MAPS; ++m)
+    {
+        bsthv_init(&maps[m]);
+        if(shared_pool)
+            bsthv_set_string_pool(&maps[m], shared_pool);
+        else if(private_pool)
+            bsthv_set_string_pool(&maps[m], NULL);
+        for(k = 0; k != KEYS_PER_MAP; ++k)
+            bsthv_insert(&maps[m], g_keys[k], &value);
+    }
+    for(m = 0; m != MAPS; ++m)
+        bsthv_clear_free(&maps[m]);
+    if(shared_pool)
+        string_pool_clear_free(shared_pool);
+    benchmark_report(what, MAPS * KEYS_PER_MAP, MAPS * KEYS_PER_MAP, get_time_in_microseconds() - start);
+
+    FREE(maps);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_string_pool(void)
+{
+    struct string_pool_t pool;
+
+    string_pool_init(&pool);
+    run("bsthv insert + clear_free (malloc per key)", NULL, 0);
+    run("bsthv insert + clear_free (private pool)", NULL, 1);
+    run("bsthv insert + clear_free (shared pool)", &pool, 0);
+    string_pool_clear_free(&pool);
+}
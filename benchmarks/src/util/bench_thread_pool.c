@@ -0,0 +1,127 @@
+#include "benchmarks/benchmark.h"
+#include "util/thread_pool.h"
+#include <stdio.h>
+
+#ifdef ENABLE_THREAD_POOL
+
+#include "util/thread.h"
+#include "util/memory.h"
+
+#define ENTITY_COUNT 200000
+#define TICKS 20
+#define GRAIN 1024
+
+/*
+ * Synthetic per-entity update, roughly what moving a snake head costs: steer
+ * towards a target, normalise the direction and integrate the position.
+ */
+struct entity_t
+{
+    float x, y;
+    float dir_x, dir_y;
+    float target_x, target_y;
+    float speed;
+};
+
+/* ------------------------------------------------------------------------- */
+static float
+inv_sqrt(float x)
+{
+    /* a few Newton steps so the update doesn't depend on libm */
+    float y = 1.0f / (x > 1.0f ? x : 1.0f);
+    int i;
+    for(i = 0; i != 4; ++i)
+        y = y * (1.5f - 0.5f * x * y * y);
+    return y;
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+update_entities(void* arg, uint32_t begin, uint32_t end)
+{
+    struct entity_t* entities = (struct entity_t*)arg;
+    for(; begin != end; ++begin)
+    {
+        struct entity_t* e = &entities[begin];
+        float dx = e->target_x - e->x;
+        float dy = e->target_y - e->y;
+        float len = inv_sqrt(dx * dx + dy * dy + 1.0f);
+        e->dir_x = e->dir_x * 0.9f + dx * len * 0.1f;
+        e->dir_y = e->dir_y * 0.9f + dy * len * 0.1f;
+        len = inv_sqrt(e->dir_x * e->dir_x + e->dir_y * e->dir_y + 0.0001f);
+        e->dir_x *= len;
+        e->dir_y *= len;
+        e->x += e->dir_x * e->speed;
+        e->y += e->dir_y * e->speed;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+reset_entities(struct entity_t* entities)
+{
+    uint32_t i;
+    benchmark_rand_reset();
+    for(i = 0; i != ENTITY_COUNT; ++i)
+    {
+        entities[i].x = (float)(benchmark_rand() % 1000);
+        entities[i].y = (float)(benchmark_rand() % 1000);
+        entities[i].dir_x = 1.0f;
+        entities[i].dir_y = 0.0f;
+        entities[i].target_x = (float)(benchmark_rand() % 1000);
+        entities[i].target_y = (float)(benchmark_rand() % 1000);
+        entities[i].speed = 1.0f + (float)(benchmark_rand() % 4);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_thread_pool(void)
+{
+    struct entity_t* entities;
+    uint32_t cpus = thread_cpu_count();
+    uint32_t workers, tick;
+    int64_t start;
+
+    entities = (struct entity_t*)MALLOC(sizeof(struct entity_t) * ENTITY_COUNT, "benchmark_thread_pool()");
+
+    reset_entities(entities);
+    start = get_time_in_microseconds();
+    for(tick = 0; tick != TICKS; ++tick)
+        update_entities(entities, 0, ENTITY_COUNT);
+    benchmark_report("entity update, serial", 1, ENTITY_COUNT * TICKS, get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(entities);
+
+    /* the calling thread helps, so n workers means n + 1 threads */
+    for(workers = 1; ; workers *= 2)
+    {
+        struct thread_pool_t* pool;
+        if(workers > cpus)
+            workers = cpus;
+        if(!(pool = thread_pool_create(workers)))
+            break;
+
+        reset_entities(entities);
+        start = get_time_in_microseconds();
+        for(tick = 0; tick != TICKS; ++tick)
+            thread_pool_parallel_for(pool, 0, ENTITY_COUNT, GRAIN, update_entities, entities);
+        benchmark_report("entity update, parallel_for", workers, ENTITY_COUNT * TICKS, get_time_in_microseconds() - start);
+        benchmark_do_not_optimise(entities);
+
+        thread_pool_destroy(pool);
+        if(workers == cpus)
+            break;
+    }
+
+    FREE(entities);
+}
+
+#else /* ENABLE_THREAD_POOL */
+
+void
+benchmark_thread_pool(void)
+{
+    printf("  skipped, configure with ENABLE_THREAD_POOL\n");
+}
+
+#endif /* ENABLE_THREAD_POOL */
@@ -0,0 +1,90 @@
+#include "benchmarks/benchmark.h"
+#include "util/ordered_vector.h"
+#include "util/typed_vector.h"
+#include <stdio.h>
+
+#define ELEMENT_COUNT 1000000
+#define ROUNDS 10
+
+DECLARE_VECTOR(u32_vector, uint32_t)
+
+/* ------------------------------------------------------------------------- */
+void
+benchmark_typed_vector(void)
+{
+    struct ordered_vector_t generic;
+    struct u32_vector_t typed;
+    uint32_t i, round, sum;
+    int64_t start;
+
+    ordered_vector_init(&generic, sizeof(uint32_t));
+    u32_vector_init(&typed);
+
+    /* push */
+    start = get_time_in_microseconds();
+    for(round = 0; round != ROUNDS; ++round)
+    {
+        ordered_vector_clear(&generic);
+        for(i = 0; i != ELEMENT_COUNT; ++i)
+            ordered_vector_push(&generic, &i);
+    }
+    benchmark_report("push (generic)", ELEMENT_COUNT, ELEMENT_COUNT * ROUNDS,
+                     get_time_in_microseconds() - start);
+
+    start = get_time_in_microseconds();
+    for(round = 0; round != ROUNDS; ++round)
+    {
+        u32_vector_clear(&typed);
+        for(i = 0; i != ELEMENT_COUNT; ++i)
+            u32_vector_push(&typed, i);
+    }
+    benchmark_report("push (typed)", ELEMENT_COUNT, ELEMENT_COUNT * ROUNDS,
+                     get_time_in_microseconds() - start);
+
+    /* sequential iteration */
+    sum = 0;
+    start = get_time_in_microseconds();
+    for(round = 0; round != ROUNDS; ++round)
+    {
+        ORDERED_VECTOR_FOR_EACH(&generic, uint32_t, value)
+            sum += *value;
+        ORDERED_VECTOR_END_EACH
+    }
+    benchmark_report("for each (generic)", ELEMENT_COUNT, ELEMENT_COUNT * ROUNDS,
+                     get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(&sum);
+
+    sum = 0;
+    start = get_time_in_microseconds();
+    for(round = 0; round != ROUNDS; ++round)
+    {
+        TYPED_VECTOR_FOR_EACH(&typed, uint32_t, value)
+            sum += *value;
+        TYPED_VECTOR_END_EACH
+    }
+    benchmark_report("for each (typed)", ELEMENT_COUNT, ELEMENT_COUNT * ROUNDS,
+                     get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(&sum);
+
+    /* indexed access */
+    sum = 0;
+    start = get_time_in_microseconds();
+    for(round = 0; round != ROUNDS; ++round)
+        for(i = 0; i != ELEMENT_COUNT; ++i)
+            sum += *(uint32_t*)ordered_vector_get_element(&generic, i);
+    benchmark_report("get_element (generic)", ELEMENT_COUNT, ELEMENT_COUNT * ROUNDS,
+                     get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(&sum);
+
+    sum = 0;
+    start = get_time_in_microseconds();
+    for(round = 0; round != ROUNDS; ++round)
+        for(i = 0; i != ELEMENT_COUNT; ++i)
+            sum += *u32_vector_get(&typed, i);
+    benchmark_report("get (typed)", ELEMENT_COUNT, ELEMENT_COUNT * ROUNDS,
+                     get_time_in_microseconds() - start);
+    benchmark_do_not_optimise(&sum);
+
+    ordered_vector_clear_free(&generic);
+    u32_vector_clear_free(&typed);
+}
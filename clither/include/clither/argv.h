@@ -3,6 +3,8 @@ struct arg_obj_t
     char run_game;
     char show_help;
     char is_server;
+    const char* config_file;     /* points into argv, NULL if not specified */
+    unsigned int instance_count; /* 0 if not specified */
 };
 
 struct arg_obj_t*
@@ -2,6 +2,7 @@
 #include "game/log.h"
 #include "util/memory.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* -------------------------------------------------------------------------- */
@@ -16,6 +17,9 @@ show_help(char* program_name)
                   "multiple game instances to be hosted "
                   "simultaniously\n",                   "-s, --server");
     printf("  %-30sThe startup config file to use\n",   "-c, --config <FILE>");
+    printf("  %-30sNumber of game instances to host in "
+                  "server mode. Defaults to one per "
+                  "processor\n",                        "-i, --instances <N>");
 }
 
 /* -------------------------------------------------------------------------- */
@@ -69,6 +73,12 @@ argv_parse(int argc, char** argv)
                 /* server mode */
                 if(*arg == 's')
                     arg_obj->is_server = 1;
+                /* config file */
+                if(*arg == 'c' && i + 1 != argc)
+                    arg_obj->config_file = argv[++i];
+                /* number of instances */
+                if(*arg == 'i' && i + 1 != argc)
+                    arg_obj->instance_count = (unsigned int)atoi(argv[++i]);
             }
         }
 
@@ -85,6 +95,12 @@ argv_parse(int argc, char** argv)
             /* server mode */
             if(strcmp(arg, "server") == 0)
                 arg_obj->is_server = 1;
+            /* config file */
+            if(strcmp(arg, "config") == 0 && i + 1 != argc)
+                arg_obj->config_file = argv[++i];
+            /* number of instances */
+            if(strcmp(arg, "instances") == 0 && i + 1 != argc)
+                arg_obj->instance_count = (unsigned int)atoi(argv[++i]);
         }
     }
 
@@ -1,28 +1,96 @@
 #include <stdio.h>
+#include <signal.h>
 #include "util/memory.h"
+#include "util/thread.h"
+#include "util/time.h"
+#include "util/yaml.h"
 #include "clither/argv.h"
 #include "game/game.h"
+#include "game/server.h"
 
-#include <stdio.h>
+/* How often the server prints statistics, in milliseconds */
+#define SERVER_REPORT_INTERVAL 1000
+
+static volatile sig_atomic_t g_quit = 0;
+
+/* ------------------------------------------------------------------------- */
+static void
+on_interrupt(int signal_number)
+{
+    g_quit = 1;
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+run_server(const struct ptree_t* config, unsigned int instance_count)
+{
+    struct server_t* server;
+    int64_t last_report;
 
+    if(!(server = server_create(config, instance_count)))
+        return;
+
+    if(server_start(server))
+    {
+        printf("Hosting %u game instances at %u ticks/s, press Ctrl+C to stop\n",
+               (unsigned int)server->instance_count,
+               (unsigned int)server->tick_rate);
+
+        /* supervisor */
+        signal(SIGINT, on_interrupt);
+        last_report = get_time_in_microseconds();
+        while(!g_quit)
+        {
+            int64_t now;
+            thread_sleep(SERVER_REPORT_INTERVAL);
+            now = get_time_in_microseconds();
+            server_report(server, now - last_report);
+            last_report = now;
+        }
+        signal(SIGINT, SIG_DFL);
+
+        server_stop(server);
+    }
+
+    server_destroy(server);
+}
+
+/* ------------------------------------------------------------------------- */
 int
 main(int argc, char** argv)
 {
     struct arg_obj_t* args;
-    struct game_t* game;
+    struct ptree_t* config = NULL;
 
     memory_init();
+    yaml_init();
 
     /* parse command line arguments */
-    args = argv_parse(argc, argv);
+    if(!(args = argv_parse(argc, argv)))
+        goto parse_args_failed;
+
+    /* loaded once and shared read-only by all game instances */
+    if(args->config_file && !(config = yaml_load(args->config_file)))
+        fprintf(stderr, "Failed to load config file \"%s\"\n", args->config_file);
 
-    game = game_create("game");
-    if(game)
-        game_destroy(game);
+    if(args->run_game)
+    {
+        if(args->is_server)
+            run_server(config, args->instance_count);
+        else
+        {
+            struct game_t* game = game_create("game", config);
+            if(game)
+                game_destroy(game);
+        }
+    }
 
     /* clean up */
+    if(config)
+        yaml_destroy(config);
     argv_free(args);
-    memory_deinit();
+    parse_args_failed : yaml_deinit();
+                        memory_deinit();
 
     return 0;
 }
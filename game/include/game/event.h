@@ -1,14 +1,19 @@
 #include "game/config.h"
-#include "util/bst_hashed_vector.h"
+#include "util/string_map.h"
 #include "util/unordered_vector.h"
 
 C_HEADER_BEGIN
 
+struct allocator_t;
 struct event_t;
 struct game_t;
 
 typedef void (*event_callback_func)(struct event_t*, void*);
 
+/*! Number of listeners stored directly in the event object before the
+ * listener container spills to the heap. */
+#define EVENT_INLINE_LISTENERS 4
+
 struct event_listener_t
 {
     event_callback_func callback;
@@ -19,21 +24,25 @@ struct event_t
     char* name;
     struct game_t* game;
     struct unordered_vector_t listeners;   /* holds event_listener_t objects */
+    struct event_listener_t listeners_inline[EVENT_INLINE_LISTENERS];
 };
 
 struct event_system_t
 {
     struct game_t* game;
-    struct bsthv_t events;
+    struct string_map_t events;
 };
 
 /*!
  * @brief Creates a new event system for the specified game instance.
  * This must be called before any events can be fired.
+ * @param[in] allocator The event map, the event objects, their names and
+ * their listener containers are allocated with this. Must outlive the event
+ * system. If NULL, the global MALLOC() and FREE() are used.
  * @return Returns 1 if successful, 0 if otherwise.
  */
 GAME_PUBLIC_API char
-event_system_create(struct game_t* game);
+event_system_create(struct game_t* game, const struct allocator_t* allocator);
 
 /*!
  * @brief Destroys an event system. This will unregister all listeners and
@@ -80,6 +89,14 @@ event_unregister(struct event_t* event);
 GAME_PUBLIC_API struct event_t*
 event_get(const struct game_t* game, const char* name);
 
+/*!
+ * @brief Same as event_get(), but with a name whose hash was computed in
+ * advance with string_map_key_init(). Code looking up the same event every
+ * frame can initialise the key once and skip hashing the name each time.
+ */
+GAME_PUBLIC_API struct event_t*
+event_get_hashed(const struct game_t* game, const struct string_map_key_t* name);
+
 /*!
  * @brief Registers a listener to the specified event.
  * @note The same callback function will not be registered twice.
@@ -1,21 +1,68 @@
 #include "game/config.h"
-#include "util/bst_hashed_vector.h"
+#include "game/task_graph.h"
+#include "util/arena.h"
+#include "util/atomic.h"
+#include "util/string_map.h"
 
 C_HEADER_BEGIN
 
 struct renderer_t;
+struct ptree_t;
+struct thread_pool_t;
 
 struct game_t
 {
     char* name;
-    struct bsthv_t events;
-    struct renderer_t* renderer;
+    struct string_map_t events;
+    struct renderer_t* renderer;        /* NULL for headless games */
+    const struct ptree_t* config;       /* shared with other games, read only */
+    struct arena_t arena;               /* events and tick graph live here, see game_create() */
+    struct task_graph_t tick_graph;     /* phases of a tick */
+    volatile uint32_t tick_count;
 };
 
+/*!
+ * @brief Creates a game with a renderer.
+ *
+ * The game's name, its event map, events and listeners and its tick graph are
+ * all allocated from the game's own arena, so only the game object and the
+ * arena's blocks come from the global allocator. Games on different threads
+ * therefore don't contend for it. The arena never reclaims memory before the
+ * game is destroyed, so events and tasks are meant to be registered once
+ * while setting the game up, not every tick.
+ * @param[in] game_name The name of the game. The string is copied.
+ * @param[in] config Config tree to read settings from. The game never
+ * modifies it, so the same tree can be shared by any number of games and
+ * threads. It must outlive the game. Can be NULL.
+ * @return Returns NULL on failure.
+ */
 GAME_PUBLIC_API struct game_t*
-game_create(const char* game_name);
+game_create(const char* game_name, const struct ptree_t* config);
+
+/*!
+ * @brief Creates a game without a renderer, for hosting it on a server.
+ * @see game_create()
+ */
+GAME_PUBLIC_API struct game_t*
+game_create_headless(const char* game_name, const struct ptree_t* config);
 
 GAME_PUBLIC_API void
 game_destroy(struct game_t* game);
 
+/*!
+ * @brief Advances the game by one tick.
+ *
+ * A game is only ever ticked by one thread at a time, but different games can
+ * be ticked at the same time by different threads.
+ * @param[in] pool The thread pool to run the phases of the tick on. Can be
+ * NULL. See task_graph_run().
+ */
+GAME_PUBLIC_API void
+game_tick(struct game_t* game, struct thread_pool_t* pool);
+
+/*!
+ * @brief Returns the number of ticks so far. Can be called from any thread.
+ */
+#define game_tick_count(game) ATOMIC_LOAD_RELAXED(&(game)->tick_count)
+
 C_HEADER_END
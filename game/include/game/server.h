@@ -0,0 +1,94 @@
+#include "game/config.h"
+#include "util/pstdint.h"
+#include "util/thread_pool.h"
+
+C_HEADER_BEGIN
+
+struct game_t;
+struct ptree_t;
+struct thread_t;
+struct thread_pool_t;
+
+/*!
+ * @brief Hosts several headless games in one process.
+ *
+ * Without ENABLE_THREAD_POOL every game gets its own thread which ticks it at
+ * the configured rate, and the operating system spreads the threads over all
+ * processors. With ENABLE_THREAD_POOL a single scheduler thread submits each
+ * game's ticks to a thread pool with one worker per processor instead, so the
+ * number of busy threads matches the number of processors no matter how many
+ * games are hosted.
+ *
+ * All games read from the same config tree, which is never modified while the
+ * server runs. A game's events and tick graph are allocated from its own arena
+ * (see game_create()), so ticking doesn't touch the global allocator.
+ */
+struct server_instance_t
+{
+    struct game_t* game;
+    struct server_t* server;
+    uint32_t last_tick_count;         /* tick count at the last report */
+#ifdef ENABLE_THREAD_POOL
+    int64_t next_tick;                /* when the scheduler submits the next tick */
+    volatile uint32_t ticking;        /* 1 while a tick is queued or running */
+#else
+    struct thread_t* thread;          /* NULL while the server isn't running */
+#endif
+};
+
+struct server_t
+{
+    const struct ptree_t* config;
+    struct server_instance_t* instances;
+    uint32_t instance_count;
+    uint32_t tick_rate;               /* ticks per second each game aims for */
+    volatile uint32_t running;
+#ifdef ENABLE_THREAD_POOL
+    struct thread_pool_t* pool;
+    struct thread_t* scheduler;
+    struct thread_pool_counter_t ticks; /* ticks which haven't finished yet */
+#endif
+};
+
+/*!
+ * @brief Creates a server and its games. The games don't tick until
+ * server_start() is called.
+ * @param[in] config The config tree shared by all games. Reads
+ * "server.instances" and "server.tick_rate". Must outlive the server. Can be
+ * NULL.
+ * @param[in] instance_count Number of games to host. If 0, the value of
+ * "server.instances" is used, and if that isn't set, one game per processor.
+ * @return Returns NULL on failure.
+ */
+GAME_PUBLIC_API struct server_t*
+server_create(const struct ptree_t* config, uint32_t instance_count);
+
+/*!
+ * @brief Stops the server if it is running and destroys all games.
+ */
+GAME_PUBLIC_API void
+server_destroy(struct server_t* server);
+
+/*!
+ * @brief Starts ticking the games.
+ * @return Returns 1 on success. If a thread couldn't be started, the ones that
+ * were are stopped again and 0 is returned.
+ */
+GAME_PUBLIC_API char
+server_start(struct server_t* server);
+
+/*!
+ * @brief Stops ticking the games and waits for the ticks in progress.
+ */
+GAME_PUBLIC_API void
+server_stop(struct server_t* server);
+
+/*!
+ * @brief Prints the number of ticks per second of every game since the last
+ * report.
+ * @param[in] elapsed_us Time in microseconds since the last report.
+ */
+GAME_PUBLIC_API void
+server_report(struct server_t* server, int64_t elapsed_us);
+
+C_HEADER_END
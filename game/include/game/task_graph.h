@@ -0,0 +1,132 @@
+#include "game/config.h"
+#include "util/ordered_vector.h"
+#include "util/thread_pool.h"
+
+C_HEADER_BEGIN
+
+struct allocator_t;
+struct thread_pool_t;
+
+/*!
+ * @brief Runs the phases of a game tick (input, movement, collision, ...) in
+ * the right order, and in parallel where that is safe.
+ *
+ * Each task declares which resources it reads and which it writes, as bit
+ * masks of up to 32 resources the caller defines, e.g.
+ * @code
+ * #define RES_INPUT   (1u << 0)
+ * #define RES_SNAKES  (1u << 1)
+ * #define RES_PELLETS (1u << 2)
+ * task_graph_add(&graph, "movement", move_snakes, game, RES_INPUT, RES_SNAKES);
+ * task_graph_add(&graph, "spawning", spawn_pellets, game, 0, RES_PELLETS);
+ * @endcode
+ * A task depends on every task added before it that writes something it
+ * reads or writes, or that reads something it writes. The result is the
+ * same as running the tasks one after another in the order they were added,
+ * but tasks which don't conflict (movement and spawning above) run at the
+ * same time.
+ *
+ * task_graph_build() works out the dependencies once. After that
+ * task_graph_run() can be called every tick and doesn't allocate.
+ */
+typedef void (*task_graph_func)(void* arg);
+
+struct task_graph_task_t
+{
+    char* name;
+    task_graph_func func;
+    void* arg;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t dependency_count;     /* number of tasks that must finish first */
+    uint32_t first_dependent;      /* index into task_graph_t::dependents */
+    uint32_t dependent_count;
+    volatile uint32_t remaining;   /* dependencies left this run */
+    struct task_graph_t* graph;
+};
+
+struct task_graph_t
+{
+    struct ordered_vector_t tasks;       /* holds task_graph_task_t objects */
+    struct ordered_vector_t dependents;  /* task indices, grouped by the task they depend on */
+    struct thread_pool_t* pool;          /* only valid during task_graph_run() */
+#ifdef ENABLE_THREAD_POOL
+    struct thread_pool_counter_t counter;
+#endif
+    char built;
+};
+
+/*!
+ * @brief Creates a new, empty task graph.
+ * @return Returns NULL if memory allocation failed.
+ */
+GAME_PUBLIC_API struct task_graph_t*
+task_graph_create(void);
+
+/*!
+ * @brief Initialises an existing task graph.
+ */
+GAME_PUBLIC_API void
+task_graph_init(struct task_graph_t* graph);
+
+/*!
+ * @brief Initialises an existing task graph and makes it take all of its
+ * memory, including the copied task names, from the specified allocator.
+ * @param[in] allocator The allocator to use. Must outlive the graph. If NULL,
+ * the global MALLOC() and FREE() are used (same as task_graph_init()).
+ */
+GAME_PUBLIC_API void
+task_graph_init_with_allocator(struct task_graph_t* graph,
+                               const struct allocator_t* allocator);
+
+/*!
+ * @brief Destroys a task graph created with task_graph_create().
+ */
+GAME_PUBLIC_API void
+task_graph_destroy(struct task_graph_t* graph);
+
+/*!
+ * @brief Removes all tasks and frees all memory.
+ */
+GAME_PUBLIC_API void
+task_graph_clear_free(struct task_graph_t* graph);
+
+/*!
+ * @brief Appends a task. The graph has to be built again before it can run.
+ * @param[in] name Identifies the task when debugging. The string is copied.
+ * @param[in] func Function to call when the task runs.
+ * @param[in] arg Passed to func.
+ * @param[in] reads Bit mask of the resources the task reads.
+ * @param[in] writes Bit mask of the resources the task writes. A task which
+ * modifies a resource should only list it here.
+ * @return Returns 1 on success, 0 if memory allocation failed.
+ */
+GAME_PUBLIC_API char
+task_graph_add(struct task_graph_t* graph,
+               const char* name,
+               task_graph_func func,
+               void* arg,
+               uint32_t reads,
+               uint32_t writes);
+
+/*!
+ * @brief Works out which tasks depend on which and allocates everything
+ * task_graph_run() needs.
+ * @return Returns 1 on success, 0 if memory allocation failed.
+ */
+GAME_PUBLIC_API char
+task_graph_build(struct task_graph_t* graph);
+
+/*!
+ * @brief Runs all tasks once and returns when they have all finished.
+ * @param[in] pool The thread pool to run the tasks on. If NULL, or if the
+ * thread pool is disabled (ENABLE_THREAD_POOL), the tasks run one after
+ * another in the calling thread.
+ */
+GAME_PUBLIC_API void
+task_graph_run(struct task_graph_t* graph, struct thread_pool_t* pool);
+
+#define task_graph_task_count(graph) ((graph)->tasks.count)
+#define task_graph_allocator(graph) ((graph)->tasks.allocator)
+
+C_HEADER_END
@@ -1,9 +1,9 @@
 #include "game/event.h"
 #include "game/game.h"
 #include "game/log.h"
+#include "util/allocator.h"
 #include "util/hash.h"
 #include "util/memory.h"
-#include "util/string.h"
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -23,11 +23,11 @@ event_free(struct event_t* event);
  * Exported functions
  * ------------------------------------------------------------------------- */
 char
-event_system_create(struct game_t* game)
+event_system_create(struct game_t* game, const struct allocator_t* allocator)
 {
     assert(game);
 
-    bsthv_init(&game->events);
+    string_map_init_with_allocator(&game->events, allocator);
 
     return 1;
 }
@@ -39,11 +39,11 @@ event_system_destroy(struct game_t* game)
     assert(game);
 
     /* Free each event object, but don't modify the container while doing so */
-    BSTHV_FOR_EACH(&game->events, struct event_t, name, event)
+    STRING_MAP_FOR_EACH(&game->events, struct event_t, name, event)
         event_free(event);
-    BSTHV_END_EACH
+    STRING_MAP_END_EACH
     /* Clear and free container */
-    bsthv_clear_free(&game->events);
+    string_map_clear_free(&game->events);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -51,33 +51,44 @@ struct event_t*
 event_register(struct game_t* game, const char* name)
 {
     struct event_t* event;
+    const struct allocator_t* allocator;
+    uintptr_t name_length;
 
     assert(game);
     assert(name);
 
+    /* everything belonging to the event comes from the same place as the map */
+    allocator = string_map_allocator(&game->events);
+
     /* allocate and initialise event object */
-    if(!(event = (struct event_t*)MALLOC(sizeof(struct event_t), "event_create()")))
+    if(!(event = (struct event_t*)ALLOCATOR_MALLOC(allocator, sizeof(struct event_t), "event_register()")))
         goto malloc_event_failed;
 
-    /* listener container */
-    unordered_vector_init(&event->listeners, sizeof(struct event_listener_t));
+    /* listener container, most events only have a handful of listeners */
+    unordered_vector_init_inline_with_allocator(&event->listeners,
+                                                sizeof(struct event_listener_t),
+                                                event->listeners_inline,
+                                                EVENT_INLINE_LISTENERS,
+                                                allocator);
 
     /* event has reference to game object */
     event->game = game;
 
     /* copy name */
-    if((event->name = malloc_string(name)) == NULL)
+    name_length = strlen(name) + 1;
+    if((event->name = (char*)ALLOCATOR_MALLOC(allocator, name_length, "event_register()")) == NULL)
         goto copy_event_name_failed;
+    memcpy(event->name, name, name_length);
 
     /* create node in game's event directory and add event */
-    if(!bsthv_insert(&game->events, name, event))
+    if(!string_map_insert(&game->events, name, event))
         goto add_event_to_game_failed;
 
     /* success! */
     return event;
 
-    add_event_to_game_failed : free_string(event->name);
-    copy_event_name_failed   : FREE(event);
+    add_event_to_game_failed : ALLOCATOR_FREE(allocator, event->name);
+    copy_event_name_failed   : ALLOCATOR_FREE(allocator, event);
     malloc_event_failed      : return NULL;
 }
 
@@ -89,12 +100,11 @@ event_unregister(struct event_t* event)
     assert(event->game);
 
     /*
-     * The game object maintains a structure of event objects (using ptree).
-     * Find the node in the ptree that is this event and delete it. This will
-     * automatically also free the event object, because during creation,
-     * ptree_set_free_func was set to event_free().
+     * The game object maintains a map of event objects keyed by their name.
+     * Look the event up by name instead of searching all events for it, but
+     * make sure it's actually this event before erasing it.
      */
-    if(bsthv_erase_element(&event->game->events, event) == NULL)
+    if(string_map_find(&event->game->events, event->name) != event)
     {
         log_message(LOG_ERROR, event->game, "Attempted to destroy the event"
             " \"%s\", but the associated game object with name \"%s\" doesn't "
@@ -103,6 +113,7 @@ event_unregister(struct event_t* event)
         return;
     }
 
+    string_map_erase(&event->game->events, event->name);
     event_free(event);
 }
 
@@ -113,7 +124,17 @@ event_get(const struct game_t* game, const char* name)
     assert(game);
     assert(name);
 
-    return bsthv_find(&game->events, name);
+    return string_map_find(&game->events, name);
+}
+
+/* ------------------------------------------------------------------------- */
+struct event_t*
+event_get_hashed(const struct game_t* game, const struct string_map_key_t* name)
+{
+    assert(game);
+    assert(name);
+
+    return string_map_find_hashed(&game->events, name);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -178,11 +199,14 @@ event_unregister_all_listeners(struct event_t* event)
 static void
 event_free(struct event_t* event)
 {
+    const struct allocator_t* allocator;
+
     assert(event);
     assert(event->name);
 
-    free_string(event->name);
+    allocator = string_map_allocator(&event->game->events);
+    ALLOCATOR_FREE(allocator, event->name);
     unordered_vector_clear_free(&event->listeners);
 
-    FREE(event);
+    ALLOCATOR_FREE(allocator, event);
 }
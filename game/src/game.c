@@ -2,43 +2,96 @@
 #include "game/event.h"
 #include "game/renderer.h"
 #include "util/memory.h"
-#include "util/string.h"
+#include <string.h>
 #include <assert.h>
 
-/* ------------------------------------------------------------------------- */
-struct game_t*
-game_create(const char* game_name)
+/* How many bytes a game's arena requests at a time */
+#define GAME_ARENA_BLOCK_SIZE (64 * 1024)
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static struct game_t*
+create_game(const char* game_name, const struct ptree_t* config, char with_renderer)
 {
     struct game_t* game;
+    uintptr_t name_length;
+
+    assert(game_name);
+
     if((game = (struct game_t*)MALLOC(sizeof *game, "game_create()")) == NULL)
         goto malloc_game_failed;
 
-    if((game->name = malloc_string(game_name)) == NULL)
+    game->config = config;
+    game->renderer = NULL;
+    game->tick_count = 0;
+    arena_init(&game->arena, GAME_ARENA_BLOCK_SIZE);
+    task_graph_init_with_allocator(&game->tick_graph, &game->arena.allocator);
+
+    name_length = strlen(game_name) + 1;
+    if((game->name = (char*)arena_alloc_unaligned(&game->arena, name_length)) == NULL)
         goto copy_game_name_failed;
+    memcpy(game->name, game_name, name_length);
 
-    if(!event_system_create(game))
+    if(!task_graph_build(&game->tick_graph))
+        goto build_tick_graph_failed;
+
+    if(!event_system_create(game, &game->arena.allocator))
         goto create_event_system_failed;
 
-    if((game->renderer = renderer_create(game)) == NULL)
+    if(with_renderer && (game->renderer = renderer_create(game)) == NULL)
         goto create_renderer_failed;
 
     return game;
 
     create_renderer_failed     : event_system_destroy(game);
-    create_event_system_failed : free_string(game->name);
-    copy_game_name_failed      : FREE(game);
+    create_event_system_failed :
+    build_tick_graph_failed    : task_graph_clear_free(&game->tick_graph);
+    copy_game_name_failed      : arena_clear_free(&game->arena);
+                                 FREE(game);
     malloc_game_failed         : return NULL;
 }
 
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct game_t*
+game_create(const char* game_name, const struct ptree_t* config)
+{
+    return create_game(game_name, config, 1);
+}
+
+/* ------------------------------------------------------------------------- */
+struct game_t*
+game_create_headless(const char* game_name, const struct ptree_t* config)
+{
+    return create_game(game_name, config, 0);
+}
+
 /* ------------------------------------------------------------------------- */
 void
 game_destroy(struct game_t* game)
 {
     assert(game);
 
-    renderer_destroy(game->renderer);
+    if(game->renderer)
+        renderer_destroy(game->renderer);
     event_system_destroy(game);
-    free_string(game->name);
+    task_graph_clear_free(&game->tick_graph);
 
+    /* also frees the name and anything else the game put into its arena */
+    arena_clear_free(&game->arena);
     FREE(game);
 }
+
+/* ------------------------------------------------------------------------- */
+void
+game_tick(struct game_t* game, struct thread_pool_t* pool)
+{
+    assert(game);
+
+    task_graph_run(&game->tick_graph, pool);
+
+    /* only this thread writes it, other threads only read it for statistics */
+    ATOMIC_STORE_RELAXED(&game->tick_count, game->tick_count + 1);
+}
@@ -0,0 +1,287 @@
+#include "game/server.h"
+#include "game/game.h"
+#include "util/atomic.h"
+#include "util/memory.h"
+#include "util/ptree.h"
+#include "util/thread.h"
+#include "util/time.h"
+#include "util/yaml.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define SERVER_DEFAULT_TICK_RATE 60
+/* If a game falls further behind than this many ticks, it skips them instead
+ * of trying to catch up */
+#define SERVER_MAX_TICK_LAG 5
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static uint32_t
+get_config_uint(const struct ptree_t* config, const char* key, uint32_t default_value)
+{
+    const char* value;
+    if(!config || !(value = yaml_get_value(config, key)))
+        return default_value;
+    return (uint32_t)atoi(value);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+advance_deadline(int64_t* next_tick, int64_t period, int64_t now)
+{
+    *next_tick += period;
+    if(now - *next_tick > period * SERVER_MAX_TICK_LAG)
+        *next_tick = now;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Rounds up to whole milliseconds. Rounding down would sleep for 0 ms when
+ * less than a millisecond is left, and the caller would spin until the
+ * deadline.
+ */
+static void
+sleep_until(int64_t deadline)
+{
+    int64_t remaining = deadline - get_time_in_microseconds();
+    if(remaining > 0)
+        thread_sleep((uint32_t)((remaining + 999) / 1000));
+}
+
+/* ------------------------------------------------------------------------- */
+#ifdef ENABLE_THREAD_POOL
+static void
+run_tick(void* arg)
+{
+    struct server_instance_t* instance = (struct server_instance_t*)arg;
+    game_tick(instance->game, instance->server->pool);
+    ATOMIC_STORE_RELEASE(&instance->ticking, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+run_scheduler(void* arg)
+{
+    struct server_t* server = (struct server_t*)arg;
+    int64_t period = 1000000 / server->tick_rate;
+    int64_t now = get_time_in_microseconds();
+    uint32_t i;
+
+    for(i = 0; i != server->instance_count; ++i)
+        server->instances[i].next_tick = now;
+
+    while(ATOMIC_LOAD_RELAXED(&server->running))
+    {
+        int64_t next_wake;
+
+        now = get_time_in_microseconds();
+        next_wake = now + period;
+        for(i = 0; i != server->instance_count; ++i)
+        {
+            struct server_instance_t* instance = &server->instances[i];
+            int64_t wake;
+
+            /* a game whose last tick is still running skips this one */
+            if(instance->next_tick <= now && !ATOMIC_LOAD_ACQUIRE(&instance->ticking))
+            {
+                ATOMIC_STORE_RELAXED(&instance->ticking, 1);
+                thread_pool_submit(server->pool, run_tick, instance, &server->ticks);
+                advance_deadline(&instance->next_tick, period, now);
+            }
+
+            /* if it is still busy, check again in a millisecond */
+            wake = instance->next_tick > now ? instance->next_tick : now + 1000;
+            if(wake < next_wake)
+                next_wake = wake;
+        }
+
+        sleep_until(next_wake);
+    }
+}
+
+#else /* ENABLE_THREAD_POOL */
+
+/* ------------------------------------------------------------------------- */
+static void
+run_instance(void* arg)
+{
+    struct server_instance_t* instance = (struct server_instance_t*)arg;
+    struct server_t* server = instance->server;
+    int64_t period = 1000000 / server->tick_rate;
+    int64_t next_tick = get_time_in_microseconds();
+
+    while(ATOMIC_LOAD_RELAXED(&server->running))
+    {
+        game_tick(instance->game, NULL);
+        advance_deadline(&next_tick, period, get_time_in_microseconds());
+        sleep_until(next_tick);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+join_instances(struct server_t* server, uint32_t count)
+{
+    uint32_t i;
+    ATOMIC_STORE_RELAXED(&server->running, 0);
+    for(i = 0; i != count; ++i)
+    {
+        thread_join(server->instances[i].thread);
+        server->instances[i].thread = NULL;
+    }
+}
+#endif /* ENABLE_THREAD_POOL */
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct server_t*
+server_create(const struct ptree_t* config, uint32_t instance_count)
+{
+    struct server_t* server;
+    uint32_t i;
+
+    if(instance_count == 0)
+        instance_count = get_config_uint(config, "server.instances", thread_cpu_count());
+    if(instance_count == 0)
+        instance_count = 1;
+
+    if(!(server = (struct server_t*)MALLOC(sizeof *server, "server_create()")))
+        goto malloc_server_failed;
+    memset(server, 0, sizeof *server);
+    server->config = config;
+    server->tick_rate = get_config_uint(config, "server.tick_rate", SERVER_DEFAULT_TICK_RATE);
+    if(server->tick_rate == 0)
+        server->tick_rate = SERVER_DEFAULT_TICK_RATE;
+
+    if(!(server->instances = (struct server_instance_t*)MALLOC(
+            sizeof(struct server_instance_t) * instance_count, "server_create()")))
+        goto malloc_instances_failed;
+    memset(server->instances, 0, sizeof(struct server_instance_t) * instance_count);
+
+    /* games are created here rather than when they first tick, so all
+     * global allocations happen on the calling thread */
+    for(; server->instance_count != instance_count; ++server->instance_count)
+    {
+        struct server_instance_t* instance = &server->instances[server->instance_count];
+        char name[32];
+        sprintf(name, "instance %u", (unsigned int)server->instance_count);
+        if(!(instance->game = game_create_headless(name, config)))
+            goto create_games_failed;
+        instance->server = server;
+    }
+
+#ifdef ENABLE_THREAD_POOL
+    /* the games tick on the pool, so it is the only place with busy threads */
+    if(!(server->pool = thread_pool_create(0)))
+        goto create_pool_failed;
+#endif
+
+    return server;
+
+#ifdef ENABLE_THREAD_POOL
+    create_pool_failed      :
+#endif
+    create_games_failed     : for(i = 0; i != server->instance_count; ++i)
+                                  game_destroy(server->instances[i].game);
+                              FREE(server->instances);
+    malloc_instances_failed : FREE(server);
+    malloc_server_failed    : return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+server_destroy(struct server_t* server)
+{
+    uint32_t i;
+
+    assert(server);
+
+    if(server->running)
+        server_stop(server);
+
+#ifdef ENABLE_THREAD_POOL
+    thread_pool_destroy(server->pool);
+#endif
+    for(i = 0; i != server->instance_count; ++i)
+        game_destroy(server->instances[i].game);
+    FREE(server->instances);
+    FREE(server);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+server_start(struct server_t* server)
+{
+    uint32_t i;
+
+    assert(server);
+    assert(!server->running);
+
+    for(i = 0; i != server->instance_count; ++i)
+        server->instances[i].last_tick_count = game_tick_count(server->instances[i].game);
+
+    server->running = 1;
+#ifdef ENABLE_THREAD_POOL
+    thread_pool_counter_init(&server->ticks);
+    for(i = 0; i != server->instance_count; ++i)
+        server->instances[i].ticking = 0;
+    if(!(server->scheduler = thread_create(run_scheduler, server)))
+    {
+        server->running = 0;
+        return 0;
+    }
+#else
+    for(i = 0; i != server->instance_count; ++i)
+        if(!(server->instances[i].thread = thread_create(run_instance, &server->instances[i])))
+        {
+            join_instances(server, i);
+            return 0;
+        }
+#endif
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+server_stop(struct server_t* server)
+{
+    assert(server);
+    assert(server->running);
+
+#ifdef ENABLE_THREAD_POOL
+    ATOMIC_STORE_RELAXED(&server->running, 0);
+    thread_join(server->scheduler);
+    server->scheduler = NULL;
+    thread_pool_wait(server->pool, &server->ticks);
+#else
+    join_instances(server, server->instance_count);
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+void
+server_report(struct server_t* server, int64_t elapsed_us)
+{
+    uint32_t i;
+
+    assert(server);
+
+    if(elapsed_us <= 0)
+        return;
+
+    for(i = 0; i != server->instance_count; ++i)
+    {
+        struct server_instance_t* instance = &server->instances[i];
+        uint32_t tick_count = game_tick_count(instance->game);
+        printf("[%s] %.1f ticks/s\n",
+               instance->game->name,
+               (double)(tick_count - instance->last_tick_count) * 1000000.0 / (double)elapsed_us);
+        instance->last_tick_count = tick_count;
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,213 @@
+#include "game/task_graph.h"
+#include "util/allocator.h"
+#include "util/atomic.h"
+#include "util/memory.h"
+#include <string.h>
+#include <assert.h>
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static char
+tasks_conflict(const struct task_graph_task_t* first, const struct task_graph_task_t* second)
+{
+    return (first->writes & (second->reads | second->writes)) ||
+           (first->reads & second->writes);
+}
+
+/* ------------------------------------------------------------------------- */
+#ifdef ENABLE_THREAD_POOL
+static void
+run_task_job(void* arg)
+{
+    struct task_graph_task_t* task = (struct task_graph_task_t*)arg;
+    struct task_graph_t* graph = task->graph;
+    const uint32_t* dependents = (const uint32_t*)graph->dependents.data;
+    uint32_t i;
+
+    task->func(task->arg);
+
+    /* whoever finishes the last dependency of a task submits it */
+    for(i = 0; i != task->dependent_count; ++i)
+    {
+        struct task_graph_task_t* dependent = (struct task_graph_task_t*)
+            ordered_vector_get_element(&graph->tasks, dependents[task->first_dependent + i]);
+        if(ATOMIC_FETCH_ADD(&dependent->remaining, (uint32_t)-1) == 1)
+            thread_pool_submit(graph->pool, run_task_job, dependent, &graph->counter);
+    }
+}
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct task_graph_t*
+task_graph_create(void)
+{
+    struct task_graph_t* graph;
+    if(!(graph = (struct task_graph_t*)MALLOC(sizeof *graph, "task_graph_create()")))
+        return NULL;
+    task_graph_init(graph);
+    return graph;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+task_graph_init(struct task_graph_t* graph)
+{
+    task_graph_init_with_allocator(graph, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+task_graph_init_with_allocator(struct task_graph_t* graph,
+                               const struct allocator_t* allocator)
+{
+    assert(graph);
+    ordered_vector_init_with_allocator(&graph->tasks, sizeof(struct task_graph_task_t), allocator);
+    ordered_vector_init_with_allocator(&graph->dependents, sizeof(uint32_t), allocator);
+    graph->pool = NULL;
+    graph->built = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+task_graph_destroy(struct task_graph_t* graph)
+{
+    assert(graph);
+    task_graph_clear_free(graph);
+    FREE(graph);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+task_graph_clear_free(struct task_graph_t* graph)
+{
+    assert(graph);
+
+    ORDERED_VECTOR_FOR_EACH(&graph->tasks, struct task_graph_task_t, task)
+        ALLOCATOR_FREE(task_graph_allocator(graph), task->name);
+    ORDERED_VECTOR_END_EACH
+    ordered_vector_clear_free(&graph->tasks);
+    ordered_vector_clear_free(&graph->dependents);
+    graph->built = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+task_graph_add(struct task_graph_t* graph,
+               const char* name,
+               task_graph_func func,
+               void* arg,
+               uint32_t reads,
+               uint32_t writes)
+{
+    struct task_graph_task_t* task;
+    char* name_copy;
+    uintptr_t name_length;
+
+    assert(graph);
+    assert(name);
+    assert(func);
+
+    name_length = strlen(name) + 1;
+    if(!(name_copy = (char*)ALLOCATOR_MALLOC(task_graph_allocator(graph), name_length, "task_graph_add()")))
+        return 0;
+    memcpy(name_copy, name, name_length);
+    if(!(task = (struct task_graph_task_t*)ordered_vector_push_emplace(&graph->tasks)))
+    {
+        ALLOCATOR_FREE(task_graph_allocator(graph), name_copy);
+        return 0;
+    }
+
+    task->name = name_copy;
+    task->func = func;
+    task->arg = arg;
+    task->reads = reads;
+    task->writes = writes;
+    task->dependency_count = 0;
+    task->first_dependent = 0;
+    task->dependent_count = 0;
+    task->remaining = 0;
+    task->graph = graph;
+    graph->built = 0;
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+task_graph_build(struct task_graph_t* graph)
+{
+    uint32_t i, j, edges = 0;
+
+    assert(graph);
+
+    graph->built = 0;
+
+    /* count first so the dependents vector only has to be allocated once */
+    for(i = 0; i != graph->tasks.count; ++i)
+    {
+        struct task_graph_task_t* task = (struct task_graph_task_t*)
+            ordered_vector_get_element(&graph->tasks, i);
+        task->dependency_count = 0;
+        task->dependent_count = 0;
+        for(j = 0; j != i; ++j)
+            if(tasks_conflict(ordered_vector_get_element(&graph->tasks, j), task))
+                ++task->dependency_count;
+        edges += task->dependency_count;
+    }
+
+    ordered_vector_clear(&graph->dependents);
+    if(!ordered_vector_reserve(&graph->dependents, edges))
+        return 0;
+
+    for(i = 0; i != graph->tasks.count; ++i)
+    {
+        struct task_graph_task_t* task = (struct task_graph_task_t*)
+            ordered_vector_get_element(&graph->tasks, i);
+        task->first_dependent = graph->dependents.count;
+        for(j = i + 1; j != graph->tasks.count; ++j)
+            if(tasks_conflict(task, ordered_vector_get_element(&graph->tasks, j)))
+            {
+                ordered_vector_push(&graph->dependents, &j);
+                ++task->dependent_count;
+            }
+    }
+
+    graph->built = 1;
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+task_graph_run(struct task_graph_t* graph, struct thread_pool_t* pool)
+{
+    assert(graph);
+    assert(graph->built);
+
+#ifdef ENABLE_THREAD_POOL
+    if(pool)
+    {
+        graph->pool = pool;
+        thread_pool_counter_init(&graph->counter);
+
+        ORDERED_VECTOR_FOR_EACH(&graph->tasks, struct task_graph_task_t, task)
+            task->remaining = task->dependency_count;
+        ORDERED_VECTOR_END_EACH
+        ORDERED_VECTOR_FOR_EACH(&graph->tasks, struct task_graph_task_t, task)
+            if(task->dependency_count == 0)
+                thread_pool_submit(pool, run_task_job, task, &graph->counter);
+        ORDERED_VECTOR_END_EACH
+
+        thread_pool_wait(pool, &graph->counter);
+        graph->pool = NULL;
+        return;
+    }
+#endif
+
+    /* the order tasks were added in is always a valid order */
+    ORDERED_VECTOR_FOR_EACH(&graph->tasks, struct task_graph_task_t, task)
+        task->func(task->arg);
+    ORDERED_VECTOR_END_EACH
+}
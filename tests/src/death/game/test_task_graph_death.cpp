@@ -0,0 +1,33 @@
+#include "tests/globals.hpp"
+#include "gmock/gmock.h"
+#include "game/task_graph.h"
+
+#define NAME task_graph_DeathTest
+
+using namespace testing;
+
+static void
+do_nothing(void* arg)
+{
+}
+
+TEST(NAME, run_without_building)
+{
+    struct task_graph_t graph;
+    task_graph_init(&graph);
+    ASSERT_THAT(task_graph_add(&graph, "a", do_nothing, NULL, 0, 1), Eq(1));
+    ASSERT_DEATH(task_graph_run(&graph, NULL), ".*graph->built.*");
+    task_graph_clear_free(&graph);
+}
+
+TEST(NAME, run_after_adding_a_task_without_building_again)
+{
+    struct task_graph_t graph;
+    task_graph_init(&graph);
+    ASSERT_THAT(task_graph_add(&graph, "a", do_nothing, NULL, 0, 1), Eq(1));
+    ASSERT_THAT(task_graph_build(&graph), Eq(1));
+    task_graph_run(&graph, NULL);
+    ASSERT_THAT(task_graph_add(&graph, "b", do_nothing, NULL, 1, 0), Eq(1));
+    ASSERT_DEATH(task_graph_run(&graph, NULL), ".*graph->built.*");
+    task_graph_clear_free(&graph);
+}
@@ -80,6 +80,24 @@ TEST(NAME, insert_emplace_with_vector_as_null_ptr)
     EXPECT_DEATH(ordered_vector_insert_emplace(NULL, 0), ASSERTION_REGEX);
 }
 
+TEST(NAME, insert_range_with_vector_as_null_ptr)
+{
+    int a = 6;
+    ASSERT_DEATH(ordered_vector_insert_range(NULL, 0, &a, 1), ASSERTION_REGEX);
+}
+
+TEST(NAME, insert_range_with_data_as_null_ptr)
+{
+    ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    EXPECT_DEATH(ordered_vector_insert_range(vec, 0, NULL, 1), ASSERTION_REGEX);
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, insert_range_emplace_with_vector_as_null_ptr)
+{
+    EXPECT_DEATH(ordered_vector_insert_range_emplace(NULL, 0, 1), ASSERTION_REGEX);
+}
+
 TEST(NAME, erase_index_with_vector_as_null_ptr)
 {
     ASSERT_DEATH(ordered_vector_erase_index(NULL, 0), ASSERTION_REGEX);
@@ -107,6 +125,18 @@ TEST(NAME, erase_element_with_element_as_out_of_bounds_ptr)
     ordered_vector_destroy(vec);
 }
 
+TEST(NAME, erase_range_with_vector_as_null_ptr)
+{
+    ASSERT_DEATH(ordered_vector_erase_range(NULL, 0, 1), ASSERTION_REGEX);
+}
+
+TEST(NAME, erase_if_with_predicate_as_null_ptr)
+{
+    ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    EXPECT_DEATH(ordered_vector_erase_if(vec, NULL, NULL), ASSERTION_REGEX);
+    ordered_vector_destroy(vec);
+}
+
 TEST(NAME, get_element_with_vec_as_null_ptr)
 {
     ASSERT_DEATH(ordered_vector_get_element(NULL, 0), ASSERTION_REGEX);
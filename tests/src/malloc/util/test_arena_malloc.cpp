@@ -0,0 +1,33 @@
+#include "gmock/gmock.h"
+#include "util/arena.h"
+#include "util/memory.h"
+
+#define NAME arena_malloc
+
+using namespace testing;
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(arena_create(64), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, alloc_new_block)
+{
+    struct arena_t* arena = arena_create(64);
+
+    force_malloc_fail_on();
+    EXPECT_THAT(arena_alloc(arena, 16), IsNull());
+    force_malloc_fail_off();
+    EXPECT_THAT(arena->blocks, IsNull());
+
+    EXPECT_THAT(arena_alloc(arena, 16), NotNull());
+
+    /* fits into existing block, doesn't need malloc */
+    force_malloc_fail_on();
+    EXPECT_THAT(arena_alloc(arena, 16), NotNull());
+    force_malloc_fail_off();
+
+    arena_destroy(arena);
+}
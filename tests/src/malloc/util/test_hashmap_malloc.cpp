@@ -0,0 +1,72 @@
+#include "gmock/gmock.h"
+#include "util/hashmap.h"
+#include "util/memory.h"
+#include <stdio.h>
+
+#define NAME hashmap_malloc
+
+using namespace testing;
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(hashmap_create(), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, insert_fails_on_each_allocation)
+{
+    struct hashmap_t map;
+    int a = 1;
+    int i;
+    char result = 0;
+
+    hashmap_init(&map);
+
+    /* the key copy and the table are allocated separately */
+    for(i = 1; !result; ++i)
+    {
+        ASSERT_THAT(i, Le(3));
+        force_malloc_fail_after(i);
+        result = hashmap_insert(&map, "a", &a);
+        force_malloc_fail_off();
+        if(!result)
+        {
+            EXPECT_THAT(hashmap_count(&map), Eq(0u));
+            EXPECT_THAT(hashmap_find(&map, "a"), IsNull());
+        }
+    }
+    EXPECT_THAT(i, Eq(4));
+    EXPECT_THAT(hashmap_find(&map, "a"), Eq(&a));
+
+    hashmap_clear_free(&map);
+}
+
+TEST(NAME, failed_grow_keeps_existing_elements)
+{
+    struct hashmap_t map;
+    char key[32];
+    int a = 1;
+    uint32_t i;
+
+    hashmap_init(&map);
+    for(i = 0; hashmap_count(&map) != map.capacity - map.capacity / 8 || i == 0; ++i)
+    {
+        sprintf(key, "%u", i);
+        ASSERT_THAT(hashmap_insert(&map, key, &a), Eq(1));
+    }
+
+    /* table is full, the next insert has to grow it */
+    force_malloc_fail_after(2);
+    EXPECT_THAT(hashmap_insert(&map, "grow", &a), Eq(0));
+    force_malloc_fail_off();
+
+    EXPECT_THAT(hashmap_count(&map), Eq(i));
+    for(i = 0; i != hashmap_count(&map); ++i)
+    {
+        sprintf(key, "%u", i);
+        EXPECT_THAT(hashmap_find(&map, key), Eq(&a));
+    }
+
+    hashmap_clear_free(&map);
+}
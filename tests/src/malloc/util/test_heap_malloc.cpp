@@ -0,0 +1,64 @@
+#include "gmock/gmock.h"
+#include "util/heap.h"
+#include "util/memory.h"
+
+#define NAME heap_malloc
+
+using namespace testing;
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(heap_create(), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, push_fails_on_each_allocation)
+{
+    struct heap_t heap;
+    heap_handle_t handle;
+    int a;
+    char result = 0;
+    int i;
+
+    heap_init(&heap);
+
+    /* the nodes and the handle positions are allocated separately */
+    for(i = 1; !result; ++i)
+    {
+        ASSERT_THAT(i, Le(3));
+        force_malloc_fail_after(i);
+        result = heap_push(&heap, 5, &a, &handle);
+        force_malloc_fail_off();
+        if(!result)
+            EXPECT_THAT(heap_count(&heap), Eq(0u));
+    }
+    EXPECT_THAT(i, Eq(4));
+    EXPECT_THAT(heap_get(&heap, handle), Eq(&a));
+
+    heap_clear_free(&heap);
+}
+
+TEST(NAME, failed_build_changes_nothing)
+{
+    struct heap_t heap;
+    struct heap_item_t items[100];
+    int a, i;
+
+    heap_init(&heap);
+    heap_push(&heap, 7, &a, NULL);
+    for(i = 0; i != 100; ++i)
+    {
+        items[i].priority = i;
+        items[i].value = NULL;
+    }
+
+    force_malloc_fail_on();
+    EXPECT_THAT(heap_build(&heap, items, 100, NULL), Eq(0));
+    force_malloc_fail_off();
+
+    EXPECT_THAT(heap_count(&heap), Eq(1u));
+    EXPECT_THAT(heap_peek(&heap), Eq(&a));
+
+    heap_clear_free(&heap);
+}
@@ -0,0 +1,55 @@
+#include "gmock/gmock.h"
+#include "util/id_allocator.h"
+#include "util/memory.h"
+
+#define NAME id_allocator_malloc
+
+using namespace testing;
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(id_allocator_create(), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, alloc_fails_on_each_allocation)
+{
+    struct id_allocator_t ids;
+    uint32_t id = ID_ALLOCATOR_INVALID_ID;
+    int i;
+
+    id_allocator_init(&ids);
+
+    /* the two levels of the bitmap are allocated separately */
+    for(i = 1; id == ID_ALLOCATOR_INVALID_ID; ++i)
+    {
+        ASSERT_THAT(i, Le(3));
+        force_malloc_fail_after(i);
+        id = id_allocator_alloc(&ids);
+        force_malloc_fail_off();
+        if(id == ID_ALLOCATOR_INVALID_ID)
+            EXPECT_THAT(id_allocator_count(&ids), Eq(0u));
+    }
+    EXPECT_THAT(i, Eq(4));
+    EXPECT_THAT(id, Eq(0u));
+
+    id_allocator_clear_free(&ids);
+}
+
+TEST(NAME, failed_reserve_changes_nothing)
+{
+    struct id_allocator_t ids;
+    id_allocator_init(&ids);
+    id_allocator_alloc(&ids);
+
+    force_malloc_fail_on();
+    EXPECT_THAT(id_allocator_reserve(&ids, 5000, 10), Eq(0));
+    force_malloc_fail_off();
+
+    EXPECT_THAT(id_allocator_count(&ids), Eq(1u));
+    EXPECT_THAT(id_allocator_is_used(&ids, 5000), Eq(0));
+    EXPECT_THAT(id_allocator_alloc(&ids), Eq(1u));
+
+    id_allocator_clear_free(&ids);
+}
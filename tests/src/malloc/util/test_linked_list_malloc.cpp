@@ -115,3 +115,24 @@ TEST(NAME, list_erase_element)
 
     list_destroy(list);
 }
+
+TEST(NAME, push_reuses_erased_nodes_without_allocating)
+{
+    int a=7, b=3;
+
+    struct list_t* list = list_create();
+    list_push(list, &a);
+    list_push(list, &b);
+    list_pop(list);
+    list_erase_element(list, &a);
+
+    force_malloc_fail_on();
+    EXPECT_THAT(list_push(list, &a), NotNull());
+    EXPECT_THAT(list_push(list, &b), NotNull());
+    EXPECT_THAT(list_push(list, &b), IsNull());
+    force_malloc_fail_off();
+
+    EXPECT_THAT(list->count, Eq(2));
+
+    list_destroy(list);
+}
@@ -29,3 +29,41 @@ TEST(NAME, insert)
 
     bstv_destroy(map);
 }
+
+TEST(NAME, build_from_unsorted_leaves_bstv_unchanged)
+{
+    struct bstv_t* bstv = bstv_create();
+    int a = 1, b = 2;
+    struct bstv_hash_value_t pairs[] = {{5, &b}, {3, &b}};
+    bstv_insert(bstv, 7, &a);
+
+    /* fails on the copy and on the sort's scratch buffer */
+    for(int i = 1; i != 3; ++i)
+    {
+        force_malloc_fail_after(i);
+        EXPECT_THAT(bstv_build_from_unsorted(bstv, pairs, 2), Eq(0));
+        force_malloc_fail_off();
+        EXPECT_THAT(bstv_count(bstv), Eq(1u));
+        EXPECT_THAT((int*)bstv_find(bstv, 7), Pointee(a));
+    }
+
+    bstv_destroy(bstv);
+}
+
+TEST(NAME, read_optimised_falls_back_if_rebuild_fails)
+{
+    struct bstv_t* bstv = bstv_create();
+    int a = 1, b = 2;
+    bstv_insert(bstv, 7, &a);
+
+    force_malloc_fail_on();
+    EXPECT_THAT(bstv_optimise_for_reads(bstv), Eq(0));
+    EXPECT_THAT((int*)bstv_find(bstv, 7), Pointee(a));
+    force_malloc_fail_off();
+
+    bstv_insert(bstv, 3, &b);
+    EXPECT_THAT((int*)bstv_find(bstv, 3), Pointee(b));
+    EXPECT_THAT(bstv->eytzinger_dirty, Eq(0));
+
+    bstv_destroy(bstv);
+}
@@ -1,5 +1,6 @@
 #include "gmock/gmock.h"
 #include "util/memory.h"
+#include <string.h>
 
 #define NAME memory_malloc
 
@@ -20,3 +21,21 @@ TEST(NAME, malloc)
     ASSERT_THAT(p1, NotNull());
     FREE(p3);
 }
+
+TEST(NAME, realloc)
+{
+    char* p1 = (char*)MALLOC(4, "");
+    ASSERT_THAT(p1, NotNull());
+    memcpy(p1, "abc", 4);
+
+    force_malloc_fail_on();
+    EXPECT_THAT(REALLOC(p1, 4096, ""), IsNull());
+    force_malloc_fail_off();
+
+    char* p2 = (char*)REALLOC(p1, 4096, "");
+    ASSERT_THAT(p2, NotNull());
+    EXPECT_THAT(p2, StrEq("abc"));
+
+    /* freeing the new location must not be reported as a leak or bad free */
+    FREE(p2);
+}
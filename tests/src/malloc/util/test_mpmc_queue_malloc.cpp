@@ -0,0 +1,32 @@
+#include "gmock/gmock.h"
+#include "util/mpmc_queue.h"
+#include "util/memory.h"
+
+#define NAME mpmc_queue_malloc
+
+using namespace testing;
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(mpmc_queue_create(sizeof(int), 16), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, create_fails_on_each_allocation)
+{
+    struct mpmc_queue_t* queue = NULL;
+    int i;
+
+    /* the struct, the cells, the mutex and two condition variables */
+    for(i = 1; !queue; ++i)
+    {
+        ASSERT_THAT(i, Le(6));
+        force_malloc_fail_after(i);
+        queue = mpmc_queue_create(sizeof(int), 16);
+        force_malloc_fail_off();
+    }
+    EXPECT_THAT(i, Eq(7));
+
+    mpmc_queue_destroy(queue);
+}
@@ -50,7 +50,7 @@ TEST(NAME, push_realloc)
 
     EXPECT_THAT(ordered_vector_push(vec, &a), Ne(0));
     EXPECT_THAT(vec->count, Lt(vec->capacity));
-    EXPECT_THAT(vec->data, Ne(old_data_ptr));
+    /* the buffer may have been grown in place by realloc() */
 
     ordered_vector_destroy(vec);
 }
@@ -92,7 +92,7 @@ TEST(NAME, push_emplace_realloc)
 
     EXPECT_THAT(ordered_vector_push_emplace(vec), NotNull());
     EXPECT_THAT(vec->count, Lt(vec->capacity));
-    EXPECT_THAT(vec->data, Ne(old_data_ptr));
+    /* the buffer may have been grown in place by realloc() */
 
     ordered_vector_destroy(vec);
 }
@@ -162,7 +162,7 @@ TEST(NAME, insert_realloc)
 
     EXPECT_THAT(ordered_vector_insert(vec, 1, &a), Ne(0));
     EXPECT_THAT(vec->count, Lt(vec->capacity));
-    EXPECT_THAT(vec->data, Ne(old_data_ptr));
+    /* the buffer may have been grown in place by realloc() */
 
     ordered_vector_destroy(vec);
 }
@@ -204,7 +204,114 @@ TEST(NAME, insert_emplace_realloc)
 
     EXPECT_THAT(ordered_vector_insert_emplace(vec, 1), NotNull());
     EXPECT_THAT(vec->count, Lt(vec->capacity));
-    EXPECT_THAT(vec->data, Ne(old_data_ptr));
+    /* the buffer may have been grown in place by realloc() */
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, insert_range_new_alloc)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    int range[] = {1, 2, 3};
+
+    force_malloc_fail_on();
+    EXPECT_THAT(ordered_vector_insert_range(vec, 0, range, 3), Eq(0));
+    force_malloc_fail_off();
+    EXPECT_THAT(vec->count, Eq(0));
+    EXPECT_THAT(vec->capacity, Eq(0));
+    EXPECT_THAT(vec->data, IsNull());
+
+    EXPECT_THAT(ordered_vector_insert_range(vec, 0, range, 3), Ne(0));
+    EXPECT_THAT((int*)ordered_vector_back(vec), Pointee(3));
+    EXPECT_THAT(vec->count, Eq(3));
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, insert_range_realloc)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    int range[] = {1, 2, 3};
+    ordered_vector_insert_range(vec, 0, range, 3);
+
+    void* old_data_ptr = vec->data;
+    force_malloc_fail_on();
+    EXPECT_THAT(ordered_vector_insert_range(vec, 1, range, 3), Eq(0));
+    force_malloc_fail_off();
+    EXPECT_THAT(vec->count, Eq(3));
+    EXPECT_THAT(vec->data, Eq(old_data_ptr)); /* make sure data is preserved */
+    EXPECT_THAT(*(int*)ordered_vector_get_element(vec, 1), Eq(2));
+
+    EXPECT_THAT(ordered_vector_insert_range(vec, 1, range, 3), Ne(0));
+    EXPECT_THAT(vec->count, Eq(6));
+    /* the buffer may have been grown in place by realloc() */
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, reserve)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    *(int*)ordered_vector_push_emplace(vec) = 5;
+
+    force_malloc_fail_on();
+    EXPECT_THAT(ordered_vector_reserve(vec, 100), Eq(0));
+    force_malloc_fail_off();
+    EXPECT_THAT(vec->capacity, Eq(2u));
+    EXPECT_THAT(*(int*)ordered_vector_get_element(vec, 0), Eq(5));
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, shrink_to_fit)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    ordered_vector_reserve(vec, 100);
+    *(int*)ordered_vector_push_emplace(vec) = 5;
+
+    force_malloc_fail_on();
+    EXPECT_THAT(ordered_vector_shrink_to_fit(vec), Eq(0));
+    force_malloc_fail_off();
+    EXPECT_THAT(vec->capacity, Eq(100u));
+    EXPECT_THAT(*(int*)ordered_vector_get_element(vec, 0), Eq(5));
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, inline_storage_spill)
+{
+    struct ordered_vector_t vec;
+    int buffer[2];
+    ordered_vector_init_inline(&vec, sizeof(int), buffer, 2);
+
+    /* no allocation required while the elements fit */
+    force_malloc_fail_on();
+    EXPECT_THAT(ordered_vector_push_emplace(&vec), NotNull());
+    EXPECT_THAT(ordered_vector_push_emplace(&vec), NotNull());
+    EXPECT_THAT(ordered_vector_push_emplace(&vec), IsNull());
+    force_malloc_fail_off();
+    EXPECT_THAT(vec.data, Eq((DATA_POINTER_TYPE*)buffer));
+    EXPECT_THAT(vec.count, Eq(2u));
+
+    EXPECT_THAT(ordered_vector_push_emplace(&vec), NotNull());
+    EXPECT_THAT(vec.data, Ne((DATA_POINTER_TYPE*)buffer));
+
+    ordered_vector_clear_free(&vec);
+}
+
+TEST(NAME, radix_sort_scratch_alloc_fails)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(uint32_t));
+    uint32_t values[] = {3, 1, 2};
+    for(int i = 0; i != 3; ++i)
+        ordered_vector_push(vec, &values[i]);
+
+    force_malloc_fail_on();
+    EXPECT_THAT(ordered_vector_radix_sort_u32(vec, 0), Eq(0));
+    force_malloc_fail_off();
+
+    for(int i = 0; i != 3; ++i)
+        EXPECT_THAT(*(uint32_t*)ordered_vector_get_element(vec, i), Eq(values[i]));
 
     ordered_vector_destroy(vec);
 }
@@ -30,12 +30,12 @@ TEST(NAME, add_node)
         force_malloc_fail_after(i);
         EXPECT_THAT(ptree_set(tree, "test.test.test.test", NULL), IsNull());
         force_malloc_fail_off();
-        ASSERT_THAT(bsthv_count(&tree->children), Eq(0));
+        ASSERT_THAT(string_map_count(&tree->children), Eq(0));
     }
 
     ASSERT_THAT(ptree_set(tree, "test.test.test.test", NULL), NotNull());
-    ASSERT_THAT(bsthv_count(&tree->children), Eq(1));
-    ASSERT_THAT(bsthv_count(&ptree_get_node(tree, "test.test.test.test")->children), Eq(0));
+    ASSERT_THAT(string_map_count(&tree->children), Eq(1));
+    ASSERT_THAT(string_map_count(&ptree_get_node(tree, "test.test.test.test")->children), Eq(0));
 
     ptree_destroy(tree);
 }
@@ -54,13 +54,13 @@ TEST(NAME, set_parent_fail_later)
         force_malloc_fail_after(i);
         EXPECT_THAT(ptree_set_parent(node, root, "node"), Eq(0));
         force_malloc_fail_off();
-        ASSERT_THAT(bsthv_count(&root->children), Eq(0));
+        ASSERT_THAT(string_map_count(&root->children), Eq(0));
         ASSERT_THAT(root->parent, IsNull());
         ASSERT_THAT(node->parent, IsNull());
     }
 
     ASSERT_THAT(ptree_set_parent(node, root, "node"), Ne(0));
-    ASSERT_THAT(bsthv_count(&root->children), Eq(1));
+    ASSERT_THAT(string_map_count(&root->children), Eq(1));
     ASSERT_THAT(root->parent, IsNull());
     ASSERT_THAT(node->parent, Eq(root));
 
@@ -102,7 +102,7 @@ TEST(NAME, duplicate_tree_fail_later)
         force_malloc_fail_after(i);
         EXPECT_THAT(ptree_duplicate_tree(tree), IsNull());
         force_malloc_fail_off();
-        ASSERT_THAT(bsthv_count(&tree->children), Eq(1));
+        ASSERT_THAT(string_map_count(&tree->children), Eq(1));
         ASSERT_THAT(n3->parent->parent->parent, Eq(tree));
         ASSERT_THAT(n1->parent->parent->parent, Eq(tree));
         ASSERT_THAT(tree->parent, IsNull());
@@ -112,7 +112,7 @@ TEST(NAME, duplicate_tree_fail_later)
 
     struct ptree_t* copy = ptree_duplicate_tree(tree);
     ASSERT_THAT(copy, NotNull());
-    ASSERT_THAT(bsthv_count(&copy->children), Eq(1));
+    ASSERT_THAT(string_map_count(&copy->children), Eq(1));
     ASSERT_THAT((int*)ptree_get_node(copy, "1.2.3")->value, Pointee(*a));
     ASSERT_THAT((int*)ptree_get_node(copy, "1.1.1")->value, Pointee(*b));
     ASSERT_THAT(copy->parent, IsNull());
@@ -143,8 +143,8 @@ TEST(NAME, duplicate_into_existing_node_fail_later)
         force_malloc_fail_after(i);
         EXPECT_THAT(ptree_duplicate_children_into_existing_node(n2, tree), Eq(0));
         force_malloc_fail_off();
-        ASSERT_THAT(bsthv_count(&tree->children), Eq(1));
-        ASSERT_THAT(bsthv_count(&n2->children), Eq(1));
+        ASSERT_THAT(string_map_count(&tree->children), Eq(1));
+        ASSERT_THAT(string_map_count(&n2->children), Eq(1));
         ASSERT_THAT(tree->parent, IsNull());
         ASSERT_THAT((int*)ptree_get_node(tree, "1.2.3")->value, Pointee(*a));
         ASSERT_THAT((int*)ptree_get_node(tree, "1.1.1")->value, Pointee(*b));
@@ -153,16 +153,15 @@ TEST(NAME, duplicate_into_existing_node_fail_later)
     ptree_destroy(tree);
 }
 
-TEST(NAME, get_node)
+TEST(NAME, get_node_does_not_allocate)
 {
     struct ptree_t* tree = ptree_create(NULL);
     ptree_set(tree, "1.1.1", NULL);
 
     force_malloc_fail_on();
-    EXPECT_THAT(ptree_get_node(tree, "1"), IsNull());
-    force_malloc_fail_off();
-
     EXPECT_THAT(ptree_get_node(tree, "1"), NotNull());
+    EXPECT_THAT(ptree_get_node(tree, "1.1.1"), NotNull());
+    force_malloc_fail_off();
 
     ptree_destroy(tree);
 }
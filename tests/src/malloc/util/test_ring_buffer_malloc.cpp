@@ -0,0 +1,63 @@
+#include "gmock/gmock.h"
+#include "util/ring_buffer.h"
+#include "util/memory.h"
+
+#define NAME ring_buffer_malloc
+
+using namespace testing;
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(ring_buffer_create(sizeof(int)), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, create_fails_on_each_allocation)
+{
+    struct ring_buffer_t* rb = NULL;
+    int i;
+
+    /* the struct and the first segment are allocated separately */
+    for(i = 1; !rb; ++i)
+    {
+        ASSERT_THAT(i, Le(3));
+        force_malloc_fail_after(i);
+        rb = ring_buffer_create(sizeof(int));
+        force_malloc_fail_off();
+    }
+    EXPECT_THAT(i, Eq(4));
+
+    ring_buffer_destroy(rb);
+}
+
+TEST(NAME, init)
+{
+    struct ring_buffer_t rb;
+    force_malloc_fail_on();
+    EXPECT_THAT(ring_buffer_init(&rb, sizeof(int)), Eq(0));
+    force_malloc_fail_off();
+}
+
+#ifdef ENABLE_RING_BUFFER_REALLOC
+TEST(NAME, failed_growth_keeps_elements)
+{
+    struct ring_buffer_t rb;
+    int i, value;
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 4);
+    for(i = 0; i != 4; ++i)
+        ring_buffer_enqueue(&rb, &i);
+
+    force_malloc_fail_on();
+    EXPECT_THAT(ring_buffer_enqueue(&rb, &i), Eq(0));
+    force_malloc_fail_off();
+
+    for(i = 0; i != 4; ++i)
+    {
+        ASSERT_THAT(ring_buffer_dequeue(&rb, &value), Eq(1));
+        EXPECT_THAT(value, Eq(i));
+    }
+    ring_buffer_clear_free(&rb);
+}
+#endif
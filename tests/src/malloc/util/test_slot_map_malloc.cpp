@@ -0,0 +1,45 @@
+#include "gmock/gmock.h"
+#include "util/slot_map.h"
+#include "util/memory.h"
+
+#define NAME slot_map_malloc
+
+using namespace testing;
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(slot_map_create(sizeof(int)), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, insert_fails_on_each_allocation)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handle = SLOT_MAP_INVALID_HANDLE;
+    int value = 7;
+    int i;
+
+    slot_map_init(&map, sizeof(int));
+
+    /*
+     * The slot, element and back reference are allocated separately. Let
+     * each allocation fail in turn, the map must stay consistent every time.
+     */
+    for(i = 1; handle == SLOT_MAP_INVALID_HANDLE; ++i)
+    {
+        ASSERT_THAT(i, Le(3));
+        force_malloc_fail_after(i);
+        handle = slot_map_insert(&map, &value);
+        force_malloc_fail_off();
+        EXPECT_THAT(map.dense_to_slot.count, Eq(slot_map_count(&map)));
+    }
+    EXPECT_THAT(i, Eq(4));
+    EXPECT_THAT(slot_map_count(&map), Eq(1u));
+
+    /* the slot left over from the failed insertions got reused */
+    EXPECT_THAT(map.slots.count, Eq(1u));
+    EXPECT_THAT((int*)slot_map_get(&map, handle), Pointee(7));
+
+    slot_map_clear_free(&map);
+}
@@ -0,0 +1,39 @@
+#include "gmock/gmock.h"
+#include "util/soa_vector.h"
+#include "util/memory.h"
+
+#define NAME soa_vector_malloc
+
+using namespace testing;
+
+static const uint32_t g_sizes[] = {sizeof(float), sizeof(int)};
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(soa_vector_create(2, g_sizes), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, push_failure_leaves_vector_unchanged)
+{
+    struct soa_vector_t v;
+    void* column;
+
+    soa_vector_init(&v, 2, g_sizes);
+    soa_vector_push_emplace(&v);
+    *(int*)soa_vector_get(&v, 1, 0) = 42;
+    column = soa_vector_column(&v, 1);
+
+    force_malloc_fail_on();
+    EXPECT_THAT(soa_vector_push_emplace(&v), Eq(0));
+    EXPECT_THAT(soa_vector_reserve(&v, 100), Eq(0));
+    force_malloc_fail_off();
+
+    EXPECT_THAT(soa_vector_count(&v), Eq(1u));
+    EXPECT_THAT(v.capacity, Eq(1u));
+    EXPECT_THAT(soa_vector_column(&v, 1), Eq(column));
+    EXPECT_THAT(*(int*)soa_vector_get(&v, 1, 0), Eq(42));
+
+    soa_vector_clear_free(&v);
+}
@@ -0,0 +1,43 @@
+#include "gmock/gmock.h"
+#include "util/string_pool.h"
+#include "util/memory.h"
+
+#define NAME string_pool_malloc
+
+using namespace testing;
+
+TEST(NAME, create)
+{
+    force_malloc_fail_on();
+    EXPECT_THAT(string_pool_create(), IsNull());
+    force_malloc_fail_off();
+}
+
+TEST(NAME, intern_fails_on_each_allocation)
+{
+    struct string_pool_t pool;
+    const char* result = NULL;
+    int i;
+
+    string_pool_init(&pool);
+
+    /* the table and the first arena block */
+    for(i = 1; !result; ++i)
+    {
+        ASSERT_THAT(i, Le(3));
+        force_malloc_fail_after(i);
+        result = string_pool_intern(&pool, "a");
+        force_malloc_fail_off();
+        if(!result)
+            EXPECT_THAT(string_pool_count(&pool), Eq(0u));
+    }
+    EXPECT_THAT(i, Eq(4));
+    EXPECT_THAT(string_pool_find_n(&pool, "a", 1), Eq(result));
+
+    /* further strings fit into the existing block and table */
+    force_malloc_fail_on();
+    EXPECT_THAT(string_pool_intern(&pool, "b"), StrEq("b"));
+    force_malloc_fail_off();
+
+    string_pool_clear_free(&pool);
+}
@@ -50,7 +50,7 @@ TEST(NAME, push_realloc)
 
     EXPECT_THAT(unordered_vector_push(vec, &a), Ne(0));
     EXPECT_THAT(vec->count, Lt(vec->capacity));
-    EXPECT_THAT(vec->data, Ne(old_data_ptr));
+    /* the buffer may have been grown in place by realloc() */
 
     unordered_vector_destroy(vec);
 }
@@ -92,7 +92,57 @@ TEST(NAME, push_emplace_realloc)
 
     EXPECT_THAT(unordered_vector_push_emplace(vec), NotNull());
     EXPECT_THAT(vec->count, Lt(vec->capacity));
-    EXPECT_THAT(vec->data, Ne(old_data_ptr));
+    /* the buffer may have been grown in place by realloc() */
 
     unordered_vector_destroy(vec);
 }
+
+TEST(NAME, reserve)
+{
+    struct unordered_vector_t* vec = unordered_vector_create(sizeof(int));
+    *(int*)unordered_vector_push_emplace(vec) = 5;
+
+    force_malloc_fail_on();
+    EXPECT_THAT(unordered_vector_reserve(vec, 100), Eq(0));
+    force_malloc_fail_off();
+    EXPECT_THAT(vec->capacity, Eq(2u));
+    EXPECT_THAT(*(int*)unordered_vector_get_element(vec, 0), Eq(5));
+
+    unordered_vector_destroy(vec);
+}
+
+TEST(NAME, shrink_to_fit)
+{
+    struct unordered_vector_t* vec = unordered_vector_create(sizeof(int));
+    unordered_vector_reserve(vec, 100);
+    *(int*)unordered_vector_push_emplace(vec) = 5;
+
+    force_malloc_fail_on();
+    EXPECT_THAT(unordered_vector_shrink_to_fit(vec), Eq(0));
+    force_malloc_fail_off();
+    EXPECT_THAT(vec->capacity, Eq(100u));
+    EXPECT_THAT(*(int*)unordered_vector_get_element(vec, 0), Eq(5));
+
+    unordered_vector_destroy(vec);
+}
+
+TEST(NAME, inline_storage_spill)
+{
+    struct unordered_vector_t vec;
+    int buffer[2];
+    unordered_vector_init_inline(&vec, sizeof(int), buffer, 2);
+
+    /* no allocation required while the elements fit */
+    force_malloc_fail_on();
+    EXPECT_THAT(unordered_vector_push_emplace(&vec), NotNull());
+    EXPECT_THAT(unordered_vector_push_emplace(&vec), NotNull());
+    EXPECT_THAT(unordered_vector_push_emplace(&vec), IsNull());
+    force_malloc_fail_off();
+    EXPECT_THAT(vec.data, Eq((DATA_POINTER_TYPE*)buffer));
+    EXPECT_THAT(vec.count, Eq(2u));
+
+    EXPECT_THAT(unordered_vector_push_emplace(&vec), NotNull());
+    EXPECT_THAT(vec.data, Ne((DATA_POINTER_TYPE*)buffer));
+
+    unordered_vector_clear_free(&vec);
+}
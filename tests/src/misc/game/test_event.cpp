@@ -11,14 +11,14 @@ TEST(NAME, create_destroy)
     /* Event system only uses game->events and nothing else. No need to create
      * a game object */
     game_t game;
-    EXPECT_THAT(event_system_create(&game), Ne(0));
+    EXPECT_THAT(event_system_create(&game, NULL), Ne(0));
     event_system_destroy(&game);
 }
 
 TEST(NAME, register_and_unregister_events)
 {
     game_t game;
-    ASSERT_THAT(event_system_create(&game), Ne(0));
+    ASSERT_THAT(event_system_create(&game, NULL), Ne(0));
 
     event_t* event = event_register(&game, "evt1");
     ASSERT_THAT(event, NotNull());
@@ -40,6 +40,51 @@ TEST(NAME, register_and_unregister_events)
     event_system_destroy(&game);
 }
 
+TEST(NAME, unregister_event_of_other_game_does_nothing)
+{
+    game_t game1, game2;
+    ASSERT_THAT(event_system_create(&game1, NULL), Ne(0));
+    ASSERT_THAT(event_system_create(&game2, NULL), Ne(0));
+    game1.name = (char*)"game1";
+    game2.name = (char*)"game2";
+
+    event_t* event1 = event_register(&game1, "evt");
+    event_t* event2 = event_register(&game2, "evt");
+    ASSERT_THAT(event1, NotNull());
+    ASSERT_THAT(event2, NotNull());
+
+    /* event claims to belong to game1, but game1 has a different event with that name */
+    event2->game = &game1;
+    event_unregister(event2);
+    EXPECT_THAT(event_get(&game1, "evt"), Eq(event1));
+    event2->game = &game2;
+
+    event_unregister(event2);
+    EXPECT_THAT(event_get(&game2, "evt"), IsNull());
+    EXPECT_THAT(event_get(&game1, "evt"), Eq(event1));
+
+    event_system_destroy(&game1);
+    event_system_destroy(&game2);
+}
+
+TEST(NAME, get_hashed)
+{
+    game_t game;
+    struct string_map_key_t evt1, evt2;
+    ASSERT_THAT(event_system_create(&game, NULL), Ne(0));
+
+    event_t* event = event_register(&game, "evt1");
+    string_map_key_init(&evt1, "evt1");
+    string_map_key_init(&evt2, "evt2");
+    EXPECT_THAT(event_get_hashed(&game, &evt1), Eq(event));
+    EXPECT_THAT(event_get_hashed(&game, &evt2), IsNull());
+
+    event_unregister(event);
+    EXPECT_THAT(event_get_hashed(&game, &evt1), IsNull());
+
+    event_system_destroy(&game);
+}
+
 static unsigned g_counter1 = 0;
 static void listener1(event_t* event, void* data)
 {
@@ -53,7 +98,7 @@ static void listener2(event_t* event, void* data)
 TEST(NAME, register_and_unregister_listeners)
 {
     game_t game;
-    ASSERT_THAT(event_system_create(&game), Ne(0));
+    ASSERT_THAT(event_system_create(&game, NULL), Ne(0));
 
     event_t* event = event_register(&game, "event");
     ASSERT_THAT(event, NotNull());
@@ -70,7 +115,7 @@ TEST(NAME, register_and_unregister_listeners)
 TEST(NAME, fire_to_multiple_listeners)
 {
     game_t game;
-    ASSERT_THAT(event_system_create(&game), Ne(0));
+    ASSERT_THAT(event_system_create(&game, NULL), Ne(0));
 
     event_t* event = event_register(&game, "event");
     ASSERT_THAT(event, NotNull());
@@ -95,7 +140,7 @@ TEST(NAME, fire_to_multiple_listeners)
 TEST(NAME, unregister_all_listeners)
 {
     game_t game;
-    ASSERT_THAT(event_system_create(&game), Ne(0));
+    ASSERT_THAT(event_system_create(&game, NULL), Ne(0));
 
     event_t* event = event_register(&game, "event");
     ASSERT_THAT(event, NotNull());
@@ -115,7 +160,7 @@ TEST(NAME, unregister_all_listeners)
 TEST(NAME, cleanup)
 {
     game_t game;
-    ASSERT_THAT(event_system_create(&game), Ne(0));
+    ASSERT_THAT(event_system_create(&game, NULL), Ne(0));
 
     event_t* event = event_register(&game, "event");
     ASSERT_THAT(event, NotNull());
@@ -125,3 +170,37 @@ TEST(NAME, cleanup)
 
     event_system_destroy(&game);
 }
+
+static unsigned g_counter_many = 0;
+static void listener_many1(event_t* event, void* data) { g_counter_many += 1; }
+static void listener_many2(event_t* event, void* data) { g_counter_many += 10; }
+static void listener_many3(event_t* event, void* data) { g_counter_many += 100; }
+static void listener_many4(event_t* event, void* data) { g_counter_many += 1000; }
+static void listener_many5(event_t* event, void* data) { g_counter_many += 10000; }
+TEST(NAME, more_listeners_than_fit_inline)
+{
+    game_t game;
+    ASSERT_THAT(event_system_create(&game, NULL), Ne(0));
+
+    event_t* event = event_register(&game, "event");
+    ASSERT_THAT(event, NotNull());
+
+    event_register_listener(event, listener_many1);
+    event_register_listener(event, listener_many2);
+    event_register_listener(event, listener_many3);
+    event_register_listener(event, listener_many4);
+    EXPECT_THAT(event->listeners.data, Eq((DATA_POINTER_TYPE*)event->listeners_inline));
+    event_register_listener(event, listener_many5);
+    EXPECT_THAT(event->listeners.data, Ne((DATA_POINTER_TYPE*)event->listeners_inline));
+
+    g_counter_many = 0;
+    event_fire(event, NULL);
+    EXPECT_THAT(g_counter_many, Eq(11111u));
+
+    event_unregister_listener(event, listener_many3);
+    g_counter_many = 0;
+    event_fire(event, NULL);
+    EXPECT_THAT(g_counter_many, Eq(11011u));
+
+    event_system_destroy(&game);
+}
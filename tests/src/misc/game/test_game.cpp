@@ -0,0 +1,149 @@
+#include "gmock/gmock.h"
+#include "game/event.h"
+#include "game/game.h"
+#include "util/memory.h"
+#include "util/ptree.h"
+#include "util/yaml.h"
+
+#define NAME game
+
+using namespace testing;
+
+TEST(NAME, create_headless_has_no_renderer)
+{
+    struct game_t* game = game_create_headless("test", NULL);
+    ASSERT_THAT(game, NotNull());
+    EXPECT_THAT(game->renderer, IsNull());
+    EXPECT_THAT(game->name, StrEq("test"));
+    EXPECT_THAT(game->config, IsNull());
+    EXPECT_THAT(game_tick_count(game), Eq(0u));
+    game_destroy(game);
+}
+
+TEST(NAME, create_headless_shares_config)
+{
+    struct ptree_t* config = yaml_create();
+    struct game_t* game1;
+    struct game_t* game2;
+    ASSERT_THAT(config, NotNull());
+    ASSERT_THAT(yaml_set_value(config, "server.tick_rate", "30"), NotNull());
+
+    game1 = game_create_headless("game1", config);
+    game2 = game_create_headless("game2", config);
+    ASSERT_THAT(game1, NotNull());
+    ASSERT_THAT(game2, NotNull());
+    EXPECT_THAT(game1->config, Eq(config));
+    EXPECT_THAT(game2->config, Eq(config));
+    EXPECT_THAT(string_map_allocator(&game1->events), Eq(&game1->arena.allocator));
+    EXPECT_THAT(string_map_allocator(&game2->events), Eq(&game2->arena.allocator));
+    EXPECT_THAT(task_graph_allocator(&game1->tick_graph), Eq(&game1->arena.allocator));
+    EXPECT_THAT(task_graph_allocator(&game2->tick_graph), Eq(&game2->arena.allocator));
+
+    force_malloc_fail_on();
+    game_tick(game1, NULL);
+    game_tick(game2, NULL);
+    force_malloc_fail_off();
+    EXPECT_THAT(game_tick_count(game1), Eq(1u));
+    EXPECT_THAT(game_tick_count(game2), Eq(1u));
+
+    game_destroy(game2);
+    game_destroy(game1);
+    yaml_destroy(config);
+}
+
+TEST(NAME, tick_advances_tick_count)
+{
+    struct game_t* game = game_create_headless("test", NULL);
+    ASSERT_THAT(game, NotNull());
+    game_tick(game, NULL);
+    EXPECT_THAT(game_tick_count(game), Eq(1u));
+    game_tick(game, NULL);
+    game_tick(game, NULL);
+    EXPECT_THAT(game_tick_count(game), Eq(3u));
+    game_destroy(game);
+}
+
+TEST(NAME, tick_does_not_allocate)
+{
+    struct game_t* game = game_create_headless("test", NULL);
+    ASSERT_THAT(game, NotNull());
+    force_malloc_fail_on();
+    game_tick(game, NULL);
+    force_malloc_fail_off();
+    EXPECT_THAT(game_tick_count(game), Eq(1u));
+    game_destroy(game);
+}
+
+TEST(NAME, create_headless_fails_on_each_allocation)
+{
+    struct game_t* game = NULL;
+    int i;
+
+    /*
+     * Only the game and the first block of its arena come from the global
+     * allocator. Everything else the game creates is taken from the arena.
+     */
+    for(i = 1; !game; ++i)
+    {
+        ASSERT_THAT(i, Le(3));
+        force_malloc_fail_after(i);
+        game = game_create_headless("test", NULL);
+        force_malloc_fail_off();
+    }
+    EXPECT_THAT(i, Eq(4));
+
+    game_destroy(game);
+}
+
+static void
+count_listener(struct event_t* event, void* data)
+{
+    ++*(int*)data;
+}
+
+template <int N> static void
+ignore_listener(struct event_t* event, void* data)
+{
+}
+
+static void
+count_task(void* arg)
+{
+    ++*(int*)arg;
+}
+
+static void
+other_task(void* arg)
+{
+}
+
+TEST(NAME, setting_up_and_ticking_does_not_use_global_allocator)
+{
+    struct game_t* game = game_create_headless("test", NULL);
+    struct event_t* event;
+    int fired = 0, ticked = 0;
+    ASSERT_THAT(game, NotNull());
+
+    /* the arena already has a block, which is plenty for all of this */
+    force_malloc_fail_on();
+    ASSERT_THAT(event = event_register(game, "tick"), NotNull());
+    ASSERT_THAT(event_register(game, "other"), NotNull());
+    /* more listeners than fit into the event, so the container spills */
+    ASSERT_THAT(EVENT_INLINE_LISTENERS, Le(4));
+    EXPECT_THAT(event_register_listener(event, count_listener), Ne(0));
+    EXPECT_THAT(event_register_listener(event, ignore_listener<1>), Ne(0));
+    EXPECT_THAT(event_register_listener(event, ignore_listener<2>), Ne(0));
+    EXPECT_THAT(event_register_listener(event, ignore_listener<3>), Ne(0));
+    EXPECT_THAT(event_register_listener(event, ignore_listener<4>), Ne(0));
+    EXPECT_THAT(task_graph_add(&game->tick_graph, "count", count_task, &ticked, 0, 1), Ne(0));
+    EXPECT_THAT(task_graph_add(&game->tick_graph, "other", other_task, NULL, 1, 0), Ne(0));
+    EXPECT_THAT(task_graph_build(&game->tick_graph), Ne(0));
+    game_tick(game, NULL);
+    event_fire(event, &fired);
+    event_unregister(event_get(game, "other"));
+    force_malloc_fail_off();
+
+    EXPECT_THAT(ticked, Eq(1));
+    EXPECT_THAT(fired, Eq(1));
+    game_destroy(game);
+}
@@ -0,0 +1,104 @@
+#include "gmock/gmock.h"
+#include "game/game.h"
+#include "game/server.h"
+#include "util/memory.h"
+#include "util/ptree.h"
+#include "util/thread.h"
+#include "util/yaml.h"
+
+#define NAME server
+
+using namespace testing;
+
+TEST(NAME, create_without_config_uses_defaults)
+{
+    struct server_t* server = server_create(NULL, 3);
+    uint32_t i;
+    ASSERT_THAT(server, NotNull());
+    EXPECT_THAT(server->instance_count, Eq(3u));
+    EXPECT_THAT(server->tick_rate, Eq(60u));
+    EXPECT_THAT(server->running, Eq(0u));
+    for(i = 0; i != server->instance_count; ++i)
+    {
+        EXPECT_THAT(server->instances[i].game, NotNull());
+        EXPECT_THAT(server->instances[i].game->renderer, IsNull());
+    }
+    server_destroy(server);
+}
+
+TEST(NAME, create_reads_shared_config)
+{
+    struct ptree_t* config = yaml_create();
+    struct server_t* server;
+    uint32_t i;
+    ASSERT_THAT(config, NotNull());
+    ASSERT_THAT(yaml_set_value(config, "server.instances", "2"), NotNull());
+    ASSERT_THAT(yaml_set_value(config, "server.tick_rate", "100"), NotNull());
+
+    server = server_create(config, 0);
+    ASSERT_THAT(server, NotNull());
+    EXPECT_THAT(server->instance_count, Eq(2u));
+    EXPECT_THAT(server->tick_rate, Eq(100u));
+    for(i = 0; i != server->instance_count; ++i)
+        EXPECT_THAT(server->instances[i].game->config, Eq(config));
+    server_destroy(server);
+
+    /* an explicit instance count overrides the config */
+    server = server_create(config, 5);
+    ASSERT_THAT(server, NotNull());
+    EXPECT_THAT(server->instance_count, Eq(5u));
+    server_destroy(server);
+
+    yaml_destroy(config);
+}
+
+TEST(NAME, start_stop_ticks_every_instance)
+{
+    struct ptree_t* config = yaml_create();
+    struct server_t* server;
+    uint32_t i;
+    ASSERT_THAT(config, NotNull());
+    ASSERT_THAT(yaml_set_value(config, "server.tick_rate", "1000"), NotNull());
+
+    server = server_create(config, 4);
+    ASSERT_THAT(server, NotNull());
+    ASSERT_THAT(server_start(server), Eq(1));
+
+    /* wait for every game to tick a few times */
+    for(i = 0; i != server->instance_count; ++i)
+        while(game_tick_count(server->instances[i].game) < 3)
+            thread_sleep(1);
+
+    server_stop(server);
+    EXPECT_THAT(server->running, Eq(0u));
+
+    /* nothing ticks once the server has stopped */
+    for(i = 0; i != server->instance_count; ++i)
+    {
+        uint32_t tick_count = game_tick_count(server->instances[i].game);
+        EXPECT_THAT(tick_count, Ge(3u));
+        thread_sleep(5);
+        EXPECT_THAT(game_tick_count(server->instances[i].game), Eq(tick_count));
+    }
+
+    /* it can be started again */
+    ASSERT_THAT(server_start(server), Eq(1));
+    server_destroy(server);
+    yaml_destroy(config);
+}
+
+TEST(NAME, create_fails_on_each_allocation)
+{
+    struct server_t* server = NULL;
+    int i;
+
+    for(i = 1; !server; ++i)
+    {
+        ASSERT_THAT(i, Le(100));
+        force_malloc_fail_after(i);
+        server = server_create(NULL, 2);
+        force_malloc_fail_off();
+    }
+
+    server_destroy(server);
+}
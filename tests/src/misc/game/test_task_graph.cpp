@@ -0,0 +1,195 @@
+#include "gmock/gmock.h"
+#include "game/task_graph.h"
+#include "util/atomic.h"
+#include "util/memory.h"
+#include "util/thread.h"
+
+#define NAME task_graph
+
+using namespace testing;
+
+#define RES_A (1u << 0)
+#define RES_B (1u << 1)
+#define RES_C (1u << 2)
+
+#define MAX_TASKS 8
+
+struct record_t
+{
+    volatile uint32_t next;
+    uint32_t order[MAX_TASKS];
+};
+
+struct task_arg_t
+{
+    struct record_t* record;
+    uint32_t id;
+};
+
+static void
+record_task(void* arg)
+{
+    struct task_arg_t* task = (struct task_arg_t*)arg;
+    task->record->order[task->id] = ATOMIC_FETCH_ADD(&task->record->next, 1);
+}
+
+/* every test runs the graph serially, and on a thread pool if there is one */
+class NAME : public Test
+{
+public:
+    virtual void SetUp()
+    {
+        pools[0] = NULL;
+        pool_count = 1;
+#ifdef ENABLE_THREAD_POOL
+        pools[pool_count++] = thread_pool_create(4);
+#endif
+        task_graph_init(&graph);
+        record.next = 0;
+        for(uint32_t i = 0; i != MAX_TASKS; ++i)
+        {
+            args[i].record = &record;
+            args[i].id = i;
+        }
+    }
+
+    virtual void TearDown()
+    {
+        task_graph_clear_free(&graph);
+#ifdef ENABLE_THREAD_POOL
+        thread_pool_destroy(pools[1]);
+#endif
+    }
+
+    struct thread_pool_t* pools[2];
+    int pool_count;
+    struct task_graph_t graph;
+    struct record_t record;
+    struct task_arg_t args[MAX_TASKS];
+};
+
+TEST_F(NAME, empty_graph_runs)
+{
+    int p;
+    ASSERT_THAT(task_graph_build(&graph), Eq(1));
+    for(p = 0; p != pool_count; ++p)
+        task_graph_run(&graph, pools[p]);
+    EXPECT_THAT(record.next, Eq(0u));
+}
+
+TEST_F(NAME, every_task_runs_once_per_tick)
+{
+    int tick, p;
+
+    task_graph_add(&graph, "a", record_task, &args[0], 0, RES_A);
+    task_graph_add(&graph, "b", record_task, &args[1], 0, RES_B);
+    task_graph_add(&graph, "c", record_task, &args[2], RES_A | RES_B, RES_C);
+    ASSERT_THAT(task_graph_task_count(&graph), Eq(3u));
+    ASSERT_THAT(task_graph_build(&graph), Eq(1));
+
+    for(tick = 0; tick != 200; ++tick)
+    {
+        record.next = 0;
+        p = tick % pool_count;
+        task_graph_run(&graph, pools[p]);
+        ASSERT_THAT(record.next, Eq(3u));
+        ASSERT_THAT(record.order[2], Eq(2u));
+    }
+}
+
+TEST_F(NAME, conflicting_tasks_keep_the_order_they_were_added_in)
+{
+    int tick, p;
+
+    /* read after write, write after read and write after write */
+    task_graph_add(&graph, "write a", record_task, &args[0], 0, RES_A);
+    task_graph_add(&graph, "read a", record_task, &args[1], RES_A, 0);
+    task_graph_add(&graph, "read a again", record_task, &args[2], RES_A, 0);
+    task_graph_add(&graph, "write a again", record_task, &args[3], 0, RES_A);
+    task_graph_add(&graph, "write a last", record_task, &args[4], 0, RES_A);
+    ASSERT_THAT(task_graph_build(&graph), Eq(1));
+
+    for(tick = 0; tick != 200; ++tick)
+    {
+        record.next = 0;
+        p = tick % pool_count;
+        task_graph_run(&graph, pools[p]);
+        ASSERT_THAT(record.order[0], Eq(0u));
+        ASSERT_THAT(record.order[1], AllOf(Ge(1u), Le(2u)));
+        ASSERT_THAT(record.order[2], AllOf(Ge(1u), Le(2u)));
+        ASSERT_THAT(record.order[3], Eq(3u));
+        ASSERT_THAT(record.order[4], Eq(4u));
+    }
+}
+
+TEST_F(NAME, run_does_not_allocate)
+{
+    task_graph_add(&graph, "a", record_task, &args[0], 0, RES_A);
+    task_graph_add(&graph, "b", record_task, &args[1], RES_A, RES_B);
+    task_graph_add(&graph, "c", record_task, &args[2], RES_A, RES_C);
+    int p;
+    ASSERT_THAT(task_graph_build(&graph), Eq(1));
+
+    for(p = 0; p != pool_count; ++p)
+    {
+        record.next = 0;
+        force_malloc_fail_on();
+        task_graph_run(&graph, pools[p]);
+        force_malloc_fail_off();
+        EXPECT_THAT(record.next, Eq(3u));
+    }
+}
+
+/* running without building again is covered by the death tests */
+TEST_F(NAME, building_again_after_adding_a_task_includes_it)
+{
+    task_graph_add(&graph, "a", record_task, &args[0], 0, RES_A);
+    ASSERT_THAT(task_graph_build(&graph), Eq(1));
+    task_graph_add(&graph, "b", record_task, &args[1], RES_A, 0);
+    ASSERT_THAT(task_graph_build(&graph), Eq(1));
+    task_graph_run(&graph, pools[pool_count - 1]);
+    EXPECT_THAT(record.order[0], Eq(0u));
+    EXPECT_THAT(record.order[1], Eq(1u));
+}
+
+/* ------------------------------------------------------------------------- */
+#ifdef ENABLE_THREAD_POOL
+struct rendezvous_t
+{
+    volatile uint32_t arrived;
+    volatile uint32_t met;
+};
+
+/* only returns early if the other task is running at the same time */
+static void
+wait_for_other(void* arg)
+{
+    struct rendezvous_t* r = (struct rendezvous_t*)arg;
+    int i;
+
+    ATOMIC_FETCH_ADD(&r->arrived, 1);
+    for(i = 0; i != 100000; ++i)
+    {
+        if(ATOMIC_LOAD_ACQUIRE(&r->arrived) == 2)
+        {
+            ATOMIC_FETCH_ADD(&r->met, 1);
+            return;
+        }
+        thread_yield();
+    }
+}
+
+TEST_F(NAME, independent_tasks_run_concurrently)
+{
+    struct rendezvous_t r;
+
+    r.arrived = 0;
+    r.met = 0;
+    task_graph_add(&graph, "spawn pellets", wait_for_other, &r, RES_A, RES_B);
+    task_graph_add(&graph, "move snakes", wait_for_other, &r, RES_A, RES_C);
+    ASSERT_THAT(task_graph_build(&graph), Eq(1));
+
+    task_graph_run(&graph, pools[1]);
+    EXPECT_THAT(r.met, Eq(2u));
+}
+#endif
@@ -0,0 +1,231 @@
+#include "gmock/gmock.h"
+#include "util/arena.h"
+#include "util/allocator.h"
+#include "util/ordered_vector.h"
+#include "util/unordered_vector.h"
+#include "util/bst_vector.h"
+#include "util/bst_hashed_vector.h"
+#include "util/linked_list.h"
+#include "util/ptree.h"
+#include "util/memory.h"
+
+#define NAME arena
+
+using namespace testing;
+
+struct counting_allocator_t
+{
+    struct allocator_t allocator;
+    int allocations;
+    int deallocations;
+};
+
+static void* counting_allocate(void* user_data, uintptr_t size)
+{
+    ((counting_allocator_t*)user_data)->allocations++;
+    return MALLOC(size, "counting_allocate()");
+}
+
+static void counting_deallocate(void* user_data, void* ptr)
+{
+    ((counting_allocator_t*)user_data)->deallocations++;
+    FREE(ptr);
+}
+
+static void counting_allocator_init(counting_allocator_t* c)
+{
+    c->allocator.allocate = counting_allocate;
+    c->allocator.reallocate = NULL;
+    c->allocator.deallocate = counting_deallocate;
+    c->allocator.user_data = c;
+    c->allocations = 0;
+    c->deallocations = 0;
+}
+
+TEST(NAME, alloc_returns_aligned_distinct_memory)
+{
+    struct arena_t* arena = arena_create(64);
+    char* a = (char*)arena_alloc(arena, 3);
+    char* b = (char*)arena_alloc(arena, 5);
+    ASSERT_THAT(a, NotNull());
+    ASSERT_THAT(b, NotNull());
+    EXPECT_THAT(a, Ne(b));
+    EXPECT_THAT((uintptr_t)a % 16, Eq(0u));
+    EXPECT_THAT((uintptr_t)b % 16, Eq(0u));
+    arena_destroy(arena);
+}
+
+TEST(NAME, alloc_larger_than_block_size)
+{
+    struct arena_t* arena = arena_create(32);
+    char* a = (char*)arena_alloc(arena, 8);
+    char* big = (char*)arena_alloc(arena, 1000);
+    char* b = (char*)arena_alloc(arena, 8);
+    ASSERT_THAT(big, NotNull());
+    memset(big, 0xAA, 1000);
+    /* small allocations continue in the existing block */
+    EXPECT_THAT(b, Eq(a + 16));
+    arena_destroy(arena);
+}
+
+TEST(NAME, clear_reuses_memory)
+{
+    struct arena_t* arena = arena_create(64);
+    arena_alloc(arena, 16);
+    arena_alloc(arena, 64);
+    void* a = arena_alloc(arena, 16);
+    arena_clear(arena);
+    /* the most recent block is kept and handed out from the start again */
+    EXPECT_THAT(arena_alloc(arena, 16), Eq(a));
+    arena_clear_free(arena);
+    EXPECT_THAT(arena->blocks, IsNull());
+    arena_destroy(arena);
+}
+
+TEST(NAME, alloc_unaligned_packs_tightly)
+{
+    struct arena_t* arena = arena_create(64);
+    char* a = (char*)arena_alloc_unaligned(arena, 3);
+    char* b = (char*)arena_alloc_unaligned(arena, 5);
+    char* c = (char*)arena_alloc(arena, 4);
+    EXPECT_THAT(b, Eq(a + 3));
+    /* aligned allocations are still aligned after unaligned ones */
+    EXPECT_THAT((uintptr_t)c % 16, Eq(0u));
+    EXPECT_THAT(c, Eq(a + 16));
+    arena_destroy(arena);
+}
+
+TEST(NAME, ordered_vector_uses_allocator)
+{
+    counting_allocator_t c;
+    struct ordered_vector_t vec;
+    counting_allocator_init(&c);
+    ordered_vector_init_with_allocator(&vec, sizeof(int), &c.allocator);
+    for(int i = 0; i != 10; ++i)
+        *(int*)ordered_vector_push_emplace(&vec) = i;
+    EXPECT_THAT(c.allocations, Gt(0));
+    ordered_vector_clear_free(&vec);
+    EXPECT_THAT(c.deallocations, Eq(c.allocations));
+    EXPECT_THAT(vec.allocator, Eq(&c.allocator));
+}
+
+TEST(NAME, unordered_vector_uses_allocator)
+{
+    counting_allocator_t c;
+    struct unordered_vector_t vec;
+    counting_allocator_init(&c);
+    unordered_vector_init_with_allocator(&vec, sizeof(int), &c.allocator);
+    for(int i = 0; i != 10; ++i)
+        *(int*)unordered_vector_push_emplace(&vec) = i;
+    EXPECT_THAT(c.allocations, Gt(0));
+    unordered_vector_clear_free(&vec);
+    EXPECT_THAT(c.deallocations, Eq(c.allocations));
+}
+
+TEST(NAME, unordered_vector_inline_spills_into_allocator)
+{
+    counting_allocator_t c;
+    struct unordered_vector_t vec;
+    int buffer[2];
+    counting_allocator_init(&c);
+    unordered_vector_init_inline_with_allocator(&vec, sizeof(int), buffer, 2, &c.allocator);
+    *(int*)unordered_vector_push_emplace(&vec) = 0;
+    *(int*)unordered_vector_push_emplace(&vec) = 1;
+    EXPECT_THAT(c.allocations, Eq(0));
+    *(int*)unordered_vector_push_emplace(&vec) = 2;
+    EXPECT_THAT(c.allocations, Gt(0));
+    unordered_vector_clear_free(&vec);
+    EXPECT_THAT(c.deallocations, Eq(c.allocations));
+}
+
+TEST(NAME, bstv_uses_allocator)
+{
+    counting_allocator_t c;
+    struct bstv_t bstv;
+    int a = 1;
+    counting_allocator_init(&c);
+    bstv_init_with_allocator(&bstv, &c.allocator);
+    bstv_insert(&bstv, 3, &a);
+    bstv_insert(&bstv, 7, &a);
+    EXPECT_THAT(c.allocations, Gt(0));
+    bstv_clear_free(&bstv);
+    EXPECT_THAT(c.deallocations, Eq(c.allocations));
+}
+
+TEST(NAME, bsthv_allocates_keys_and_chains_with_allocator)
+{
+    counting_allocator_t c;
+    struct bsthv_t bsthv;
+    int a = 1;
+    counting_allocator_init(&c);
+    bsthv_init_with_allocator(&bsthv, &c.allocator);
+    bsthv_insert(&bsthv, "one", &a);
+    bsthv_insert(&bsthv, "two", &a);
+    /* one allocation each for the hashes and chains plus one for each key */
+    EXPECT_THAT(c.allocations, Eq(4));
+    bsthv_erase(&bsthv, "one");
+    EXPECT_THAT(c.deallocations, Eq(1));
+    bsthv_clear_free(&bsthv);
+    EXPECT_THAT(c.deallocations, Eq(c.allocations));
+}
+
+TEST(NAME, list_uses_allocator)
+{
+    counting_allocator_t c;
+    struct list_t list;
+    int a = 1;
+    counting_allocator_init(&c);
+    list_init_with_allocator(&list, &c.allocator);
+    list_push(&list, &a);
+    list_push(&list, &a);
+    list_push(&list, &a);
+    EXPECT_THAT(c.allocations, Eq(3));
+    list_pop(&list);
+    EXPECT_THAT(c.deallocations, Eq(0)); /* the node is kept in the pool */
+    list_clear(&list);
+    EXPECT_THAT(c.deallocations, Eq(3));
+}
+
+TEST(NAME, ptree_nodes_use_allocator)
+{
+    counting_allocator_t c;
+    struct ptree_t* tree;
+    counting_allocator_init(&c);
+    tree = ptree_create_with_allocator(NULL, &c.allocator);
+    ASSERT_THAT(tree, NotNull());
+    ASSERT_THAT(ptree_set(tree, "a.b.c", NULL), NotNull());
+    ASSERT_THAT(ptree_set(tree, "a.d", NULL), NotNull());
+    EXPECT_THAT(string_map_allocator(&ptree_get_node(tree, "a.b")->children), Eq(&c.allocator));
+    ptree_destroy(tree);
+    EXPECT_THAT(c.allocations, Gt(1));
+    EXPECT_THAT(c.deallocations, Eq(c.allocations));
+}
+
+TEST(NAME, ptree_duplicate_into_node_uses_target_allocator)
+{
+    counting_allocator_t c;
+    struct ptree_t* source = ptree_create(NULL);
+    struct ptree_t* target;
+    counting_allocator_init(&c);
+    target = ptree_create_with_allocator(NULL, &c.allocator);
+    ptree_set(source, "a.b", NULL);
+    ASSERT_THAT(ptree_duplicate_children_into_existing_node(target, source), Ne(0));
+    EXPECT_THAT(ptree_get_node(target, "a.b"), NotNull());
+    EXPECT_THAT(string_map_allocator(&ptree_get_node(target, "a.b")->children), Eq(&c.allocator));
+    ptree_destroy(source);
+    ptree_destroy(target);
+    EXPECT_THAT(c.deallocations, Eq(c.allocations));
+}
+
+TEST(NAME, ptree_in_arena)
+{
+    struct arena_t arena;
+    struct ptree_t tree;
+    arena_init(&arena, 1024);
+    ptree_init_with_allocator(&tree, NULL, &arena.allocator);
+    ASSERT_THAT(ptree_set(&tree, "config.graphics.width", NULL), NotNull());
+    ASSERT_THAT(ptree_set(&tree, "config.graphics.height", NULL), NotNull());
+    EXPECT_THAT(ptree_get_node(&tree, "config.graphics.height"), NotNull());
+    /* no need to destroy the tree, everything lives in the arena */
+    arena_clear_free(&arena);
+}
@@ -1,5 +1,6 @@
 #include "gmock/gmock.h"
 #include "util/bst_hashed_vector.h"
+#include "util/string_pool.h"
 
 #define NAME bst_hashed_vector
 
@@ -8,27 +9,30 @@ using namespace testing;
 TEST(NAME, init_sets_correct_values)
 {
     struct bsthv_t bsthv;
-    bsthv.vector.count = 4;
-    bsthv.vector.capacity = 56;
-    bsthv.vector.data = (DATA_POINTER_TYPE*)4783;
-    bsthv.vector.element_size = 283;
+    bsthv.chains.count = 4;
+    bsthv.chains.capacity = 56;
+    bsthv.chains.data = (DATA_POINTER_TYPE*)4783;
+    bsthv.chains.element_size = 283;
+    bsthv.hashes.count = 4;
 
     bsthv_init(&bsthv);
-    ASSERT_EQ(0, bsthv.vector.count);
-
-    ASSERT_EQ(0, bsthv.vector.capacity);
-    ASSERT_EQ(0, bsthv.vector.count);
-    ASSERT_EQ(NULL, bsthv.vector.data);
-    ASSERT_EQ(sizeof(struct bsthv_key_value_t), bsthv.vector.element_size);
+    ASSERT_EQ(0, bsthv.chains.count);
+
+    ASSERT_EQ(0, bsthv.chains.capacity);
+    ASSERT_EQ(0, bsthv.chains.count);
+    ASSERT_EQ(NULL, bsthv.chains.data);
+    ASSERT_EQ(sizeof(struct bsthv_value_chain_t), bsthv.chains.element_size);
+    ASSERT_EQ(0, bsthv.hashes.count);
+    ASSERT_EQ(sizeof(uint32_t), bsthv.hashes.element_size);
 }
 
 TEST(NAME, create_initialises_bsthv)
 {
     struct bsthv_t* bsthv = bsthv_create();
-    ASSERT_EQ(0, bsthv->vector.capacity);
-    ASSERT_EQ(0, bsthv->vector.count);
-    ASSERT_EQ(NULL, bsthv->vector.data);
-    ASSERT_EQ(sizeof(struct bsthv_key_value_t), bsthv->vector.element_size);
+    ASSERT_EQ(0, bsthv->chains.capacity);
+    ASSERT_EQ(0, bsthv->chains.count);
+    ASSERT_EQ(NULL, bsthv->chains.data);
+    ASSERT_EQ(sizeof(struct bsthv_value_chain_t), bsthv->chains.element_size);
     bsthv_destroy(bsthv);
 }
 
@@ -104,8 +108,8 @@ TEST(NAME, clear_keeps_underlying_vector)
     // this should delete all entries but keep the underlying vector
     bsthv_clear(bsthv);
 
-    ASSERT_EQ(0, bsthv->vector.count);
-    EXPECT_THAT(bsthv->vector.data, NotNull());
+    ASSERT_EQ(0, bsthv->chains.count);
+    EXPECT_THAT(bsthv->chains.data, NotNull());
 
     bsthv_destroy(bsthv);
 }
@@ -122,8 +126,8 @@ TEST(NAME, clear_free_deletes_underlying_vector)
     // this should delete all entries + free the underlying vector
     bsthv_clear_free(bsthv);
 
-    ASSERT_EQ(0, bsthv->vector.count);
-    ASSERT_EQ(NULL, bsthv->vector.data);
+    ASSERT_EQ(0, bsthv->chains.count);
+    ASSERT_EQ(NULL, bsthv->chains.data);
 
     bsthv_destroy(bsthv);
 }
@@ -442,3 +446,103 @@ TEST(NAME, erase_in_for_loop)
 
 	bsthv_destroy(bsthv);
 }
+
+TEST(NAME, hashed_functions_match_unhashed_functions)
+{
+    struct bsthv_t* bsthv = bsthv_create();
+    struct bsthv_key_t key;
+    int a = 1, b = 2;
+
+    bsthv_key_init(&key, "key");
+    EXPECT_THAT(key.len, Eq(3u));
+    EXPECT_THAT(key.hash, Eq(bsthv_hash_string("key")));
+
+    EXPECT_THAT(bsthv_insert_hashed(bsthv, &key, &a), Eq(1));
+    EXPECT_THAT(bsthv_insert_hashed(bsthv, &key, &b), Eq(0));
+    EXPECT_THAT((int*)bsthv_find(bsthv, "key"), Pointee(a));
+    EXPECT_THAT((int*)bsthv_find_hashed(bsthv, &key), Pointee(a));
+    EXPECT_THAT(bsthv_key_exists_hashed(bsthv, &key), Eq(1));
+
+    bsthv_key_init(&key, "other");
+    EXPECT_THAT(bsthv_find_hashed(bsthv, &key), IsNull());
+    EXPECT_THAT(bsthv_key_exists_hashed(bsthv, &key), Eq(0));
+
+    bsthv_destroy(bsthv);
+}
+
+TEST(NAME, keys_can_be_part_of_a_longer_string)
+{
+    struct bsthv_t* bsthv = bsthv_create();
+    struct bsthv_key_t key;
+    const char* path = "first.second";
+    int a = 1, b = 2;
+
+    bsthv_key_init_n(&key, path, 5);
+    EXPECT_THAT(key.hash, Eq(bsthv_hash_string("first")));
+    EXPECT_THAT(bsthv_insert_hashed(bsthv, &key, &a), Eq(1));
+    bsthv_key_init_n(&key, path + 6, 6);
+    EXPECT_THAT(bsthv_insert_hashed(bsthv, &key, &b), Eq(1));
+
+    /* only the segment is copied */
+    EXPECT_THAT(bsthv_find_element(bsthv, &a), StrEq("first"));
+    EXPECT_THAT((int*)bsthv_find(bsthv, "first"), Pointee(a));
+    EXPECT_THAT((int*)bsthv_find(bsthv, "second"), Pointee(b));
+
+    bsthv_key_init_n(&key, path, 5);
+    EXPECT_THAT((int*)bsthv_find_hashed(bsthv, &key), Pointee(a));
+
+    bsthv_destroy(bsthv);
+}
+
+TEST(NAME, private_string_pool_stores_keys)
+{
+    struct bsthv_t* bsthv = bsthv_create();
+    int a = 1, b = 2;
+
+    ASSERT_THAT(bsthv_set_string_pool(bsthv, NULL), Eq(1));
+    ASSERT_THAT(bsthv->key_pool, NotNull());
+
+    EXPECT_THAT(bsthv_insert(bsthv, "a", &a), Eq(1));
+    EXPECT_THAT(bsthv_insert(bsthv, "b", &b), Eq(1));
+    EXPECT_THAT(string_pool_count(bsthv->key_pool), Eq(2u));
+    EXPECT_THAT(bsthv_find_element(bsthv, &a), Eq(string_pool_find_n(bsthv->key_pool, "a", 1)));
+    EXPECT_THAT((int*)bsthv_find(bsthv, "a"), Pointee(a));
+    EXPECT_THAT((int*)bsthv_erase(bsthv, "a"), Pointee(a));
+    EXPECT_THAT(bsthv_find(bsthv, "a"), IsNull());
+
+    bsthv_clear(bsthv);
+    EXPECT_THAT(bsthv->key_pool, NotNull());
+    EXPECT_THAT(string_pool_count(bsthv->key_pool), Eq(0u));
+
+    bsthv_clear_free(bsthv);
+    EXPECT_THAT(bsthv->key_pool, IsNull());
+    EXPECT_THAT(bsthv_insert(bsthv, "c", &a), Eq(1));
+
+    bsthv_destroy(bsthv);
+}
+
+TEST(NAME, shared_string_pool_dedups_keys_between_maps)
+{
+    struct string_pool_t* pool = string_pool_create();
+    struct bsthv_t* m1 = bsthv_create();
+    struct bsthv_t* m2 = bsthv_create();
+    const char* interned;
+    int a = 1, b = 2;
+
+    bsthv_set_string_pool(m1, pool);
+    bsthv_set_string_pool(m2, pool);
+    bsthv_insert(m1, "position", &a);
+    bsthv_insert(m2, "position", &b);
+
+    EXPECT_THAT(string_pool_count(pool), Eq(1u));
+    interned = string_pool_intern(pool, "position");
+    EXPECT_THAT(bsthv_find_element(m1, &a), Eq(interned));
+    EXPECT_THAT(bsthv_find_element(m2, &b), Eq(interned));
+    EXPECT_THAT((int*)bsthv_find(m2, interned), Pointee(b));
+
+    /* maps don't free a pool they don't own */
+    bsthv_destroy(m1);
+    bsthv_destroy(m2);
+    EXPECT_THAT(interned, StrEq("position"));
+    string_pool_destroy(pool);
+}
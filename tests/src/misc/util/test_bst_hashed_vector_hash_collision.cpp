@@ -29,27 +29,30 @@ public:
 TEST_F(NAME, init_sets_correct_values)
 {
     struct bsthv_t bsthv;
-    bsthv.vector.count = 4;
-    bsthv.vector.capacity = 56;
-    bsthv.vector.data = (DATA_POINTER_TYPE*)4783;
-    bsthv.vector.element_size = 283;
+    bsthv.chains.count = 4;
+    bsthv.chains.capacity = 56;
+    bsthv.chains.data = (DATA_POINTER_TYPE*)4783;
+    bsthv.chains.element_size = 283;
+    bsthv.hashes.count = 4;
 
     bsthv_init(&bsthv);
-    ASSERT_EQ(0, bsthv.vector.count);
-
-    ASSERT_EQ(0, bsthv.vector.capacity);
-    ASSERT_EQ(0, bsthv.vector.count);
-    ASSERT_EQ(NULL, bsthv.vector.data);
-    ASSERT_EQ(sizeof(struct bsthv_key_value_t), bsthv.vector.element_size);
+    ASSERT_EQ(0, bsthv.chains.count);
+
+    ASSERT_EQ(0, bsthv.chains.capacity);
+    ASSERT_EQ(0, bsthv.chains.count);
+    ASSERT_EQ(NULL, bsthv.chains.data);
+    ASSERT_EQ(sizeof(struct bsthv_value_chain_t), bsthv.chains.element_size);
+    ASSERT_EQ(0, bsthv.hashes.count);
+    ASSERT_EQ(sizeof(uint32_t), bsthv.hashes.element_size);
 }
 
 TEST_F(NAME, create_initialises_bsthv)
 {
     struct bsthv_t* bsthv = bsthv_create();
-    ASSERT_EQ(0, bsthv->vector.capacity);
-    ASSERT_EQ(0, bsthv->vector.count);
-    ASSERT_EQ(NULL, bsthv->vector.data);
-    ASSERT_EQ(sizeof(struct bsthv_key_value_t), bsthv->vector.element_size);
+    ASSERT_EQ(0, bsthv->chains.capacity);
+    ASSERT_EQ(0, bsthv->chains.count);
+    ASSERT_EQ(NULL, bsthv->chains.data);
+    ASSERT_EQ(sizeof(struct bsthv_value_chain_t), bsthv->chains.element_size);
     bsthv_destroy(bsthv);
 }
 
@@ -125,8 +128,8 @@ TEST_F(NAME, clear_keeps_underlying_vector)
     // this should delete all entries but keep the underlying vector
     bsthv_clear(bsthv);
 
-    ASSERT_EQ(0, bsthv->vector.count);
-    EXPECT_THAT(bsthv->vector.data, NotNull());
+    ASSERT_EQ(0, bsthv->chains.count);
+    EXPECT_THAT(bsthv->chains.data, NotNull());
 
     bsthv_destroy(bsthv);
 }
@@ -143,8 +146,8 @@ TEST_F(NAME, clear_free_deletes_underlying_vector)
     // this should delete all entries + free the underlying vector
     bsthv_clear_free(bsthv);
 
-    ASSERT_EQ(0, bsthv->vector.count);
-    ASSERT_EQ(NULL, bsthv->vector.data);
+    ASSERT_EQ(0, bsthv->chains.count);
+    ASSERT_EQ(NULL, bsthv->chains.data);
 
     bsthv_destroy(bsthv);
 }
@@ -463,3 +466,29 @@ TEST_F(NAME, erase_in_for_loop)
 
 	bsthv_destroy(bsthv);
 }
+
+TEST_F(NAME, hashed_lookup_of_prefixes_compares_whole_key)
+{
+    struct bsthv_t* bsthv = bsthv_create();
+    struct bsthv_key_t key;
+    const char* str = "abcd";
+    int a = 1, b = 2, c = 3;
+
+    /* all keys hash to 42 and end up in the same chain */
+    bsthv_insert(bsthv, "abc", &a);
+    bsthv_insert(bsthv, "ab", &b);
+    bsthv_insert(bsthv, "abcd", &c);
+
+    bsthv_key_init_n(&key, str, 2);
+    EXPECT_THAT((int*)bsthv_find_hashed(bsthv, &key), Pointee(b));
+    bsthv_key_init_n(&key, str, 3);
+    EXPECT_THAT((int*)bsthv_find_hashed(bsthv, &key), Pointee(a));
+    bsthv_key_init_n(&key, str, 4);
+    EXPECT_THAT((int*)bsthv_find_hashed(bsthv, &key), Pointee(c));
+    bsthv_key_init_n(&key, str, 1);
+    EXPECT_THAT(bsthv_key_exists_hashed(bsthv, &key), Eq(0));
+    EXPECT_THAT(bsthv_insert_hashed(bsthv, &key, &a), Eq(1));
+    EXPECT_THAT((int*)bsthv_find(bsthv, "a"), Pointee(a));
+
+    bsthv_destroy(bsthv);
+}
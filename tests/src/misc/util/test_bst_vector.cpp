@@ -8,27 +8,36 @@ using namespace testing;
 TEST(NAME, init_sets_correct_values)
 {
     struct bstv_t bstv;
-    bstv.vector.count = 4;
-    bstv.vector.capacity = 56;
-    bstv.vector.data = (DATA_POINTER_TYPE*)4783;
-    bstv.vector.element_size = 283;
+    bstv.hashes.count = 4;
+    bstv.hashes.capacity = 56;
+    bstv.hashes.data = (DATA_POINTER_TYPE*)4783;
+    bstv.hashes.element_size = 283;
+    bstv.values.count = 4;
+    bstv.values.capacity = 56;
+    bstv.values.data = (DATA_POINTER_TYPE*)4783;
+    bstv.values.element_size = 283;
 
     bstv_init(&bstv);
-    ASSERT_EQ(0, bstv.vector.count);
-
-    ASSERT_EQ(0, bstv.vector.capacity);
-    ASSERT_EQ(0, bstv.vector.count);
-    ASSERT_EQ(NULL, bstv.vector.data);
-    ASSERT_EQ(sizeof(struct bstv_hash_value_t), bstv.vector.element_size);
+    ASSERT_EQ(0, bstv_count(&bstv));
+
+    ASSERT_EQ(0, bstv.hashes.capacity);
+    ASSERT_EQ(0, bstv.hashes.count);
+    ASSERT_EQ(NULL, bstv.hashes.data);
+    ASSERT_EQ(sizeof(uint32_t), bstv.hashes.element_size);
+    ASSERT_EQ(0, bstv.values.capacity);
+    ASSERT_EQ(0, bstv.values.count);
+    ASSERT_EQ(NULL, bstv.values.data);
+    ASSERT_EQ(sizeof(void*), bstv.values.element_size);
 }
 
 TEST(NAME, create_initialises_bstv)
 {
     struct bstv_t* bstv = bstv_create();
-    ASSERT_EQ(0, bstv->vector.capacity);
-    ASSERT_EQ(0, bstv->vector.count);
-    ASSERT_EQ(NULL, bstv->vector.data);
-    ASSERT_EQ(sizeof(struct bstv_hash_value_t), bstv->vector.element_size);
+    ASSERT_EQ(0, bstv->hashes.capacity);
+    ASSERT_EQ(0, bstv->hashes.count);
+    ASSERT_EQ(NULL, bstv->hashes.data);
+    ASSERT_EQ(sizeof(uint32_t), bstv->hashes.element_size);
+    ASSERT_EQ(sizeof(void*), bstv->values.element_size);
     bstv_destroy(bstv);
 }
 
@@ -104,8 +113,8 @@ TEST(NAME, clear_keeps_underlying_vector)
     // this should delete all entries but keep the underlying vector
     bstv_clear(bstv);
 
-    ASSERT_EQ(0, bstv->vector.count);
-    EXPECT_THAT(bstv->vector.data, NotNull());
+    ASSERT_EQ(0, bstv->hashes.count);
+    EXPECT_THAT(bstv->hashes.data, NotNull());
 
     bstv_destroy(bstv);
 }
@@ -122,8 +131,8 @@ TEST(NAME, clear_free_deletes_underlying_vector)
     // this should delete all entries + free the underlying vector
     bstv_clear_free(bstv);
 
-    ASSERT_EQ(0, bstv->vector.count);
-    ASSERT_EQ(NULL, bstv->vector.data);
+    ASSERT_EQ(0, bstv->hashes.count);
+    ASSERT_EQ(NULL, bstv->hashes.data);
 
     bstv_destroy(bstv);
 }
@@ -510,3 +519,215 @@ TEST(NAME, erase_in_for_loop)
 
 	bstv_destroy(bstv);
 }
+
+TEST(NAME, build_from_unsorted)
+{
+    struct bstv_t* bstv = bstv_create();
+    int a=1, b=2, c=3, d=4, e=5;
+    struct bstv_hash_value_t pairs[] = {
+        {969, &e}, {243, &a}, {456, &c}, {243, &d}, {0xFFFFFFFF, &b}, {256, &b}
+    };
+
+    bstv_insert(bstv, 1000, &a);
+    ASSERT_THAT(bstv_build_from_unsorted(bstv, pairs, 6), Eq(1));
+
+    /* old contents are replaced, duplicates keep the first pair */
+    EXPECT_THAT(bstv_count(bstv), Eq(4u));
+    EXPECT_THAT(bstv_find(bstv, 1000), IsNull());
+    EXPECT_THAT((int*)bstv_find(bstv, 243), Pointee(a));
+    EXPECT_THAT((int*)bstv_find(bstv, 256), Pointee(b));
+    EXPECT_THAT((int*)bstv_find(bstv, 456), Pointee(c));
+    EXPECT_THAT((int*)bstv_find(bstv, 969), Pointee(e));
+
+    ASSERT_THAT(bstv_build_from_unsorted(bstv, NULL, 0), Eq(1));
+    EXPECT_THAT(bstv_count(bstv), Eq(0u));
+
+    bstv_destroy(bstv);
+}
+
+TEST(NAME, build_from_unsorted_matches_insert)
+{
+    struct bstv_t* inserted = bstv_create();
+    struct bstv_t* built = bstv_create();
+    struct bstv_hash_value_t pairs[500];
+    uint32_t seed = 7;
+
+    for(int i = 0; i != 500; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        pairs[i].hash = (seed >> 8) % 400;
+        pairs[i].value = &pairs[i];
+        bstv_insert(inserted, pairs[i].hash, pairs[i].value);
+    }
+    ASSERT_THAT(bstv_build_from_unsorted(built, pairs, 500), Eq(1));
+
+    ASSERT_THAT(bstv_count(built), Eq(bstv_count(inserted)));
+    BSTV_FOR_EACH(inserted, void, hash, value)
+        EXPECT_THAT(bstv_find(built, hash), Eq(value));
+    BSTV_END_EACH
+
+    bstv_destroy(built);
+    bstv_destroy(inserted);
+}
+
+TEST(NAME, read_optimised_find)
+{
+    struct bstv_t* bstv = bstv_create();
+    int values[1000];
+
+    for(int i = 0; i != 1000; ++i)
+    {
+        values[i] = i;
+        bstv_insert(bstv, i * 3 + 1, &values[i]);
+    }
+    ASSERT_THAT(bstv_optimise_for_reads(bstv), Eq(1));
+    EXPECT_THAT(bstv->eytzinger_dirty, Eq(0));
+    EXPECT_THAT((uintptr_t)bstv->eytzinger_hashes % 64, Eq(0u));
+
+    /* every size of tree, hits and misses on both sides of each hash */
+    for(int i = 0; i != 1000; ++i)
+    {
+        EXPECT_THAT((int*)bstv_find(bstv, i * 3 + 1), Pointee(i));
+        EXPECT_THAT(bstv_hash_exists(bstv, i * 3 + 1), Eq(1));
+        EXPECT_THAT(bstv_find(bstv, i * 3), IsNull());
+        EXPECT_THAT(bstv_find(bstv, i * 3 + 2), IsNull());
+    }
+    EXPECT_THAT(bstv_find(bstv, 0xFFFFFFFE), IsNull());
+    EXPECT_THAT(bstv_hash_exists(bstv, 0), Eq(0));
+
+    bstv_destroy(bstv);
+}
+
+TEST(NAME, read_optimised_all_sizes)
+{
+    struct bstv_t* bstv = bstv_create();
+    int value;
+
+    ASSERT_THAT(bstv_optimise_for_reads(bstv), Eq(1));
+    EXPECT_THAT(bstv_find(bstv, 5), IsNull());
+
+    for(uint32_t n = 1; n != 70; ++n)
+    {
+        bstv_insert(bstv, n * 2, &value);
+        for(uint32_t h = 0; h <= n * 2 + 1; ++h)
+        {
+            if(h % 2 == 0 && h != 0)
+                EXPECT_THAT(bstv_find(bstv, h), Eq(&value));
+            else
+                EXPECT_THAT(bstv_find(bstv, h), IsNull());
+        }
+    }
+
+    bstv_destroy(bstv);
+}
+
+TEST(NAME, read_optimised_rebuilds_lazily_after_mutation)
+{
+    struct bstv_t* bstv = bstv_create();
+    int a = 1, b = 2, c = 3;
+
+    bstv_insert(bstv, 10, &a);
+    bstv_insert(bstv, 20, &b);
+    bstv_optimise_for_reads(bstv);
+
+    bstv_insert(bstv, 15, &c);
+    EXPECT_THAT(bstv->eytzinger_dirty, Eq(1));
+    EXPECT_THAT((int*)bstv_find(bstv, 15), Pointee(c));
+    EXPECT_THAT(bstv->eytzinger_dirty, Eq(0));
+
+    /* changing a value patches the index */
+    bstv_set(bstv, 20, &a);
+    EXPECT_THAT(bstv->eytzinger_dirty, Eq(0));
+    EXPECT_THAT((int*)bstv_find(bstv, 20), Pointee(a));
+
+    bstv_erase(bstv, 10);
+    EXPECT_THAT(bstv_find(bstv, 10), IsNull());
+    EXPECT_THAT((int*)bstv_find(bstv, 15), Pointee(c));
+
+    BSTV_FOR_EACH(bstv, int, hash, value)
+        if(hash == 15)
+            BSTV_ERASE_CURRENT_ITEM_IN_FOR_LOOP(bstv, value);
+    BSTV_END_EACH
+    EXPECT_THAT(bstv_find(bstv, 15), IsNull());
+
+    bstv_clear(bstv);
+    EXPECT_THAT(bstv_find(bstv, 20), IsNull());
+
+    bstv_disable_read_optimisation(bstv);
+    EXPECT_THAT(bstv->eytzinger_block, IsNull());
+    bstv_insert(bstv, 30, &a);
+    EXPECT_THAT((int*)bstv_find(bstv, 30), Pointee(a));
+
+    bstv_destroy(bstv);
+}
+
+TEST(NAME, for_each_visits_hashes_in_order_with_matching_values)
+{
+    struct bstv_t* bstv = bstv_create();
+    int values[5] = {0, 1, 2, 3, 4};
+    uint32_t last_hash = 0;
+    int visited = 0;
+
+    bstv_insert(bstv, 30, &values[3]);
+    bstv_insert(bstv, 10, &values[1]);
+    bstv_insert(bstv, 40, &values[4]);
+    bstv_insert(bstv, 0, &values[0]);
+    bstv_insert(bstv, 20, &values[2]);
+
+    BSTV_FOR_EACH(bstv, int, hash, value)
+        EXPECT_THAT(hash, Ge(last_hash));
+        EXPECT_THAT(*value * 10, Eq((int)hash));
+        last_hash = hash;
+        ++visited;
+    BSTV_END_EACH
+    EXPECT_THAT(visited, Eq(5));
+
+    bstv_destroy(bstv);
+}
+
+TEST(NAME, erase_in_for_loop_keeps_hashes_and_values_in_sync)
+{
+    struct bstv_t* bstv = bstv_create();
+    int values[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    int i;
+
+    for(i = 0; i != 8; ++i)
+        bstv_insert(bstv, i, &values[i]);
+
+    BSTV_FOR_EACH(bstv, int, hash, value)
+        if(hash % 2 == 0)
+            BSTV_ERASE_CURRENT_ITEM_IN_FOR_LOOP(bstv, value);
+    BSTV_END_EACH
+
+    ASSERT_THAT(bstv_count(bstv), Eq(4u));
+    for(i = 0; i != 8; ++i)
+    {
+        if(i % 2 == 0)
+            EXPECT_THAT(bstv_find(bstv, i), IsNull());
+        else
+            EXPECT_THAT((int*)bstv_find(bstv, i), Pointee(i));
+    }
+
+    bstv_destroy(bstv);
+}
+
+TEST(NAME, find_unused_hash_returns_lowest_gap)
+{
+    struct bstv_t* bstv = bstv_create();
+    uint32_t i;
+
+    EXPECT_THAT(bstv_find_unused_hash(bstv), Eq(0u));
+    for(i = 0; i != 100; ++i)
+        if(i != 37 && i != 60)
+            bstv_insert(bstv, i, NULL);
+
+    EXPECT_THAT(bstv_find_unused_hash(bstv), Eq(37u));
+    bstv_insert(bstv, 37, NULL);
+    EXPECT_THAT(bstv_find_unused_hash(bstv), Eq(60u));
+    bstv_insert(bstv, 60, NULL);
+    EXPECT_THAT(bstv_find_unused_hash(bstv), Eq(100u));
+    bstv_erase(bstv, 0);
+    EXPECT_THAT(bstv_find_unused_hash(bstv), Eq(0u));
+
+    bstv_destroy(bstv);
+}
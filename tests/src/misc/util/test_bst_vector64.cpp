@@ -0,0 +1,222 @@
+#include "gmock/gmock.h"
+#include "util/bst_vector64.h"
+
+#define NAME bst_vector64
+
+using namespace testing;
+
+TEST(NAME, init_sets_correct_values)
+{
+    struct bstv64_t bstv;
+    bstv.vector.count = 4;
+    bstv.vector.capacity = 56;
+    bstv.vector.data = (DATA_POINTER_TYPE*)4783;
+
+    bstv64_init(&bstv);
+    EXPECT_THAT(bstv64_count(&bstv), Eq(0u));
+    EXPECT_THAT(bstv.vector.capacity, Eq(0u));
+    EXPECT_THAT(bstv.vector.data, IsNull());
+    EXPECT_THAT(bstv.vector.element_size, Eq(sizeof(struct bstv64_key_value_t)));
+}
+
+TEST(NAME, insert_and_find)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int a=56, b=45, c=18;
+
+    EXPECT_THAT(bstv64_insert(bstv, 30, &a), Eq(1));
+    EXPECT_THAT(bstv64_insert(bstv, 10, &b), Eq(1));
+    EXPECT_THAT(bstv64_insert(bstv, 20, &c), Eq(1));
+    EXPECT_THAT(bstv64_count(bstv), Eq(3u));
+
+    EXPECT_THAT(bstv64_find(bstv, 30), Eq(&a));
+    EXPECT_THAT(bstv64_find(bstv, 10), Eq(&b));
+    EXPECT_THAT(bstv64_find(bstv, 20), Eq(&c));
+    EXPECT_THAT(bstv64_find(bstv, 15), IsNull());
+    EXPECT_THAT(bstv64_find(bstv, 40), IsNull());
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, keys_differing_only_in_the_upper_32_bits_are_distinct)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int a, b, c;
+    uint64_t low = 0x12345678u;
+    uint64_t k1 = ((uint64_t)1 << 32) | low;
+    uint64_t k2 = ((uint64_t)2 << 32) | low;
+
+    EXPECT_THAT(bstv64_insert(bstv, low, &a), Eq(1));
+    EXPECT_THAT(bstv64_insert(bstv, k1, &b), Eq(1));
+    EXPECT_THAT(bstv64_insert(bstv, k2, &c), Eq(1));
+    EXPECT_THAT(bstv64_count(bstv), Eq(3u));
+
+    EXPECT_THAT(bstv64_find(bstv, low), Eq(&a));
+    EXPECT_THAT(bstv64_find(bstv, k1), Eq(&b));
+    EXPECT_THAT(bstv64_find(bstv, k2), Eq(&c));
+
+    EXPECT_THAT(bstv64_erase(bstv, k1), Eq(&b));
+    EXPECT_THAT(bstv64_find(bstv, low), Eq(&a));
+    EXPECT_THAT(bstv64_find(bstv, k2), Eq(&c));
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, pointers_can_be_used_as_keys)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int values[64];
+    int i;
+
+    for(i = 0; i != 64; ++i)
+        ASSERT_THAT(bstv64_insert(bstv, (uint64_t)(uintptr_t)&values[i], &values[i]), Eq(1));
+    for(i = 0; i != 64; ++i)
+        EXPECT_THAT(bstv64_find(bstv, (uint64_t)(uintptr_t)&values[i]), Eq(&values[i]));
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, inserting_duplicate_keys_fails)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int a, b;
+
+    EXPECT_THAT(bstv64_insert(bstv, 5, &a), Eq(1));
+    EXPECT_THAT(bstv64_insert(bstv, 5, &b), Eq(0));
+    EXPECT_THAT(bstv64_count(bstv), Eq(1u));
+    EXPECT_THAT(bstv64_find(bstv, 5), Eq(&a));
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, inserting_invalid_key_fails)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int a;
+    EXPECT_THAT(bstv64_insert(bstv, BST_VECTOR64_INVALID_KEY, &a), Eq(0));
+    EXPECT_THAT(bstv64_count(bstv), Eq(0u));
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, key_exists_with_null_value)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    EXPECT_THAT(bstv64_insert(bstv, 7, NULL), Eq(1));
+    EXPECT_THAT(bstv64_key_exists(bstv, 7), Eq(1));
+    EXPECT_THAT(bstv64_key_exists(bstv, 8), Eq(0));
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, set_replaces_existing_value_only)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int a, b;
+
+    bstv64_insert(bstv, 3, &a);
+    bstv64_set(bstv, 3, &b);
+    bstv64_set(bstv, 4, &a);
+    EXPECT_THAT(bstv64_find(bstv, 3), Eq(&b));
+    EXPECT_THAT(bstv64_key_exists(bstv, 4), Eq(0));
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, find_element_returns_key)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int a, b, c;
+    uint64_t big = (uint64_t)0xABCD << 40;
+
+    bstv64_insert(bstv, 1, &a);
+    bstv64_insert(bstv, big, &b);
+    EXPECT_THAT(bstv64_find_element(bstv, &b), Eq(big));
+    EXPECT_THAT(bstv64_find_element(bstv, &c), Eq(BST_VECTOR64_INVALID_KEY));
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, erase_missing_key_returns_null)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int a;
+
+    bstv64_insert(bstv, 1, &a);
+    EXPECT_THAT(bstv64_erase(bstv, 2), IsNull());
+    EXPECT_THAT(bstv64_erase(bstv, 1), Eq(&a));
+    EXPECT_THAT(bstv64_erase(bstv, 1), IsNull());
+    EXPECT_THAT(bstv64_count(bstv), Eq(0u));
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, for_each_iterates_in_key_order)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int values[4];
+    uint64_t keys[4];
+    int i = 0;
+
+    keys[0] = 5;
+    keys[1] = (uint64_t)1 << 33;
+    keys[2] = 1;
+    keys[3] = (uint64_t)1 << 32;
+    for(i = 0; i != 4; ++i)
+        bstv64_insert(bstv, keys[i], &values[i]);
+
+    {
+        uint64_t expected_keys[4];
+        int* expected_values[4];
+        expected_keys[0] = keys[2]; expected_values[0] = &values[2];
+        expected_keys[1] = keys[0]; expected_values[1] = &values[0];
+        expected_keys[2] = keys[3]; expected_values[2] = &values[3];
+        expected_keys[3] = keys[1]; expected_values[3] = &values[1];
+
+        i = 0;
+        BSTV64_FOR_EACH(bstv, int, key, value)
+            EXPECT_THAT(key, Eq(expected_keys[i]));
+            EXPECT_THAT(value, Eq(expected_values[i]));
+            ++i;
+        BSTV64_END_EACH
+        EXPECT_THAT(i, Eq(4));
+    }
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, erase_current_item_in_for_loop)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int values[6];
+    int i;
+
+    for(i = 0; i != 6; ++i)
+        bstv64_insert(bstv, (uint64_t)i << 32, &values[i]);
+
+    BSTV64_FOR_EACH(bstv, int, key, value)
+        if((key >> 32) % 2 == 0)
+            BSTV64_ERASE_CURRENT_ITEM_IN_FOR_LOOP(bstv, value);
+    BSTV64_END_EACH
+
+    EXPECT_THAT(bstv64_count(bstv), Eq(3u));
+    EXPECT_THAT(bstv64_find(bstv, (uint64_t)1 << 32), Eq(&values[1]));
+    EXPECT_THAT(bstv64_find(bstv, (uint64_t)3 << 32), Eq(&values[3]));
+    EXPECT_THAT(bstv64_find(bstv, (uint64_t)5 << 32), Eq(&values[5]));
+
+    bstv64_destroy(bstv);
+}
+
+TEST(NAME, clear_keeps_memory_and_clear_free_releases_it)
+{
+    struct bstv64_t* bstv = bstv64_create();
+    int a;
+
+    bstv64_insert(bstv, 1, &a);
+    bstv64_clear(bstv);
+    EXPECT_THAT(bstv64_count(bstv), Eq(0u));
+    EXPECT_THAT(bstv->vector.data, NotNull());
+
+    bstv64_clear_free(bstv);
+    EXPECT_THAT(bstv->vector.data, IsNull());
+
+    bstv64_destroy(bstv);
+}
@@ -0,0 +1,99 @@
+#include "gmock/gmock.h"
+#include "util/hash.h"
+#include <string.h>
+
+#define NAME hash
+
+using namespace testing;
+
+/* Test vectors published with the reference implementation of wyhash final
+ * version 4. The seed is the index of the vector. Between them they cover
+ * every code path: empty, 1-3 bytes, 4-16 bytes, 17-48 bytes and the 48 byte
+ * loop. */
+TEST(NAME, wyhash_matches_reference_test_vectors)
+{
+    static const struct
+    {
+        const char* key;
+        uint64_t hash;
+    } vectors[] = {
+        {"", 0x93228a4de0eec5a2ull},
+        {"a", 0xc5bac3db178713c4ull},
+        {"abc", 0xa97f2f7b1d9b3314ull},
+        {"message digest", 0x786d1f1df3801df4ull},
+        {"abcdefghijklmnopqrstuvwxyz", 0xdca5a8138ad37c87ull},
+        {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", 0xb9e734f117cfaf70ull},
+        {"12345678901234567890123456789012345678901234567890123456789012345678901234567890", 0x6cc5eab49a92d617ull}
+    };
+    uint32_t i;
+
+    for(i = 0; i != sizeof(vectors) / sizeof(*vectors); ++i)
+        EXPECT_THAT(hash_wyhash64(vectors[i].key, (uint32_t)strlen(vectors[i].key), i), Eq(vectors[i].hash))
+            << "key=\"" << vectors[i].key << "\"";
+}
+
+TEST(NAME, wyhash_does_not_depend_on_alignment)
+{
+    char buf[300 + 8];
+    char data[300];
+    uint32_t len, offset;
+    for(len = 0; len != sizeof(data); ++len)
+        data[len] = (char)(len * 13 + 1);
+
+    for(offset = 0; offset != 8; ++offset)
+    {
+        memcpy(buf + offset, data, sizeof(data));
+        for(len = 0; len <= 256; ++len)
+            ASSERT_THAT(hash_wyhash64(buf + offset, len, 0), Eq(hash_wyhash64(data, len, 0)))
+                << "offset=" << offset << " len=" << len;
+    }
+}
+
+TEST(NAME, wyhash_only_reads_len_bytes)
+{
+    char a[64], b[64];
+    uint32_t len;
+    memset(a, 'a', sizeof(a));
+    memset(b, 'a', sizeof(b));
+
+    for(len = 0; len != 63; ++len)
+    {
+        b[len] = 'b';
+        EXPECT_THAT(hash_wyhash64(a, len, 0), Eq(hash_wyhash64(b, len, 0))) << "len=" << len;
+        EXPECT_THAT(hash_wyhash64(a, len + 1, 0), Ne(hash_wyhash64(b, len + 1, 0))) << "len=" << len;
+        b[len] = 'a';
+    }
+}
+
+TEST(NAME, wyhash_different_lengths_give_different_hashes)
+{
+    char zeros[257];
+    uint32_t i, j;
+    memset(zeros, 0, sizeof(zeros));
+
+    for(i = 0; i != sizeof(zeros); ++i)
+        for(j = i + 1; j != sizeof(zeros); ++j)
+            ASSERT_THAT(hash_wyhash64(zeros, i, 0), Ne(hash_wyhash64(zeros, j, 0)));
+}
+
+TEST(NAME, wyhash_seed_changes_hash)
+{
+    EXPECT_THAT(hash_wyhash64("event", 5, 0), Ne(hash_wyhash64("event", 5, 1)));
+}
+
+TEST(NAME, wyhash32_uses_global_seed)
+{
+    uint64_t old = hash_get_seed();
+    uint32_t unseeded, seeded;
+
+    hash_set_seed(0);
+    unseeded = hash_wyhash32("event", 5);
+    hash_set_seed(0x1234567890ull);
+    EXPECT_THAT(hash_get_seed(), Eq(0x1234567890ull));
+    seeded = hash_wyhash32("event", 5);
+    EXPECT_THAT(seeded, Ne(unseeded));
+
+    hash_set_seed(0);
+    EXPECT_THAT(hash_wyhash32("event", 5), Eq(unseeded));
+    hash_set_seed(old);
+}
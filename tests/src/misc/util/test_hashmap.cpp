@@ -0,0 +1,340 @@
+#include "gmock/gmock.h"
+#include "util/hashmap.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NAME hashmap
+
+using namespace testing;
+
+TEST(NAME, init_sets_correct_values)
+{
+    struct hashmap_t map;
+    memset(&map, 0xAB, sizeof map);
+    hashmap_init(&map);
+    EXPECT_THAT(hashmap_count(&map), Eq(0u));
+    EXPECT_THAT(map.capacity, Eq(0u));
+    EXPECT_THAT(map.block, IsNull());
+    EXPECT_THAT(map.allocator, IsNull());
+}
+
+TEST(NAME, find_on_empty_map_returns_null)
+{
+    struct hashmap_t map;
+    hashmap_init(&map);
+    EXPECT_THAT(hashmap_find(&map, "a"), IsNull());
+    EXPECT_THAT(hashmap_key_exists(&map, "a"), Eq(0));
+    EXPECT_THAT(hashmap_erase(&map, "a"), IsNull());
+    EXPECT_THAT(hashmap_get_any_element(&map), IsNull());
+    hashmap_clear_free(&map);
+}
+
+TEST(NAME, insert_and_find)
+{
+    struct hashmap_t* map = hashmap_create();
+    int a = 1, b = 2, c = 3;
+
+    EXPECT_THAT(hashmap_insert(map, "a", &a), Eq(1));
+    EXPECT_THAT(hashmap_insert(map, "b", &b), Eq(1));
+    EXPECT_THAT(hashmap_insert(map, "c", &c), Eq(1));
+    EXPECT_THAT(hashmap_count(map), Eq(3u));
+
+    EXPECT_THAT((int*)hashmap_find(map, "a"), Pointee(1));
+    EXPECT_THAT((int*)hashmap_find(map, "b"), Pointee(2));
+    EXPECT_THAT((int*)hashmap_find(map, "c"), Pointee(3));
+    EXPECT_THAT(hashmap_find(map, "d"), IsNull());
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, insert_existing_key_fails)
+{
+    struct hashmap_t* map = hashmap_create();
+    int a = 1, b = 2;
+
+    EXPECT_THAT(hashmap_insert(map, "a", &a), Eq(1));
+    EXPECT_THAT(hashmap_insert(map, "a", &b), Eq(0));
+    EXPECT_THAT(hashmap_count(map), Eq(1u));
+    EXPECT_THAT((int*)hashmap_find(map, "a"), Pointee(1));
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, keys_are_copied)
+{
+    struct hashmap_t* map = hashmap_create();
+    char key[] = "key";
+    int a = 1;
+
+    hashmap_insert(map, key, &a);
+    key[0] = 'x';
+    EXPECT_THAT((int*)hashmap_find(map, "key"), Pointee(1));
+    EXPECT_THAT(hashmap_find(map, key), IsNull());
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, set_changes_existing_value)
+{
+    struct hashmap_t* map = hashmap_create();
+    int a = 1, b = 2;
+
+    hashmap_insert(map, "a", &a);
+    hashmap_set(map, "a", &b);
+    hashmap_set(map, "b", &a);
+    EXPECT_THAT((int*)hashmap_find(map, "a"), Pointee(2));
+    EXPECT_THAT(hashmap_key_exists(map, "b"), Eq(0));
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, null_values_are_allowed)
+{
+    struct hashmap_t* map = hashmap_create();
+
+    EXPECT_THAT(hashmap_insert(map, "a", NULL), Eq(1));
+    EXPECT_THAT(hashmap_key_exists(map, "a"), Eq(1));
+    EXPECT_THAT(hashmap_find(map, "a"), IsNull());
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, grows_and_keeps_all_elements)
+{
+    struct hashmap_t* map = hashmap_create();
+    static int values[5000];
+    char key[32];
+    int i;
+
+    for(i = 0; i != 5000; ++i)
+    {
+        values[i] = i;
+        sprintf(key, "key%d", i);
+        ASSERT_THAT(hashmap_insert(map, key, &values[i]), Eq(1));
+    }
+    EXPECT_THAT(hashmap_count(map), Eq(5000u));
+    EXPECT_THAT(hashmap_count(map), Le(map->capacity - map->capacity / 8));
+
+    for(i = 0; i != 5000; ++i)
+    {
+        sprintf(key, "key%d", i);
+        ASSERT_THAT((int*)hashmap_find(map, key), Pointee(i));
+    }
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, erase_returns_value_and_removes_key)
+{
+    struct hashmap_t* map = hashmap_create();
+    int a = 1, b = 2;
+
+    hashmap_insert(map, "a", &a);
+    hashmap_insert(map, "b", &b);
+    EXPECT_THAT((int*)hashmap_erase(map, "a"), Pointee(1));
+    EXPECT_THAT(hashmap_erase(map, "a"), IsNull());
+    EXPECT_THAT(hashmap_count(map), Eq(1u));
+    EXPECT_THAT(hashmap_find(map, "a"), IsNull());
+    EXPECT_THAT((int*)hashmap_find(map, "b"), Pointee(2));
+
+    /* key can be inserted again */
+    EXPECT_THAT(hashmap_insert(map, "a", &b), Eq(1));
+    EXPECT_THAT((int*)hashmap_find(map, "a"), Pointee(2));
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, repeated_insert_erase_does_not_grow_table)
+{
+    struct hashmap_t* map = hashmap_create();
+    char key[32];
+    int a = 1;
+    int i;
+    uint32_t capacity;
+
+    hashmap_insert(map, "first", &a);
+    capacity = map->capacity;
+
+    /* tombstones must be reclaimed instead of growing forever */
+    for(i = 0; i != 10000; ++i)
+    {
+        sprintf(key, "key%d", i);
+        ASSERT_THAT(hashmap_insert(map, key, &a), Eq(1));
+        ASSERT_THAT(hashmap_erase(map, key), Eq(&a));
+    }
+    EXPECT_THAT(map->capacity, Eq(capacity));
+    EXPECT_THAT(hashmap_count(map), Eq(1u));
+    EXPECT_THAT(hashmap_find(map, "first"), Eq(&a));
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, erase_with_tombstones_keeps_other_keys_reachable)
+{
+    struct hashmap_t* map = hashmap_create();
+    static int values[1000];
+    char key[32];
+    int i;
+
+    for(i = 0; i != 1000; ++i)
+    {
+        values[i] = i;
+        sprintf(key, "key%d", i);
+        hashmap_insert(map, key, &values[i]);
+    }
+    for(i = 0; i < 1000; i += 3)
+    {
+        sprintf(key, "key%d", i);
+        ASSERT_THAT((int*)hashmap_erase(map, key), Pointee(i));
+    }
+    for(i = 0; i != 1000; ++i)
+    {
+        sprintf(key, "key%d", i);
+        if(i % 3 == 0)
+            EXPECT_THAT(hashmap_find(map, key), IsNull());
+        else
+            EXPECT_THAT((int*)hashmap_find(map, key), Pointee(i));
+    }
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, find_and_erase_element)
+{
+    struct hashmap_t* map = hashmap_create();
+    int a = 1, b = 2, c = 3;
+
+    hashmap_insert(map, "a", &a);
+    hashmap_insert(map, "b", &b);
+    EXPECT_THAT(hashmap_find_element(map, &b), StrEq("b"));
+    EXPECT_THAT(hashmap_find_element(map, &c), IsNull());
+    EXPECT_THAT(hashmap_erase_element(map, &b), Eq(&b));
+    EXPECT_THAT(hashmap_erase_element(map, &b), IsNull());
+    EXPECT_THAT(hashmap_count(map), Eq(1u));
+    EXPECT_THAT(hashmap_get_any_element(map), Eq(&a));
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, for_each_visits_every_element_once)
+{
+    struct hashmap_t* map = hashmap_create();
+    int values[100];
+    int visited[100];
+    char key[32];
+    int i, count = 0;
+
+    for(i = 0; i != 100; ++i)
+    {
+        values[i] = i;
+        visited[i] = 0;
+        sprintf(key, "%d", i);
+        hashmap_insert(map, key, &values[i]);
+    }
+
+    HASHMAP_FOR_EACH(map, int, k, value)
+        EXPECT_THAT(atoi(k), Eq(*value));
+        ++visited[*value];
+        ++count;
+    HASHMAP_END_EACH
+
+    EXPECT_THAT(count, Eq(100));
+    for(i = 0; i != 100; ++i)
+        EXPECT_THAT(visited[i], Eq(1));
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, erase_in_for_loop)
+{
+    struct hashmap_t* map = hashmap_create();
+    int values[50];
+    char key[32];
+    int i;
+
+    for(i = 0; i != 50; ++i)
+    {
+        values[i] = i;
+        sprintf(key, "%d", i);
+        hashmap_insert(map, key, &values[i]);
+    }
+
+    HASHMAP_FOR_EACH(map, int, k, value)
+        if(*value % 2)
+            HASHMAP_ERASE_CURRENT_ITEM_IN_FOR_LOOP(map, k, value);
+    HASHMAP_END_EACH
+
+    EXPECT_THAT(hashmap_count(map), Eq(25u));
+    for(i = 0; i != 50; ++i)
+    {
+        sprintf(key, "%d", i);
+        EXPECT_THAT(hashmap_key_exists(map, key), Eq(i % 2 == 0));
+    }
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, clear_keeps_capacity)
+{
+    struct hashmap_t* map = hashmap_create();
+    int a = 1;
+    uint32_t capacity;
+
+    hashmap_insert(map, "a", &a);
+    hashmap_insert(map, "b", &a);
+    capacity = map->capacity;
+    hashmap_clear(map);
+    EXPECT_THAT(hashmap_count(map), Eq(0u));
+    EXPECT_THAT(map->capacity, Eq(capacity));
+    EXPECT_THAT(hashmap_find(map, "a"), IsNull());
+    EXPECT_THAT(hashmap_insert(map, "a", &a), Eq(1));
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, reserve_avoids_growing)
+{
+    struct hashmap_t* map = hashmap_create();
+    char key[32];
+    int a = 1;
+    int i;
+    void* block;
+
+    ASSERT_THAT(hashmap_reserve(map, 1000), Eq(1));
+    block = map->block;
+    for(i = 0; i != 1000; ++i)
+    {
+        sprintf(key, "%d", i);
+        hashmap_insert(map, key, &a);
+    }
+    EXPECT_THAT(map->block, Eq(block));
+
+    hashmap_destroy(map);
+}
+
+TEST(NAME, hashed_functions_with_partial_keys)
+{
+    struct hashmap_t* map = hashmap_create();
+    struct hashmap_key_t key;
+    const char* path = "abc.ab";
+    int a = 1, b = 2;
+
+    hashmap_key_init_n(&key, path, 3);
+    EXPECT_THAT(hashmap_insert_hashed(map, &key, &a), Eq(1));
+    EXPECT_THAT(hashmap_insert_hashed(map, &key, &b), Eq(0));
+    hashmap_key_init_n(&key, path + 4, 2);
+    EXPECT_THAT(hashmap_insert_hashed(map, &key, &b), Eq(1));
+
+    EXPECT_THAT(hashmap_find_element(map, &a), StrEq("abc"));
+    EXPECT_THAT((int*)hashmap_find(map, "ab"), Pointee(b));
+
+    hashmap_key_init_n(&key, path, 2);
+    EXPECT_THAT((int*)hashmap_find_hashed(map, &key), Pointee(b));
+    EXPECT_THAT(hashmap_key_exists_hashed(map, &key), Eq(1));
+    hashmap_key_init_n(&key, path, 1);
+    EXPECT_THAT(hashmap_find_hashed(map, &key), IsNull());
+    hashmap_key_init(&key, "abc");
+    EXPECT_THAT((int*)hashmap_find_hashed(map, &key), Pointee(a));
+
+    hashmap_destroy(map);
+}
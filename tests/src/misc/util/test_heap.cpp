@@ -0,0 +1,270 @@
+#include "gmock/gmock.h"
+#include "util/heap.h"
+#include <algorithm>
+#include <vector>
+
+#define NAME heap
+
+using namespace testing;
+
+/* checks the heap property and that every handle points at its node */
+static void
+expect_valid_heap(const struct heap_t* heap)
+{
+    const struct heap_node_t* nodes = (const struct heap_node_t*)heap->nodes.data;
+    const uint32_t* positions = (const uint32_t*)heap->positions.data;
+    uint32_t i;
+    for(i = 0; i != heap_count(heap); ++i)
+    {
+        if(i > 0)
+            ASSERT_THAT(nodes[(i - 1) / 4].priority, Le(nodes[i].priority)) << "index " << i;
+        ASSERT_THAT(positions[nodes[i].handle], Eq(i));
+    }
+}
+
+TEST(NAME, init)
+{
+    struct heap_t heap;
+    heap_init(&heap);
+    EXPECT_THAT(heap_count(&heap), Eq(0u));
+    EXPECT_THAT(heap_peek(&heap), IsNull());
+    EXPECT_THAT(heap_pop(&heap), IsNull());
+    EXPECT_THAT(heap_contains(&heap, 0), Eq(0));
+    heap_clear_free(&heap);
+}
+
+TEST(NAME, pops_in_priority_order)
+{
+    struct heap_t* heap = heap_create();
+    int values[7];
+    int64_t priorities[7] = {5, -3, 9, 0, 2, 100, -50};
+    int i;
+
+    for(i = 0; i != 7; ++i)
+        ASSERT_THAT(heap_push(heap, priorities[i], &values[i], NULL), Eq(1));
+    EXPECT_THAT(heap_count(heap), Eq(7u));
+    expect_valid_heap(heap);
+
+    EXPECT_THAT(heap_peek_priority(heap), Eq(-50));
+    EXPECT_THAT(heap_peek(heap), Eq(&values[6]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[6]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[1]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[3]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[4]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[0]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[2]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[5]));
+    EXPECT_THAT(heap_pop(heap), IsNull());
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, matches_sorted_order_for_many_elements)
+{
+    struct heap_t* heap = heap_create();
+    std::vector<int64_t> expected;
+    uint32_t x = 12345, i;
+
+    for(i = 0; i != 1000; ++i)
+    {
+        int64_t priority;
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        priority = (int64_t)(x % 500) - 250; /* lots of duplicates */
+        expected.push_back(priority);
+        ASSERT_THAT(heap_push(heap, priority, NULL, NULL), Eq(1));
+    }
+    expect_valid_heap(heap);
+
+    std::sort(expected.begin(), expected.end());
+    for(i = 0; i != 1000; ++i)
+    {
+        ASSERT_THAT(heap_peek_priority(heap), Eq(expected[i]));
+        heap_pop(heap);
+    }
+    EXPECT_THAT(heap_count(heap), Eq(0u));
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, handles_refer_to_their_elements)
+{
+    struct heap_t* heap = heap_create();
+    int values[50];
+    heap_handle_t handles[50];
+    int i;
+
+    for(i = 0; i != 50; ++i)
+        heap_push(heap, 50 - i, &values[i], &handles[i]);
+    for(i = 0; i != 50; ++i)
+    {
+        EXPECT_THAT(heap_contains(heap, handles[i]), Eq(1));
+        EXPECT_THAT(heap_get(heap, handles[i]), Eq(&values[i]));
+        EXPECT_THAT(heap_get_priority(heap, handles[i]), Eq(50 - i));
+    }
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, decrease_priority_moves_element_to_front)
+{
+    struct heap_t* heap = heap_create();
+    int values[20];
+    heap_handle_t handles[20];
+    int i;
+
+    for(i = 0; i != 20; ++i)
+        heap_push(heap, i * 10, &values[i], &handles[i]);
+
+    heap_decrease_priority(heap, handles[15], -1);
+    expect_valid_heap(heap);
+    EXPECT_THAT(heap_peek(heap), Eq(&values[15]));
+
+    heap_decrease_priority(heap, handles[7], 5);
+    expect_valid_heap(heap);
+    EXPECT_THAT(heap_pop(heap), Eq(&values[15]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[0]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[7]));
+    EXPECT_THAT(heap_pop(heap), Eq(&values[1]));
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, set_priority_can_increase_priority)
+{
+    struct heap_t* heap = heap_create();
+    int values[20];
+    heap_handle_t handles[20];
+    int i;
+
+    for(i = 0; i != 20; ++i)
+        heap_push(heap, i, &values[i], &handles[i]);
+
+    heap_set_priority(heap, handles[0], 1000);
+    expect_valid_heap(heap);
+    EXPECT_THAT(heap_peek(heap), Eq(&values[1]));
+    EXPECT_THAT(heap_get_priority(heap, handles[0]), Eq(1000));
+
+    for(i = 0; i != 19; ++i)
+        heap_pop(heap);
+    EXPECT_THAT(heap_pop(heap), Eq(&values[0]));
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, erase_from_the_middle)
+{
+    struct heap_t* heap = heap_create();
+    int values[30];
+    heap_handle_t handles[30];
+    int i;
+
+    for(i = 0; i != 30; ++i)
+        heap_push(heap, (i * 7) % 30, &values[i], &handles[i]);
+
+    EXPECT_THAT(heap_erase(heap, handles[12]), Eq(&values[12]));
+    EXPECT_THAT(heap_contains(heap, handles[12]), Eq(0));
+    EXPECT_THAT(heap_erase(heap, handles[0]), Eq(&values[0]));
+    EXPECT_THAT(heap_count(heap), Eq(28u));
+    expect_valid_heap(heap);
+
+    for(i = 0; i != 28; ++i)
+    {
+        void* value = heap_pop(heap);
+        EXPECT_THAT(value, Ne((void*)&values[12]));
+        EXPECT_THAT(value, Ne((void*)&values[0]));
+    }
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, handles_of_removed_elements_are_reused)
+{
+    struct heap_t* heap = heap_create();
+    int a, b, c;
+    heap_handle_t ha, hb, hc;
+
+    heap_push(heap, 1, &a, &ha);
+    heap_push(heap, 2, &b, &hb);
+    heap_pop(heap);
+    EXPECT_THAT(heap_contains(heap, ha), Eq(0));
+    EXPECT_THAT(heap_contains(heap, hb), Eq(1));
+
+    heap_push(heap, 3, &c, &hc);
+    EXPECT_THAT(hc, Eq(ha));
+    EXPECT_THAT(heap_get(heap, hc), Eq(&c));
+    EXPECT_THAT(heap->positions.count, Eq(2u));
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, build_heapifies_array)
+{
+    struct heap_t* heap = heap_create();
+    std::vector<struct heap_item_t> items;
+    std::vector<heap_handle_t> handles(500);
+    std::vector<int> values(500);
+    uint32_t i;
+
+    heap_push(heap, -1000, NULL, NULL); /* replaced by build */
+
+    for(i = 0; i != 500; ++i)
+    {
+        struct heap_item_t item;
+        item.priority = (int64_t)((i * 7919) % 500);
+        item.value = &values[i];
+        items.push_back(item);
+    }
+    ASSERT_THAT(heap_build(heap, &items[0], 500, &handles[0]), Eq(1));
+    EXPECT_THAT(heap_count(heap), Eq(500u));
+    expect_valid_heap(heap);
+
+    for(i = 0; i != 500; ++i)
+    {
+        EXPECT_THAT(heap_get(heap, handles[i]), Eq(&values[i]));
+        EXPECT_THAT(heap_get_priority(heap, handles[i]), Eq(items[i].priority));
+    }
+
+    for(i = 0; i != 500; ++i)
+    {
+        ASSERT_THAT(heap_peek_priority(heap), Eq((int64_t)i));
+        heap_pop(heap);
+    }
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, build_small_and_empty)
+{
+    struct heap_t* heap = heap_create();
+    struct heap_item_t items[2];
+    int a, b;
+
+    EXPECT_THAT(heap_build(heap, NULL, 0, NULL), Eq(1));
+    EXPECT_THAT(heap_count(heap), Eq(0u));
+
+    items[0].priority = 9; items[0].value = &a;
+    items[1].priority = 4; items[1].value = &b;
+    EXPECT_THAT(heap_build(heap, items, 1, NULL), Eq(1));
+    EXPECT_THAT(heap_peek(heap), Eq(&a));
+    EXPECT_THAT(heap_build(heap, items, 2, NULL), Eq(1));
+    EXPECT_THAT(heap_peek(heap), Eq(&b));
+
+    heap_destroy(heap);
+}
+
+TEST(NAME, clear_invalidates_handles)
+{
+    struct heap_t* heap = heap_create();
+    heap_handle_t h;
+    int a;
+
+    heap_push(heap, 1, &a, &h);
+    heap_clear(heap);
+    EXPECT_THAT(heap_count(heap), Eq(0u));
+    EXPECT_THAT(heap_contains(heap, h), Eq(0));
+
+    heap_push(heap, 1, &a, &h);
+    EXPECT_THAT(h, Eq(0u));
+
+    heap_destroy(heap);
+}
@@ -0,0 +1,156 @@
+#include "gmock/gmock.h"
+#include "util/id_allocator.h"
+#include <set>
+
+#define NAME id_allocator
+
+using namespace testing;
+
+TEST(NAME, init)
+{
+    struct id_allocator_t ids;
+    id_allocator_init(&ids);
+    EXPECT_THAT(ids.used, IsNull());
+    EXPECT_THAT(ids.full, IsNull());
+    EXPECT_THAT(ids.capacity, Eq(0u));
+    EXPECT_THAT(id_allocator_count(&ids), Eq(0u));
+    EXPECT_THAT(id_allocator_is_used(&ids, 0), Eq(0));
+    id_allocator_clear_free(&ids);
+}
+
+TEST(NAME, allocates_ascending_ids)
+{
+    struct id_allocator_t* ids = id_allocator_create();
+    uint32_t i;
+    for(i = 0; i != 5000; ++i)
+        ASSERT_THAT(id_allocator_alloc(ids), Eq(i));
+    EXPECT_THAT(id_allocator_count(ids), Eq(5000u));
+    EXPECT_THAT(id_allocator_is_used(ids, 4999), Eq(1));
+    EXPECT_THAT(id_allocator_is_used(ids, 5000), Eq(0));
+    id_allocator_destroy(ids);
+}
+
+TEST(NAME, released_ids_are_reused_lowest_first)
+{
+    struct id_allocator_t* ids = id_allocator_create();
+    uint32_t i;
+    for(i = 0; i != 3000; ++i)
+        id_allocator_alloc(ids);
+
+    EXPECT_THAT(id_allocator_release(ids, 2500), Eq(1));
+    EXPECT_THAT(id_allocator_release(ids, 40), Eq(1));
+    EXPECT_THAT(id_allocator_release(ids, 1024), Eq(1));
+    EXPECT_THAT(id_allocator_release(ids, 40), Eq(0));
+    EXPECT_THAT(id_allocator_is_used(ids, 40), Eq(0));
+    EXPECT_THAT(id_allocator_count(ids), Eq(2997u));
+
+    EXPECT_THAT(id_allocator_alloc(ids), Eq(40u));
+    EXPECT_THAT(id_allocator_alloc(ids), Eq(1024u));
+    EXPECT_THAT(id_allocator_alloc(ids), Eq(2500u));
+    EXPECT_THAT(id_allocator_alloc(ids), Eq(3000u));
+
+    id_allocator_destroy(ids);
+}
+
+TEST(NAME, release_unknown_id_returns_false)
+{
+    struct id_allocator_t* ids = id_allocator_create();
+    EXPECT_THAT(id_allocator_release(ids, 0), Eq(0));
+    EXPECT_THAT(id_allocator_release(ids, 123456), Eq(0));
+    id_allocator_alloc(ids);
+    EXPECT_THAT(id_allocator_release(ids, 1), Eq(0));
+    EXPECT_THAT(id_allocator_release(ids, 0), Eq(1));
+    id_allocator_destroy(ids);
+}
+
+TEST(NAME, reserve_skips_range)
+{
+    struct id_allocator_t* ids = id_allocator_create();
+    uint32_t i;
+
+    ASSERT_THAT(id_allocator_reserve(ids, 0, 100), Eq(1));
+    ASSERT_THAT(id_allocator_reserve(ids, 130, 2000), Eq(1));
+    EXPECT_THAT(id_allocator_count(ids), Eq(2100u));
+
+    for(i = 100; i != 130; ++i)
+        EXPECT_THAT(id_allocator_alloc(ids), Eq(i));
+    EXPECT_THAT(id_allocator_alloc(ids), Eq(2130u));
+
+    id_allocator_destroy(ids);
+}
+
+TEST(NAME, reserve_fails_if_any_id_is_taken)
+{
+    struct id_allocator_t* ids = id_allocator_create();
+    uint32_t i;
+
+    ASSERT_THAT(id_allocator_reserve(ids, 50, 1), Eq(1));
+    EXPECT_THAT(id_allocator_reserve(ids, 0, 100), Eq(0));
+    EXPECT_THAT(id_allocator_count(ids), Eq(1u));
+    for(i = 0; i != 100; ++i)
+        EXPECT_THAT(id_allocator_is_used(ids, i), Eq(i == 50));
+
+    EXPECT_THAT(id_allocator_reserve(ids, 0, 0), Eq(1));
+    EXPECT_THAT(id_allocator_reserve(ids, 0xFFFFFFF0u, 100), Eq(0));
+
+    id_allocator_destroy(ids);
+}
+
+TEST(NAME, reserve_far_away_range_grows)
+{
+    struct id_allocator_t* ids = id_allocator_create();
+    ASSERT_THAT(id_allocator_reserve(ids, 100000, 64), Eq(1));
+    EXPECT_THAT(id_allocator_is_used(ids, 99999), Eq(0));
+    EXPECT_THAT(id_allocator_is_used(ids, 100000), Eq(1));
+    EXPECT_THAT(id_allocator_is_used(ids, 100063), Eq(1));
+    EXPECT_THAT(id_allocator_is_used(ids, 100064), Eq(0));
+    EXPECT_THAT(id_allocator_alloc(ids), Eq(0u));
+    id_allocator_destroy(ids);
+}
+
+TEST(NAME, random_alloc_release_matches_reference)
+{
+    struct id_allocator_t* ids = id_allocator_create();
+    std::set<uint32_t> used;
+    uint32_t state = 1234567;
+    int i;
+
+    for(i = 0; i != 20000; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        if(state % 3 != 0 || used.empty())
+        {
+            uint32_t expected = 0;
+            while(used.count(expected))
+                ++expected;
+            ASSERT_THAT(id_allocator_alloc(ids), Eq(expected));
+            used.insert(expected);
+        }
+        else
+        {
+            std::set<uint32_t>::iterator it = used.lower_bound(state % (*used.rbegin() + 1));
+            if(it == used.end())
+                it = used.begin();
+            ASSERT_THAT(id_allocator_release(ids, *it), Eq(1));
+            used.erase(it);
+        }
+        ASSERT_THAT(id_allocator_count(ids), Eq(used.size()));
+    }
+
+    id_allocator_destroy(ids);
+}
+
+TEST(NAME, clear_releases_everything)
+{
+    struct id_allocator_t* ids = id_allocator_create();
+    uint32_t i;
+    for(i = 0; i != 2000; ++i)
+        id_allocator_alloc(ids);
+    id_allocator_clear(ids);
+    EXPECT_THAT(id_allocator_count(ids), Eq(0u));
+    EXPECT_THAT(id_allocator_is_used(ids, 5), Eq(0));
+    EXPECT_THAT(id_allocator_alloc(ids), Eq(0u));
+    id_allocator_destroy(ids);
+}
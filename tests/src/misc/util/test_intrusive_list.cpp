@@ -0,0 +1,159 @@
+#include "gmock/gmock.h"
+#include "util/intrusive_list.h"
+#include <string.h>
+
+#define NAME intrusive_list
+
+using namespace testing;
+
+struct item_t
+{
+    int value;
+    struct ilist_link_t link;
+};
+
+static int
+collect(const struct ilist_t* list, int* out)
+{
+    int n = 0;
+    ILIST_FOR_EACH(list, struct item_t, link, item)
+        out[n++] = item->value;
+    ILIST_END_EACH
+    return n;
+}
+
+TEST(NAME, zero_initialised_list_is_empty)
+{
+    struct ilist_t list;
+    memset(&list, 0, sizeof list);
+    EXPECT_THAT(ilist_count(&list), Eq(0u));
+    EXPECT_THAT(ilist_pop_front(&list), IsNull());
+    EXPECT_THAT(ilist_pop_back(&list), IsNull());
+}
+
+TEST(NAME, push_front_and_back)
+{
+    struct ilist_t list;
+    struct item_t items[4];
+    int out[4];
+    int i;
+
+    ilist_init(&list);
+    for(i = 0; i != 4; ++i)
+        items[i].value = i;
+
+    ilist_push_back(&list, &items[1].link);
+    ilist_push_back(&list, &items[2].link);
+    ilist_push_front(&list, &items[0].link);
+    ilist_push_back(&list, &items[3].link);
+
+    EXPECT_THAT(ilist_count(&list), Eq(4u));
+    ASSERT_THAT(collect(&list, out), Eq(4));
+    EXPECT_THAT(out, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(NAME, entry_returns_containing_struct)
+{
+    struct item_t item;
+    EXPECT_THAT(ILIST_ENTRY(&item.link, struct item_t, link), Eq(&item));
+}
+
+TEST(NAME, erase_front_middle_and_back)
+{
+    struct ilist_t list;
+    struct item_t items[5];
+    int out[5];
+    int i;
+
+    ilist_init(&list);
+    for(i = 0; i != 5; ++i)
+    {
+        items[i].value = i;
+        ilist_push_back(&list, &items[i].link);
+    }
+
+    ilist_erase(&list, &items[2].link);
+    ASSERT_THAT(collect(&list, out), Eq(4));
+    EXPECT_THAT(out[0], Eq(0));
+    EXPECT_THAT(out[1], Eq(1));
+    EXPECT_THAT(out[2], Eq(3));
+    EXPECT_THAT(out[3], Eq(4));
+
+    ilist_erase(&list, &items[0].link);
+    ilist_erase(&list, &items[4].link);
+    ASSERT_THAT(collect(&list, out), Eq(2));
+    EXPECT_THAT(out[0], Eq(1));
+    EXPECT_THAT(out[1], Eq(3));
+    EXPECT_THAT(list.front, Eq(&items[1].link));
+    EXPECT_THAT(list.back, Eq(&items[3].link));
+
+    ilist_erase(&list, &items[1].link);
+    ilist_erase(&list, &items[3].link);
+    EXPECT_THAT(ilist_count(&list), Eq(0u));
+    EXPECT_THAT(list.front, IsNull());
+    EXPECT_THAT(list.back, IsNull());
+}
+
+TEST(NAME, pop_front_and_back)
+{
+    struct ilist_t list;
+    struct item_t items[3];
+    int i;
+
+    ilist_init(&list);
+    for(i = 0; i != 3; ++i)
+    {
+        items[i].value = i;
+        ilist_push_back(&list, &items[i].link);
+    }
+
+    EXPECT_THAT(ilist_pop_front(&list), Eq(&items[0].link));
+    EXPECT_THAT(ilist_pop_back(&list), Eq(&items[2].link));
+    EXPECT_THAT(ilist_pop_back(&list), Eq(&items[1].link));
+    EXPECT_THAT(ilist_pop_back(&list), IsNull());
+    EXPECT_THAT(ilist_count(&list), Eq(0u));
+}
+
+TEST(NAME, erase_while_iterating)
+{
+    struct ilist_t list;
+    struct item_t items[6];
+    int out[6];
+    int i;
+
+    ilist_init(&list);
+    for(i = 0; i != 6; ++i)
+    {
+        items[i].value = i;
+        ilist_push_back(&list, &items[i].link);
+    }
+
+    ILIST_FOR_EACH(&list, struct item_t, link, item)
+        if(item->value % 2 == 0)
+            ilist_erase(&list, &item->link);
+    ILIST_END_EACH
+
+    ASSERT_THAT(collect(&list, out), Eq(3));
+    EXPECT_THAT(out[0], Eq(1));
+    EXPECT_THAT(out[1], Eq(3));
+    EXPECT_THAT(out[2], Eq(5));
+}
+
+TEST(NAME, erased_element_can_be_inserted_again)
+{
+    struct ilist_t list;
+    struct item_t a, b;
+    int out[2];
+
+    ilist_init(&list);
+    a.value = 1;
+    b.value = 2;
+    ilist_push_back(&list, &a.link);
+    ilist_push_back(&list, &b.link);
+    ilist_erase(&list, &a.link);
+    ilist_push_back(&list, &a.link);
+
+    ASSERT_THAT(collect(&list, out), Eq(2));
+    EXPECT_THAT(out[0], Eq(2));
+    EXPECT_THAT(out[1], Eq(1));
+}
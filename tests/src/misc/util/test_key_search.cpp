@@ -0,0 +1,125 @@
+#include "gmock/gmock.h"
+#include "util/key_search.h"
+#include <algorithm>
+#include <vector>
+
+using namespace testing;
+
+/* TEST_P() and INSTANTIATE_TEST_CASE_P() don't expand macros in the suite
+ * name, so it is spelled out instead of using NAME */
+
+class key_search : public TestWithParam<key_search_impl_e>
+{
+public:
+    virtual void SetUp()
+    {
+        old_impl = key_search_get_impl();
+        if(!key_search_set_impl(GetParam()))
+            supported = false;
+        else
+            supported = true;
+    }
+
+    virtual void TearDown()
+    {
+        key_search_set_impl(old_impl);
+    }
+
+    /* reference result */
+    static uint32_t lower_bound(const std::vector<uint32_t>& keys, uint32_t key)
+    {
+        return (uint32_t)(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+    }
+
+    key_search_impl_e old_impl;
+    bool supported;
+};
+
+TEST_P(key_search, empty_array_returns_zero)
+{
+    if(!supported)
+        return;
+    EXPECT_THAT(key_search_lower_bound(NULL, 0, 5), Eq(0u));
+}
+
+TEST_P(key_search, matches_std_lower_bound_for_all_sizes_around_threshold)
+{
+    uint32_t count, key;
+    if(!supported)
+        return;
+
+    for(count = 1; count <= KEY_SEARCH_LINEAR_THRESHOLD * 3; ++count)
+    {
+        std::vector<uint32_t> keys;
+        uint32_t i;
+        for(i = 0; i != count; ++i)
+            keys.push_back(i * 2 + 1); /* odd keys, so even keys are misses */
+
+        for(key = 0; key <= count * 2 + 1; ++key)
+            ASSERT_THAT(key_search_lower_bound(&keys[0], count, key), Eq(lower_bound(keys, key)))
+                << "count=" << count << " key=" << key;
+    }
+}
+
+TEST_P(key_search, unsigned_keys_above_sign_bit_are_ordered_correctly)
+{
+    std::vector<uint32_t> keys;
+    uint32_t i;
+    if(!supported)
+        return;
+
+    for(i = 0; i != 100; ++i)
+        keys.push_back(0x7FFFFFC0u + i * 0x01000000u);
+    keys.push_back(0xFFFFFFFFu);
+
+    for(i = 0; i != keys.size(); ++i)
+    {
+        EXPECT_THAT(key_search_lower_bound(&keys[0], keys.size(), keys[i]), Eq(i));
+        EXPECT_THAT(key_search_lower_bound(&keys[0], keys.size(), keys[i] - 1), Eq(i));
+    }
+    EXPECT_THAT(key_search_lower_bound(&keys[0], keys.size(), 0), Eq(0u));
+}
+
+TEST_P(key_search, duplicate_keys_return_first_occurrence)
+{
+    std::vector<uint32_t> keys(40, 7);
+    if(!supported)
+        return;
+    keys.push_back(9);
+    EXPECT_THAT(key_search_lower_bound(&keys[0], keys.size(), 7), Eq(0u));
+    EXPECT_THAT(key_search_lower_bound(&keys[0], keys.size(), 8), Eq(40u));
+    EXPECT_THAT(key_search_lower_bound(&keys[0], keys.size(), 10), Eq(41u));
+}
+
+TEST_P(key_search, unaligned_arrays_are_supported)
+{
+    std::vector<uint32_t> keys;
+    uint32_t i;
+    if(!supported)
+        return;
+
+    for(i = 0; i != 65; ++i)
+        keys.push_back(i * 3);
+    /* offset by one element so the array isn't 16/32 byte aligned */
+    for(i = 0; i != 64; ++i)
+        EXPECT_THAT(key_search_lower_bound(&keys[1], 64, keys[i + 1]), Eq(i));
+}
+
+INSTANTIATE_TEST_CASE_P(impl, key_search, Values(
+    KEY_SEARCH_AUTO, KEY_SEARCH_SCALAR, KEY_SEARCH_SSE2, KEY_SEARCH_AVX2));
+
+TEST(key_search_dispatch, set_impl_to_scalar_always_succeeds)
+{
+    key_search_impl_e old = key_search_get_impl();
+    EXPECT_THAT(key_search_set_impl(KEY_SEARCH_SCALAR), Eq(1));
+    EXPECT_THAT(key_search_get_impl(), Eq(KEY_SEARCH_SCALAR));
+    key_search_set_impl(old);
+}
+
+TEST(key_search_dispatch, auto_never_reports_auto)
+{
+    key_search_impl_e old = key_search_get_impl();
+    EXPECT_THAT(key_search_set_impl(KEY_SEARCH_AUTO), Eq(1));
+    EXPECT_THAT(key_search_get_impl(), Ne(KEY_SEARCH_AUTO));
+    key_search_set_impl(old);
+}
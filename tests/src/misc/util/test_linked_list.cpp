@@ -452,3 +452,25 @@ TEST(NAME, iterate_backwards_and_erase)
 
     list_destroy(list);
 }
+
+TEST(NAME, erased_nodes_are_reused_by_push)
+{
+    struct list_t* list = list_create();
+    struct list_node_t* a;
+    struct list_node_t* b;
+    int values[] = {3, 7};
+
+    a = list_push(list, &values[0]);
+    list_push(list, &values[1]);
+    list_erase_node(list, a);
+    EXPECT_THAT(list->free_nodes, Eq(a));
+
+    b = list_push(list, &values[0]);
+    EXPECT_THAT(b, Eq(a));
+    EXPECT_THAT(list->free_nodes, IsNull());
+    EXPECT_THAT(list->count, Eq(2));
+    EXPECT_THAT((int*)list->tail->data, Pointee(7));
+    EXPECT_THAT((int*)list->head->data, Pointee(3));
+
+    list_destroy(list);
+}
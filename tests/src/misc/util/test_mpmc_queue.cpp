@@ -0,0 +1,226 @@
+#include "gmock/gmock.h"
+#include "util/mpmc_queue.h"
+#include "util/atomic.h"
+#include "util/thread.h"
+
+#define NAME mpmc_queue
+
+using namespace testing;
+
+TEST(NAME, create_and_destroy)
+{
+    struct mpmc_queue_t* queue = mpmc_queue_create(sizeof(int), 16);
+    ASSERT_THAT(queue, NotNull());
+    EXPECT_THAT(mpmc_queue_count(queue), Eq(0u));
+    mpmc_queue_destroy(queue);
+}
+
+TEST(NAME, capacity_is_rounded_up_to_power_of_two)
+{
+    struct mpmc_queue_t queue;
+    int i;
+
+    mpmc_queue_init(&queue, sizeof(int), 5);
+    for(i = 0; i != 8; ++i)
+        ASSERT_THAT(mpmc_queue_try_enqueue(&queue, &i), Eq(1));
+    EXPECT_THAT(mpmc_queue_try_enqueue(&queue, &i), Eq(0));
+    EXPECT_THAT(mpmc_queue_count(&queue), Eq(8u));
+    mpmc_queue_clear_free(&queue);
+}
+
+TEST(NAME, capacity_is_at_least_two)
+{
+    struct mpmc_queue_t queue;
+    int i = 0;
+
+    mpmc_queue_init(&queue, sizeof(int), 0);
+    EXPECT_THAT(mpmc_queue_try_enqueue(&queue, &i), Eq(1));
+    EXPECT_THAT(mpmc_queue_try_enqueue(&queue, &i), Eq(1));
+    EXPECT_THAT(mpmc_queue_try_enqueue(&queue, &i), Eq(0));
+    mpmc_queue_clear_free(&queue);
+}
+
+TEST(NAME, try_dequeue_from_empty_fails)
+{
+    struct mpmc_queue_t queue;
+    int value = 3;
+
+    mpmc_queue_init(&queue, sizeof(int), 4);
+    EXPECT_THAT(mpmc_queue_try_dequeue(&queue, &value), Eq(0));
+    EXPECT_THAT(value, Eq(3));
+    mpmc_queue_clear_free(&queue);
+}
+
+TEST(NAME, elements_come_out_in_order_across_wraparound)
+{
+    struct mpmc_queue_t queue;
+    int i, value;
+
+    mpmc_queue_init(&queue, sizeof(int), 4);
+    for(i = 0; i != 3; ++i)
+        mpmc_queue_try_enqueue(&queue, &i);
+    for(i = 3; i != 100; ++i)
+    {
+        ASSERT_THAT(mpmc_queue_try_enqueue(&queue, &i), Eq(1));
+        ASSERT_THAT(mpmc_queue_try_dequeue(&queue, &value), Eq(1));
+        ASSERT_THAT(value, Eq(i - 3));
+    }
+    EXPECT_THAT(mpmc_queue_count(&queue), Eq(3u));
+    mpmc_queue_clear_free(&queue);
+}
+
+TEST(NAME, odd_element_sizes_are_copied_whole)
+{
+    struct mpmc_queue_t queue;
+    char in[13] = "hello world!";
+    char out[13] = {0};
+
+    mpmc_queue_init(&queue, sizeof(in), 4);
+    ASSERT_THAT(mpmc_queue_try_enqueue(&queue, in), Eq(1));
+    ASSERT_THAT(mpmc_queue_try_enqueue(&queue, "another one"), Eq(1));
+    ASSERT_THAT(mpmc_queue_try_dequeue(&queue, out), Eq(1));
+    EXPECT_THAT(out, StrEq("hello world!"));
+    ASSERT_THAT(mpmc_queue_try_dequeue(&queue, out), Eq(1));
+    EXPECT_THAT(out, StrEq("another one"));
+    mpmc_queue_clear_free(&queue);
+}
+
+TEST(NAME, closed_queue_rejects_new_elements_but_drains)
+{
+    struct mpmc_queue_t queue;
+    int value = 7;
+
+    mpmc_queue_init(&queue, sizeof(int), 4);
+    mpmc_queue_enqueue(&queue, &value);
+    mpmc_queue_close(&queue);
+
+    EXPECT_THAT(mpmc_queue_try_enqueue(&queue, &value), Eq(0));
+    EXPECT_THAT(mpmc_queue_enqueue(&queue, &value), Eq(0));
+    value = 0;
+    EXPECT_THAT(mpmc_queue_dequeue(&queue, &value), Eq(1));
+    EXPECT_THAT(value, Eq(7));
+    EXPECT_THAT(mpmc_queue_dequeue(&queue, &value), Eq(0));
+    mpmc_queue_clear_free(&queue);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+close_queue(void* arg)
+{
+    mpmc_queue_close((struct mpmc_queue_t*)arg);
+}
+
+TEST(NAME, close_wakes_blocked_consumer)
+{
+    struct mpmc_queue_t queue;
+    struct thread_t* thread;
+    int value;
+
+    mpmc_queue_init(&queue, sizeof(int), 4);
+    thread = thread_create(close_queue, &queue);
+    ASSERT_THAT(thread, NotNull());
+    EXPECT_THAT(mpmc_queue_dequeue(&queue, &value), Eq(0));
+    thread_join(thread);
+    mpmc_queue_clear_free(&queue);
+}
+
+/* ------------------------------------------------------------------------- */
+/* several producers and consumers hammering a small queue */
+
+#define PRODUCERS 4
+#define CONSUMERS 4
+#define ITEMS_PER_PRODUCER 50000
+
+struct stress_state_t
+{
+    struct mpmc_queue_t queue;
+    volatile uint32_t next_producer_id;
+    volatile uint32_t received;
+    volatile uint32_t errors;
+    volatile uint32_t checksum;
+};
+
+static void
+stress_producer(void* arg)
+{
+    struct stress_state_t* state = (struct stress_state_t*)arg;
+    uint32_t id = ATOMIC_FETCH_ADD(&state->next_producer_id, 1);
+    uint32_t i;
+
+    for(i = 0; i != ITEMS_PER_PRODUCER; ++i)
+    {
+        uint32_t value = (id << 24) | i;
+        /* mix blocking and non-blocking calls */
+        if(i & 1)
+        {
+            while(!mpmc_queue_try_enqueue(&state->queue, &value))
+                thread_yield();
+        }
+        else if(!mpmc_queue_enqueue(&state->queue, &value))
+            ATOMIC_FETCH_ADD(&state->errors, 1);
+    }
+}
+
+static void
+stress_consumer(void* arg)
+{
+    struct stress_state_t* state = (struct stress_state_t*)arg;
+    uint32_t last[PRODUCERS];
+    uint32_t value, received = 0, checksum = 0;
+    int i;
+
+    for(i = 0; i != PRODUCERS; ++i)
+        last[i] = (uint32_t)-1;
+
+    while(mpmc_queue_dequeue(&state->queue, &value))
+    {
+        uint32_t id = value >> 24, seq = value & 0xFFFFFF;
+
+        /* one consumer must see each producer's elements in order */
+        if(id >= PRODUCERS || (last[id] != (uint32_t)-1 && seq <= last[id]))
+            ATOMIC_FETCH_ADD(&state->errors, 1);
+        else
+            last[id] = seq;
+        checksum += value;
+        ++received;
+    }
+
+    ATOMIC_FETCH_ADD(&state->received, received);
+    ATOMIC_FETCH_ADD(&state->checksum, checksum);
+}
+
+TEST(NAME, stress_many_producers_and_consumers)
+{
+    struct stress_state_t state;
+    struct thread_t* producers[PRODUCERS];
+    struct thread_t* consumers[CONSUMERS];
+    uint32_t expected_checksum = 0, id, i;
+
+    ASSERT_THAT(mpmc_queue_init(&state.queue, sizeof(uint32_t), 16), Eq(1));
+    state.next_producer_id = 0;
+    state.received = 0;
+    state.errors = 0;
+    state.checksum = 0;
+
+    for(i = 0; i != CONSUMERS; ++i)
+        ASSERT_THAT((consumers[i] = thread_create(stress_consumer, &state)), NotNull());
+    for(i = 0; i != PRODUCERS; ++i)
+        ASSERT_THAT((producers[i] = thread_create(stress_producer, &state)), NotNull());
+
+    for(i = 0; i != PRODUCERS; ++i)
+        thread_join(producers[i]);
+    mpmc_queue_close(&state.queue);
+    for(i = 0; i != CONSUMERS; ++i)
+        thread_join(consumers[i]);
+
+    for(id = 0; id != PRODUCERS; ++id)
+        for(i = 0; i != ITEMS_PER_PRODUCER; ++i)
+            expected_checksum += (id << 24) | i;
+
+    EXPECT_THAT(state.errors, Eq(0u));
+    EXPECT_THAT(state.received, Eq((uint32_t)(PRODUCERS * ITEMS_PER_PRODUCER)));
+    EXPECT_THAT(state.checksum, Eq(expected_checksum));
+    EXPECT_THAT(mpmc_queue_count(&state.queue), Eq(0u));
+
+    mpmc_queue_clear_free(&state.queue);
+}
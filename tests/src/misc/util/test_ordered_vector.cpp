@@ -356,4 +356,317 @@ TEST(NAME, insert_emplacing_preserves_existing_elements)
     ASSERT_EQ(82, *(int*)ordered_vector_get_element(vec, 8));
     
     ordered_vector_destroy(vec);
-}
\ No newline at end of file
+}
+TEST(NAME, insert_range_preserves_existing_elements)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    int range[] = {1, 2, 3};
+    *(int*)ordered_vector_push_emplace(vec) = 53;
+    *(int*)ordered_vector_push_emplace(vec) = 24;
+    *(int*)ordered_vector_push_emplace(vec) = 73;
+
+    ASSERT_NE(0, ordered_vector_insert_range(vec, 1, range, 3)); // middle insertion
+    ASSERT_EQ(6, vec->count);
+    ASSERT_EQ(53, *(int*)ordered_vector_get_element(vec, 0));
+    ASSERT_EQ(1, *(int*)ordered_vector_get_element(vec, 1));
+    ASSERT_EQ(2, *(int*)ordered_vector_get_element(vec, 2));
+    ASSERT_EQ(3, *(int*)ordered_vector_get_element(vec, 3));
+    ASSERT_EQ(24, *(int*)ordered_vector_get_element(vec, 4));
+    ASSERT_EQ(73, *(int*)ordered_vector_get_element(vec, 5));
+
+    ASSERT_NE(0, ordered_vector_insert_range(vec, 0, range, 2)); // beginning insertion
+    ASSERT_NE(0, ordered_vector_insert_range(vec, 8, range + 2, 1)); // end insertion
+    ASSERT_EQ(9, vec->count);
+    ASSERT_EQ(1, *(int*)ordered_vector_get_element(vec, 0));
+    ASSERT_EQ(2, *(int*)ordered_vector_get_element(vec, 1));
+    ASSERT_EQ(53, *(int*)ordered_vector_get_element(vec, 2));
+    ASSERT_EQ(73, *(int*)ordered_vector_get_element(vec, 7));
+    ASSERT_EQ(3, *(int*)ordered_vector_get_element(vec, 8));
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, insert_range_reallocates_once_to_fit_range)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    int range[20];
+    for(int i = 0; i != 20; ++i)
+        range[i] = i;
+    *(int*)ordered_vector_push_emplace(vec) = 53;
+
+    ASSERT_NE(0, ordered_vector_insert_range(vec, 0, range, 20));
+    ASSERT_EQ(21, vec->count);
+    ASSERT_EQ(21, vec->capacity);
+    for(int i = 0; i != 20; ++i)
+        ASSERT_EQ(i, *(int*)ordered_vector_get_element(vec, i));
+    ASSERT_EQ(53, *(int*)ordered_vector_get_element(vec, 20));
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, insert_range_invalid_index_or_empty_range)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    int range[] = {1, 2};
+    ASSERT_EQ(0, ordered_vector_insert_range(vec, 1, range, 2));
+    ASSERT_NE(0, ordered_vector_insert_range(vec, 0, range, 0));
+    ASSERT_EQ(NULL, ordered_vector_insert_range_emplace(vec, 0, 0));
+    ASSERT_EQ(0, vec->count);
+    ASSERT_EQ(NULL, vec->data);
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, erase_range_preserves_existing_elements)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    for(int i = 0; i != 8; ++i)
+        *(int*)ordered_vector_push_emplace(vec) = i;
+
+    ordered_vector_erase_range(vec, 2, 5);
+    ASSERT_EQ(5, vec->count);
+    ASSERT_EQ(0, *(int*)ordered_vector_get_element(vec, 0));
+    ASSERT_EQ(1, *(int*)ordered_vector_get_element(vec, 1));
+    ASSERT_EQ(5, *(int*)ordered_vector_get_element(vec, 2));
+    ASSERT_EQ(6, *(int*)ordered_vector_get_element(vec, 3));
+    ASSERT_EQ(7, *(int*)ordered_vector_get_element(vec, 4));
+
+    ordered_vector_erase_range(vec, 3, 100); // clamped
+    ASSERT_EQ(3, vec->count);
+    ASSERT_EQ(5, *(int*)ordered_vector_get_element(vec, 2));
+
+    ordered_vector_erase_range(vec, 2, 2); // empty range
+    ordered_vector_erase_range(vec, 5, 8); // out of bounds
+    ASSERT_EQ(3, vec->count);
+
+    ordered_vector_erase_range(vec, 0, 3);
+    ASSERT_EQ(0, vec->count);
+    ordered_vector_destroy(vec);
+}
+
+static char is_odd(const void* element, void* user_data)
+{
+    ++*(int*)user_data;
+    return *(const int*)element % 2;
+}
+
+TEST(NAME, erase_if_is_stable_and_calls_predicate_once_per_element)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    int calls = 0;
+    int values[] = {1, 2, 4, 3, 5, 6, 8, 7, 10, 9};
+    for(int i = 0; i != 10; ++i)
+        *(int*)ordered_vector_push_emplace(vec) = values[i];
+
+    ASSERT_EQ(5, ordered_vector_erase_if(vec, is_odd, &calls));
+    ASSERT_EQ(10, calls);
+    ASSERT_EQ(5, vec->count);
+    ASSERT_EQ(2, *(int*)ordered_vector_get_element(vec, 0));
+    ASSERT_EQ(4, *(int*)ordered_vector_get_element(vec, 1));
+    ASSERT_EQ(6, *(int*)ordered_vector_get_element(vec, 2));
+    ASSERT_EQ(8, *(int*)ordered_vector_get_element(vec, 3));
+    ASSERT_EQ(10, *(int*)ordered_vector_get_element(vec, 4));
+
+    calls = 0;
+    ASSERT_EQ(0, ordered_vector_erase_if(vec, is_odd, &calls));
+    ASSERT_EQ(5, calls);
+    ASSERT_EQ(5, vec->count);
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, erase_if_all_and_empty)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    int calls = 0;
+    ASSERT_EQ(0, ordered_vector_erase_if(vec, is_odd, &calls));
+    ASSERT_EQ(0, calls);
+    *(int*)ordered_vector_push_emplace(vec) = 1;
+    *(int*)ordered_vector_push_emplace(vec) = 3;
+    *(int*)ordered_vector_push_emplace(vec) = 5;
+    ASSERT_EQ(3, ordered_vector_erase_if(vec, is_odd, &calls));
+    ASSERT_EQ(0, vec->count);
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, reserve)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    EXPECT_NE(0, ordered_vector_reserve(vec, 100));
+    EXPECT_EQ(100u, vec->capacity);
+    EXPECT_EQ(0u, vec->count);
+
+    void* data = vec->data;
+    for(int i = 0; i != 100; ++i)
+        *(int*)ordered_vector_push_emplace(vec) = i;
+    EXPECT_EQ(data, vec->data);
+
+    /* smaller than capacity does nothing */
+    EXPECT_NE(0, ordered_vector_reserve(vec, 10));
+    EXPECT_EQ(100u, vec->capacity);
+
+    EXPECT_NE(0, ordered_vector_reserve(vec, 200));
+    EXPECT_EQ(200u, vec->capacity);
+    for(int i = 0; i != 100; ++i)
+        EXPECT_EQ(i, *(int*)ordered_vector_get_element(vec, i));
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, shrink_to_fit)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    for(int i = 0; i != 100; ++i)
+        *(int*)ordered_vector_push_emplace(vec) = i;
+    while(vec->count > 10)
+        ordered_vector_erase_index(vec, vec->count - 1);
+
+    EXPECT_NE(0, ordered_vector_shrink_to_fit(vec));
+    EXPECT_EQ(10u, vec->capacity);
+    for(int i = 0; i != 10; ++i)
+        EXPECT_EQ(i, *(int*)ordered_vector_get_element(vec, i));
+
+    ordered_vector_clear(vec);
+    EXPECT_NE(0, ordered_vector_shrink_to_fit(vec));
+    EXPECT_EQ(0u, vec->capacity);
+    EXPECT_EQ(NULL, vec->data);
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, growth_factor)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    ordered_vector_set_growth_factor(vec, 1.5f);
+    ordered_vector_reserve(vec, 10);
+    while(vec->count < vec->capacity)
+        ordered_vector_push_emplace(vec);
+    ordered_vector_push_emplace(vec);
+    EXPECT_EQ(15u, vec->capacity);
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, inline_storage)
+{
+    struct ordered_vector_t vec;
+    int buffer[4];
+    ordered_vector_init_inline(&vec, sizeof(int), buffer, 4);
+    EXPECT_EQ((DATA_POINTER_TYPE*)buffer, vec.data);
+    EXPECT_EQ(4u, vec.capacity);
+
+    for(int i = 0; i != 4; ++i)
+        *(int*)ordered_vector_push_emplace(&vec) = i;
+    EXPECT_EQ((DATA_POINTER_TYPE*)buffer, vec.data);
+
+    /* spills to the heap */
+    *(int*)ordered_vector_push_emplace(&vec) = 4;
+    EXPECT_NE((DATA_POINTER_TYPE*)buffer, vec.data);
+    EXPECT_EQ(8u, vec.capacity);
+    for(int i = 0; i != 5; ++i)
+        EXPECT_EQ(i, *(int*)ordered_vector_get_element(&vec, i));
+
+    /* moves back into the inline buffer */
+    ordered_vector_erase_index(&vec, 4);
+    ordered_vector_erase_index(&vec, 3);
+    EXPECT_NE(0, ordered_vector_shrink_to_fit(&vec));
+    EXPECT_EQ((DATA_POINTER_TYPE*)buffer, vec.data);
+    EXPECT_EQ(4u, vec.capacity);
+    for(int i = 0; i != 3; ++i)
+        EXPECT_EQ(i, *(int*)ordered_vector_get_element(&vec, i));
+
+    /* inline buffer is never freed */
+    ordered_vector_clear_free(&vec);
+    EXPECT_EQ((DATA_POINTER_TYPE*)buffer, vec.data);
+    EXPECT_EQ(4u, vec.capacity);
+    EXPECT_EQ(0u, vec.count);
+}
+
+static int compare_ints(const void* a, const void* b)
+{
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+TEST(NAME, sort)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(int));
+    int values[] = {5, -3, 9, 0, 5, 12, -8};
+    for(int i = 0; i != 7; ++i)
+        ordered_vector_push(vec, &values[i]);
+
+    ordered_vector_sort(vec, compare_ints);
+    int expected[] = {-8, -3, 0, 5, 5, 9, 12};
+    for(int i = 0; i != 7; ++i)
+        EXPECT_EQ(expected[i], *(int*)ordered_vector_get_element(vec, i));
+
+    ordered_vector_destroy(vec);
+}
+
+struct radix_element_t
+{
+    char padding;
+    uint32_t key32;
+    uint64_t key64;
+    int order;
+};
+
+TEST(NAME, radix_sort_u32_is_stable)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(struct radix_element_t));
+    uint32_t keys[] = {0xFFFFFFFF, 3, 0x10000, 3, 0, 0x10000, 255, 256};
+    for(int i = 0; i != 8; ++i)
+    {
+        struct radix_element_t* e = (struct radix_element_t*)ordered_vector_push_emplace(vec);
+        e->key32 = keys[i];
+        e->order = i;
+    }
+
+    EXPECT_NE(0, ordered_vector_radix_sort_u32(vec, offsetof(struct radix_element_t, key32)));
+    uint32_t expected_keys[] = {0, 3, 3, 255, 256, 0x10000, 0x10000, 0xFFFFFFFF};
+    int expected_order[] = {4, 1, 3, 6, 7, 2, 5, 0};
+    for(int i = 0; i != 8; ++i)
+    {
+        struct radix_element_t* e = (struct radix_element_t*)ordered_vector_get_element(vec, i);
+        EXPECT_EQ(expected_keys[i], e->key32);
+        EXPECT_EQ(expected_order[i], e->order);
+    }
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, radix_sort_u64)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(struct radix_element_t));
+    uint32_t seed = 1;
+    for(int i = 0; i != 1000; ++i)
+    {
+        struct radix_element_t* e = (struct radix_element_t*)ordered_vector_push_emplace(vec);
+        seed = seed * 1103515245u + 12345u;
+        e->key64 = ((uint64_t)seed << 29) ^ seed;
+        e->order = i;
+    }
+
+    EXPECT_NE(0, ordered_vector_radix_sort_u64(vec, offsetof(struct radix_element_t, key64)));
+    ASSERT_EQ(1000u, vec->count);
+    for(int i = 1; i != 1000; ++i)
+    {
+        struct radix_element_t* a = (struct radix_element_t*)ordered_vector_get_element(vec, i - 1);
+        struct radix_element_t* b = (struct radix_element_t*)ordered_vector_get_element(vec, i);
+        EXPECT_LE(a->key64, b->key64);
+    }
+
+    ordered_vector_destroy(vec);
+}
+
+TEST(NAME, radix_sort_empty_and_equal_keys)
+{
+    struct ordered_vector_t* vec = ordered_vector_create(sizeof(uint32_t));
+    EXPECT_NE(0, ordered_vector_radix_sort_u32(vec, 0));
+
+    /* all passes are skipped, order is preserved */
+    for(uint32_t i = 0; i != 10; ++i)
+        *(uint32_t*)ordered_vector_push_emplace(vec) = 7;
+    EXPECT_NE(0, ordered_vector_radix_sort_u32(vec, 0));
+    EXPECT_EQ(10u, vec->count);
+
+    ordered_vector_destroy(vec);
+}
@@ -1,6 +1,8 @@
 #include "gmock/gmock.h"
 #include "util/ptree.h"
 #include "util/memory.h"
+#include <string.h>
+#include <stdio.h>
 
 #define NAME ptree
 
@@ -51,10 +53,7 @@ TEST(NAME, init)
     // init with some garbage values
     struct ptree_t tree;
     int a = 6;
-    tree.children.vector.element_size = 2935;
-    tree.children.vector.capacity = 282;
-    tree.children.vector.count = 2358;
-    tree.children.vector.data = (DATA_POINTER_TYPE*)239842;
+    memset(&tree.children, 0xAB, sizeof tree.children);
     tree.parent = (struct ptree_t*)8384;
     tree.dup_value = (ptree_dup_func)20398;
     tree.free_value = (ptree_free_func)230027;
@@ -62,10 +61,18 @@ TEST(NAME, init)
 
     ptree_init(&tree, &a);
 
-    EXPECT_THAT(tree.children.vector.element_size, Eq(sizeof(struct bsthv_key_value_t)));
-    EXPECT_THAT(tree.children.vector.capacity, Eq(0));
-    EXPECT_THAT(tree.children.vector.count, Eq(0));
-    EXPECT_THAT(tree.children.vector.data, IsNull());
+    EXPECT_THAT(string_map_count(&tree.children), Eq(0));
+#if !defined(ENABLE_OPEN_ADDRESSING_STRING_MAP)
+    EXPECT_THAT(tree.children.chains.element_size, Eq(sizeof(struct bsthv_value_chain_t)));
+    EXPECT_THAT(tree.children.chains.capacity, Eq(0));
+    EXPECT_THAT(tree.children.chains.count, Eq(0));
+    EXPECT_THAT(tree.children.chains.data, IsNull());
+    EXPECT_THAT(tree.children.hashes.element_size, Eq(sizeof(uint32_t)));
+    EXPECT_THAT(tree.children.hashes.count, Eq(0));
+#else
+    EXPECT_THAT(tree.children.capacity, Eq(0));
+    EXPECT_THAT(tree.children.block, IsNull());
+#endif
     EXPECT_THAT(tree.parent, IsNull());
     EXPECT_THAT(tree.dup_value, IsNull());
     EXPECT_THAT(tree.free_value, IsNull());
@@ -114,23 +121,23 @@ TEST(NAME, add_node_no_fill_in)
     struct ptree_t* node7 = ptree_set(tree,  "node7", &f);
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(3));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&node2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(3));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&node2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node2"), Eq(node2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node3"), Eq(node3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node2"), Eq(node2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node3"), Eq(node3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
 
     // check parents
     EXPECT_THAT(tree->parent, IsNull());
@@ -180,23 +187,23 @@ TEST(NAME, add_node_fill_in_missing_middle_nodes)
     node1->value = &b;
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(3));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&node2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(3));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&node2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node2"), Eq(node2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node3"), Eq(node3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node2"), Eq(node2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node3"), Eq(node3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
 
     // check parents
     EXPECT_THAT(tree->parent, IsNull());
@@ -246,19 +253,19 @@ TEST(NAME, clean_tree)
     ASSERT_THAT(ptree_clean(tree), Eq(2));
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(2));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(2));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(2));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(2));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node3"), Eq(node3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node3"), Eq(node3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
 
     // check parents
     EXPECT_THAT(tree->parent, IsNull());
@@ -285,7 +292,7 @@ TEST(NAME, clean_tree_middle_nodes)
     ptree_set(tree, "node1.node2.node3.node4", NULL);
     ptree_clean(tree);
 
-    EXPECT_THAT(bsthv_count(&tree->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children), Eq(0));
 
     ptree_destroy(tree);
 }
@@ -296,7 +303,7 @@ TEST(NAME, dont_allow_duplicate_keys_in_same_node)
 
     EXPECT_THAT(ptree_set(tree, "node", NULL), NotNull());
     EXPECT_THAT(ptree_set(tree, "node", NULL), IsNull());
-    EXPECT_THAT(bsthv_count(&tree->children), Eq(1));
+    EXPECT_THAT(string_map_count(&tree->children), Eq(1));
 
     ptree_destroy(tree);
 }
@@ -307,7 +314,7 @@ TEST(NAME, dont_allow_duplicate_keys_with_fill_in)
 
     EXPECT_THAT(ptree_set(tree, "node.node.node", NULL), NotNull());
     EXPECT_THAT(ptree_set(tree, "node.node.node", NULL), IsNull());
-    EXPECT_THAT(bsthv_count(&tree->children), Eq(1));
+    EXPECT_THAT(string_map_count(&tree->children), Eq(1));
 
     ptree_destroy(tree);
 }
@@ -321,7 +328,7 @@ TEST(NAME, remove_node_and_clean_up_tree)
 
     ptree_remove(tree, "node1.node2.node3.node4");
 
-    EXPECT_THAT(bsthv_count(&tree->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children), Eq(0));
 
     ptree_destroy(tree);
 }
@@ -483,14 +490,14 @@ TEST(NAME, recursively_destroy_node)
     ptree_destroy(node1);
 
     // check container sizes of remaining nodes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(2));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(2));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), IsNull());
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), IsNull());
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
 
     // check parents
     EXPECT_THAT(tree->parent, IsNull());
@@ -617,23 +624,23 @@ TEST(NAME, duplicate_tree)
     EXPECT_THAT(dnode7, NotNull());
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&dup->children),  Eq(3));
-    EXPECT_THAT(bsthv_count(&dnode1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&dnode2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&dnode4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dup->children),  Eq(3));
+    EXPECT_THAT(string_map_count(&dnode1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&dnode2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&dnode4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dup->children,  "node1"), Eq(dnode1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node2"), Eq(dnode2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node3"), Eq(dnode3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode3->children, "node4"), Eq(dnode4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node5"), Eq(dnode5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dup->children,  "node6"), Eq(dnode6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dup->children,  "node7"), Eq(dnode7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dup->children,  "node1"), Eq(dnode1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node2"), Eq(dnode2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node3"), Eq(dnode3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode3->children, "node4"), Eq(dnode4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node5"), Eq(dnode5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dup->children,  "node6"), Eq(dnode6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dup->children,  "node7"), Eq(dnode7));
 
     // make sure none of the nodes are the same as the original tree
     EXPECT_THAT(dup, Ne(tree));
@@ -731,17 +738,17 @@ TEST(NAME, duplicate_tree_node)
     EXPECT_THAT(dnode5, NotNull());
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&dnode1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&dnode2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&dnode4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&dnode2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&dnode4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode5->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node2"), Eq(dnode2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node3"), Eq(dnode3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode3->children, "node4"), Eq(dnode4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node5"), Eq(dnode5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node2"), Eq(dnode2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node3"), Eq(dnode3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode3->children, "node4"), Eq(dnode4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node5"), Eq(dnode5));
 
     // make sure none of the nodes are the same as the original tree
     EXPECT_THAT(node1, Ne(dnode1));
@@ -920,37 +927,37 @@ TEST(NAME, duplicate_children_into_existing_empty_node)
     EXPECT_THAT(dnode7, NotNull());
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(3));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&node2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&dnode2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&dnode4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(3));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&node2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(3));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&dnode2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&dnode4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node2"), Eq(node2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node3"), Eq(node3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node4->children, "node1"), Eq(dnode1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node2"), Eq(dnode2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node3"), Eq(dnode3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode3->children, "node4"), Eq(dnode4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node5"), Eq(dnode5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node4->children, "node6"), Eq(dnode6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node4->children, "node7"), Eq(dnode7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node2"), Eq(node2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node3"), Eq(node3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node4->children, "node1"), Eq(dnode1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node2"), Eq(dnode2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node3"), Eq(dnode3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode3->children, "node4"), Eq(dnode4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node5"), Eq(dnode5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node4->children, "node6"), Eq(dnode6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node4->children, "node7"), Eq(dnode7));
 
     // make sure none of the nodes are the same as the original tree
     EXPECT_THAT(node1, Ne(dnode1));
@@ -1082,37 +1089,37 @@ TEST(NAME, duplicate_tree_into_existing_node_with_children)
     EXPECT_THAT(dnode7, NotNull());
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(3));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(6));
-    EXPECT_THAT(bsthv_count(&node2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&dnode2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&dnode4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&dnode7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(3));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(6));
+    EXPECT_THAT(string_map_count(&node2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&dnode2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&dnode4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&dnode7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node2"), Eq(node2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node3"), Eq(node3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node1"), Eq(dnode1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node2"), Eq(dnode2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node3"), Eq(dnode3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode3->children, "node4"), Eq(dnode4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&dnode1->children, "node5"), Eq(dnode5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node6"), Eq(dnode6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node7"), Eq(dnode7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node2"), Eq(node2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node3"), Eq(node3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node1"), Eq(dnode1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node2"), Eq(dnode2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node3"), Eq(dnode3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode3->children, "node4"), Eq(dnode4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&dnode1->children, "node5"), Eq(dnode5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node6"), Eq(dnode6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node7"), Eq(dnode7));
 
     // make sure none of the nodes are the same as the original tree
     EXPECT_THAT(node1, Ne(dnode1));
@@ -1210,23 +1217,23 @@ TEST(NAME, duplicate_tree_into_itself_fails)
     EXPECT_THAT(ptree_duplicate_children_into_existing_node(tree, tree), Eq(0));
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(3));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&node2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(3));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&node2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node2"), Eq(node2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node3"), Eq(node3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node2"), Eq(node2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node3"), Eq(node3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
 
     // check parents
     EXPECT_THAT(tree->parent, IsNull());
@@ -1273,23 +1280,23 @@ TEST(NAME, relocate_node_in_tree)
     // |_node7      (f)
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(4));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(2));
-    EXPECT_THAT(bsthv_count(&node2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(4));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(2));
+    EXPECT_THAT(string_map_count(&node2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node2"), Eq(node2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node3"), Eq(node3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node2"), Eq(node2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node3"), Eq(node3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
 
     // check parents
     EXPECT_THAT(tree->parent, IsNull());
@@ -1342,23 +1349,23 @@ TEST(NAME, relocate_parent_node_into_child_node_fails)
     EXPECT_THAT(ptree_set_parent(node1, node5, "node1"), Eq(0));
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(3));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(3));
-    EXPECT_THAT(bsthv_count(&node2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(3));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(3));
+    EXPECT_THAT(string_map_count(&node2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node2"), Eq(node2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node3"), Eq(node3));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node2"), Eq(node2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node3"), Eq(node3));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
 
     // check parents
     EXPECT_THAT(tree->parent, IsNull());
@@ -1408,22 +1415,22 @@ TEST(NAME, set_parent_to_null_unlinks_tree)
     EXPECT_THAT(ptree_set_parent(node3, NULL, "root"), Ne(0));
 
     // check container sizes
-    EXPECT_THAT(bsthv_count(&tree->children),  Eq(3));
-    EXPECT_THAT(bsthv_count(&node1->children), Eq(2));
-    EXPECT_THAT(bsthv_count(&node2->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node3->children), Eq(1));
-    EXPECT_THAT(bsthv_count(&node4->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node5->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node6->children), Eq(0));
-    EXPECT_THAT(bsthv_count(&node7->children), Eq(0));
+    EXPECT_THAT(string_map_count(&tree->children),  Eq(3));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(2));
+    EXPECT_THAT(string_map_count(&node2->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node3->children), Eq(1));
+    EXPECT_THAT(string_map_count(&node4->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node5->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node6->children), Eq(0));
+    EXPECT_THAT(string_map_count(&node7->children), Eq(0));
 
     // check structure
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node1"), Eq(node1));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node2"), Eq(node2));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node3->children, "node4"), Eq(node4));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&node1->children, "node5"), Eq(node5));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node6"), Eq(node6));
-    EXPECT_THAT((struct ptree_t*)bsthv_find(&tree->children,  "node7"), Eq(node7));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node1"), Eq(node1));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node2"), Eq(node2));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node3->children, "node4"), Eq(node4));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&node1->children, "node5"), Eq(node5));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node6"), Eq(node6));
+    EXPECT_THAT((struct ptree_t*)string_map_find(&tree->children,  "node7"), Eq(node7));
 
     // check parents
     EXPECT_THAT(tree->parent, IsNull());
@@ -1478,6 +1485,74 @@ TEST(NAME, get_node_no_depth)
     ptree_destroy(tree);
 }
 
+TEST(NAME, nodes_reference_their_key_in_the_parent)
+{
+    int a = 3;
+    struct ptree_t* tree  = ptree_create(&a);
+    struct ptree_t* node1 = ptree_set(tree, "node1.node2", NULL);
+    struct ptree_t* node3 = ptree_set(tree, "node3", NULL);
+    node1 = ptree_get_node(tree, "node1");
+
+    EXPECT_THAT(tree->key, IsNull());
+    EXPECT_THAT(node1->key, StrEq("node1"));
+    EXPECT_THAT(ptree_get_node(tree, "node1.node2")->key, StrEq("node2"));
+
+    /* moving a node updates the key, the old key is gone */
+    EXPECT_THAT(ptree_set_parent(node3, node1, "moved"), Ne(0));
+    EXPECT_THAT(node3->key, StrEq("moved"));
+    EXPECT_THAT(node3->parent, Eq(node1));
+    EXPECT_THAT(ptree_get_node(tree, "node3"), IsNull());
+    EXPECT_THAT(ptree_get_node(tree, "node1.moved"), Eq(node3));
+
+    /* renaming within the same parent */
+    EXPECT_THAT(ptree_set_parent(node3, node1, "renamed"), Ne(0));
+    EXPECT_THAT(node3->key, StrEq("renamed"));
+    EXPECT_THAT(string_map_count(&node1->children), Eq(2u));
+    EXPECT_THAT(ptree_get_node(tree, "node1.moved"), IsNull());
+
+    /* failing to move leaves the node where it was */
+    EXPECT_THAT(ptree_set_parent(node3, node1, "node2"), Eq(0));
+    EXPECT_THAT(node3->key, StrEq("renamed"));
+    EXPECT_THAT(ptree_get_node(tree, "node1.renamed"), Eq(node3));
+
+    EXPECT_THAT(ptree_set_parent(node3, NULL, "root"), Ne(0));
+    EXPECT_THAT(node3->key, IsNull());
+    EXPECT_THAT(string_map_count(&node1->children), Eq(1u));
+
+    ptree_destroy(node3);
+    ptree_destroy(tree);
+}
+
+TEST(NAME, destroying_node_removes_it_from_parent)
+{
+    struct ptree_t* tree = ptree_create(NULL);
+    char key[16];
+    int i;
+
+    for(i = 0; i != 100; ++i)
+    {
+        sprintf(key, "node%d", i);
+        ASSERT_THAT(ptree_set(tree, key, NULL), NotNull());
+    }
+    for(i = 0; i != 100; i += 2)
+    {
+        sprintf(key, "node%d", i);
+        ptree_destroy(ptree_get_node(tree, key));
+    }
+
+    EXPECT_THAT(string_map_count(&tree->children), Eq(50u));
+    for(i = 0; i != 100; ++i)
+    {
+        sprintf(key, "node%d", i);
+        if(i % 2)
+            EXPECT_THAT(ptree_get_node(tree, key)->key, StrEq(key));
+        else
+            EXPECT_THAT(ptree_get_node(tree, key), IsNull());
+    }
+
+    ptree_destroy(tree);
+}
+
 TEST(NAME, get_node_existing_key)
 {
     int a = 3, b = 2, c = 7, d = 4, e = 12, f = 4;
@@ -1533,6 +1608,23 @@ TEST(NAME, find_non_existing_key_in_tree)
     ptree_destroy(tree);
 }
 
+TEST(NAME, get_node_stops_at_empty_path_segment)
+{
+    int a = 3;
+    struct ptree_t* tree  = ptree_create(&a);
+    struct ptree_t* node1 = ptree_set(tree, "node1", NULL);
+    struct ptree_t* node2 = ptree_set(node1, "node2", NULL);
+
+    EXPECT_THAT(ptree_get_node(tree, ""), Eq(tree));
+    EXPECT_THAT(ptree_get_node(tree, "node1."), Eq(node1));
+    EXPECT_THAT(ptree_get_node(tree, "node1..node2"), Eq(node1));
+    EXPECT_THAT(ptree_get_node(tree, "node1.node2"), Eq(node2));
+    EXPECT_THAT(ptree_get_node(tree, "node"), IsNull());
+    EXPECT_THAT(ptree_get_node(tree, "node1.node"), IsNull());
+
+    ptree_destroy(tree);
+}
+
 TEST(NAME, traverse_node_children)
 {
     const char* keys[] = {"node1", "node2", "node3", "node4"};
@@ -0,0 +1,329 @@
+#include "gmock/gmock.h"
+#include "util/ring_buffer.h"
+#include "util/thread.h"
+
+#define NAME ring_buffer
+
+using namespace testing;
+
+TEST(NAME, init_rounds_capacity_up_to_power_of_two)
+{
+    struct ring_buffer_t rb;
+    int i;
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 5);
+    for(i = 0; i != 8; ++i)
+        ASSERT_THAT(ring_buffer_enqueue(&rb, &i), Eq(1));
+#ifndef ENABLE_RING_BUFFER_REALLOC
+    EXPECT_THAT(ring_buffer_enqueue(&rb, &i), Eq(0));
+#endif
+    EXPECT_THAT(ring_buffer_count(&rb), Ge(8u));
+    ring_buffer_clear_free(&rb);
+}
+
+TEST(NAME, create_and_destroy)
+{
+    struct ring_buffer_t* rb = ring_buffer_create(sizeof(int));
+    ASSERT_THAT(rb, NotNull());
+    EXPECT_THAT(ring_buffer_count(rb), Eq(0u));
+    EXPECT_THAT(ring_buffer_peek(rb), IsNull());
+    ring_buffer_destroy(rb);
+}
+
+TEST(NAME, dequeue_from_empty_fails)
+{
+    struct ring_buffer_t rb;
+    int value = 5;
+
+    ring_buffer_init(&rb, sizeof(int));
+    EXPECT_THAT(ring_buffer_dequeue(&rb, &value), Eq(0));
+    EXPECT_THAT(value, Eq(5));
+    ring_buffer_clear_free(&rb);
+}
+
+TEST(NAME, elements_come_out_in_order_across_wraparound)
+{
+    struct ring_buffer_t rb;
+    int i, value;
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 4);
+
+    /* go around the buffer several times, keeping it partially filled */
+    for(i = 0; i != 3; ++i)
+        ASSERT_THAT(ring_buffer_enqueue(&rb, &i), Eq(1));
+    for(i = 3; i != 100; ++i)
+    {
+        ASSERT_THAT(ring_buffer_enqueue(&rb, &i), Eq(1));
+        ASSERT_THAT(ring_buffer_dequeue(&rb, &value), Eq(1));
+        ASSERT_THAT(value, Eq(i - 3));
+    }
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(3u));
+    EXPECT_THAT(*(int*)ring_buffer_peek(&rb), Eq(97));
+
+    ring_buffer_clear_free(&rb);
+}
+
+TEST(NAME, full_buffer_rejects_elements)
+{
+    struct ring_buffer_t rb;
+    int i, value;
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 4);
+    for(i = 0; i != 4; ++i)
+        ring_buffer_enqueue(&rb, &i);
+#ifndef ENABLE_RING_BUFFER_REALLOC
+    i = 4;
+    EXPECT_THAT(ring_buffer_enqueue(&rb, &i), Eq(0));
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(4u));
+#endif
+    ASSERT_THAT(ring_buffer_dequeue(&rb, &value), Eq(1));
+    EXPECT_THAT(value, Eq(0));
+    i = 5;
+    EXPECT_THAT(ring_buffer_enqueue(&rb, &i), Eq(1));
+
+    ring_buffer_clear_free(&rb);
+}
+
+TEST(NAME, batch_enqueue_and_dequeue_wrap_around)
+{
+    struct ring_buffer_t rb;
+    int in[6] = {0, 1, 2, 3, 4, 5};
+    int out[6] = {0};
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 8);
+
+    /* move the positions so the next batch crosses the end of the buffer */
+    ASSERT_THAT(ring_buffer_enqueue_n(&rb, in, 6), Eq(6u));
+    ASSERT_THAT(ring_buffer_dequeue_n(&rb, out, 6), Eq(6u));
+
+    ASSERT_THAT(ring_buffer_enqueue_n(&rb, in, 6), Eq(6u));
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(6u));
+    ASSERT_THAT(ring_buffer_dequeue_n(&rb, out, 10), Eq(6u));
+    EXPECT_THAT(out, ElementsAre(0, 1, 2, 3, 4, 5));
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(0u));
+
+    ring_buffer_clear_free(&rb);
+}
+
+#ifndef ENABLE_RING_BUFFER_REALLOC
+TEST(NAME, batch_enqueue_stops_when_full)
+{
+    struct ring_buffer_t rb;
+    int in[6] = {0, 1, 2, 3, 4, 5};
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 4);
+    EXPECT_THAT(ring_buffer_enqueue_n(&rb, in, 6), Eq(4u));
+    EXPECT_THAT(ring_buffer_enqueue_n(&rb, in, 6), Eq(0u));
+    ring_buffer_clear_free(&rb);
+}
+#endif
+
+TEST(NAME, reserve_and_commit_write_in_place)
+{
+    struct ring_buffer_t rb;
+    uint32_t reserved;
+    int* slots;
+    int value;
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 4);
+
+    /* positions at 3, so only one slot is left before the end */
+    for(value = 0; value != 3; ++value)
+        ring_buffer_enqueue(&rb, &value);
+    ring_buffer_dequeue_n(&rb, &value, 1);
+    ring_buffer_dequeue_n(&rb, &value, 1);
+    ring_buffer_dequeue_n(&rb, &value, 1);
+
+    slots = (int*)ring_buffer_reserve(&rb, 3, &reserved);
+    ASSERT_THAT(slots, NotNull());
+    ASSERT_THAT(reserved, Eq(1u));
+    slots[0] = 10;
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(0u));
+    ring_buffer_commit(&rb, 1);
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(1u));
+
+    slots = (int*)ring_buffer_reserve(&rb, 2, &reserved);
+    ASSERT_THAT(slots, NotNull());
+    ASSERT_THAT(reserved, Eq(2u));
+    slots[0] = 11;
+    slots[1] = 12;
+    /* only publish part of what was reserved */
+    ring_buffer_commit(&rb, 1);
+
+    ASSERT_THAT(ring_buffer_dequeue(&rb, &value), Eq(1));
+    EXPECT_THAT(value, Eq(10));
+    ASSERT_THAT(ring_buffer_dequeue(&rb, &value), Eq(1));
+    EXPECT_THAT(value, Eq(11));
+    EXPECT_THAT(ring_buffer_dequeue(&rb, &value), Eq(0));
+
+    ring_buffer_clear_free(&rb);
+}
+
+TEST(NAME, peek_and_consume_read_in_place)
+{
+    struct ring_buffer_t rb;
+    int in[3] = {4, 5, 6};
+    uint32_t available;
+    int* elements;
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 4);
+    EXPECT_THAT(ring_buffer_peek_n(&rb, 2, &available), IsNull());
+    EXPECT_THAT(available, Eq(0u));
+
+    ring_buffer_enqueue_n(&rb, in, 3);
+    elements = (int*)ring_buffer_peek_n(&rb, 2, &available);
+    ASSERT_THAT(elements, NotNull());
+    ASSERT_THAT(available, Eq(2u));
+    EXPECT_THAT(elements[0], Eq(4));
+    EXPECT_THAT(elements[1], Eq(5));
+
+    ring_buffer_consume(&rb, 1);
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(2u));
+    EXPECT_THAT(*(int*)ring_buffer_peek(&rb), Eq(5));
+
+    ring_buffer_clear_free(&rb);
+}
+
+TEST(NAME, clear_discards_elements)
+{
+    struct ring_buffer_t rb;
+    int in[3] = {1, 2, 3};
+    int value;
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 4);
+    ring_buffer_enqueue_n(&rb, in, 3);
+    ring_buffer_clear(&rb);
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(0u));
+    EXPECT_THAT(ring_buffer_dequeue(&rb, &value), Eq(0));
+    EXPECT_THAT(ring_buffer_enqueue_n(&rb, in, 3), Eq(3u));
+    ring_buffer_clear_free(&rb);
+}
+
+#ifdef ENABLE_RING_BUFFER_REALLOC
+TEST(NAME, full_buffer_grows_without_losing_order)
+{
+    struct ring_buffer_t rb;
+    int i, value;
+
+    ring_buffer_init_with_capacity(&rb, sizeof(int), 4);
+
+    /* the consumer is still in the first segment while the producer moves on */
+    for(i = 0; i != 2; ++i)
+        ring_buffer_enqueue(&rb, &i);
+    ring_buffer_dequeue(&rb, &value);
+    for(i = 2; i != 40; ++i)
+        ASSERT_THAT(ring_buffer_enqueue(&rb, &i), Eq(1));
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(39u));
+
+    for(i = 1; i != 40; ++i)
+    {
+        ASSERT_THAT(ring_buffer_dequeue(&rb, &value), Eq(1));
+        ASSERT_THAT(value, Eq(i));
+    }
+    EXPECT_THAT(ring_buffer_dequeue(&rb, &value), Eq(0));
+
+    ring_buffer_clear_free(&rb);
+}
+
+TEST(NAME, growth_stops_at_max_size)
+{
+    struct ring_buffer_t rb;
+    uint32_t i, max = RING_BUFFER_MAX_SIZE / sizeof(uint32_t);
+
+    ring_buffer_init_with_capacity(&rb, sizeof(uint32_t), 4);
+    for(i = 0; i != max * 2; ++i)
+        if(!ring_buffer_enqueue(&rb, &i))
+            break;
+    /* the smaller segments still hold elements too, so more than max fit */
+    EXPECT_THAT(i, Ge(max));
+    EXPECT_THAT(i, Lt(max * 2));
+    ring_buffer_clear_free(&rb);
+}
+#endif
+
+/* ------------------------------------------------------------------------- */
+/* one producer and one consumer thread */
+
+#define TRANSFER_COUNT 1000000
+
+struct spsc_state_t
+{
+    struct ring_buffer_t* rb;
+    uint32_t errors;
+    uint32_t count_errors;   /* written by the producer only */
+};
+
+static void
+producer(void* arg)
+{
+    struct spsc_state_t* state = (struct spsc_state_t*)arg;
+    uint32_t next = 0;
+
+    while(next != TRANSFER_COUNT)
+    {
+        uint32_t reserved, i;
+        uint32_t* slots;
+
+        /* alternate between copying and writing in place */
+        if(next & 1)
+        {
+            if(ring_buffer_enqueue(state->rb, &next))
+                ++next;
+            else
+                thread_yield();
+            continue;
+        }
+
+        slots = (uint32_t*)ring_buffer_reserve(state->rb, 7, &reserved);
+        if(!slots)
+        {
+            thread_yield();
+            continue;
+        }
+        if(reserved > TRANSFER_COUNT - next)
+            reserved = TRANSFER_COUNT - next;
+        for(i = 0; i != reserved; ++i)
+            slots[i] = next++;
+        ring_buffer_commit(state->rb, reserved);
+
+        /* the consumer may free segments while the producer counts */
+        if(ring_buffer_count(state->rb) > next)
+            ++state->count_errors;
+    }
+}
+
+TEST(NAME, elements_cross_threads_in_order)
+{
+    struct ring_buffer_t rb;
+    struct spsc_state_t state;
+    struct thread_t* thread;
+    uint32_t expected = 0;
+    uint32_t batch[5];
+
+    ring_buffer_init_with_capacity(&rb, sizeof(uint32_t), 64);
+    state.rb = &rb;
+    state.errors = 0;
+    state.count_errors = 0;
+    thread = thread_create(producer, &state);
+    ASSERT_THAT(thread, NotNull());
+
+    while(expected != TRANSFER_COUNT)
+    {
+        uint32_t count = ring_buffer_dequeue_n(&rb, batch, 5);
+        uint32_t i;
+        if(count == 0)
+        {
+            thread_yield();
+            continue;
+        }
+        for(i = 0; i != count; ++i)
+            if(batch[i] != expected++)
+                ++state.errors;
+    }
+
+    thread_join(thread);
+    EXPECT_THAT(state.errors, Eq(0u));
+    EXPECT_THAT(state.count_errors, Eq(0u));
+    EXPECT_THAT(ring_buffer_count(&rb), Eq(0u));
+    ring_buffer_clear_free(&rb);
+}
@@ -0,0 +1,205 @@
+#include "gmock/gmock.h"
+#include "util/slot_map.h"
+#include "util/memory.h"
+
+#define NAME slot_map
+
+using namespace testing;
+
+TEST(NAME, init)
+{
+    struct slot_map_t map;
+    slot_map_init(&map, sizeof(int));
+    EXPECT_THAT(slot_map_count(&map), Eq(0u));
+    EXPECT_THAT(map.dense.element_size, Eq(sizeof(int)));
+    EXPECT_THAT(slot_map_get(&map, SLOT_MAP_INVALID_HANDLE), IsNull());
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, create_and_destroy)
+{
+    struct slot_map_t* map = slot_map_create(sizeof(int));
+    ASSERT_THAT(map, NotNull());
+    EXPECT_THAT(slot_map_count(map), Eq(0u));
+    slot_map_destroy(map);
+}
+
+TEST(NAME, insert_and_get)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handles[100];
+    int i;
+
+    slot_map_init(&map, sizeof(int));
+    for(i = 0; i != 100; ++i)
+    {
+        handles[i] = slot_map_insert(&map, &i);
+        ASSERT_THAT(handles[i], Ne(SLOT_MAP_INVALID_HANDLE));
+    }
+    EXPECT_THAT(slot_map_count(&map), Eq(100u));
+    for(i = 0; i != 100; ++i)
+        EXPECT_THAT((int*)slot_map_get(&map, handles[i]), Pointee(i));
+
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, insert_emplace)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handle;
+    int* value;
+
+    slot_map_init(&map, sizeof(int));
+    value = (int*)slot_map_insert_emplace(&map, &handle);
+    ASSERT_THAT(value, NotNull());
+    *value = 42;
+    EXPECT_THAT((int*)slot_map_get(&map, handle), Pointee(42));
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, erase_keeps_other_handles_valid)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handles[10];
+    int i;
+
+    slot_map_init(&map, sizeof(int));
+    for(i = 0; i != 10; ++i)
+        handles[i] = slot_map_insert(&map, &i);
+
+    /* erasing from the front moves the last element into the gap */
+    EXPECT_THAT(slot_map_erase(&map, handles[0]), Eq(1));
+    EXPECT_THAT(slot_map_erase(&map, handles[4]), Eq(1));
+    EXPECT_THAT(slot_map_erase(&map, handles[9]), Eq(1));
+    EXPECT_THAT(slot_map_count(&map), Eq(7u));
+
+    for(i = 0; i != 10; ++i)
+    {
+        if(i == 0 || i == 4 || i == 9)
+            EXPECT_THAT(slot_map_get(&map, handles[i]), IsNull());
+        else
+            EXPECT_THAT((int*)slot_map_get(&map, handles[i]), Pointee(i));
+    }
+
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, erase_stale_handle_fails)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handle;
+    int value = 5;
+
+    slot_map_init(&map, sizeof(int));
+    handle = slot_map_insert(&map, &value);
+    EXPECT_THAT(slot_map_erase(&map, handle), Eq(1));
+    EXPECT_THAT(slot_map_erase(&map, handle), Eq(0));
+    EXPECT_THAT(slot_map_erase(&map, SLOT_MAP_INVALID_HANDLE), Eq(0));
+    EXPECT_THAT(slot_map_count(&map), Eq(0u));
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, reused_slot_does_not_resurrect_stale_handle)
+{
+    struct slot_map_t map;
+    slot_map_handle_t old_handle, new_handle;
+    int a = 1, b = 2;
+
+    slot_map_init(&map, sizeof(int));
+    old_handle = slot_map_insert(&map, &a);
+    slot_map_erase(&map, old_handle);
+    new_handle = slot_map_insert(&map, &b);
+
+    /* same slot, different generation */
+    EXPECT_THAT(new_handle & (SLOT_MAP_MAX_SLOTS - 1), Eq(old_handle & (SLOT_MAP_MAX_SLOTS - 1)));
+    EXPECT_THAT(new_handle, Ne(old_handle));
+    EXPECT_THAT(slot_map_get(&map, old_handle), IsNull());
+    EXPECT_THAT((int*)slot_map_get(&map, new_handle), Pointee(2));
+    EXPECT_THAT(map.slots.count, Eq(1u));
+
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, generation_never_wraps_to_invalid_handle)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handle;
+    int value = 0;
+    int i;
+
+    slot_map_init(&map, sizeof(int));
+    for(i = 0; i != (1 << (32 - SLOT_MAP_INDEX_BITS)) + 10; ++i)
+    {
+        handle = slot_map_insert(&map, &value);
+        ASSERT_THAT(handle, Ne(SLOT_MAP_INVALID_HANDLE));
+        ASSERT_THAT(slot_map_erase(&map, handle), Eq(1));
+    }
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, clear_invalidates_handles)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handles[10];
+    int i;
+
+    slot_map_init(&map, sizeof(int));
+    for(i = 0; i != 10; ++i)
+        handles[i] = slot_map_insert(&map, &i);
+    slot_map_clear(&map);
+    EXPECT_THAT(slot_map_count(&map), Eq(0u));
+    for(i = 0; i != 10; ++i)
+        EXPECT_THAT(slot_map_get(&map, handles[i]), IsNull());
+
+    /* slots are reused */
+    for(i = 0; i != 10; ++i)
+        handles[i] = slot_map_insert(&map, &i);
+    EXPECT_THAT(map.slots.count, Eq(10u));
+    for(i = 0; i != 10; ++i)
+        EXPECT_THAT((int*)slot_map_get(&map, handles[i]), Pointee(i));
+
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, iterate_dense_array)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handles[10];
+    int i, sum = 0, count = 0;
+
+    slot_map_init(&map, sizeof(int));
+    for(i = 0; i != 10; ++i)
+        handles[i] = slot_map_insert(&map, &i);
+    slot_map_erase(&map, handles[3]);
+
+    SLOT_MAP_FOR_EACH(&map, int, value)
+        sum += *value;
+        ++count;
+    SLOT_MAP_END_EACH
+    EXPECT_THAT(count, Eq(9));
+    EXPECT_THAT(sum, Eq(45 - 3));
+
+    slot_map_clear_free(&map);
+}
+
+TEST(NAME, get_handle_from_dense_index)
+{
+    struct slot_map_t map;
+    slot_map_handle_t handles[10];
+    uint32_t i;
+
+    slot_map_init(&map, sizeof(uint32_t));
+    for(i = 0; i != 10; ++i)
+        handles[i] = slot_map_insert(&map, &i);
+    slot_map_erase(&map, handles[2]);
+
+    for(i = 0; i != slot_map_count(&map); ++i)
+    {
+        slot_map_handle_t handle = slot_map_get_handle(&map, i);
+        uint32_t value = *(uint32_t*)slot_map_get(&map, handle);
+        EXPECT_THAT(handle, Eq(handles[value]));
+    }
+    EXPECT_THAT(slot_map_get_handle(&map, 9), Eq(SLOT_MAP_INVALID_HANDLE));
+
+    slot_map_clear_free(&map);
+}
@@ -0,0 +1,152 @@
+#include "gmock/gmock.h"
+#include "util/soa_vector.h"
+#include "util/memory.h"
+
+#define NAME soa_vector
+
+using namespace testing;
+
+enum
+{
+    COLUMN_X,
+    COLUMN_FLAG,
+    COLUMN_ID,
+
+    COLUMN_COUNT
+};
+
+static const uint32_t g_sizes[COLUMN_COUNT] = {sizeof(float), sizeof(char), sizeof(uint64_t)};
+
+TEST(NAME, init)
+{
+    struct soa_vector_t v;
+    soa_vector_init(&v, COLUMN_COUNT, g_sizes);
+    EXPECT_THAT(soa_vector_count(&v), Eq(0u));
+    EXPECT_THAT(v.capacity, Eq(0u));
+    EXPECT_THAT(v.column_count, Eq(3u));
+    EXPECT_THAT(v.element_sizes[COLUMN_FLAG], Eq(sizeof(char)));
+    EXPECT_THAT(soa_vector_column(&v, COLUMN_X), IsNull());
+    soa_vector_clear_free(&v);
+}
+
+TEST(NAME, create_and_destroy)
+{
+    struct soa_vector_t* v = soa_vector_create(COLUMN_COUNT, g_sizes);
+    ASSERT_THAT(v, NotNull());
+    EXPECT_THAT(soa_vector_push_emplace(v), Eq(1));
+    soa_vector_destroy(v);
+}
+
+TEST(NAME, push_grows_all_columns_together)
+{
+    struct soa_vector_t v;
+    uint32_t i;
+
+    soa_vector_init(&v, COLUMN_COUNT, g_sizes);
+    for(i = 0; i != 1000; ++i)
+    {
+        ASSERT_THAT(soa_vector_push_emplace(&v), Eq(1));
+        *(float*)soa_vector_get(&v, COLUMN_X, i) = (float)i;
+        *(char*)soa_vector_get(&v, COLUMN_FLAG, i) = (char)(i & 1);
+        *(uint64_t*)soa_vector_get(&v, COLUMN_ID, i) = (uint64_t)i << 32;
+    }
+    EXPECT_THAT(soa_vector_count(&v), Eq(1000u));
+    EXPECT_THAT(v.capacity, Ge(1000u));
+
+    for(i = 0; i != 1000; ++i)
+    {
+        EXPECT_THAT(((float*)soa_vector_column(&v, COLUMN_X))[i], Eq((float)i));
+        EXPECT_THAT(((char*)soa_vector_column(&v, COLUMN_FLAG))[i], Eq((char)(i & 1)));
+        EXPECT_THAT(((uint64_t*)soa_vector_column(&v, COLUMN_ID))[i], Eq((uint64_t)i << 32));
+    }
+
+    soa_vector_clear_free(&v);
+}
+
+TEST(NAME, columns_are_aligned)
+{
+    struct soa_vector_t v;
+    uint32_t i, c;
+
+    soa_vector_init(&v, COLUMN_COUNT, g_sizes);
+    for(i = 0; i != 37; ++i)
+    {
+        soa_vector_push_emplace(&v);
+        for(c = 0; c != COLUMN_COUNT; ++c)
+            EXPECT_THAT((uintptr_t)soa_vector_column(&v, c) % SOA_VECTOR_ALIGNMENT, Eq(0u));
+    }
+    soa_vector_clear_free(&v);
+}
+
+TEST(NAME, reserve)
+{
+    struct soa_vector_t v;
+    void* column;
+
+    soa_vector_init(&v, COLUMN_COUNT, g_sizes);
+    EXPECT_THAT(soa_vector_reserve(&v, 100), Eq(1));
+    EXPECT_THAT(v.capacity, Eq(100u));
+    EXPECT_THAT(soa_vector_count(&v), Eq(0u));
+
+    column = soa_vector_column(&v, COLUMN_ID);
+    for(int i = 0; i != 100; ++i)
+        soa_vector_push_emplace(&v);
+    EXPECT_THAT(soa_vector_column(&v, COLUMN_ID), Eq(column));
+
+    /* reserving less than the capacity does nothing */
+    EXPECT_THAT(soa_vector_reserve(&v, 10), Eq(1));
+    EXPECT_THAT(v.capacity, Eq(100u));
+
+    soa_vector_clear_free(&v);
+}
+
+TEST(NAME, erase_moves_last_element_in_every_column)
+{
+    struct soa_vector_t v;
+    uint32_t i;
+
+    soa_vector_init(&v, COLUMN_COUNT, g_sizes);
+    for(i = 0; i != 5; ++i)
+    {
+        soa_vector_push_emplace(&v);
+        *(float*)soa_vector_get(&v, COLUMN_X, i) = (float)i;
+        *(char*)soa_vector_get(&v, COLUMN_FLAG, i) = (char)('a' + i);
+        *(uint64_t*)soa_vector_get(&v, COLUMN_ID, i) = i * 10;
+    }
+
+    soa_vector_erase_index(&v, 1);
+    ASSERT_THAT(soa_vector_count(&v), Eq(4u));
+    EXPECT_THAT(*(float*)soa_vector_get(&v, COLUMN_X, 1), Eq(4.0f));
+    EXPECT_THAT(*(char*)soa_vector_get(&v, COLUMN_FLAG, 1), Eq('e'));
+    EXPECT_THAT(*(uint64_t*)soa_vector_get(&v, COLUMN_ID, 1), Eq(40u));
+
+    /* erasing the last element doesn't move anything */
+    soa_vector_erase_index(&v, 3);
+    ASSERT_THAT(soa_vector_count(&v), Eq(3u));
+    EXPECT_THAT(*(char*)soa_vector_get(&v, COLUMN_FLAG, 0), Eq('a'));
+    EXPECT_THAT(*(char*)soa_vector_get(&v, COLUMN_FLAG, 1), Eq('e'));
+    EXPECT_THAT(*(char*)soa_vector_get(&v, COLUMN_FLAG, 2), Eq('c'));
+
+    /* out of range */
+    soa_vector_erase_index(&v, 3);
+    EXPECT_THAT(soa_vector_count(&v), Eq(3u));
+
+    soa_vector_clear_free(&v);
+}
+
+TEST(NAME, clear_keeps_memory)
+{
+    struct soa_vector_t v;
+
+    soa_vector_init(&v, COLUMN_COUNT, g_sizes);
+    soa_vector_push_emplace(&v);
+    soa_vector_push_emplace(&v);
+    soa_vector_clear(&v);
+    EXPECT_THAT(soa_vector_count(&v), Eq(0u));
+    EXPECT_THAT(v.capacity, Ne(0u));
+    EXPECT_THAT(v.block, NotNull());
+
+    soa_vector_clear_free(&v);
+    EXPECT_THAT(v.capacity, Eq(0u));
+    EXPECT_THAT(v.block, IsNull());
+}
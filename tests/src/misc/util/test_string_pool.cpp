@@ -0,0 +1,121 @@
+#include "gmock/gmock.h"
+#include "util/string_pool.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NAME string_pool
+
+using namespace testing;
+
+TEST(NAME, init)
+{
+    struct string_pool_t pool;
+    memset(&pool, 0xFF, sizeof pool);
+    string_pool_init(&pool);
+    EXPECT_THAT(pool.slots, IsNull());
+    EXPECT_THAT(pool.capacity, Eq(0u));
+    EXPECT_THAT(string_pool_count(&pool), Eq(0u));
+    string_pool_clear_free(&pool);
+}
+
+TEST(NAME, interning_equal_strings_returns_same_pointer)
+{
+    struct string_pool_t* pool = string_pool_create();
+    char buf[16];
+    const char* a;
+    const char* b;
+
+    strcpy(buf, "position");
+    a = string_pool_intern(pool, buf);
+    strcpy(buf, "rotation");
+    b = string_pool_intern(pool, buf);
+
+    ASSERT_THAT(a, NotNull());
+    ASSERT_THAT(b, NotNull());
+    EXPECT_THAT(a, Ne((const char*)buf));
+    EXPECT_THAT(a, StrEq("position"));
+    EXPECT_THAT(b, StrEq("rotation"));
+    EXPECT_THAT(string_pool_intern(pool, "position"), Eq(a));
+    EXPECT_THAT(string_pool_intern(pool, "rotation"), Eq(b));
+    EXPECT_THAT(string_pool_count(pool), Eq(2u));
+
+    string_pool_destroy(pool);
+}
+
+TEST(NAME, intern_n_copies_and_terminates_part_of_a_string)
+{
+    struct string_pool_t* pool = string_pool_create();
+    const char* path = "node.child";
+    const char* a = string_pool_intern_n(pool, path, 4);
+    const char* b = string_pool_intern_n(pool, path + 5, 5);
+
+    EXPECT_THAT(a, StrEq("node"));
+    EXPECT_THAT(b, StrEq("child"));
+    EXPECT_THAT(string_pool_intern(pool, "node"), Eq(a));
+    EXPECT_THAT(string_pool_intern_n(pool, path, 3), Ne(a));
+    EXPECT_THAT(string_pool_count(pool), Eq(3u));
+
+    string_pool_destroy(pool);
+}
+
+TEST(NAME, empty_string_can_be_interned)
+{
+    struct string_pool_t* pool = string_pool_create();
+    const char* a = string_pool_intern(pool, "");
+    EXPECT_THAT(a, StrEq(""));
+    EXPECT_THAT(string_pool_intern_n(pool, "abc", 0), Eq(a));
+    string_pool_destroy(pool);
+}
+
+TEST(NAME, find_does_not_intern)
+{
+    struct string_pool_t* pool = string_pool_create();
+    const char* a;
+
+    EXPECT_THAT(string_pool_find_n(pool, "a", 1), IsNull());
+    a = string_pool_intern(pool, "a");
+    EXPECT_THAT(string_pool_find_n(pool, "a", 1), Eq(a));
+    EXPECT_THAT(string_pool_find_n(pool, "b", 1), IsNull());
+    EXPECT_THAT(string_pool_count(pool), Eq(1u));
+
+    string_pool_destroy(pool);
+}
+
+TEST(NAME, many_strings_survive_growing)
+{
+    struct string_pool_t* pool = string_pool_create();
+    const char* interned[1000];
+    char key[16];
+    int i;
+
+    for(i = 0; i != 1000; ++i)
+    {
+        sprintf(key, "key%d", i);
+        interned[i] = string_pool_intern(pool, key);
+        ASSERT_THAT(interned[i], NotNull());
+    }
+    EXPECT_THAT(string_pool_count(pool), Eq(1000u));
+
+    for(i = 0; i != 1000; ++i)
+    {
+        sprintf(key, "key%d", i);
+        EXPECT_THAT(interned[i], StrEq(key));
+        EXPECT_THAT(string_pool_intern(pool, key), Eq(interned[i]));
+    }
+    EXPECT_THAT(string_pool_count(pool), Eq(1000u));
+
+    string_pool_destroy(pool);
+}
+
+TEST(NAME, clear_forgets_strings)
+{
+    struct string_pool_t* pool = string_pool_create();
+    string_pool_intern(pool, "a");
+    string_pool_intern(pool, "b");
+    string_pool_clear(pool);
+    EXPECT_THAT(string_pool_count(pool), Eq(0u));
+    EXPECT_THAT(string_pool_find_n(pool, "a", 1), IsNull());
+    EXPECT_THAT(string_pool_intern(pool, "a"), StrEq("a"));
+    EXPECT_THAT(string_pool_count(pool), Eq(1u));
+    string_pool_destroy(pool);
+}
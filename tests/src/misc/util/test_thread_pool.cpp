@@ -0,0 +1,232 @@
+#include "gmock/gmock.h"
+#include "util/config.h"
+
+#ifdef ENABLE_THREAD_POOL
+
+#include "util/thread_pool.h"
+#include "util/atomic.h"
+
+#define NAME thread_pool
+
+using namespace testing;
+
+static void
+increment(void* arg)
+{
+    ATOMIC_FETCH_ADD((volatile uint32_t*)arg, 1);
+}
+
+TEST(NAME, create_and_destroy)
+{
+    struct thread_pool_t* pool = thread_pool_create(3);
+    ASSERT_THAT(pool, NotNull());
+    EXPECT_THAT(thread_pool_worker_count(pool), Eq(3u));
+    thread_pool_destroy(pool);
+}
+
+TEST(NAME, zero_workers_means_one_per_cpu)
+{
+    struct thread_pool_t* pool = thread_pool_create(0);
+    ASSERT_THAT(pool, NotNull());
+    EXPECT_THAT(thread_pool_worker_count(pool), Ge(1u));
+    thread_pool_destroy(pool);
+}
+
+TEST(NAME, wait_returns_after_all_jobs_ran)
+{
+    struct thread_pool_t* pool = thread_pool_create(4);
+    struct thread_pool_counter_t counter;
+    volatile uint32_t count = 0;
+    int i;
+
+    thread_pool_counter_init(&counter);
+    for(i = 0; i != 5000; ++i)
+        thread_pool_submit(pool, increment, (void*)&count, &counter);
+    thread_pool_wait(pool, &counter);
+    EXPECT_THAT(count, Eq(5000u));
+    EXPECT_THAT(counter.pending, Eq(0u));
+
+    thread_pool_destroy(pool);
+}
+
+TEST(NAME, wait_on_unused_counter_returns_immediately)
+{
+    struct thread_pool_t* pool = thread_pool_create(1);
+    struct thread_pool_counter_t counter;
+    thread_pool_counter_init(&counter);
+    thread_pool_wait(pool, &counter);
+    thread_pool_destroy(pool);
+}
+
+TEST(NAME, destroy_runs_remaining_jobs)
+{
+    struct thread_pool_t* pool = thread_pool_create(2);
+    volatile uint32_t count = 0;
+    int i;
+
+    for(i = 0; i != 3000; ++i)
+        thread_pool_submit(pool, increment, (void*)&count, NULL);
+    thread_pool_destroy(pool);
+    EXPECT_THAT(count, Eq(3000u));
+}
+
+/* ------------------------------------------------------------------------- */
+/* jobs submitting jobs, summing a tree recursively */
+
+struct fib_t
+{
+    struct thread_pool_t* pool;
+    uint32_t n;
+    uint32_t result;
+};
+
+static void
+fib(void* arg)
+{
+    struct fib_t* f = (struct fib_t*)arg;
+    struct fib_t a, b;
+    struct thread_pool_counter_t counter;
+
+    if(f->n < 2)
+    {
+        f->result = f->n;
+        return;
+    }
+
+    a.pool = b.pool = f->pool;
+    a.n = f->n - 1;
+    b.n = f->n - 2;
+    thread_pool_counter_init(&counter);
+    thread_pool_submit(f->pool, fib, &a, &counter);
+    fib(&b);
+    thread_pool_wait(f->pool, &counter);
+    f->result = a.result + b.result;
+}
+
+TEST(NAME, nested_jobs_can_wait_for_their_children)
+{
+    struct thread_pool_t* pool = thread_pool_create(4);
+    struct thread_pool_counter_t counter;
+    struct fib_t f;
+
+    f.pool = pool;
+    f.n = 20;
+    thread_pool_counter_init(&counter);
+    thread_pool_submit(pool, fib, &f, &counter);
+    thread_pool_wait(pool, &counter);
+    EXPECT_THAT(f.result, Eq(6765u));
+
+    thread_pool_destroy(pool);
+}
+
+/* ------------------------------------------------------------------------- */
+struct chain_t
+{
+    volatile uint32_t count;
+    uint32_t count_when_continued;
+};
+
+static void
+record_count(void* arg)
+{
+    struct chain_t* chain = (struct chain_t*)arg;
+    chain->count_when_continued = chain->count;
+}
+
+TEST(NAME, continuation_runs_after_counter_reaches_zero)
+{
+    struct thread_pool_t* pool = thread_pool_create(4);
+    struct thread_pool_counter_t first, second;
+    struct chain_t chain;
+    int i;
+
+    chain.count = 0;
+    chain.count_when_continued = 0;
+    thread_pool_counter_init(&first);
+    thread_pool_counter_init(&second);
+
+    for(i = 0; i != 1000; ++i)
+        thread_pool_submit(pool, increment, (void*)&chain.count, &first);
+    thread_pool_then(pool, &first, record_count, &chain, &second);
+
+    /* waiting on the continuation's counter also waits for the first batch */
+    thread_pool_wait(pool, &second);
+    EXPECT_THAT(chain.count_when_continued, Eq(1000u));
+
+    thread_pool_destroy(pool);
+}
+
+TEST(NAME, continuation_on_finished_counter_runs_immediately)
+{
+    struct thread_pool_t* pool = thread_pool_create(2);
+    struct thread_pool_counter_t first, second;
+    volatile uint32_t count = 0;
+
+    thread_pool_counter_init(&first);
+    thread_pool_counter_init(&second);
+    thread_pool_then(pool, &first, increment, (void*)&count, &second);
+    thread_pool_wait(pool, &second);
+    EXPECT_THAT(count, Eq(1u));
+
+    thread_pool_destroy(pool);
+}
+
+/* ------------------------------------------------------------------------- */
+struct range_state_t
+{
+    volatile uint32_t calls;
+    uint32_t grain;
+    char* visited;
+    volatile uint32_t errors;
+};
+
+static void
+visit_range(void* arg, uint32_t begin, uint32_t end)
+{
+    struct range_state_t* state = (struct range_state_t*)arg;
+    if(end <= begin || end - begin > state->grain)
+        ATOMIC_FETCH_ADD(&state->errors, 1);
+    for(; begin != end; ++begin)
+        state->visited[begin]++;
+    ATOMIC_FETCH_ADD(&state->calls, 1);
+}
+
+TEST(NAME, parallel_for_visits_every_index_once)
+{
+    struct thread_pool_t* pool = thread_pool_create(4);
+    struct range_state_t state;
+    char visited[10000] = {0};
+    int i;
+
+    state.calls = 0;
+    state.grain = 64;
+    state.visited = visited;
+    state.errors = 0;
+    thread_pool_parallel_for(pool, 100, 10000, 64, visit_range, &state);
+
+    EXPECT_THAT(state.errors, Eq(0u));
+    EXPECT_THAT(state.calls, Ge((10000u - 100u) / 64u));
+    for(i = 0; i != 100; ++i)
+        ASSERT_THAT(visited[i], Eq(0));
+    for(i = 100; i != 10000; ++i)
+        ASSERT_THAT(visited[i], Eq(1));
+
+    thread_pool_destroy(pool);
+}
+
+TEST(NAME, parallel_for_with_empty_range_does_nothing)
+{
+    struct thread_pool_t* pool = thread_pool_create(1);
+    struct range_state_t state;
+
+    state.calls = 0;
+    state.grain = 1;
+    state.visited = NULL;
+    state.errors = 0;
+    thread_pool_parallel_for(pool, 5, 5, 1, visit_range, &state);
+    EXPECT_THAT(state.calls, Eq(0u));
+
+    thread_pool_destroy(pool);
+}
+
+#endif /* ENABLE_THREAD_POOL */
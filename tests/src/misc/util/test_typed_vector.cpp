@@ -0,0 +1,92 @@
+#include "gmock/gmock.h"
+#include "util/typed_vector.h"
+
+#define NAME typed_vector
+
+using namespace testing;
+
+struct point_t
+{
+    int x, y;
+};
+
+DECLARE_VECTOR(int_vector, int)
+DECLARE_VECTOR(point_vector, struct point_t)
+
+TEST(NAME, init)
+{
+    struct int_vector_t v;
+    int_vector_init(&v);
+    EXPECT_THAT(int_vector_count(&v), Eq(0u));
+    EXPECT_THAT(v.vector.element_size, Eq(sizeof(int)));
+    EXPECT_THAT(int_vector_data(&v), IsNull());
+}
+
+TEST(NAME, push_and_get)
+{
+    struct int_vector_t v;
+    int_vector_init(&v);
+    for(int i = 0; i != 100; ++i)
+        ASSERT_THAT(int_vector_push(&v, i * 2), Ne(0));
+    ASSERT_THAT(int_vector_count(&v), Eq(100u));
+    for(int i = 0; i != 100; ++i)
+        EXPECT_THAT(int_vector_get(&v, i), Pointee(i * 2));
+    EXPECT_THAT(int_vector_get(&v, 100), IsNull());
+    EXPECT_THAT(int_vector_back(&v), Pointee(198));
+    int_vector_clear_free(&v);
+}
+
+TEST(NAME, push_emplace_struct)
+{
+    struct point_vector_t v;
+    point_vector_init(&v);
+    struct point_t* p = point_vector_push_emplace(&v);
+    p->x = 3; p->y = 4;
+    struct point_t q = {5, 6};
+    point_vector_push(&v, q);
+    EXPECT_THAT(point_vector_get(&v, 0)->y, Eq(4));
+    EXPECT_THAT(point_vector_get(&v, 1)->x, Eq(5));
+    point_vector_clear_free(&v);
+}
+
+TEST(NAME, pop_and_erase)
+{
+    struct int_vector_t v;
+    int_vector_init(&v);
+    EXPECT_THAT(int_vector_pop(&v), IsNull());
+    for(int i = 0; i != 5; ++i)
+        int_vector_push(&v, i);
+    EXPECT_THAT(int_vector_pop(&v), Pointee(4));
+    int_vector_erase_index(&v, 1);
+    int_vector_erase_index(&v, 10);
+    ASSERT_THAT(int_vector_count(&v), Eq(3u));
+    EXPECT_THAT(int_vector_get(&v, 0), Pointee(0));
+    EXPECT_THAT(int_vector_get(&v, 1), Pointee(2));
+    EXPECT_THAT(int_vector_get(&v, 2), Pointee(3));
+    int_vector_clear_free(&v);
+}
+
+TEST(NAME, for_each)
+{
+    struct int_vector_t v;
+    int sum = 0;
+    int_vector_init(&v);
+    for(int i = 1; i <= 10; ++i)
+        int_vector_push(&v, i);
+    TYPED_VECTOR_FOR_EACH(&v, int, value)
+        sum += *value;
+    TYPED_VECTOR_END_EACH
+    EXPECT_THAT(sum, Eq(55));
+    int_vector_clear_free(&v);
+}
+
+TEST(NAME, compatible_with_generic_api)
+{
+    struct int_vector_t v;
+    int_vector_init(&v);
+    ordered_vector_reserve(&v.vector, 64);
+    int_vector_push(&v, 7);
+    EXPECT_THAT(*(int*)ordered_vector_get_element(&v.vector, 0), Eq(7));
+    EXPECT_THAT(v.vector.capacity, Eq(64u));
+    int_vector_clear_free(&v);
+}
@@ -235,3 +235,95 @@ TEST(NAME, erase_invalid_index)
     unordered_vector_erase_index(vec, 0);
     unordered_vector_destroy(vec);
 }
+
+TEST(NAME, reserve)
+{
+    struct unordered_vector_t* vec = unordered_vector_create(sizeof(int));
+    EXPECT_NE(0, unordered_vector_reserve(vec, 100));
+    EXPECT_EQ(100u, vec->capacity);
+    EXPECT_EQ(0u, vec->count);
+
+    void* data = vec->data;
+    for(int i = 0; i != 100; ++i)
+        *(int*)unordered_vector_push_emplace(vec) = i;
+    EXPECT_EQ(data, vec->data);
+
+    /* smaller than capacity does nothing */
+    EXPECT_NE(0, unordered_vector_reserve(vec, 10));
+    EXPECT_EQ(100u, vec->capacity);
+
+    EXPECT_NE(0, unordered_vector_reserve(vec, 200));
+    EXPECT_EQ(200u, vec->capacity);
+    for(int i = 0; i != 100; ++i)
+        EXPECT_EQ(i, *(int*)unordered_vector_get_element(vec, i));
+
+    unordered_vector_destroy(vec);
+}
+
+TEST(NAME, shrink_to_fit)
+{
+    struct unordered_vector_t* vec = unordered_vector_create(sizeof(int));
+    for(int i = 0; i != 100; ++i)
+        *(int*)unordered_vector_push_emplace(vec) = i;
+    while(vec->count > 10)
+        unordered_vector_erase_index(vec, vec->count - 1);
+
+    EXPECT_NE(0, unordered_vector_shrink_to_fit(vec));
+    EXPECT_EQ(10u, vec->capacity);
+    for(int i = 0; i != 10; ++i)
+        EXPECT_EQ(i, *(int*)unordered_vector_get_element(vec, i));
+
+    unordered_vector_clear(vec);
+    EXPECT_NE(0, unordered_vector_shrink_to_fit(vec));
+    EXPECT_EQ(0u, vec->capacity);
+    EXPECT_EQ(NULL, vec->data);
+
+    unordered_vector_destroy(vec);
+}
+
+TEST(NAME, growth_factor)
+{
+    struct unordered_vector_t* vec = unordered_vector_create(sizeof(int));
+    unordered_vector_set_growth_factor(vec, 1.5f);
+    unordered_vector_reserve(vec, 10);
+    while(vec->count < vec->capacity)
+        unordered_vector_push_emplace(vec);
+    unordered_vector_push_emplace(vec);
+    EXPECT_EQ(15u, vec->capacity);
+    unordered_vector_destroy(vec);
+}
+
+TEST(NAME, inline_storage)
+{
+    struct unordered_vector_t vec;
+    int buffer[4];
+    unordered_vector_init_inline(&vec, sizeof(int), buffer, 4);
+    EXPECT_EQ((DATA_POINTER_TYPE*)buffer, vec.data);
+    EXPECT_EQ(4u, vec.capacity);
+
+    for(int i = 0; i != 4; ++i)
+        *(int*)unordered_vector_push_emplace(&vec) = i;
+    EXPECT_EQ((DATA_POINTER_TYPE*)buffer, vec.data);
+
+    /* spills to the heap */
+    *(int*)unordered_vector_push_emplace(&vec) = 4;
+    EXPECT_NE((DATA_POINTER_TYPE*)buffer, vec.data);
+    EXPECT_EQ(8u, vec.capacity);
+    for(int i = 0; i != 5; ++i)
+        EXPECT_EQ(i, *(int*)unordered_vector_get_element(&vec, i));
+
+    /* moves back into the inline buffer */
+    unordered_vector_erase_index(&vec, 4);
+    unordered_vector_erase_index(&vec, 3);
+    EXPECT_NE(0, unordered_vector_shrink_to_fit(&vec));
+    EXPECT_EQ((DATA_POINTER_TYPE*)buffer, vec.data);
+    EXPECT_EQ(4u, vec.capacity);
+    for(int i = 0; i != 3; ++i)
+        EXPECT_EQ(i, *(int*)unordered_vector_get_element(&vec, i));
+
+    /* inline buffer is never freed */
+    unordered_vector_clear_free(&vec);
+    EXPECT_EQ((DATA_POINTER_TYPE*)buffer, vec.data);
+    EXPECT_EQ(4u, vec.capacity);
+    EXPECT_EQ(0u, vec.count);
+}
@@ -0,0 +1,84 @@
+/*!
+ * @file allocator.h
+ * @brief Pluggable memory allocation interface for the util containers.
+ * @page allocator Allocators
+ *
+ * By default every container allocates its memory through the global
+ * MALLOC() and FREE() macros (see util/memory.h). If a container is
+ * initialised with one of the *_init_with_allocator() functions instead, all
+ * of its internal allocations are routed through the specified allocator.
+ * This makes it possible to place containers into arenas or pools (see
+ * @ref arena), which can then be torn down all at once.
+ *
+ * Passing NULL as the allocator selects the default global behaviour.
+ * @{
+ */
+
+#ifndef UTIL_ALLOCATOR_H
+#define UTIL_ALLOCATOR_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include "util/memory.h"
+
+C_HEADER_BEGIN
+
+typedef void* (*allocator_allocate_func)(void* user_data, uintptr_t size);
+typedef void* (*allocator_reallocate_func)(void* user_data, void* ptr, uintptr_t size);
+typedef void (*allocator_deallocate_func)(void* user_data, void* ptr);
+
+struct allocator_t
+{
+    /* Must return NULL on failure. */
+    allocator_allocate_func allocate;
+    /* Optional, can be NULL. Must leave ptr untouched and return NULL on
+     * failure. If NULL, containers fall back to allocate + copy + deallocate. */
+    allocator_reallocate_func reallocate;
+    /* Must accept any pointer previously returned by allocate/reallocate. */
+    allocator_deallocate_func deallocate;
+    /* Passed to every callback. */
+    void* user_data;
+};
+
+/*!
+ * @brief Allocates memory using the specified allocator, or using MALLOC() if
+ * the allocator is NULL.
+ * @param[in] allocator The allocator to use. Can be NULL.
+ * @param[in] size Number of bytes to allocate.
+ * @param[in] where String literal naming the calling function. Only used for
+ * the error message printed by MALLOC().
+ */
+#define ALLOCATOR_MALLOC(allocator, size, where)                               \
+    ((allocator) ? (allocator)->allocate((allocator)->user_data, size)        \
+                 : MALLOC(size, where))
+
+/*!
+ * @brief Reallocates memory using the specified allocator, or using REALLOC()
+ * if the allocator is NULL. Only valid if ALLOCATOR_CAN_REALLOC() is true.
+ */
+#define ALLOCATOR_REALLOC(allocator, ptr, size, where)                         \
+    ((allocator) ? (allocator)->reallocate((allocator)->user_data, ptr, size) \
+                 : REALLOC(ptr, size, where))
+
+/*!
+ * @brief Evaluates to true if the allocator is able to resize memory.
+ * Otherwise callers must allocate, copy and free themselves.
+ */
+#define ALLOCATOR_CAN_REALLOC(allocator) (!(allocator) || (allocator)->reallocate)
+
+/*!
+ * @brief Frees memory previously allocated with ALLOCATOR_MALLOC() using the
+ * same allocator.
+ */
+#define ALLOCATOR_FREE(allocator, ptr) do {                                    \
+        if(allocator)                                                          \
+            (allocator)->deallocate((allocator)->user_data, ptr);              \
+        else                                                                   \
+            FREE(ptr);                                                         \
+    } while(0)
+
+C_HEADER_END
+
+#endif /* UTIL_ALLOCATOR_H */
+
+/** @} */
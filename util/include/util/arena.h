@@ -0,0 +1,104 @@
+/*!
+ * @file arena.h
+ * @brief Linear (bump pointer) allocator for short-lived groups of objects.
+ * @page arena Arena
+ *
+ * An arena hands out memory by advancing a pointer through large blocks
+ * which it requests from MALLOC(). Individual allocations are never freed;
+ * instead, the entire arena is reset or released at once. This makes
+ * allocation very cheap and tear-down O(number of blocks) instead of
+ * O(number of allocations).
+ *
+ * Arenas expose an @ref allocator so they can be passed to any of the
+ * *_init_with_allocator() functions of the util containers:
+ * ```
+ * struct arena_t arena;
+ * struct ptree_t tree;
+ * arena_init(&arena, 64 * 1024);
+ * ptree_init_with_allocator(&tree, NULL, &arena.allocator);
+ * ... build tree ...
+ * arena_clear_free(&arena); // tree and all of its nodes and keys are gone
+ * ```
+ * @note Containers using an arena will still call deallocate() when they
+ * shrink or erase elements. This memory is not reclaimed until the arena is
+ * cleared.
+ * @{
+ */
+
+#ifndef UTIL_ARENA_H
+#define UTIL_ARENA_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include "util/allocator.h"
+
+C_HEADER_BEGIN
+
+struct arena_block_t;
+
+struct arena_t
+{
+    struct allocator_t allocator;   /* pass &arena->allocator to containers */
+    struct arena_block_t* blocks;   /* linked list of blocks, most recent first */
+    uintptr_t block_size;           /* size of newly allocated blocks in bytes */
+};
+
+/*!
+ * @brief Creates a new arena object.
+ * @param[in] block_size How many bytes to request from MALLOC() at a time.
+ * Allocations larger than this get a dedicated block.
+ * @return Returns the new arena, or NULL if allocation failed.
+ */
+UTIL_PUBLIC_API struct arena_t*
+arena_create(uintptr_t block_size);
+
+/*!
+ * @brief Initialises an existing arena object. No memory is allocated until
+ * the first allocation request.
+ * @param[in] arena The arena to initialise.
+ * @param[in] block_size How many bytes to request from MALLOC() at a time.
+ */
+UTIL_PUBLIC_API void
+arena_init(struct arena_t* arena, uintptr_t block_size);
+
+/*!
+ * @brief Frees all memory held by the arena and the arena object itself.
+ */
+UTIL_PUBLIC_API void
+arena_destroy(struct arena_t* arena);
+
+/*!
+ * @brief Invalidates all allocations made from the arena but keeps the most
+ * recently allocated block around for re-use.
+ */
+UTIL_PUBLIC_API void
+arena_clear(struct arena_t* arena);
+
+/*!
+ * @brief Invalidates all allocations made from the arena and frees all of
+ * its blocks.
+ */
+UTIL_PUBLIC_API void
+arena_clear_free(struct arena_t* arena);
+
+/*!
+ * @brief Allocates memory from the arena. The returned memory is aligned to
+ * the largest fundamental type.
+ * @return Returns NULL if a new block was required and MALLOC() failed.
+ */
+UTIL_PUBLIC_API void*
+arena_alloc(struct arena_t* arena, uintptr_t size);
+
+/*!
+ * @brief Allocates memory from the arena without any alignment. Packs small
+ * objects which don't need it (such as strings) tightly.
+ * @return Returns NULL if a new block was required and MALLOC() failed.
+ */
+UTIL_PUBLIC_API void*
+arena_alloc_unaligned(struct arena_t* arena, uintptr_t size);
+
+C_HEADER_END
+
+#endif /* UTIL_ARENA_H */
+
+/** @} */
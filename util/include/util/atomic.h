@@ -0,0 +1,59 @@
+/*!
+ * @file atomic.h
+ * @brief Atomic loads and stores for lock-free code shared between threads.
+ *
+ * C89 has no atomics, so these map onto the compiler's builtins. They work
+ * on naturally aligned 32-bit integers and pointers, which must be declared
+ * volatile.
+ *
+ * The acquire and release variants order other memory accesses around the
+ * atomic one. A release store makes every write before it visible to a
+ * thread which sees the stored value through an acquire load. Relaxed
+ * accesses are only atomic and order nothing else, so use them for values
+ * only the calling thread writes.
+ *
+ * The read-modify-write operations ATOMIC_CAS() and ATOMIC_FETCH_ADD() only
+ * work on 32-bit integers and are full barriers. ATOMIC_CAS() returns
+ * non-zero if *p was equal to expected and has been replaced by desired.
+ * ATOMIC_FETCH_ADD() returns the value *p had before the addition.
+ * ATOMIC_FENCE() is a full barrier on its own, mainly needed to stop a store
+ * from being reordered with a later load.
+ */
+
+#ifndef UTIL_ATOMIC_H
+#define UTIL_ATOMIC_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define ATOMIC_LOAD_RELAXED(p)      __atomic_load_n(p, __ATOMIC_RELAXED)
+#   define ATOMIC_LOAD_ACQUIRE(p)      __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#   define ATOMIC_STORE_RELAXED(p, v)  __atomic_store_n(p, v, __ATOMIC_RELAXED)
+#   define ATOMIC_STORE_RELEASE(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#   define ATOMIC_CAS(p, expected, desired) \
+        __sync_bool_compare_and_swap(p, expected, desired)
+#   define ATOMIC_FETCH_ADD(p, v)      __sync_fetch_and_add(p, v)
+#   define ATOMIC_FENCE()              __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    /*
+     * Aligned loads and stores are atomic on x86, and with /volatile:ms
+     * (the default on x86) the compiler gives volatile reads acquire and
+     * volatile writes release semantics. This is why variables accessed
+     * with these macros must be declared volatile.
+     */
+#   define ATOMIC_LOAD_RELAXED(p)      (*(p))
+#   define ATOMIC_LOAD_ACQUIRE(p)      (*(p))
+#   define ATOMIC_STORE_RELAXED(p, v)  (*(p) = (v))
+#   define ATOMIC_STORE_RELEASE(p, v)  (*(p) = (v))
+#   include <intrin.h>
+#   define ATOMIC_CAS(p, expected, desired) \
+        (_InterlockedCompareExchange((volatile long*)(p), (long)(desired), (long)(expected)) == (long)(expected))
+#   define ATOMIC_FETCH_ADD(p, v) \
+        ((uint32_t)_InterlockedExchangeAdd((volatile long*)(p), (long)(v)))
+#   define ATOMIC_FENCE()              _mm_mfence()
+#else
+#   error "Atomics aren't implemented for this compiler"
+#endif
+
+#endif /* UTIL_ATOMIC_H */
@@ -14,6 +14,8 @@ C_HEADER_BEGIN
 
 extern const uint32_t MAP_INVALID_KEY;
 
+struct string_pool_t;
+
 struct bsthv_value_chain_t
 {
     char*                       key;
@@ -21,29 +23,51 @@ struct bsthv_value_chain_t
     struct bsthv_value_chain_t* next;
 };
 
-struct bsthv_key_value_t
+/*!
+ * @brief A key together with its length and hash.
+ *
+ * Computing the hash of a key means walking the whole string. Callers which
+ * look up the same key repeatedly can initialise a bsthv_key_t once and use
+ * the *_hashed() functions instead.
+ * @note The hash depends on the hash function set with
+ * bsthv_set_string_hash_func(). Keys must be initialised again after
+ * changing it.
+ */
+struct bsthv_key_t
 {
-    uint32_t                    hash;
-    struct bsthv_value_chain_t  value_chain;
+    const char* str;    /* not necessarily null terminated */
+    uint32_t    len;
+    uint32_t    hash;
 };
 
 struct bsthv_t
 {
-    struct ordered_vector_t     vector;  /* container for bsthv_key_value_t objects */
+    /*
+     * Hashes and value chains are stored in two parallel vectors. Searching
+     * only has to touch the hashes, so 16 of them fit into a cache line
+     * instead of 2 hash/chain pairs, and they can be compared with SIMD (see
+     * @ref key_search).
+     */
+    struct ordered_vector_t     hashes;  /* uint32_t, sorted */
+    struct ordered_vector_t     chains;  /* bsthv_value_chain_t, same order as the hashes */
+    struct string_pool_t*       key_pool; /* NULL if keys are allocated one by one */
     uint32_t count;
+    char owns_key_pool;
 };
 
 /*!
  * @brief Sets the function to use for computing the hash value of keys.
  * @param func The callback function to use. Must return a uint32_t and accept
- * the parameters "key" (string) and "len" (length of the string).
+ * the parameters "key" (string) and "len" (length of the string). The
+ * default is hash_wyhash32(), hash_jenkins_oaat() is the old one. Changing the
+ * function while a bsthv contains elements makes those elements unreachable.
  */
 UTIL_PUBLIC_API void
 bsthv_set_string_hash_func(uint32_t(*func)(const char*, uint32_t len));
 
 /*!
- * @brief Restores the default hash function used to compute the hash value of
- * keys.
+ * @brief Restores the default hash function (hash_wyhash32()) used to compute
+ * the hash value of keys.
  */
 UTIL_PUBLIC_API void
 bsthv_restore_default_hash_func(void);
@@ -55,6 +79,21 @@ bsthv_restore_default_hash_func(void);
 UTIL_PUBLIC_API uint32_t
 bsthv_hash_string(const char* str);
 
+/*!
+ * @brief Initialises a key from a null terminated string. The string is
+ * referenced, not copied.
+ */
+UTIL_PUBLIC_API void
+bsthv_key_init(struct bsthv_key_t* key, const char* str);
+
+/*!
+ * @brief Initialises a key from the first len characters of a string. The
+ * string doesn't have to be null terminated, which allows looking up parts
+ * of a longer string (such as the segments of a path) without copying them.
+ */
+UTIL_PUBLIC_API void
+bsthv_key_init_n(struct bsthv_key_t* key, const char* str, uint32_t len);
+
 /*!
  * @brief Creates a new bsthv object.
  * @return Returns the newly created bsthv object. It must be freed with
@@ -73,6 +112,38 @@ bsthv_create(void);
 UTIL_PUBLIC_API void
 bsthv_init(struct bsthv_t* bsthv);
 
+/*!
+ * @brief Initialises an existing bsthv object and makes it use the specified
+ * allocator for all of its internal memory. The key strings copied
+ * into the bsthv and the collision chains are allocated with it too.
+ * @note This does **not** FREE existing elements.
+ * @param[in] bsthv The bsthv object to initialise.
+ * @param[in] allocator The allocator to use. Must outlive the bsthv. If NULL,
+ * the global MALLOC() and FREE() are used (same as bsthv_init()).
+ */
+UTIL_PUBLIC_API void
+bsthv_init_with_allocator(struct bsthv_t* bsthv,
+                          const struct allocator_t* allocator);
+
+/*!
+ * @brief Makes the bsthv intern its keys into a string pool instead of
+ * allocating every key separately (see @ref string_pool).
+ *
+ * Keys are then copied into the pool's blocks and never freed individually.
+ * Erasing an element leaves its key in the pool until the pool is cleared.
+ * Looking up a key using the pool's copy of the string is a pointer compare.
+ * @note Collision chains are still allocated with the bsthv's allocator. Use
+ * bsthv_init_with_allocator() with an @ref arena to avoid those too.
+ * @param[in] bsthv The bsthv. Must be empty.
+ * @param[in] pool The pool to use. It can be shared by any number of
+ * containers and must outlive all of them. If NULL, the bsthv creates a
+ * private pool. bsthv_clear() resets the private pool, and bsthv_clear_free()
+ * frees it, after which keys are allocated one by one again.
+ * @return Returns 1 on success, 0 if the private pool could not be allocated.
+ */
+UTIL_PUBLIC_API char
+bsthv_set_string_pool(struct bsthv_t* bsthv, struct string_pool_t* pool);
+
 /*!
  * @brief Destroys an existing bsthv object and FREEs the underlying memory.
  * @note Elements inserted into the bsthv are not FREEd.
@@ -98,6 +169,12 @@ bsthv_destroy(struct bsthv_t* bsthv);
 UTIL_PUBLIC_API char
 bsthv_insert(struct bsthv_t* bsthv, const char* key, void* value);
 
+/*!
+ * @brief Same as bsthv_insert(), but uses a key with a precomputed hash.
+ */
+UTIL_PUBLIC_API char
+bsthv_insert_hashed(struct bsthv_t* bsthv, const struct bsthv_key_t* key, void* value);
+
 /*!
  * @brief Sets the value bsthvped to the specified hash in the bsthv.
  * @note If the hash is not found, this function silently fails.
@@ -122,6 +199,21 @@ bsthv_set(struct bsthv_t* bsthv, const char* key, void* value);
 UTIL_PUBLIC_API void*
 bsthv_find(const struct bsthv_t* bsthv, const char* key);
 
+/*!
+ * @brief Same as bsthv_find(), but uses a key with a precomputed hash.
+ */
+UTIL_PUBLIC_API void*
+bsthv_find_hashed(const struct bsthv_t* bsthv, const struct bsthv_key_t* key);
+
+/*!
+ * @brief Looks up a key and returns the bsthv's own copy of it. The copy
+ * stays at the same address until the element is erased, so containers of
+ * containers (such as ptree) can keep it as a back-reference to their key.
+ * @return Returns the stored key, or NULL if the key doesn't exist.
+ */
+UTIL_PUBLIC_API const char*
+bsthv_find_key_hashed(const struct bsthv_t* bsthv, const struct bsthv_key_t* key);
+
 /*!
  * @brief Finds the specified element in the bsthv and returns its key.
  * @note Complexity is O(n).
@@ -152,6 +244,12 @@ bsthv_get_any_element(const struct bsthv_t* bsthv);
 UTIL_PUBLIC_API char
 bsthv_key_exists(struct bsthv_t* bsthv, const char* key);
 
+/*!
+ * @brief Same as bsthv_key_exists(), but uses a key with a precomputed hash.
+ */
+UTIL_PUBLIC_API char
+bsthv_key_exists_hashed(const struct bsthv_t* bsthv, const struct bsthv_key_t* key);
+
 /*!
  * @brief Erases an element from the bsthv using a key.
  * @note Complexity is O(log2(n))
@@ -169,10 +267,15 @@ bsthv_erase(struct bsthv_t* bsthv, const char* key);
 UTIL_PUBLIC_API void*
 bsthv_erase_element(struct bsthv_t* bsthv, void* value);
 
+/*!
+ * @brief Erases the element with the specified key from the value chain at
+ * the specified position in the sorted order. Used by
+ * BSTHV_ERASE_CURRENT_ITEM_IN_FOR_LOOP.
+ * @return Returns the value of the erased element, or NULL if the key was not
+ * found in that chain.
+ */
 UTIL_PUBLIC_API void*
-bsthv_erase_key_value_object(struct bsthv_t* bsthv,
-                             const char* key,
-                             struct bsthv_key_value_t* kv);
+bsthv_erase_index(struct bsthv_t* bsthv, uint32_t index, const char* key);
 
 /*!
  * @brief Erases the entire bsthv, including the underlying memory.
@@ -204,13 +307,10 @@ bsthv_clear_free(struct bsthv_t* bsthv);
  */
 #define BSTHV_FOR_EACH(bsthv_v, var_t, key_v, var_v) {                                        \
     uint32_t i_##var_v;                                                                       \
-    struct bsthv_key_value_t* kv_##var_v;                                                     \
     var_t* var_v;                                                                             \
-    for(i_##var_v = 0;                                                                        \
-        i_##var_v != (bsthv_v)->vector.count &&                                               \
-            (kv_##var_v = (((struct bsthv_key_value_t*)(bsthv_v)->vector.data) + i_##var_v)); \
-        ++i_##var_v) {                                                                        \
-        struct bsthv_value_chain_t* vc_##var_v = &(kv_##var_v)->value_chain;                  \
+    for(i_##var_v = 0; i_##var_v != (bsthv_v)->hashes.count; ++i_##var_v) {                  \
+        struct bsthv_value_chain_t* vc_##var_v =                                              \
+            ((struct bsthv_value_chain_t*)(bsthv_v)->chains.data) + i_##var_v;                \
         const char* key_v;                                                                    \
         for(; vc_##var_v &&                                                                   \
             ((key_v = (vc_##var_v)->key) || 1) &&                                             \
@@ -223,7 +323,7 @@ bsthv_clear_free(struct bsthv_t* bsthv);
 #define BSTHV_END_EACH }}}
 
 #define BSTHV_ERASE_CURRENT_ITEM_IN_FOR_LOOP(bsthv_v, key_v, var_v) do { \
-    bsthv_erase_key_value_object(bsthv_v, key_v, ((struct bsthv_key_value_t*)(bsthv_v)->vector.data) + i_##var_v); \
+    bsthv_erase_index(bsthv_v, i_##var_v, key_v); \
     --i_##var_v; } while(0)
 
 C_HEADER_END
@@ -22,7 +22,25 @@ struct bstv_hash_value_t
 
 struct bstv_t
 {
-    struct ordered_vector_t   vector;
+    /*
+     * Hashes and values are stored in two parallel vectors. Searching only
+     * has to touch the hashes, so 16 of them fit into a cache line instead
+     * of 4 hash/value pairs, and they can be compared with SIMD (see
+     * @ref key_search).
+     */
+    struct ordered_vector_t   hashes;  /* uint32_t, sorted */
+    struct ordered_vector_t   values;  /* void*, same order as the hashes */
+
+    /*
+     * Optional read optimised copy of the hashes in Eytzinger (BFS) order,
+     * see bstv_optimise_for_reads(). The sorted vectors above always remain
+     * the authoritative storage.
+     */
+    uint32_t* eytzinger_hashes;  /* 1-based, hashes[0] is unused */
+    void**    eytzinger_values;  /* values in the same order as the hashes */
+    void*     eytzinger_block;   /* allocation holding both arrays */
+    char      read_optimised;    /* set by bstv_optimise_for_reads() */
+    char      eytzinger_dirty;   /* vectors were modified since the last rebuild */
 };
 
 /*!
@@ -43,6 +61,18 @@ bstv_create(void);
 UTIL_PUBLIC_API void
 bstv_init(struct bstv_t* bstv);
 
+/*!
+ * @brief Initialises an existing bstv object and makes it use the specified
+ * allocator for all of its internal memory.
+ * @note This does **not** FREE existing elements.
+ * @param[in] bstv The bstv object to initialise.
+ * @param[in] allocator The allocator to use. Must outlive the bstv. If NULL,
+ * the global MALLOC() and FREE() are used (same as bstv_init()).
+ */
+UTIL_PUBLIC_API void
+bstv_init_with_allocator(struct bstv_t* bstv,
+                         const struct allocator_t* allocator);
+
 /*!
  * @brief Destroys an existing bstv object and FREEs the underlying memory.
  * @note Elements inserted into the bstv are not FREEd.
@@ -71,6 +101,27 @@ bstv_destroy(struct bstv_t* bstv);
 UTIL_PUBLIC_API char
 bstv_insert(struct bstv_t* bstv, uint32_t hash, void* value);
 
+/*!
+ * @brief Replaces the contents of the bstv with the specified hash/value
+ * pairs, which can be in any order.
+ *
+ * This is much faster than calling bstv_insert() for every pair, which has
+ * to shift existing elements on every insertion (O(n^2) overall). Here the
+ * pairs are copied once and radix sorted, which is O(n).
+ * @note If a hash appears more than once, the first pair is kept and the
+ * others are dropped, just like bstv_insert() would. Pairs using the
+ * reserved hash 0xFFFFFFFF are dropped too.
+ * @param[in] bstv The bstv to fill. Existing elements are removed.
+ * @param[in] pairs Array of hash/value pairs.
+ * @param[in] count Number of pairs in the array.
+ * @return Returns 1 on success, 0 if memory allocation failed. In this case
+ * the bstv is left unchanged.
+ */
+UTIL_PUBLIC_API char
+bstv_build_from_unsorted(struct bstv_t* bstv,
+                         const struct bstv_hash_value_t* pairs,
+                         uint32_t count);
+
 /*!
  * @brief Sets the value bstvped to the specified hash in the bstv.
  * @note If the hash is not found, this function silently fails.
@@ -126,8 +177,9 @@ UTIL_PUBLIC_API char
 bstv_hash_exists(struct bstv_t* bstv, uint32_t hash);
 
 /*!
- * @brief Returns a hash that does not yet exist in the bstv.
- * @note Complexity is O(n)
+ * @brief Returns the lowest hash that does not yet exist in the bstv.
+ * @note Complexity is O(log2(n)). To hand out IDs, an @ref id_allocator
+ * doesn't need the bstv at all and is O(1).
  * @param[in] bstv The bstv to generate a hash from.
  * @return Returns a hash that does not yet exist in the bstv.
  */
@@ -155,6 +207,15 @@ bstv_erase(struct bstv_t* bstv, uint32_t hash);
 UTIL_PUBLIC_API void*
 bstv_erase_element(struct bstv_t* bstv, void* value);
 
+/*!
+ * @brief Erases the element at the specified position in the sorted order.
+ * Used by BSTV_ERASE_CURRENT_ITEM_IN_FOR_LOOP.
+ * @return Returns the value of the erased element, or NULL if the index is
+ * out of range.
+ */
+UTIL_PUBLIC_API void*
+bstv_erase_index(struct bstv_t* bstv, uint32_t index);
+
 /*!
  * @brief Erases the entire bstv, including the underlying memory.
  * @note This does **not** FREE existing elements. If you have elements in your
@@ -168,12 +229,45 @@ bstv_clear(struct bstv_t* bstv);
 UTIL_PUBLIC_API void
 bstv_clear_free(struct bstv_t* bstv);
 
+/*!
+ * @brief Switches the bstv into read optimised mode and builds the
+ * read optimised index immediately.
+ *
+ * A normal bstv binary searches the sorted hashes, where almost every probe
+ * is a cache miss once the bstv grows past the cache size. In read optimised
+ * mode the hashes are additionally stored in Eytzinger (breadth-first)
+ * order. The first levels of
+ * the implicit tree share a few cache lines, the search is branchless and
+ * the cache line holding the next four levels is prefetched while the
+ * current level is compared.
+ *
+ * bstv_find() and bstv_hash_exists() use the index. Every other function
+ * operates on the sorted vectors as usual and marks the index as stale, which
+ * causes the next lookup to rebuild it (O(n)). This mode therefore pays off
+ * for bstvs which are built once (e.g. with bstv_build_from_unsorted()) or
+ * modified rarely and looked up often.
+ *
+ * @warning Rebuilding the index modifies the bstv. If several threads look
+ * up the same bstv, call this function again after modifying the bstv so
+ * lookups never have to rebuild.
+ * @return Returns 1 on success, 0 if memory allocation failed. In this case
+ * lookups fall back to the sorted vectors until the index can be rebuilt.
+ */
+UTIL_PUBLIC_API char
+bstv_optimise_for_reads(struct bstv_t* bstv);
+
+/*!
+ * @brief Leaves read optimised mode and frees the index.
+ */
+UTIL_PUBLIC_API void
+bstv_disable_read_optimisation(struct bstv_t* bstv);
+
 /*!
  * @brief Returns the number of elements in the specified bstv.
  * @param[in] bstv The bstv to count the elements of.
  * @return The number of elements in the specified bstv.
  */
-#define bstv_count(bstv) ((bstv)->vector.count)
+#define bstv_count(bstv) ((bstv)->hashes.count)
 
 /*!
  * @brief Iterates over the specified bstv's elements and opens a FOR_EACH
@@ -183,14 +277,14 @@ bstv_clear_free(struct bstv_t* bstv);
  * @param[in] var The name to give the variable pointing to the current
  * element.
  */
-#define BSTV_FOR_EACH(bstv, var_t, hash_v, var_v) {                                                                 \
-    uint32_t i_##var_v;                                                                                  \
-    uint32_t hash_v;                                                                                                 \
-    var_t* var_v;                                                                                                   \
-    for(i_##var_v = 0;                                                                                   \
-        i_##var_v != bstv_count(bstv) &&                                                                 \
-            ((hash_v = ((struct bstv_hash_value_t*) (bstv)->vector.data)[i_##var_v].hash) || 1) &&        \
-            ((var_v  = (var_t*)((struct bstv_hash_value_t*)(bstv)->vector.data)[i_##var_v].value) || 1); \
+#define BSTV_FOR_EACH(bstv, var_t, hash_v, var_v) {                             \
+    uint32_t i_##var_v;                                                         \
+    uint32_t hash_v;                                                            \
+    var_t* var_v;                                                               \
+    for(i_##var_v = 0;                                                          \
+        i_##var_v != bstv_count(bstv) &&                                        \
+            ((hash_v = ((uint32_t*)(bstv)->hashes.data)[i_##var_v]) || 1) &&    \
+            ((var_v  = (var_t*)((void**)(bstv)->values.data)[i_##var_v]) || 1); \
         ++i_##var_v) {
 
 /*!
@@ -206,7 +300,7 @@ bstv_clear_free(struct bstv_t* bstv);
  * @param[in] bstv A pointer to the bstv object currently being iterated.
  */
 #define BSTV_ERASE_CURRENT_ITEM_IN_FOR_LOOP(bstv, var_v) do { \
-    ordered_vector_erase_element(&(bstv)->vector, ((struct bstv_hash_value_t*)(bstv)->vector.data) + i_##var_v); \
+    bstv_erase_index(bstv, i_##var_v); \
     --i_##var_v; } while(0)
 
 C_HEADER_END
@@ -0,0 +1,189 @@
+/*!
+ * @file bst_vector64.h
+ * @brief Same as @ref bst_vector.h, but with 64-bit keys.
+ *
+ * bstv truncates its keys to 32 bits, which loses information when the keys
+ * are pointers or other 64-bit identifiers. bstv64 keeps the whole key.
+ *
+ * Keys and values are stored as pairs in a single ordered vector. The
+ * typical use is looking up a record by its address, where every successful
+ * search needs the value anyway, and it keeps the container down to a
+ * single allocation.
+ */
+
+#ifndef UTIL_BST_VECTOR64_H
+#define UTIL_BST_VECTOR64_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include "util/ordered_vector.h"
+
+C_HEADER_BEGIN
+
+/*! Reserved key, returned by bstv64_find_element() if nothing was found. */
+#define BST_VECTOR64_INVALID_KEY ((uint64_t)-1)
+
+struct bstv64_key_value_t
+{
+    uint64_t key;
+    void*    value;
+};
+
+struct bstv64_t
+{
+    struct ordered_vector_t vector;  /* bstv64_key_value_t, sorted by key */
+};
+
+/*!
+ * @brief Creates a new bstv64 object.
+ * @return Returns the newly created bstv64 object. It must be freed with
+ * bstv64_destroy() when no longer required.
+ */
+UTIL_PUBLIC_API struct bstv64_t*
+bstv64_create(void);
+
+/*!
+ * @brief Initialises an existing bstv64 object.
+ * @note This does **not** FREE existing elements.
+ * @param[in] bstv The bstv64 object to initialise.
+ */
+UTIL_PUBLIC_API void
+bstv64_init(struct bstv64_t* bstv);
+
+/*!
+ * @brief Initialises an existing bstv64 object and makes it use the specified
+ * allocator for all of its internal memory.
+ * @note This does **not** FREE existing elements.
+ * @param[in] bstv The bstv64 object to initialise.
+ * @param[in] allocator The allocator to use. Must outlive the bstv64. If NULL,
+ * the global MALLOC() and FREE() are used (same as bstv64_init()).
+ */
+UTIL_PUBLIC_API void
+bstv64_init_with_allocator(struct bstv64_t* bstv,
+                           const struct allocator_t* allocator);
+
+/*!
+ * @brief Destroys an existing bstv64 object and FREEs the underlying memory.
+ * @note Elements inserted into the bstv64 are not FREEd.
+ * @param[in] bstv The bstv64 object to destroy.
+ */
+UTIL_PUBLIC_API void
+bstv64_destroy(struct bstv64_t* bstv);
+
+/*!
+ * @brief Inserts an element into the bstv64.
+ * @note Complexity is O(log2(n)) to find the insertion point.
+ * @param[in] bstv The bstv64 object to insert into.
+ * @param[in] key A unique key to assign to the element being inserted. The
+ * key must not exist in the bstv64 and must not be BST_VECTOR64_INVALID_KEY,
+ * or the element will not be inserted.
+ * @param[in] value The data to insert. It is only referenced, not copied.
+ * @return Returns 1 if insertion was successful, 0 if otherwise.
+ */
+UTIL_PUBLIC_API char
+bstv64_insert(struct bstv64_t* bstv, uint64_t key, void* value);
+
+/*!
+ * @brief Sets the value mapped to the specified key.
+ * @note If the key is not found, this function silently fails.
+ */
+UTIL_PUBLIC_API void
+bstv64_set(struct bstv64_t* bstv, uint64_t key, void* value);
+
+/*!
+ * @brief Looks for an element in the bstv64 and returns it if found.
+ * @note Complexity is O(log2(n)).
+ * @return Returns the data associated with the specified key, or NULL if the
+ * key doesn't exist. Use bstv64_key_exists() to tell a missing key apart from
+ * a NULL value.
+ */
+UTIL_PUBLIC_API void*
+bstv64_find(const struct bstv64_t* bstv, uint64_t key);
+
+/*!
+ * @brief Finds the specified element in the bstv64 and returns its key.
+ * @note Complexity is O(n).
+ * @return Returns the key if the value was found, BST_VECTOR64_INVALID_KEY if
+ * otherwise.
+ */
+UTIL_PUBLIC_API uint64_t
+bstv64_find_element(const struct bstv64_t* bstv, const void* value);
+
+/*!
+ * @brief Returns 1 if the specified key exists, 0 if otherwise.
+ */
+UTIL_PUBLIC_API char
+bstv64_key_exists(const struct bstv64_t* bstv, uint64_t key);
+
+/*!
+ * @brief Erases an element from the bstv64 using a key.
+ * @note Complexity is O(log2(n)) to find the element.
+ * @return Returns the data associated with the specified key, or NULL if the
+ * key was not found. The value itself is **not** FREEd.
+ */
+UTIL_PUBLIC_API void*
+bstv64_erase(struct bstv64_t* bstv, uint64_t key);
+
+/*!
+ * @brief Erases the element at the specified position in the sorted order.
+ * Used by BSTV64_ERASE_CURRENT_ITEM_IN_FOR_LOOP.
+ * @return Returns the value of the erased element, or NULL if the index is
+ * out of range.
+ */
+UTIL_PUBLIC_API void*
+bstv64_erase_index(struct bstv64_t* bstv, uint32_t index);
+
+/*!
+ * @brief Erases all elements but keeps the underlying memory.
+ * @note This does **not** FREE the values.
+ */
+UTIL_PUBLIC_API void
+bstv64_clear(struct bstv64_t* bstv);
+
+/*!
+ * @brief Erases all elements and FREEs the underlying memory.
+ * @note This does **not** FREE the values.
+ */
+UTIL_PUBLIC_API void
+bstv64_clear_free(struct bstv64_t* bstv);
+
+/*!
+ * @brief Returns the number of elements in the specified bstv64.
+ */
+#define bstv64_count(bstv) ((bstv)->vector.count)
+
+/*!
+ * @brief Iterates over the specified bstv64's elements in key order and
+ * opens a FOR_EACH scope.
+ * @param[in] bstv The bstv64 to iterate.
+ * @param[in] var_t The type of data being held in the bstv64.
+ * @param[in] key_v The name to give the variable holding the current key.
+ * @param[in] var_v The name to give the variable pointing to the current
+ * element.
+ */
+#define BSTV64_FOR_EACH(bstv, var_t, key_v, var_v) {                            \
+    uint32_t i_##var_v;                                                         \
+    uint64_t key_v;                                                             \
+    var_t* var_v;                                                               \
+    for(i_##var_v = 0;                                                          \
+        i_##var_v != bstv64_count(bstv) &&                                      \
+            ((key_v = ((struct bstv64_key_value_t*)(bstv)->vector.data)[i_##var_v].key) || 1) && \
+            ((var_v = (var_t*)((struct bstv64_key_value_t*)(bstv)->vector.data)[i_##var_v].value) || 1); \
+        ++i_##var_v) {
+
+/*!
+ * @brief Closes a for each scope previously opened by BSTV64_FOR_EACH.
+ */
+#define BSTV64_END_EACH }}
+
+/*!
+ * @brief Erases the current element while iterating.
+ * @note This does not free the data being referenced by the bstv64.
+ */
+#define BSTV64_ERASE_CURRENT_ITEM_IN_FOR_LOOP(bstv, var_v) do { \
+    bstv64_erase_index(bstv, i_##var_v); \
+    --i_##var_v; } while(0)
+
+C_HEADER_END
+
+#endif /* UTIL_BST_VECTOR64_H */
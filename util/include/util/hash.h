@@ -1,3 +1,6 @@
+#ifndef UTIL_HASH_H
+#define UTIL_HASH_H
+
 #include "util/pstdint.h"
 #include "util/config.h"
 
@@ -12,7 +15,50 @@ C_HEADER_BEGIN
 UTIL_PUBLIC_API uint32_t
 hash_jenkins_oaat(const char* key, uint32_t len);
 
+/*!
+ * @brief wyhash (final version 4). Reads the key 8 bytes at a time instead of
+ * one byte at a time and is several times faster than hash_jenkins_oaat() for
+ * all but the shortest keys.
+ * @note The key does not have to be aligned. Words are read in the machine's
+ * byte order, so hashes differ between little and big endian machines. Don't
+ * store them anywhere.
+ * @param[in] key The data to hash.
+ * @param[in] len The length of the data in bytes.
+ * @param[in] seed Different seeds give unrelated hashes for the same key.
+ * @return Returns a 64-bit hash of the data.
+ */
+UTIL_PUBLIC_API uint64_t
+hash_wyhash64(const void* key, uint32_t len, uint64_t seed);
+
+/*!
+ * @brief Same as hash_wyhash64(), but uses the seed set with hash_set_seed()
+ * and folds the result to 32 bits. This has the same signature as
+ * hash_jenkins_oaat() and can be passed to bsthv_set_string_hash_func().
+ */
+UTIL_PUBLIC_API uint32_t
+hash_wyhash32(const char* key, uint32_t len);
+
+/*!
+ * @brief Sets the seed used by hash_wyhash32(). The default is 0.
+ *
+ * Seeding with something random on startup makes it harder for e.g. network
+ * peers to pick keys which all collide.
+ * @warning Containers store the hashes of their keys. Only change the seed
+ * before anything has been hashed with hash_wyhash32(), or after all
+ * containers using it have been cleared.
+ */
+UTIL_PUBLIC_API void
+hash_set_seed(uint64_t seed);
+
+/*!
+ * @brief Returns the seed used by hash_wyhash32().
+ */
+UTIL_PUBLIC_API uint64_t
+hash_get_seed(void);
+
 UTIL_PUBLIC_API
 void hash_sha256(const char* message, uint32_t len, uint32_t digest[8]);
 
 C_HEADER_END
+
+#endif /* UTIL_HASH_H */
@@ -0,0 +1,293 @@
+/*!
+ * @file hashmap.h
+ * @brief Open addressing hash map with string keys.
+ * @page hashmap Hash Map
+ *
+ * Same interface as @ref bst_hashed_vector.h, but implemented as a swiss
+ * table instead of a sorted vector. Insertion and lookup are O(1) on
+ * average, nothing has to be shifted around on insertion and there are no
+ * heap allocated collision chains.
+ *
+ * Every slot has a control byte. It is either empty, deleted (a tombstone)
+ * or holds the top 7 bits of the slot's hash. Slots are grouped into groups
+ * of HASHMAP_GROUP_WIDTH, and a lookup compares the control bytes of an
+ * entire group against the hash bits at once (with SSE2 where available).
+ * Only slots whose control byte matches have their stored 32-bit hash and
+ * key compared. A lookup ends at the first group containing an empty slot.
+ *
+ * Keys are copied into the map like with bsthv. The full hash of every key
+ * is stored in its slot, so growing the table never has to rehash the key
+ * strings and most mismatches are rejected without a strcmp().
+ *
+ * Unlike bsthv, elements are not iterated in any particular order and
+ * inserting may move every element (but never invalidates the value
+ * pointers themselves).
+ * @{
+ */
+
+#ifndef UTIL_HASHMAP_H
+#define UTIL_HASHMAP_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+
+C_HEADER_BEGIN
+
+struct allocator_t;
+
+/*! Number of slots probed at once. The capacity is always a multiple of it. */
+#define HASHMAP_GROUP_WIDTH 16
+
+/*! Control byte bit which is set for empty and deleted slots. */
+#define HASHMAP_CTRL_FREE_BIT 0x80
+#define HASHMAP_CTRL_EMPTY    0x80
+#define HASHMAP_CTRL_DELETED  0xFE
+
+/*!
+ * @brief A key together with its length and hash, for callers which look up
+ * the same key repeatedly. See the *_hashed() functions.
+ */
+struct hashmap_key_t
+{
+    const char* str;        /* not necessarily null terminated */
+    uint32_t len;
+    uint32_t hash;
+};
+
+/*
+ * The key, value and hash of a slot are kept together, so a successful
+ * lookup touches one control byte and one slot.
+ */
+struct hashmap_slot_t
+{
+    char* key;              /* copy of the key, owned by the map */
+    void* value;
+    uint32_t hash;
+};
+
+struct hashmap_t
+{
+    uint8_t* ctrl;          /* one control byte per slot */
+    struct hashmap_slot_t* slots;
+    void* block;            /* one allocation holding the slots and control bytes */
+    uint32_t capacity;      /* number of slots, 0 or a power of two >= HASHMAP_GROUP_WIDTH */
+    uint32_t count;
+    uint32_t growth_left;   /* empty slots that can still be used before growing */
+    const struct allocator_t* allocator;
+};
+
+/*!
+ * @brief Initialises a key from a null terminated string. The string is
+ * referenced, not copied.
+ */
+UTIL_PUBLIC_API void
+hashmap_key_init(struct hashmap_key_t* key, const char* str);
+
+/*!
+ * @brief Initialises a key from the first len characters of a string, which
+ * doesn't have to be null terminated.
+ */
+UTIL_PUBLIC_API void
+hashmap_key_init_n(struct hashmap_key_t* key, const char* str, uint32_t len);
+
+/*!
+ * @brief Creates a new hashmap object.
+ * @return Returns the newly created hashmap object. It must be freed with
+ * hashmap_destroy() when no longer required.
+ */
+UTIL_PUBLIC_API struct hashmap_t*
+hashmap_create(void);
+
+/*!
+ * @brief Initialises an existing hashmap object.
+ * @note This does **not** FREE existing elements.
+ */
+UTIL_PUBLIC_API void
+hashmap_init(struct hashmap_t* map);
+
+/*!
+ * @brief Initialises an existing hashmap object and makes it use the
+ * specified allocator for the table and for the copied keys.
+ * @param[in] allocator The allocator to use. Must outlive the hashmap. If NULL,
+ * the global MALLOC() and FREE() are used (same as hashmap_init()).
+ */
+UTIL_PUBLIC_API void
+hashmap_init_with_allocator(struct hashmap_t* map,
+                            const struct allocator_t* allocator);
+
+/*!
+ * @brief Destroys an existing hashmap object and FREEs the underlying memory.
+ * @note Elements inserted into the hashmap are not FREEd.
+ */
+UTIL_PUBLIC_API void
+hashmap_destroy(struct hashmap_t* map);
+
+/*!
+ * @brief Makes sure the specified number of elements can be held without
+ * growing the table.
+ * @return Returns 1 on success, 0 if memory allocation failed. In this case
+ * the hashmap is left unchanged.
+ */
+UTIL_PUBLIC_API char
+hashmap_reserve(struct hashmap_t* map, uint32_t count);
+
+/*!
+ * @brief Inserts an element into the hashmap by using a string as a key.
+ * @note Complexity is O(1) on average.
+ * @param[in] key A unique string to assign to the element being inserted. The
+ * string must not exist in the hashmap or the element will not be inserted.
+ * The string is copied.
+ * @param[in] value The data to insert into the hashmap. It is only
+ * referenced, not copied.
+ * @return Returns 1 if insertion was successful, 0 if the key already exists
+ * or if memory allocation failed. In both cases the hashmap is unchanged.
+ */
+UTIL_PUBLIC_API char
+hashmap_insert(struct hashmap_t* map, const char* key, void* value);
+
+/*!
+ * @brief Same as hashmap_insert(), but uses a key with a precomputed hash.
+ */
+UTIL_PUBLIC_API char
+hashmap_insert_hashed(struct hashmap_t* map, const struct hashmap_key_t* key, void* value);
+
+/*!
+ * @brief Sets the value associated with the specified key.
+ * @note If the key is not found, this function silently fails.
+ */
+UTIL_PUBLIC_API void
+hashmap_set(struct hashmap_t* map, const char* key, void* value);
+
+/*!
+ * @brief Looks for an element in the hashmap and returns it if found.
+ * @return Returns the value associated with the key, or NULL if the key
+ * doesn't exist. Use hashmap_key_exists() to tell a missing key apart from a
+ * NULL value.
+ */
+UTIL_PUBLIC_API void*
+hashmap_find(const struct hashmap_t* map, const char* key);
+
+/*!
+ * @brief Same as hashmap_find(), but uses a key with a precomputed hash.
+ */
+UTIL_PUBLIC_API void*
+hashmap_find_hashed(const struct hashmap_t* map, const struct hashmap_key_t* key);
+
+/*!
+ * @brief Looks up a key and returns the hashmap's own copy of it. The copy
+ * stays at the same address until the element is erased, even if the table
+ * grows.
+ * @return Returns the stored key, or NULL if the key doesn't exist.
+ */
+UTIL_PUBLIC_API const char*
+hashmap_find_key_hashed(const struct hashmap_t* map, const struct hashmap_key_t* key);
+
+/*!
+ * @brief Finds the specified element in the hashmap and returns its key.
+ * @note Complexity is O(n).
+ * @return Returns the key if the value was found, NULL if otherwise.
+ */
+UTIL_PUBLIC_API const char*
+hashmap_find_element(const struct hashmap_t* map, const void* value);
+
+/*!
+ * @brief Gets any element from the hashmap.
+ * @return Returns an element, or NULL if the hashmap is empty. Which element
+ * is undefined.
+ */
+UTIL_PUBLIC_API void*
+hashmap_get_any_element(const struct hashmap_t* map);
+
+/*!
+ * @brief Returns 1 if the specified key exists, 0 if otherwise.
+ */
+UTIL_PUBLIC_API char
+hashmap_key_exists(const struct hashmap_t* map, const char* key);
+
+/*!
+ * @brief Same as hashmap_key_exists(), but uses a key with a precomputed
+ * hash.
+ */
+UTIL_PUBLIC_API char
+hashmap_key_exists_hashed(const struct hashmap_t* map, const struct hashmap_key_t* key);
+
+/*!
+ * @brief Erases an element from the hashmap using a key.
+ * @return Returns the value associated with the key, or NULL if the key was
+ * not found. The value itself is **not** FREEd.
+ */
+UTIL_PUBLIC_API void*
+hashmap_erase(struct hashmap_t* map, const char* key);
+
+/*!
+ * @brief Erases the first element found with the specified value.
+ * @note Complexity is O(n).
+ * @return Returns the value if it was found, NULL if otherwise.
+ */
+UTIL_PUBLIC_API void*
+hashmap_erase_element(struct hashmap_t* map, void* value);
+
+/*!
+ * @brief Erases the element in the specified slot. Used by
+ * HASHMAP_ERASE_CURRENT_ITEM_IN_FOR_LOOP.
+ * @return Returns the value of the erased element.
+ */
+UTIL_PUBLIC_API void*
+hashmap_erase_slot(struct hashmap_t* map, uint32_t slot);
+
+/*!
+ * @brief Erases all elements but keeps the table allocated.
+ * @note This does **not** FREE the values.
+ */
+UTIL_PUBLIC_API void
+hashmap_clear(struct hashmap_t* map);
+
+/*!
+ * @brief Erases all elements and FREEs the table.
+ * @note This does **not** FREE the values.
+ */
+UTIL_PUBLIC_API void
+hashmap_clear_free(struct hashmap_t* map);
+
+/*!
+ * @brief Returns the number of elements in the specified hashmap.
+ */
+#define hashmap_count(map) ((map)->count)
+
+/*!
+ * @brief Iterates over the specified hashmap's elements and opens a FOR_EACH
+ * scope.
+ * @param[in] map_v The hashmap to iterate.
+ * @param[in] var_t The type of data being held in the hashmap.
+ * @param[in] key_v The name to give the variable holding the current key.
+ * @param[in] var_v The name to give the variable pointing to the current
+ * element.
+ */
+#define HASHMAP_FOR_EACH(map_v, var_t, key_v, var_v) {                           \
+    uint32_t i_##var_v;                                                         \
+    for(i_##var_v = 0; i_##var_v != (map_v)->capacity; ++i_##var_v) {          \
+        const char* key_v;                                                      \
+        var_t* var_v;                                                           \
+        if((map_v)->ctrl[i_##var_v] & HASHMAP_CTRL_FREE_BIT)                    \
+            continue;                                                           \
+        key_v = (map_v)->slots[i_##var_v].key;                                  \
+        var_v = (var_t*)(map_v)->slots[i_##var_v].value;                        \
+        (void)key_v; {
+
+/*!
+ * @brief Closes a for each scope previously opened by HASHMAP_FOR_EACH.
+ */
+#define HASHMAP_END_EACH }}}
+
+/*!
+ * @brief Erases the current element while iterating. Erasing never moves
+ * other elements, so iteration continues normally.
+ */
+#define HASHMAP_ERASE_CURRENT_ITEM_IN_FOR_LOOP(map_v, key_v, var_v) \
+    hashmap_erase_slot(map_v, i_##var_v)
+
+C_HEADER_END
+
+#endif /* UTIL_HASHMAP_H */
+
+/** @} */
@@ -0,0 +1,231 @@
+/*!
+ * @file heap.h
+ * @brief Min-heap priority queue with handles for changing priorities.
+ * @page heap Heap
+ *
+ * Elements are a value together with a signed 64-bit priority. The element
+ * with the smallest priority is always at the front. Timestamps in
+ * microseconds (see get_time_in_microseconds()) can be used as priorities
+ * directly, and path costs can be scaled to fixed point.
+ *
+ * The heap is 4-ary: node i has the children 4i+1 to 4i+4. This halves the
+ * height compared to a binary heap, and the four children of a node are
+ * next to each other in memory. Sifting down compares more elements per
+ * level, but they usually share one or two cache lines. Push, pop and
+ * changing a priority are O(log n), peeking is O(1) and building a heap from
+ * an array is O(n).
+ *
+ * Every element pushed into the heap is assigned a handle. The handle stays
+ * valid until the element is popped or erased, and can be used to decrease
+ * the priority of the element or to erase it from the middle of the heap.
+ * Handles of removed elements are reused for new elements.
+ * @{
+ */
+
+#ifndef UTIL_HEAP_H
+#define UTIL_HEAP_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include "util/ordered_vector.h"
+
+C_HEADER_BEGIN
+
+typedef uint32_t heap_handle_t;
+
+/*! Never assigned to an element. */
+#define HEAP_INVALID_HANDLE ((heap_handle_t)-1)
+
+/*! A value together with its priority. Used by heap_build(). */
+struct heap_item_t
+{
+    int64_t priority;
+    void*   value;
+};
+
+struct heap_node_t
+{
+    int64_t       priority;
+    void*         value;
+    heap_handle_t handle;
+};
+
+struct heap_t
+{
+    struct ordered_vector_t nodes;     /* heap_node_t in heap order */
+    /*
+     * One uint32_t per handle. For handles in use it is the index of the
+     * element in nodes. Unused handles form a free list: the entry has
+     * HEAP_FREE_BIT set and stores the next unused handle.
+     */
+    struct ordered_vector_t positions;
+    heap_handle_t free_handle;         /* first unused handle, or HEAP_INVALID_HANDLE */
+};
+
+/*!
+ * @brief Creates a new heap object.
+ * @return Returns the newly created heap object. It must be freed with
+ * heap_destroy() when no longer required.
+ */
+UTIL_PUBLIC_API struct heap_t*
+heap_create(void);
+
+/*!
+ * @brief Initialises an existing heap object.
+ * @note This does **not** FREE existing memory.
+ */
+UTIL_PUBLIC_API void
+heap_init(struct heap_t* heap);
+
+/*!
+ * @brief Initialises an existing heap object and makes it use the specified
+ * allocator for all of its internal memory.
+ * @param[in] allocator The allocator to use. Must outlive the heap. If NULL,
+ * the global MALLOC() and FREE() are used (same as heap_init()).
+ */
+UTIL_PUBLIC_API void
+heap_init_with_allocator(struct heap_t* heap,
+                         const struct allocator_t* allocator);
+
+/*!
+ * @brief Destroys an existing heap object and FREEs the underlying memory.
+ * @note The values are not FREEd.
+ */
+UTIL_PUBLIC_API void
+heap_destroy(struct heap_t* heap);
+
+/*!
+ * @brief Removes all elements but keeps the underlying memory. All handles
+ * become invalid.
+ */
+UTIL_PUBLIC_API void
+heap_clear(struct heap_t* heap);
+
+/*!
+ * @brief Removes all elements and FREEs the underlying memory.
+ */
+UTIL_PUBLIC_API void
+heap_clear_free(struct heap_t* heap);
+
+/*!
+ * @brief Makes sure the specified number of elements can be pushed without
+ * allocating memory.
+ * @return Returns 1 on success, 0 if memory allocation failed.
+ */
+UTIL_PUBLIC_API char
+heap_reserve(struct heap_t* heap, uint32_t count);
+
+/*!
+ * @brief Inserts an element.
+ * @note Complexity is O(log n).
+ * @param[in] priority The priority of the element. Smaller priorities are
+ * popped first. Elements of equal priority are popped in no particular
+ * order.
+ * @param[in] value The value to insert. It is only referenced, not copied.
+ * @param[out] handle If not NULL, the handle of the new element is written
+ * here.
+ * @return Returns 1 on success, 0 if memory allocation failed. In this case
+ * the heap is left unchanged.
+ */
+UTIL_PUBLIC_API char
+heap_push(struct heap_t* heap, int64_t priority, void* value, heap_handle_t* handle);
+
+/*!
+ * @brief Removes the element with the smallest priority.
+ * @return Returns the value of the removed element, or NULL if the heap is
+ * empty.
+ */
+UTIL_PUBLIC_API void*
+heap_pop(struct heap_t* heap);
+
+/*!
+ * @brief Returns the value of the element with the smallest priority
+ * without removing it, or NULL if the heap is empty.
+ */
+UTIL_PUBLIC_API void*
+heap_peek(const struct heap_t* heap);
+
+/*!
+ * @brief Returns the smallest priority in the heap.
+ * @warning The heap must not be empty.
+ */
+UTIL_PUBLIC_API int64_t
+heap_peek_priority(const struct heap_t* heap);
+
+/*!
+ * @brief Returns 1 if the handle refers to an element in the heap, 0 if
+ * otherwise.
+ * @note Handles are reused, so this can't detect a handle which was held on
+ * to after its element was removed.
+ */
+UTIL_PUBLIC_API char
+heap_contains(const struct heap_t* heap, heap_handle_t handle);
+
+/*!
+ * @brief Returns the value of the element with the specified handle.
+ */
+UTIL_PUBLIC_API void*
+heap_get(const struct heap_t* heap, heap_handle_t handle);
+
+/*!
+ * @brief Returns the priority of the element with the specified handle.
+ */
+UTIL_PUBLIC_API int64_t
+heap_get_priority(const struct heap_t* heap, heap_handle_t handle);
+
+/*!
+ * @brief Lowers the priority of an element, moving it closer to the front.
+ * @note Complexity is O(log n).
+ * @param[in] handle A handle returned by heap_push() or heap_build().
+ * @param[in] priority The new priority. Must not be larger than the current
+ * priority.
+ */
+UTIL_PUBLIC_API void
+heap_decrease_priority(struct heap_t* heap, heap_handle_t handle, int64_t priority);
+
+/*!
+ * @brief Sets the priority of an element to any value.
+ * @note Complexity is O(log n).
+ */
+UTIL_PUBLIC_API void
+heap_set_priority(struct heap_t* heap, heap_handle_t handle, int64_t priority);
+
+/*!
+ * @brief Removes an element from anywhere in the heap.
+ * @note Complexity is O(log n).
+ * @return Returns the value of the removed element.
+ */
+UTIL_PUBLIC_API void*
+heap_erase(struct heap_t* heap, heap_handle_t handle);
+
+/*!
+ * @brief Replaces the contents of the heap with the specified items, which
+ * can be in any order.
+ *
+ * This is faster than calling heap_push() for every item (O(n) instead of
+ * O(n log n)).
+ * @param[in] heap The heap to fill. Existing elements are removed and their
+ * handles become invalid.
+ * @param[in] items Array of priority/value pairs.
+ * @param[in] count Number of items in the array.
+ * @param[out] handles If not NULL, the handle of items[i] is written to
+ * handles[i]. Must have room for count handles.
+ * @return Returns 1 on success, 0 if memory allocation failed. In this case
+ * the heap is left unchanged.
+ */
+UTIL_PUBLIC_API char
+heap_build(struct heap_t* heap,
+           const struct heap_item_t* items,
+           uint32_t count,
+           heap_handle_t* handles);
+
+/*!
+ * @brief Returns the number of elements in the heap.
+ */
+#define heap_count(heap) ((heap)->nodes.count)
+
+C_HEADER_END
+
+#endif /* UTIL_HEAP_H */
+
+/** @} */
@@ -0,0 +1,120 @@
+/*!
+ * @file id_allocator.h
+ * @brief Hands out small unique integer IDs and takes them back.
+ * @page id_allocator ID Allocator
+ *
+ * IDs are tracked in a two level bitmap. The bottom level has one bit per ID,
+ * set if the ID is in use. The top level has one bit per 32-bit word of the
+ * bottom level, set if that word is full, i.e. if all of its 32 IDs are in
+ * use. Finding a free ID looks for the first top level word which isn't full,
+ * then for the first clear bit in the two words below it. Both are a single
+ * count-trailing-zeros instruction, and one top level word covers 1024 IDs.
+ *
+ * The allocator also remembers the first top level word that isn't full, so
+ * allocating is O(1) amortized. Releasing is always O(1).
+ *
+ * The lowest free ID is always returned, so IDs stay small and dense and can
+ * be used as indices into arrays.
+ * @{
+ */
+
+#ifndef UTIL_ID_ALLOCATOR_H
+#define UTIL_ID_ALLOCATOR_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+
+C_HEADER_BEGIN
+
+/*! Returned by id_allocator_alloc() if no ID could be allocated. */
+#define ID_ALLOCATOR_INVALID_ID ((uint32_t)-1)
+
+/*! Number of IDs covered by one word of the top level bitmap. */
+#define ID_ALLOCATOR_IDS_PER_BLOCK (32 * 32)
+
+struct id_allocator_t
+{
+    uint32_t* used;     /* one bit per ID, set if the ID is allocated */
+    uint32_t* full;     /* one bit per word of used[], set if all of its bits are set */
+    uint32_t capacity;  /* number of IDs the bitmaps can hold, a multiple of ID_ALLOCATOR_IDS_PER_BLOCK */
+    uint32_t count;     /* number of allocated IDs */
+    uint32_t first_free_block; /* all words of full[] before this one are completely set */
+};
+
+/*!
+ * @brief Creates a new ID allocator.
+ * @return Returns the new allocator, or NULL if allocation failed.
+ */
+UTIL_PUBLIC_API struct id_allocator_t*
+id_allocator_create(void);
+
+/*!
+ * @brief Initialises an existing ID allocator. No memory is allocated until
+ * the first ID is allocated.
+ */
+UTIL_PUBLIC_API void
+id_allocator_init(struct id_allocator_t* ids);
+
+/*!
+ * @brief Destroys an ID allocator and frees all of its memory.
+ */
+UTIL_PUBLIC_API void
+id_allocator_destroy(struct id_allocator_t* ids);
+
+/*!
+ * @brief Releases all IDs but keeps the memory.
+ */
+UTIL_PUBLIC_API void
+id_allocator_clear(struct id_allocator_t* ids);
+
+/*!
+ * @brief Releases all IDs and frees all memory.
+ */
+UTIL_PUBLIC_API void
+id_allocator_clear_free(struct id_allocator_t* ids);
+
+/*!
+ * @brief Allocates the lowest ID which isn't in use.
+ * @note Complexity is O(1) amortized.
+ * @return Returns the ID, or ID_ALLOCATOR_INVALID_ID if memory allocation
+ * failed.
+ */
+UTIL_PUBLIC_API uint32_t
+id_allocator_alloc(struct id_allocator_t* ids);
+
+/*!
+ * @brief Marks a range of IDs as in use, e.g. IDs with a special meaning
+ * which must never be handed out by id_allocator_alloc().
+ * @note Complexity is O(count / 32).
+ * @param[in] first The first ID of the range.
+ * @param[in] count The number of IDs in the range.
+ * @return Returns 1 on success. Returns 0 if any of the IDs is already in use
+ * or if memory allocation failed. In both cases nothing is changed.
+ */
+UTIL_PUBLIC_API char
+id_allocator_reserve(struct id_allocator_t* ids, uint32_t first, uint32_t count);
+
+/*!
+ * @brief Releases an ID so it can be allocated again.
+ * @note Complexity is O(1).
+ * @return Returns 1 if the ID was in use, 0 if otherwise.
+ */
+UTIL_PUBLIC_API char
+id_allocator_release(struct id_allocator_t* ids, uint32_t id);
+
+/*!
+ * @brief Returns 1 if the specified ID is in use, 0 if otherwise.
+ */
+UTIL_PUBLIC_API char
+id_allocator_is_used(const struct id_allocator_t* ids, uint32_t id);
+
+/*!
+ * @brief Returns the number of IDs in use.
+ */
+#define id_allocator_count(ids) ((ids)->count)
+
+C_HEADER_END
+
+#endif /* UTIL_ID_ALLOCATOR_H */
+
+/** @} */
@@ -0,0 +1,146 @@
+/*!
+ * @file intrusive_list.h
+ * @brief Doubly linked list whose links are embedded in the elements.
+ * @page intrusive_list Intrusive List
+ *
+ * Unlike @ref linked_list.h, the list never allocates anything. Every
+ * element contains a struct ilist_link_t member, and the list links those
+ * members together. Inserting and erasing are O(1) and can't fail, and an
+ * element can be erased knowing only the element itself (no search by
+ * value).
+ *
+ * ```
+ * struct foo_t
+ * {
+ *     int data;
+ *     struct ilist_link_t link;
+ * };
+ *
+ * ilist_push_back(&list, &foo->link);
+ * ILIST_FOR_EACH(&list, struct foo_t, link, foo)
+ *     do_something_with(foo);
+ * ILIST_END_EACH
+ * ilist_erase(&list, &foo->link);
+ * ```
+ *
+ * An element can only be in one list per link member. The element must stay
+ * at the same address while it is linked. A zero-initialised ilist_t is a
+ * valid, empty list.
+ * @{
+ */
+
+#ifndef UTIL_INTRUSIVE_LIST_H
+#define UTIL_INTRUSIVE_LIST_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include <stddef.h>
+
+C_HEADER_BEGIN
+
+struct ilist_link_t
+{
+    struct ilist_link_t* prev;
+    struct ilist_link_t* next;
+};
+
+struct ilist_t
+{
+    struct ilist_link_t* front;
+    struct ilist_link_t* back;
+    uint32_t count;
+};
+
+/*!
+ * @brief Initialises an empty list.
+ */
+UTIL_PUBLIC_API void
+ilist_init(struct ilist_t* list);
+
+/*!
+ * @brief Inserts an element at the front of the list.
+ * @param[in] link The link member of the element. Must not be in a list.
+ */
+UTIL_PUBLIC_API void
+ilist_push_front(struct ilist_t* list, struct ilist_link_t* link);
+
+/*!
+ * @brief Inserts an element at the back of the list.
+ * @param[in] link The link member of the element. Must not be in a list.
+ */
+UTIL_PUBLIC_API void
+ilist_push_back(struct ilist_t* list, struct ilist_link_t* link);
+
+/*!
+ * @brief Removes the first element of the list.
+ * @return Returns the link of the removed element, or NULL if the list is
+ * empty.
+ */
+UTIL_PUBLIC_API struct ilist_link_t*
+ilist_pop_front(struct ilist_t* list);
+
+/*!
+ * @brief Removes the last element of the list.
+ * @return Returns the link of the removed element, or NULL if the list is
+ * empty.
+ */
+UTIL_PUBLIC_API struct ilist_link_t*
+ilist_pop_back(struct ilist_t* list);
+
+/*!
+ * @brief Removes an element from the list in O(1).
+ * @param[in] link The link member of the element. Must be in this list.
+ */
+UTIL_PUBLIC_API void
+ilist_erase(struct ilist_t* list, struct ilist_link_t* link);
+
+/*!
+ * @brief Removes all elements from the list.
+ * @note The elements themselves are not touched.
+ */
+UTIL_PUBLIC_API void
+ilist_clear(struct ilist_t* list);
+
+/*!
+ * @brief Returns the number of elements in the list.
+ */
+#define ilist_count(list) ((list)->count)
+
+/*!
+ * @brief Gets a pointer to the element which contains the specified link.
+ * @param[in] link_p Pointer to the link member.
+ * @param[in] type The type of the element.
+ * @param[in] member The name of the link member inside of the element.
+ */
+#define ILIST_ENTRY(link_p, type, member) \
+    ((type*)((char*)(link_p) - offsetof(type, member)))
+
+/*!
+ * @brief Iterates over the elements of a list from front to back and opens a
+ * FOR_EACH scope.
+ * @note It is safe to erase the current element while iterating.
+ * @param[in] list The list to iterate.
+ * @param[in] type The type of the elements.
+ * @param[in] member The name of the link member inside of the element.
+ * @param[in] var The name to give the variable pointing to the current
+ * element.
+ */
+#define ILIST_FOR_EACH(list, type, member, var) {                               \
+    type* var;                                                                  \
+    struct ilist_link_t* link_##var;                                            \
+    struct ilist_link_t* next_link_##var;                                       \
+    for(link_##var = (list)->front;                                             \
+        link_##var && ((var = ILIST_ENTRY(link_##var, type, member),            \
+                        next_link_##var = link_##var->next) || 1);              \
+        link_##var = next_link_##var) {
+
+/*!
+ * @brief Closes a for each scope previously opened by ILIST_FOR_EACH.
+ */
+#define ILIST_END_EACH }}
+
+C_HEADER_END
+
+#endif /* UTIL_INTRUSIVE_LIST_H */
+
+/** @} */
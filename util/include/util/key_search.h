@@ -0,0 +1,72 @@
+/*!
+ * @file key_search.h
+ * @brief Lower bound search over sorted arrays of 32-bit keys.
+ * @page key_search Key Search
+ *
+ * Used by @ref bst_vector and @ref bst_hashed_vector to look up hashes.
+ *
+ * For small arrays a binary search is dominated by mispredicted branches,
+ * while comparing 4 (SSE2) or 8 (AVX2) keys per instruction and scanning
+ * linearly is cheaper. For larger arrays a binary search narrows the range
+ * down to KEY_SEARCH_LINEAR_THRESHOLD keys, which are then scanned the same
+ * way.
+ *
+ * The instruction set is chosen once at runtime, depending on what the CPU
+ * supports. On CPUs or compilers without SSE2, a plain scalar binary search
+ * is used.
+ * @{
+ */
+
+#ifndef UTIL_KEY_SEARCH_H
+#define UTIL_KEY_SEARCH_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+
+C_HEADER_BEGIN
+
+/*! Arrays up to this size are scanned linearly instead of bisected. */
+#define KEY_SEARCH_LINEAR_THRESHOLD 32
+
+typedef enum key_search_impl_e
+{
+    KEY_SEARCH_AUTO,   /* pick the best implementation the CPU supports */
+    KEY_SEARCH_SCALAR,
+    KEY_SEARCH_SSE2,
+    KEY_SEARCH_AVX2
+} key_search_impl_e;
+
+/*!
+ * @brief Finds the first key which is not less than the specified key.
+ * @param[in] keys Array of keys sorted in ascending order. There are no
+ * alignment requirements.
+ * @param[in] count Number of keys in the array.
+ * @param[in] key The key to search for.
+ * @return Returns the index of the lower bound, or count if all keys are less
+ * than the specified key.
+ */
+UTIL_PUBLIC_API uint32_t
+key_search_lower_bound(const uint32_t* keys, uint32_t count, uint32_t key);
+
+/*!
+ * @brief Forces a specific implementation. Intended for tests and
+ * benchmarks.
+ * @param[in] impl The implementation to use. KEY_SEARCH_AUTO restores the
+ * runtime detection.
+ * @return Returns 1 if the implementation is supported by this CPU and build,
+ * 0 if otherwise. In this case the current implementation is kept.
+ */
+UTIL_PUBLIC_API char
+key_search_set_impl(key_search_impl_e impl);
+
+/*!
+ * @brief Returns the implementation currently in use.
+ */
+UTIL_PUBLIC_API key_search_impl_e
+key_search_get_impl(void);
+
+C_HEADER_END
+
+#endif /* UTIL_KEY_SEARCH_H */
+
+/** @} */
@@ -5,6 +5,8 @@
 
 C_HEADER_BEGIN
 
+struct allocator_t;
+
 /*!
  * @brief Holds user defined data and information on linked nodes.
  */
@@ -17,12 +19,24 @@ struct list_node_t
 
 /*!
  * @brief Holds information on the entire list of nodes.
+ *
+ * New nodes are pushed onto the head, so the tail is the oldest node and
+ * following the next pointers from the tail visits the nodes in the order
+ * they were pushed.
+ *
+ * Nodes of erased elements are kept in a pool and reused by list_push(), so
+ * a list which has elements pushed and erased repeatedly stops allocating
+ * once it has reached its largest size. The pool is freed by list_clear().
+ * If the list only has to reference elements which are structs you own,
+ * consider an @ref intrusive_list instead, which never allocates at all.
  */
 struct list_t
 {
     int count;
     struct list_node_t* head;
     struct list_node_t* tail;
+    struct list_node_t* free_nodes;      /* pool of unused nodes, linked through next */
+    const struct allocator_t* allocator; /* where nodes come from. NULL means MALLOC()/FREE() */
 };
 
 /*!
@@ -40,6 +54,18 @@ list_create(void);
 UTIL_PUBLIC_API void
 list_init(struct list_t* list);
 
+/*!
+ * @brief Initialises an existing list and makes it allocate its nodes using
+ * the specified allocator.
+ * @param[in] list The list to initialise. Must be a valid list (cannot be
+ * NULL).
+ * @param[in] allocator The allocator to use. Must outlive the list. If NULL,
+ * the global MALLOC() and FREE() are used (same as list_init()).
+ */
+UTIL_PUBLIC_API void
+list_init_with_allocator(struct list_t* list,
+                         const struct allocator_t* allocator);
+
 /*!
  * @brief Destroys a list.
  * @note The data each link holds is **not** de-allocated, it is up to you to
@@ -52,7 +78,7 @@ list_destroy(struct list_t* list);
 
 /*!
  * @brief Unlinks and removes all nodes in a list. The list will be empty after
- * this operation.
+ * this operation. This also frees the nodes held in the pool.
  * @note The data each link holds is **not** de-allocated, it is up to you to
  * traverse the list and destroy any data contained within the list before
  * clearing it.
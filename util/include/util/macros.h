@@ -6,4 +6,39 @@
  */
 #define REF(x) ((void)x)
 
+/*!
+ * @brief Declares a function with internal linkage which the compiler should
+ * inline. C89 has no inline keyword, so use the compiler specific extension
+ * if one is available.
+ */
+#if defined(__cplusplus)
+#   define UTIL_INLINE static inline
+#elif defined(__GNUC__) || defined(__clang__)
+#   define UTIL_INLINE static __inline__
+#elif defined(_MSC_VER)
+#   define UTIL_INLINE static __inline
+#else
+#   define UTIL_INLINE static
+#endif
+
+/*!
+ * @brief Hints the CPU to start loading the cache line containing the
+ * specified address. Never faults, even if the address is invalid.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#   define UTIL_PREFETCH(addr) __builtin_prefetch(addr)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#   include <xmmintrin.h>
+#   define UTIL_PREFETCH(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
+#else
+#   define UTIL_PREFETCH(addr)
+#endif
+
+/*!
+ * @brief Assumed size of a cache line in bytes. Data written by different
+ * threads is kept at least this far apart so the threads don't keep taking
+ * the line away from each other (false sharing).
+ */
+#define UTIL_CACHE_LINE_SIZE 64
+
 #endif /* UTIL_MACROS_H */
@@ -7,10 +7,13 @@
 C_HEADER_BEGIN
 #ifdef ENABLE_MEMORY_DEBUGGING
 #   define MALLOC(size, where) malloc_wrapper_debug(size, "malloc() failed in " where " - not enough memory")
+#   define REALLOC(ptr, size, where) realloc_wrapper_debug(ptr, size, "realloc() failed in " where " - not enough memory")
 #   define FREE free_wrapper_debug
 #else
+#   include <stdlib.h>
 #   define MALLOC(size, where) malloc_wrapper(size, "malloc() failed in " where " - not enough memory")
-#   define FREE free free
+#   define REALLOC(ptr, size, where) realloc_wrapper(ptr, size, "realloc() failed in " where " - not enough memory")
+#   define FREE free
 #endif
 
 /*!
@@ -32,6 +35,21 @@ memory_init(void);
 UTIL_PUBLIC_API uintptr_t
 memory_deinit(void);
 
+/*!
+ * @brief Calls malloc() and prints the specified message if it fails.
+ */
+UTIL_PUBLIC_API void*
+malloc_wrapper(uintptr_t size, const char* msg);
+
+/*!
+ * @brief Calls realloc() and prints the specified message if it fails.
+ * @note Like realloc(), the original memory is left untouched if this fails.
+ * Large blocks may be grown in place or remapped by the C library instead of
+ * being copied.
+ */
+UTIL_PUBLIC_API void*
+realloc_wrapper(void* ptr, uintptr_t size, const char* msg);
+
 #ifdef ENABLE_MEMORY_DEBUGGING
 /*!
  * @brief Does the same thing as a normal call to malloc(), but does some
@@ -40,8 +58,13 @@ memory_deinit(void);
 UTIL_PUBLIC_API void*
 malloc_wrapper_debug(uintptr_t size, const char* msg);
 
+/*!
+ * @brief Does the same thing as a normal call to realloc(), but moves the
+ * allocation record of ptr to the new location so leak tracking keeps
+ * working. Passing NULL as ptr behaves like MALLOC().
+ */
 UTIL_PUBLIC_API void*
-malloc_wrapper(uintptr_t size, const char* msg);
+realloc_wrapper_debug(void* ptr, uintptr_t size, const char* msg);
 
 /*!
  * @brief Does the same thing as a normal call to fee(), but does some
@@ -0,0 +1,135 @@
+/*!
+ * @file mpmc_queue.h
+ * @brief Bounded queue any number of threads can push to and pop from.
+ * @page mpmc_queue MPMC Queue
+ *
+ * Fixed size elements are copied into a ring of cells whose capacity is a
+ * power of two. Each cell has a sequence number which tells whether it is
+ * ready to be written or read for a given position (D. Vyukov's bounded
+ * MPMC queue). A thread claims a position with a single compare-and-swap
+ * and then works on its cell without any further synchronisation, so
+ * producers only contend with producers and consumers only with consumers.
+ *
+ * The try functions never block. mpmc_queue_enqueue() and
+ * mpmc_queue_dequeue() spin for a short while and then sleep on a condition
+ * variable until the queue isn't full (or empty) any more. The mutex is only
+ * touched when a thread actually has to sleep, or when someone is sleeping
+ * and needs waking.
+ *
+ * mpmc_queue_close() lets blocked threads return, e.g. on shutdown.
+ * @{
+ */
+
+#ifndef UTIL_MPMC_QUEUE_H
+#define UTIL_MPMC_QUEUE_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include "util/macros.h"
+
+C_HEADER_BEGIN
+
+struct mutex_t;
+struct cond_t;
+
+struct mpmc_queue_t
+{
+    unsigned char* cells;
+    uint32_t cell_size;
+    uint32_t element_size;
+    uint32_t mask;
+    struct mutex_t* mutex;
+    struct cond_t* not_empty;
+    struct cond_t* not_full;
+    volatile uint32_t consumers_waiting;
+    volatile uint32_t producers_waiting;
+    volatile uint32_t closed;
+    char pad0[UTIL_CACHE_LINE_SIZE];
+
+    volatile uint32_t enqueue_pos;
+    char pad1[UTIL_CACHE_LINE_SIZE - sizeof(uint32_t)];
+
+    volatile uint32_t dequeue_pos;
+    char pad2[UTIL_CACHE_LINE_SIZE - sizeof(uint32_t)];
+};
+
+/*!
+ * @brief Creates a new queue.
+ * @param[in] element_size Size in bytes of one element.
+ * @param[in] capacity The maximum number of elements. Rounded up to the
+ * next power of two, and at least 2.
+ * @return Returns the new queue, or NULL if memory allocation failed.
+ */
+UTIL_PUBLIC_API struct mpmc_queue_t*
+mpmc_queue_create(uint32_t element_size, uint32_t capacity);
+
+/*!
+ * @brief Initialises an existing queue. See mpmc_queue_create().
+ * @return Returns 1 on success, 0 on failure.
+ */
+UTIL_PUBLIC_API char
+mpmc_queue_init(struct mpmc_queue_t* queue, uint32_t element_size, uint32_t capacity);
+
+/*!
+ * @brief Destroys a queue created with mpmc_queue_create().
+ */
+UTIL_PUBLIC_API void
+mpmc_queue_destroy(struct mpmc_queue_t* queue);
+
+/*!
+ * @brief Frees all memory of a queue initialised with mpmc_queue_init().
+ * @warning No other thread may be using the queue.
+ */
+UTIL_PUBLIC_API void
+mpmc_queue_clear_free(struct mpmc_queue_t* queue);
+
+/*!
+ * @brief Copies an element into the queue if there is room.
+ * @return Returns 1 on success, 0 if the queue is full or closed.
+ */
+UTIL_PUBLIC_API char
+mpmc_queue_try_enqueue(struct mpmc_queue_t* queue, const void* data);
+
+/*!
+ * @brief Copies the oldest element out of the queue and removes it, if there
+ * is one.
+ * @return Returns 1 on success, 0 if the queue is empty.
+ */
+UTIL_PUBLIC_API char
+mpmc_queue_try_dequeue(struct mpmc_queue_t* queue, void* data);
+
+/*!
+ * @brief Copies an element into the queue, waiting for room if necessary.
+ * @return Returns 1 on success, 0 if the queue was closed.
+ */
+UTIL_PUBLIC_API char
+mpmc_queue_enqueue(struct mpmc_queue_t* queue, const void* data);
+
+/*!
+ * @brief Copies the oldest element out of the queue and removes it, waiting
+ * for one to arrive if necessary.
+ * @return Returns 1 on success. Returns 0 if the queue was closed and
+ * everything in it has been dequeued.
+ */
+UTIL_PUBLIC_API char
+mpmc_queue_dequeue(struct mpmc_queue_t* queue, void* data);
+
+/*!
+ * @brief Stops the queue from accepting new elements and wakes up all
+ * blocked threads. Elements already in the queue can still be dequeued.
+ */
+UTIL_PUBLIC_API void
+mpmc_queue_close(struct mpmc_queue_t* queue);
+
+/*!
+ * @brief Returns the number of elements in the queue. Other threads can
+ * change this at any time, so only use it as a hint.
+ */
+UTIL_PUBLIC_API uint32_t
+mpmc_queue_count(const struct mpmc_queue_t* queue);
+
+C_HEADER_END
+
+#endif /* UTIL_MPMC_QUEUE_H */
+
+/** @} */
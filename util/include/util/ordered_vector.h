@@ -26,6 +26,11 @@
 
 C_HEADER_BEGIN
 
+struct allocator_t;
+
+/*! Capacity is multiplied by this whenever the vector runs out of space. */
+#define ORDERED_VECTOR_DEFAULT_GROWTH_FACTOR 2.0f
+
 #define DATA_POINTER_TYPE unsigned char
 struct ordered_vector_t
 {
@@ -33,6 +38,10 @@ struct ordered_vector_t
     uint32_t capacity;           /* how many elements actually fit into the allocated space */
     uint32_t count;              /* number of elements inserted */
     DATA_POINTER_TYPE* data;     /* pointer to the contiguous section of memory */
+    const struct allocator_t* allocator; /* where data comes from. NULL means MALLOC()/FREE() */
+    float growth_factor;         /* capacity is multiplied by this when expanding */
+    DATA_POINTER_TYPE* inline_data; /* optional storage owned by the user, used before spilling to the heap */
+    uint32_t inline_capacity;    /* how many elements fit into inline_data */
 };
 
 /*!
@@ -56,6 +65,53 @@ UTIL_PUBLIC_API void
 ordered_vector_init(struct ordered_vector_t* vector,
                     const uint32_t element_size);
 
+/*!
+ * @brief Initialises an existing vector object and makes it use the specified
+ * allocator for all of its memory.
+ * @note This does **not** free existing memory. If you've pushed elements
+ * into your vector and call this, you will have created a memory leak.
+ * @param[in] vector The vector to initialise.
+ * @param[in] element_size Specifies the size in bytes of the type of data you
+ * want the vector to store. Typically one would pass sizeof(my_data_type).
+ * @param[in] allocator The allocator to use. Must outlive the vector. If NULL,
+ * the global MALLOC() and FREE() are used (same as ordered_vector_init()).
+ */
+UTIL_PUBLIC_API void
+ordered_vector_init_with_allocator(struct ordered_vector_t* vector,
+                                   const uint32_t element_size,
+                                   const struct allocator_t* allocator);
+
+/*!
+ * @brief Initialises an existing vector object so it stores its first
+ * elements in the specified buffer, and only allocates memory once it
+ * outgrows the buffer.
+ *
+ * This is intended for vectors that typically hold very few elements. The
+ * buffer is usually an array member of the struct which also contains the
+ * vector:
+ * ```
+ * struct foo_t
+ * {
+ *     struct ordered_vector_t bars;
+ *     struct bar_t bars_inline[4];
+ * };
+ * ordered_vector_init_inline(&foo->bars, sizeof(struct bar_t), foo->bars_inline, 4);
+ * ```
+ * @warning Because the vector points into the buffer, a vector initialised
+ * this way must not be copied or moved in memory together with its buffer.
+ * @param[in] vector The vector to initialise.
+ * @param[in] element_size Specifies the size in bytes of the type of data you
+ * want the vector to store. Typically one would pass sizeof(my_data_type).
+ * @param[in] buffer Storage for inline_capacity elements. Must outlive the
+ * vector. It is never freed by the vector.
+ * @param[in] inline_capacity How many elements fit into buffer.
+ */
+UTIL_PUBLIC_API void
+ordered_vector_init_inline(struct ordered_vector_t* vector,
+                           const uint32_t element_size,
+                           void* buffer,
+                           uint32_t inline_capacity);
+
 /*!
  * @brief Destroys an existing vector object and frees all memory allocated by
  * inserted elements.
@@ -81,6 +137,39 @@ ordered_vector_clear(struct ordered_vector_t* vector);
 UTIL_PUBLIC_API void
 ordered_vector_clear_free(struct ordered_vector_t* vector);
 
+/*!
+ * @brief Makes sure the vector has space for at least the specified number of
+ * elements, so that up to that many elements can be inserted without the
+ * vector re-allocating.
+ * @param[in] vector The vector to reserve memory in.
+ * @param[in] count The number of elements to reserve space for. If this is
+ * smaller than the current capacity, nothing happens.
+ * @return Returns 1 if successful, 0 if memory allocation failed. The vector
+ * is left unchanged on failure.
+ */
+UTIL_PUBLIC_API char
+ordered_vector_reserve(struct ordered_vector_t* vector, uint32_t count);
+
+/*!
+ * @brief Gives back any memory not occupied by elements. If the vector is
+ * empty, all of its memory is freed.
+ * @param[in] vector The vector to shrink.
+ * @return Returns 1 if successful, 0 if memory allocation failed. The vector
+ * is left unchanged on failure.
+ */
+UTIL_PUBLIC_API char
+ordered_vector_shrink_to_fit(struct ordered_vector_t* vector);
+
+/*!
+ * @brief Sets the factor by which the capacity grows whenever the vector runs
+ * out of space. The default is ORDERED_VECTOR_DEFAULT_GROWTH_FACTOR.
+ * @note Smaller factors waste less memory but re-allocate more often.
+ * @param[in] vector The vector to configure.
+ * @param[in] factor Must be larger than 1.
+ */
+UTIL_PUBLIC_API void
+ordered_vector_set_growth_factor(struct ordered_vector_t* vector, float factor);
+
 /*!
  * @brief Gets the number of elements that have been inserted into the vector.
  */
@@ -182,6 +271,48 @@ ordered_vector_insert_emplace(struct ordered_vector_t* vector, uint32_t index);
 UTIL_PUBLIC_API char
 ordered_vector_insert(struct ordered_vector_t* vector, uint32_t index, void* data);
 
+/*!
+ * @brief Allocates space for **count** new elements at the specified index,
+ * but does not initialise them.
+ * @note All elements at or after **index** are shifted up in a single move,
+ * and the underlying memory is re-allocated at most once. This is a lot
+ * cheaper than calling ordered_vector_insert_emplace() **count** times.
+ * @warning The returned pointer could be invalidated if any other
+ * vector related function is called, as the underlying memory of the vector
+ * could be re-allocated. Use the pointer immediately after calling this
+ * function.
+ * @param[in] vector The vector to emplace the elements into.
+ * @param[in] index Where to insert. The first new element will have this
+ * index.
+ * @param[in] count The number of elements to make space for.
+ * @return A pointer to the first emplaced element. The remaining elements
+ * follow contiguously. If the index is out of bounds, if count is 0 or if
+ * re-allocation fails, NULL is returned and the vector is left untouched.
+ */
+UTIL_PUBLIC_API void*
+ordered_vector_insert_range_emplace(struct ordered_vector_t* vector,
+                                    uint32_t index,
+                                    uint32_t count);
+
+/*!
+ * @brief Inserts (copies) **count** contiguous elements at the specified
+ * index.
+ * @note See ordered_vector_insert_range_emplace() for details on complexity.
+ * @param[in] vector The vector to insert into.
+ * @param[in] index Where to insert. The first new element will have this
+ * index.
+ * @param[in] data Pointer to **count** contiguous elements to copy into the
+ * vector. Must not point into the vector itself.
+ * @param[in] count The number of elements to copy.
+ * @return Returns non-zero if the data was successfully inserted, zero if
+ * otherwise.
+ */
+UTIL_PUBLIC_API char
+ordered_vector_insert_range(struct ordered_vector_t* vector,
+                            uint32_t index,
+                            const void* data,
+                            uint32_t count);
+
 /*!
  * @brief Erases the specified element from the vector.
  * @note This causes all elements with indices greater than **index** to be
@@ -200,6 +331,88 @@ ordered_vector_erase_index(struct ordered_vector_t* vector, uint32_t index);
 UTIL_PUBLIC_API void
 ordered_vector_erase_element(struct ordered_vector_t* vector, void* element);
 
+/*!
+ * @brief Erases all elements in the range [begin_index, end_index) from the
+ * vector.
+ * @note All elements after the range are shifted down in a single move.
+ * @param[in] vector The vector to erase from.
+ * @param[in] begin_index The index of the first element to erase.
+ * @param[in] end_index The index of the last element to erase (exclusive). If
+ * this is larger than the number of elements, the range is clamped.
+ */
+UTIL_PUBLIC_API void
+ordered_vector_erase_range(struct ordered_vector_t* vector,
+                           uint32_t begin_index,
+                           uint32_t end_index);
+
+/*!
+ * @brief Callback used by ordered_vector_erase_if().
+ * @param[in] element A pointer to the element being tested.
+ * @param[in] user_data The user data that was passed to
+ * ordered_vector_erase_if().
+ * @return Should return non-zero if the element should be erased, zero if
+ * otherwise.
+ */
+typedef char (*ordered_vector_predicate_func)(const void* element, void* user_data);
+
+/*!
+ * @brief Erases every element for which the predicate returns non-zero.
+ *
+ * This is a stable compaction done in a single pass. The predicate is called
+ * exactly once per element, in order, and every remaining element is moved at
+ * most once.
+ * @param[in] vector The vector to erase from.
+ * @param[in] predicate The function deciding which elements to erase.
+ * @param[in] user_data Passed through to the predicate. Can be NULL.
+ * @return Returns the number of elements that were erased.
+ */
+UTIL_PUBLIC_API uint32_t
+ordered_vector_erase_if(struct ordered_vector_t* vector,
+                        ordered_vector_predicate_func predicate,
+                        void* user_data);
+
+/*!
+ * @brief Callback used by ordered_vector_sort().
+ * @return Should return a negative value if a should come before b, a
+ * positive value if a should come after b and zero if they are equal.
+ */
+typedef int (*ordered_vector_compare_func)(const void* a, const void* b);
+
+/*!
+ * @brief Sorts all elements in place using a comparison function.
+ * @note Complexity is O(n log n). The sort is not stable.
+ * @param[in] vector The vector to sort.
+ * @param[in] compare The function defining the order of two elements.
+ */
+UTIL_PUBLIC_API void
+ordered_vector_sort(struct ordered_vector_t* vector,
+                    ordered_vector_compare_func compare);
+
+/*!
+ * @brief Sorts all elements by an unsigned 32-bit key stored inside each
+ * element using an LSD radix sort.
+ *
+ * The sort is stable, so elements with equal keys keep their relative order.
+ * Complexity is O(n), but a temporary buffer the size of the vector is
+ * allocated. Passes over bytes which are equal for every key are skipped.
+ * @param[in] vector The vector to sort.
+ * @param[in] key_offset Offset in bytes from the beginning of an element to
+ * its key (use offsetof()). The key doesn't have to be aligned.
+ * @return Returns 1 on success, 0 if the temporary buffer could not be
+ * allocated. In this case the vector is left unchanged.
+ */
+UTIL_PUBLIC_API char
+ordered_vector_radix_sort_u32(struct ordered_vector_t* vector,
+                              uint32_t key_offset);
+
+/*!
+ * @brief Same as ordered_vector_radix_sort_u32() but for unsigned 64-bit
+ * keys.
+ */
+UTIL_PUBLIC_API char
+ordered_vector_radix_sort_u64(struct ordered_vector_t* vector,
+                              uint32_t key_offset);
+
 /*!
  * @brief Gets a pointer to the specified element in the vector.
  * @warning The returned pointer could be invalidated if any other
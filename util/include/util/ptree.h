@@ -21,7 +21,7 @@
 #include "util/pstdint.h"
 #include "util/config.h"
 #include "util/hash.h"
-#include "util/bst_hashed_vector.h"
+#include "util/string_map.h"
 
 C_HEADER_BEGIN
 
@@ -32,9 +32,10 @@ struct ptree_t
 {
     void* value;
     struct ptree_t* parent;
+    const char* key;        /* the parent's copy of this node's key, NULL if there is no parent */
     ptree_dup_func dup_value;
     ptree_free_func free_value;
-    struct bsthv_t children;
+    struct string_map_t children;
 };
 
 /*! Contains the delimiter used for separating nodes. */
@@ -49,6 +50,22 @@ extern const char ptree_node_delim;
 UTIL_PUBLIC_API struct ptree_t*
 ptree_create(void* value);
 
+/*!
+ * @brief Allocates and initialises a new empty ptree object using the
+ * specified allocator.
+ *
+ * The root node, all child nodes created under it and their keys are
+ * allocated with the allocator. Each node remembers the allocator it was
+ * created with, so ptree_destroy() releases it to the right place even if
+ * nodes are moved between trees with ptree_set_parent().
+ * @param[in] value The data for the root node to reference. Can be NULL.
+ * @param[in] allocator The allocator to use. Must outlive the tree. If NULL,
+ * this is equivalent to ptree_create().
+ * @return Returns the root node of a new, empty ptree object.
+ */
+UTIL_PUBLIC_API struct ptree_t*
+ptree_create_with_allocator(void* value, const struct allocator_t* allocator);
+
 /*!
  * @brief Initialises an allocated ptree object.
  * @note Calling this does **not** delete the ptree. If you call this on a
@@ -59,6 +76,20 @@ ptree_create(void* value);
 UTIL_PUBLIC_API void
 ptree_init(struct ptree_t* tree, void* value);
 
+/*!
+ * @brief Initialises an allocated ptree object. All child nodes created under
+ * it will be allocated using the specified allocator.
+ * @note Calling this does **not** delete the ptree. If you call this on a
+ * non-empty ptree then all data in the tree will be leaked.
+ * @param[in] value The data for the root node to reference. Can be NULL.
+ * @param[in] allocator The allocator to use. Must outlive the tree. If NULL,
+ * this is equivalent to ptree_init().
+ */
+UTIL_PUBLIC_API void
+ptree_init_with_allocator(struct ptree_t* tree,
+                          void* value,
+                          const struct allocator_t* allocator);
+
 /*!
  * @brief Destroys an existing ptree.
  *
@@ -230,9 +261,9 @@ UTIL_PUBLIC_API void
 ptree_print(const struct ptree_t* tree);
 
 #define PTREE_FOR_EACH_IN_NODE(tree, hash, node) \
-    BSTHV_FOR_EACH(&(tree)->children, struct ptree_t, hash, node)
+    STRING_MAP_FOR_EACH(&(tree)->children, struct ptree_t, hash, node)
 
-#define PTREE_END_EACH BSTHV_END_EACH
+#define PTREE_END_EACH STRING_MAP_END_EACH
 
 C_HEADER_END
 
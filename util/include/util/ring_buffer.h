@@ -1,34 +1,210 @@
+/*!
+ * @file ring_buffer.h
+ * @brief Lock-free single producer, single consumer queue.
+ * @page ring_buffer Ring Buffer
+ *
+ * Hands fixed size elements from one thread (the producer) to another (the
+ * consumer) without locks. At any time only one thread may call the producer
+ * functions (enqueue, reserve, commit) and only one thread may call the
+ * consumer functions (dequeue, peek, consume). Which threads those are can
+ * change, as long as the hand-over is synchronised by other means.
+ *
+ * The capacity is a power of two, so positions wrap with a mask instead of a
+ * division. The read and write positions live on separate cache lines, and
+ * each side keeps a cached copy of the other side's position. The other
+ * side's cache line is only touched when the cached copy says the buffer is
+ * full (or empty).
+ *
+ * Besides copying elements in and out, both sides can work directly on the
+ * buffer's memory. ring_buffer_reserve() returns space for the producer to
+ * fill in place, and ring_buffer_commit() publishes it.
+ * ring_buffer_peek_n() and ring_buffer_consume() do the same for the
+ * consumer.
+ *
+ * The initial size in bytes is RING_BUFFER_FIXED_SIZE. If
+ * ENABLE_RING_BUFFER_REALLOC is set, a full buffer grows instead of
+ * rejecting elements, up to RING_BUFFER_MAX_SIZE bytes. The consumer may
+ * still be reading the old memory, so growing doesn't move any elements.
+ * The producer continues in a new, twice as large block, and the consumer
+ * switches over and frees the old block once it has drained it.
+ * @{
+ */
+
+#ifndef UTIL_RING_BUFFER_H
+#define UTIL_RING_BUFFER_H
+
+#include "util/pstdint.h"
 #include "util/config.h"
-#include "util/unordered_vector.h"
+#include "util/macros.h"
 
 C_HEADER_BEGIN
 
+struct ring_buffer_segment_t;
+
 struct ring_buffer_t
 {
-    struct unordered_vector_t vector;
-    uint32_t read;
-    uint32_t write;
+    uint32_t element_size;
+    uint32_t max_capacity;   /* the largest a segment may grow to, in elements */
+    char pad0[UTIL_CACHE_LINE_SIZE];
+
+    /* only accessed by the consumer */
+    struct ring_buffer_segment_t* read_segment;
+    uint32_t cached_tail;    /* write position of read_segment when the consumer last looked */
+    volatile uint32_t read_count;   /* elements consumed so far, for ring_buffer_count() */
+    char pad1[UTIL_CACHE_LINE_SIZE];
+
+    /* only accessed by the producer */
+    struct ring_buffer_segment_t* write_segment;
+    uint32_t cached_head;    /* read position of write_segment when the producer last looked */
+    volatile uint32_t write_count;  /* elements committed so far, for ring_buffer_count() */
+    char pad2[UTIL_CACHE_LINE_SIZE];
 };
 
+/*!
+ * @brief Creates a new ring buffer with the default capacity of
+ * RING_BUFFER_FIXED_SIZE bytes.
+ * @param[in] element_size Size in bytes of one element.
+ * @return Returns the new ring buffer, or NULL if memory allocation failed.
+ */
 UTIL_PUBLIC_API struct ring_buffer_t*
 ring_buffer_create(uint32_t element_size);
 
-UTIL_PUBLIC_API void
+/*!
+ * @brief Initialises an existing ring buffer with the default capacity of
+ * RING_BUFFER_FIXED_SIZE bytes.
+ * @return Returns 1 on success, 0 if memory allocation failed.
+ */
+UTIL_PUBLIC_API char
 ring_buffer_init(struct ring_buffer_t* rb, uint32_t element_size);
 
+/*!
+ * @brief Initialises an existing ring buffer so it can hold at least the
+ * specified number of elements.
+ * @param[in] capacity Rounded up to the next power of two.
+ * @return Returns 1 on success, 0 if memory allocation failed.
+ */
+UTIL_PUBLIC_API char
+ring_buffer_init_with_capacity(struct ring_buffer_t* rb,
+                               uint32_t element_size,
+                               uint32_t capacity);
+
+/*!
+ * @brief Destroys a ring buffer created with ring_buffer_create().
+ */
 UTIL_PUBLIC_API void
 ring_buffer_destroy(struct ring_buffer_t* rb);
 
+/*!
+ * @brief Discards all elements.
+ * @warning Must not be called while the producer or consumer are using the
+ * ring buffer.
+ */
 UTIL_PUBLIC_API void
 ring_buffer_clear(struct ring_buffer_t* rb);
 
+/*!
+ * @brief Frees all memory. The ring buffer must be initialised again before
+ * it can be used.
+ * @warning Must not be called while the producer or consumer are using the
+ * ring buffer.
+ */
 UTIL_PUBLIC_API void
 ring_buffer_clear_free(struct ring_buffer_t* rb);
 
+/*!
+ * @brief Returns the number of elements in the ring buffer. Can be called
+ * from any thread. If the producer or consumer are running at the same time,
+ * the result may already be out of date when it is returned.
+ */
+UTIL_PUBLIC_API uint32_t
+ring_buffer_count(const struct ring_buffer_t* rb);
+
+/* ------------------------------------------------------------------------- */
+/* producer */
+
+/*!
+ * @brief Copies one element into the ring buffer. Producer only.
+ * @return Returns 1 on success, 0 if the ring buffer is full.
+ */
+UTIL_PUBLIC_API char
+ring_buffer_enqueue(struct ring_buffer_t* rb, const void* data);
+
+/*!
+ * @brief Copies up to count elements into the ring buffer. Producer only.
+ * @return Returns the number of elements which were copied. This is less
+ * than count if the ring buffer became full.
+ */
+UTIL_PUBLIC_API uint32_t
+ring_buffer_enqueue_n(struct ring_buffer_t* rb, const void* data, uint32_t count);
+
+/*!
+ * @brief Gets space for up to count elements, which the producer can fill in
+ * place and then publish with ring_buffer_commit(). Producer only.
+ * @param[in] count The number of elements the caller would like to write.
+ * @param[out] reserved The number of elements which actually fit. This can
+ * be less than count if the buffer is almost full, or because the space
+ * wraps around the end of the buffer. Reserve again after committing to get
+ * the rest.
+ * @return Returns a pointer to the first reserved element, or NULL if the
+ * ring buffer is full.
+ */
+UTIL_PUBLIC_API void*
+ring_buffer_reserve(struct ring_buffer_t* rb, uint32_t count, uint32_t* reserved);
+
+/*!
+ * @brief Makes the first count elements of the space returned by the last
+ * call to ring_buffer_reserve() visible to the consumer. Producer only.
+ */
 UTIL_PUBLIC_API void
-ring_buffer_queue(struct ring_buffer_t* rb, void* data);
+ring_buffer_commit(struct ring_buffer_t* rb, uint32_t count);
+
+/* ------------------------------------------------------------------------- */
+/* consumer */
 
+/*!
+ * @brief Copies the oldest element out of the ring buffer and removes it.
+ * Consumer only.
+ * @return Returns 1 on success, 0 if the ring buffer is empty.
+ */
+UTIL_PUBLIC_API char
+ring_buffer_dequeue(struct ring_buffer_t* rb, void* data);
+
+/*!
+ * @brief Copies up to count of the oldest elements out of the ring buffer
+ * and removes them. Consumer only.
+ * @return Returns the number of elements which were copied.
+ */
+UTIL_PUBLIC_API uint32_t
+ring_buffer_dequeue_n(struct ring_buffer_t* rb, void* data, uint32_t count);
+
+/*!
+ * @brief Returns the oldest element without removing it, or NULL if the
+ * ring buffer is empty. Consumer only.
+ */
 UTIL_PUBLIC_API void*
-ring_buffer_peak(struct ring_buffer_t* rb);
+ring_buffer_peek(struct ring_buffer_t* rb);
+
+/*!
+ * @brief Gets up to count of the oldest elements without copying or removing
+ * them. Release them with ring_buffer_consume() when done. Consumer only.
+ * @param[out] available The number of elements the returned pointer points
+ * to. This can be less than count if the elements wrap around the end of the
+ * buffer.
+ * @return Returns a pointer to the oldest element, or NULL if the ring
+ * buffer is empty.
+ */
+UTIL_PUBLIC_API void*
+ring_buffer_peek_n(struct ring_buffer_t* rb, uint32_t count, uint32_t* available);
+
+/*!
+ * @brief Removes the first count elements returned by the last call to
+ * ring_buffer_peek_n(). Consumer only.
+ */
+UTIL_PUBLIC_API void
+ring_buffer_consume(struct ring_buffer_t* rb, uint32_t count);
 
 C_HEADER_END
+
+#endif /* UTIL_RING_BUFFER_H */
+
+/** @} */
@@ -0,0 +1,152 @@
+/*!
+ * @file slot_map.h
+ * @brief Container handing out stable handles to densely stored elements.
+ * @page slot_map Slot Map
+ *
+ * Elements are stored contiguously in an @ref unordered_vector, so iterating
+ * all of them is as fast as iterating an array. Because erasing moves the
+ * last element into the gap, pointers and indices into the dense array are
+ * not stable. Instead, inserting an element returns a 32-bit handle which
+ * stays valid until the element is erased.
+ *
+ * A handle stores the index of a slot and the generation of that slot. Each
+ * slot remembers where its element currently lives in the dense array. When
+ * an element is erased, the generation of its slot is incremented, so any
+ * handles still referring to it become stale and slot_map_get() returns NULL
+ * for them instead of returning some other element.
+ *
+ * Insertion, erasure and lookup are all O(1).
+ * @{
+ */
+
+#ifndef UTIL_SLOT_MAP_H
+#define UTIL_SLOT_MAP_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include "util/unordered_vector.h"
+
+C_HEADER_BEGIN
+
+typedef uint32_t slot_map_handle_t;
+
+/*! Number of bits of a handle used for the slot index. The remaining bits
+ * store the generation. */
+#define SLOT_MAP_INDEX_BITS 20
+#define SLOT_MAP_MAX_SLOTS ((uint32_t)1 << SLOT_MAP_INDEX_BITS)
+/*! Never returned for a valid element. */
+#define SLOT_MAP_INVALID_HANDLE ((slot_map_handle_t)0)
+
+struct slot_map_t
+{
+    struct unordered_vector_t dense;         /* the elements themselves */
+    struct unordered_vector_t dense_to_slot; /* uint32_t slot index for every element in dense */
+    struct unordered_vector_t slots;         /* struct slot_map_slot_t */
+    uint32_t free_head;                      /* first unused slot, or (uint32_t)-1 */
+};
+
+/*!
+ * @brief Creates a new slot map object.
+ * @param[in] element_size The size in bytes of one element.
+ * @return Returns the new slot map, or NULL if allocation failed.
+ */
+UTIL_PUBLIC_API struct slot_map_t*
+slot_map_create(uint32_t element_size);
+
+/*!
+ * @brief Initialises an existing slot map object.
+ * @note This does **not** free existing memory.
+ * @param[in] map The slot map to initialise.
+ * @param[in] element_size The size in bytes of one element.
+ */
+UTIL_PUBLIC_API void
+slot_map_init(struct slot_map_t* map, uint32_t element_size);
+
+/*!
+ * @brief Destroys an existing slot map object and frees all of its memory.
+ */
+UTIL_PUBLIC_API void
+slot_map_destroy(struct slot_map_t* map);
+
+/*!
+ * @brief Erases all elements. All handles become stale, but memory is kept.
+ */
+UTIL_PUBLIC_API void
+slot_map_clear(struct slot_map_t* map);
+
+/*!
+ * @brief Erases all elements and frees all memory.
+ * @warning Because the generations are lost, handles created before calling
+ * this may become valid again for new elements. Use slot_map_clear() if old
+ * handles may still be around.
+ */
+UTIL_PUBLIC_API void
+slot_map_clear_free(struct slot_map_t* map);
+
+/*!
+ * @brief Makes space for a new element without initialising it.
+ * @param[in] map The slot map to insert into.
+ * @param[out] handle Receives the handle of the new element.
+ * @return Returns a pointer to the uninitialised element, or NULL if memory
+ * allocation failed or all slots are in use. The pointer is only valid
+ * until the slot map is modified again; use the handle to find the element
+ * later.
+ */
+UTIL_PUBLIC_API void*
+slot_map_insert_emplace(struct slot_map_t* map, slot_map_handle_t* handle);
+
+/*!
+ * @brief Copies an element into the slot map.
+ * @return Returns the handle of the new element, or SLOT_MAP_INVALID_HANDLE
+ * if memory allocation failed or all slots are in use.
+ */
+UTIL_PUBLIC_API slot_map_handle_t
+slot_map_insert(struct slot_map_t* map, const void* data);
+
+/*!
+ * @brief Looks up the element referred to by a handle.
+ * @return Returns a pointer to the element, or NULL if the handle is stale
+ * (its element was erased) or invalid.
+ */
+UTIL_PUBLIC_API void*
+slot_map_get(const struct slot_map_t* map, slot_map_handle_t handle);
+
+/*!
+ * @brief Erases the element referred to by a handle. The last element in the
+ * dense array is moved into the gap.
+ * @return Returns 1 if the element was erased, 0 if the handle was stale or
+ * invalid.
+ */
+UTIL_PUBLIC_API char
+slot_map_erase(struct slot_map_t* map, slot_map_handle_t handle);
+
+/*!
+ * @brief Returns the handle of the element at the specified position in the
+ * dense array. Useful when iterating with SLOT_MAP_FOR_EACH.
+ */
+UTIL_PUBLIC_API slot_map_handle_t
+slot_map_get_handle(const struct slot_map_t* map, uint32_t dense_index);
+
+/*!
+ * @brief Number of elements in the slot map.
+ */
+#define slot_map_count(x) ((x)->dense.count)
+
+/*!
+ * @brief Iterates over all elements in the dense array. The order is
+ * unspecified.
+ * @warning Don't insert or erase while iterating.
+ */
+#define SLOT_MAP_FOR_EACH(map, var_type, var) \
+    UNORDERED_VECTOR_FOR_EACH(&(map)->dense, var_type, var)
+
+/*!
+ * @brief Closes a for each scope previously opened by SLOT_MAP_FOR_EACH.
+ */
+#define SLOT_MAP_END_EACH UNORDERED_VECTOR_END_EACH
+
+C_HEADER_END
+
+#endif /* UTIL_SLOT_MAP_H */
+
+/** @} */
@@ -0,0 +1,160 @@
+/*!
+ * @file soa_vector.h
+ * @brief Structure-of-arrays container with one column per field.
+ * @page soa_vector SoA Vector
+ *
+ * An ordered_vector of structs stores all fields of an element next to each
+ * other. Loops which only touch one or two fields (e.g. updating positions)
+ * still have to pull every other field through the cache. A soa_vector
+ * stores each field in its own contiguous column instead:
+ * ```
+ * enum { POS_X, POS_Y, VEL_X, VEL_Y };
+ * static const uint32_t sizes[] = {sizeof(float), sizeof(float), sizeof(float), sizeof(float)};
+ *
+ * struct soa_vector_t v;
+ * soa_vector_init(&v, 4, sizes);
+ * ...
+ * float* x = soa_vector_column(&v, POS_X);
+ * float* vx = soa_vector_column(&v, VEL_X);
+ * for(i = 0; i != soa_vector_count(&v); ++i)
+ *     x[i] += vx[i];
+ * ```
+ *
+ * All columns share a single count and capacity and live in one memory
+ * block, so growing the container is a single allocation. Every column
+ * starts on a SOA_VECTOR_ALIGNMENT byte boundary, which allows aligned SIMD
+ * loads on any column.
+ *
+ * Erasing an element moves the last element into the gap in every column,
+ * so the order of elements is not preserved.
+ * @{
+ */
+
+#ifndef UTIL_SOA_VECTOR_H
+#define UTIL_SOA_VECTOR_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+
+C_HEADER_BEGIN
+
+struct allocator_t;
+
+#define SOA_VECTOR_MAX_COLUMNS 16
+/*! Every column is aligned to this many bytes (enough for AVX). */
+#define SOA_VECTOR_ALIGNMENT 32
+#define SOA_VECTOR_DEFAULT_GROWTH_FACTOR 2.0f
+
+struct soa_vector_t
+{
+    uint32_t column_count;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t element_sizes[SOA_VECTOR_MAX_COLUMNS];
+    void* columns[SOA_VECTOR_MAX_COLUMNS]; /* aligned pointers into block */
+    void* block;                           /* the allocation holding all columns */
+    const struct allocator_t* allocator;   /* NULL means global MALLOC/FREE */
+};
+
+/*!
+ * @brief Creates a new soa vector object.
+ * @param[in] column_count Number of columns. Must be between 1 and
+ * SOA_VECTOR_MAX_COLUMNS.
+ * @param[in] element_sizes Array of column_count sizes in bytes, one for
+ * each column.
+ * @return Returns the new soa vector, or NULL if allocation failed.
+ */
+UTIL_PUBLIC_API struct soa_vector_t*
+soa_vector_create(uint32_t column_count, const uint32_t* element_sizes);
+
+/*!
+ * @brief Initialises an existing soa vector object.
+ * @note This does **not** free existing memory.
+ * @param[in] vector The soa vector to initialise.
+ * @param[in] column_count Number of columns. Must be between 1 and
+ * SOA_VECTOR_MAX_COLUMNS.
+ * @param[in] element_sizes Array of column_count sizes in bytes, one for
+ * each column.
+ */
+UTIL_PUBLIC_API void
+soa_vector_init(struct soa_vector_t* vector,
+                uint32_t column_count,
+                const uint32_t* element_sizes);
+
+/*!
+ * @brief Same as soa_vector_init(), but all memory is allocated through the
+ * specified allocator.
+ * @param[in] allocator The allocator to use, or NULL for the default.
+ */
+UTIL_PUBLIC_API void
+soa_vector_init_with_allocator(struct soa_vector_t* vector,
+                               uint32_t column_count,
+                               const uint32_t* element_sizes,
+                               const struct allocator_t* allocator);
+
+/*!
+ * @brief Destroys an existing soa vector object and frees all memory.
+ */
+UTIL_PUBLIC_API void
+soa_vector_destroy(struct soa_vector_t* vector);
+
+/*!
+ * @brief Erases all elements without freeing memory.
+ */
+UTIL_PUBLIC_API void
+soa_vector_clear(struct soa_vector_t* vector);
+
+/*!
+ * @brief Erases all elements and frees the underlying memory.
+ */
+UTIL_PUBLIC_API void
+soa_vector_clear_free(struct soa_vector_t* vector);
+
+/*!
+ * @brief Makes sure all columns can hold at least the specified number of
+ * elements without reallocating.
+ * @return Returns 1 on success, 0 if memory allocation failed. In this case
+ * the vector is left unchanged.
+ */
+UTIL_PUBLIC_API char
+soa_vector_reserve(struct soa_vector_t* vector, uint32_t count);
+
+/*!
+ * @brief Appends an uninitialised element to every column. Use
+ * soa_vector_get() with index soa_vector_count() - 1 to fill in the fields.
+ * @return Returns 1 on success, 0 if memory allocation failed.
+ */
+UTIL_PUBLIC_API char
+soa_vector_push_emplace(struct soa_vector_t* vector);
+
+/*!
+ * @brief Erases the element at the specified index from every column by
+ * moving the last element into its place.
+ */
+UTIL_PUBLIC_API void
+soa_vector_erase_index(struct soa_vector_t* vector, uint32_t index);
+
+/*!
+ * @brief Number of elements in the soa vector.
+ */
+#define soa_vector_count(x) ((x)->count)
+
+/*!
+ * @brief Returns a pointer to the beginning of the specified column. The
+ * pointer is aligned to SOA_VECTOR_ALIGNMENT and is only valid until the
+ * vector grows.
+ */
+#define soa_vector_column(x, column) ((x)->columns[column])
+
+/*!
+ * @brief Returns a pointer to the field of the specified column belonging to
+ * the element at the specified index.
+ */
+#define soa_vector_get(x, column, index) \
+    ((void*)((char*)(x)->columns[column] + (x)->element_sizes[column] * (index)))
+
+C_HEADER_END
+
+#endif /* UTIL_SOA_VECTOR_H */
+
+/** @} */
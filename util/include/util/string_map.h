@@ -0,0 +1,76 @@
+/*!
+ * @file string_map.h
+ * @brief Selects the container used for string keyed lookups in ptree and
+ * the event system.
+ *
+ * By default this is @ref bst_hashed_vector.h. When the library is configured
+ * with ENABLE_OPEN_ADDRESSING_STRING_MAP, @ref hashmap.h is used instead.
+ * Both have the same interface, so code written against string_map_* and
+ * STRING_MAP_* compiles with either one.
+ *
+ * Neither implementation guarantees an iteration order that callers should
+ * rely on.
+ */
+
+#ifndef UTIL_STRING_MAP_H
+#define UTIL_STRING_MAP_H
+
+#include "util/config.h"
+
+#if defined(ENABLE_OPEN_ADDRESSING_STRING_MAP)
+#   include "util/hashmap.h"
+
+#   define string_map_t                         hashmap_t
+#   define string_map_key_t                     hashmap_key_t
+#   define string_map_key_init                  hashmap_key_init
+#   define string_map_key_init_n                hashmap_key_init_n
+#   define string_map_init                      hashmap_init
+#   define string_map_init_with_allocator       hashmap_init_with_allocator
+#   define string_map_insert                    hashmap_insert
+#   define string_map_insert_hashed             hashmap_insert_hashed
+#   define string_map_set                       hashmap_set
+#   define string_map_find                      hashmap_find
+#   define string_map_find_hashed               hashmap_find_hashed
+#   define string_map_find_key_hashed           hashmap_find_key_hashed
+#   define string_map_find_element              hashmap_find_element
+#   define string_map_key_exists                hashmap_key_exists
+#   define string_map_key_exists_hashed         hashmap_key_exists_hashed
+#   define string_map_erase                     hashmap_erase
+#   define string_map_erase_element             hashmap_erase_element
+#   define string_map_clear                     hashmap_clear
+#   define string_map_clear_free                hashmap_clear_free
+#   define string_map_count                     hashmap_count
+#   define string_map_allocator(map)            ((map)->allocator)
+#   define STRING_MAP_FOR_EACH                  HASHMAP_FOR_EACH
+#   define STRING_MAP_END_EACH                  HASHMAP_END_EACH
+#   define STRING_MAP_ERASE_CURRENT_ITEM_IN_FOR_LOOP HASHMAP_ERASE_CURRENT_ITEM_IN_FOR_LOOP
+#else
+#   include "util/bst_hashed_vector.h"
+
+#   define string_map_t                         bsthv_t
+#   define string_map_key_t                     bsthv_key_t
+#   define string_map_key_init                  bsthv_key_init
+#   define string_map_key_init_n                bsthv_key_init_n
+#   define string_map_init                      bsthv_init
+#   define string_map_init_with_allocator       bsthv_init_with_allocator
+#   define string_map_insert                    bsthv_insert
+#   define string_map_insert_hashed             bsthv_insert_hashed
+#   define string_map_set                       bsthv_set
+#   define string_map_find                      bsthv_find
+#   define string_map_find_hashed               bsthv_find_hashed
+#   define string_map_find_key_hashed           bsthv_find_key_hashed
+#   define string_map_find_element              bsthv_find_element
+#   define string_map_key_exists                bsthv_key_exists
+#   define string_map_key_exists_hashed         bsthv_key_exists_hashed
+#   define string_map_erase                     bsthv_erase
+#   define string_map_erase_element             bsthv_erase_element
+#   define string_map_clear                     bsthv_clear
+#   define string_map_clear_free                bsthv_clear_free
+#   define string_map_count                     bsthv_count
+#   define string_map_allocator(map)            ((map)->chains.allocator)
+#   define STRING_MAP_FOR_EACH                  BSTHV_FOR_EACH
+#   define STRING_MAP_END_EACH                  BSTHV_END_EACH
+#   define STRING_MAP_ERASE_CURRENT_ITEM_IN_FOR_LOOP BSTHV_ERASE_CURRENT_ITEM_IN_FOR_LOOP
+#endif
+
+#endif /* UTIL_STRING_MAP_H */
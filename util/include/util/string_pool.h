@@ -0,0 +1,112 @@
+/*!
+ * @file string_pool.h
+ * @brief Intern table for strings.
+ * @page string_pool String Pool
+ *
+ * A string pool stores every distinct string once. Interning a string returns
+ * a pointer to the pool's copy, and interning an equal string again returns
+ * the same pointer, so interned strings can be compared by pointer.
+ *
+ * The copies are packed into an @ref arena, so interning costs no MALLOC()
+ * per string. Individual strings are never freed. The whole pool is released
+ * at once with string_pool_clear() or string_pool_clear_free().
+ *
+ * bsthv can store its keys in a pool instead of allocating each key
+ * separately, see bsthv_set_string_pool(). A pool can be shared by many
+ * containers, e.g. all of the nodes of a tree loaded from a YAML file, where
+ * the same keys appear over and over.
+ * @{
+ */
+
+#ifndef UTIL_STRING_POOL_H
+#define UTIL_STRING_POOL_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include "util/arena.h"
+
+C_HEADER_BEGIN
+
+struct string_pool_slot_t
+{
+    const char* str;    /* NULL if the slot is empty */
+    uint32_t hash;
+    uint32_t len;
+};
+
+struct string_pool_t
+{
+    struct arena_t arena;               /* holds the string copies */
+    struct string_pool_slot_t* slots;   /* open addressing, linear probing */
+    uint32_t capacity;                  /* 0 or a power of two */
+    uint32_t count;
+};
+
+/*!
+ * @brief Creates a new string pool object.
+ * @return Returns the new pool, or NULL if allocation failed. It must be freed
+ * with string_pool_destroy() when no longer required.
+ */
+UTIL_PUBLIC_API struct string_pool_t*
+string_pool_create(void);
+
+/*!
+ * @brief Initialises an existing string pool object. No memory is allocated
+ * until the first string is interned.
+ */
+UTIL_PUBLIC_API void
+string_pool_init(struct string_pool_t* pool);
+
+/*!
+ * @brief Frees all strings held by the pool and the pool object itself.
+ */
+UTIL_PUBLIC_API void
+string_pool_destroy(struct string_pool_t* pool);
+
+/*!
+ * @brief Invalidates all interned strings but keeps the memory around for
+ * re-use.
+ */
+UTIL_PUBLIC_API void
+string_pool_clear(struct string_pool_t* pool);
+
+/*!
+ * @brief Invalidates all interned strings and frees all memory.
+ */
+UTIL_PUBLIC_API void
+string_pool_clear_free(struct string_pool_t* pool);
+
+/*!
+ * @brief Returns the pool's copy of a null terminated string, and copies it
+ * into the pool if it isn't there yet.
+ * @return Returns the interned string, which stays valid until the pool is
+ * cleared. Returns NULL if memory allocation failed.
+ */
+UTIL_PUBLIC_API const char*
+string_pool_intern(struct string_pool_t* pool, const char* str);
+
+/*!
+ * @brief Same as string_pool_intern(), but interns the first len characters
+ * of a string which doesn't have to be null terminated. The interned copy is
+ * null terminated.
+ */
+UTIL_PUBLIC_API const char*
+string_pool_intern_n(struct string_pool_t* pool, const char* str, uint32_t len);
+
+/*!
+ * @brief Returns the pool's copy of a string, or NULL if it was never
+ * interned. Never allocates.
+ */
+UTIL_PUBLIC_API const char*
+string_pool_find_n(const struct string_pool_t* pool, const char* str, uint32_t len);
+
+/*!
+ * @brief Returns the number of distinct strings in the pool.
+ */
+#define string_pool_count(pool) ((pool)->count)
+
+C_HEADER_END
+
+#endif /* UTIL_STRING_POOL_H */
+
+/** @} */
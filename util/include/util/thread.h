@@ -0,0 +1,130 @@
+/*!
+ * @file thread.h
+ * @brief Starting and joining operating system threads, and the mutexes
+ * and condition variables to make them wait for each other.
+ */
+
+#ifndef UTIL_THREAD_H
+#define UTIL_THREAD_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+
+/*!
+ * @brief Declares a variable with static storage duration of which every
+ * thread has its own copy.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#   define UTIL_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#   define UTIL_THREAD_LOCAL __declspec(thread)
+#else
+#   error "Thread local storage isn't implemented for this compiler"
+#endif
+
+C_HEADER_BEGIN
+
+struct thread_t;
+struct mutex_t;
+struct cond_t;
+
+/*! The function a new thread runs. The thread ends when it returns. */
+typedef void (*thread_func)(void* arg);
+
+/*!
+ * @brief Starts a new thread.
+ * @param[in] func The function to run in the new thread.
+ * @param[in] arg Passed to func.
+ * @return Returns the new thread, or NULL if it couldn't be started. The
+ * thread must be joined with thread_join(), which also frees it.
+ */
+UTIL_PUBLIC_API struct thread_t*
+thread_create(thread_func func, void* arg);
+
+/*!
+ * @brief Waits for a thread to finish and frees it.
+ */
+UTIL_PUBLIC_API void
+thread_join(struct thread_t* thread);
+
+/*!
+ * @brief Lets the operating system run another thread. Used when spinning
+ * on a value another thread is expected to change soon.
+ */
+UTIL_PUBLIC_API void
+thread_yield(void);
+
+/*!
+ * @brief Suspends the calling thread for at least the specified time. The
+ * operating system may round it up to its scheduler granularity.
+ */
+UTIL_PUBLIC_API void
+thread_sleep(uint32_t milliseconds);
+
+/*!
+ * @brief Returns the number of processors available to the process, or 1 if
+ * it can't be determined.
+ */
+UTIL_PUBLIC_API uint32_t
+thread_cpu_count(void);
+
+/*!
+ * @brief Creates a new, non-recursive mutex.
+ * @return Returns the new mutex, or NULL on failure.
+ */
+UTIL_PUBLIC_API struct mutex_t*
+mutex_create(void);
+
+/*!
+ * @brief Destroys a mutex. It must not be locked.
+ */
+UTIL_PUBLIC_API void
+mutex_destroy(struct mutex_t* mutex);
+
+/*! @brief Waits until no other thread holds the mutex and locks it. */
+UTIL_PUBLIC_API void
+mutex_lock(struct mutex_t* mutex);
+
+/*! @brief Unlocks a mutex held by the calling thread. */
+UTIL_PUBLIC_API void
+mutex_unlock(struct mutex_t* mutex);
+
+/*!
+ * @brief Creates a new condition variable.
+ * @return Returns the new condition variable, or NULL on failure.
+ */
+UTIL_PUBLIC_API struct cond_t*
+cond_create(void);
+
+/*!
+ * @brief Destroys a condition variable. No thread may be waiting on it.
+ */
+UTIL_PUBLIC_API void
+cond_destroy(struct cond_t* cond);
+
+/*!
+ * @brief Unlocks the mutex, waits until the condition variable is signalled
+ * and locks the mutex again before returning. The mutex must be locked by
+ * the calling thread.
+ * @note The wait can also end without a signal (spurious wake-up), so always
+ * check the condition being waited for again.
+ */
+UTIL_PUBLIC_API void
+cond_wait(struct cond_t* cond, struct mutex_t* mutex);
+
+/*!
+ * @brief Wakes up at least one thread waiting on the condition variable, if
+ * any.
+ */
+UTIL_PUBLIC_API void
+cond_signal(struct cond_t* cond);
+
+/*!
+ * @brief Wakes up all threads waiting on the condition variable.
+ */
+UTIL_PUBLIC_API void
+cond_broadcast(struct cond_t* cond);
+
+C_HEADER_END
+
+#endif /* UTIL_THREAD_H */
@@ -0,0 +1,150 @@
+/*!
+ * @file thread_pool.h
+ * @brief Work-stealing thread pool. Only available with ENABLE_THREAD_POOL.
+ * @page thread_pool Thread Pool
+ *
+ * A fixed number of worker threads run jobs. A job is a function and an
+ * argument, and is copied by value into the pool so submitting one doesn't
+ * allocate.
+ *
+ * Every worker has its own deque (Chase-Lev). Jobs submitted from inside a
+ * job go to the back of the submitting worker's deque, and the worker takes
+ * them from the back again. This keeps the most recently touched data on the
+ * same core. Workers with nothing to do steal from the front of the other
+ * deques, which is where the oldest and usually biggest pieces of work are.
+ * Jobs submitted from outside the pool go through a shared mpmc_queue_t.
+ * Workers sleep when there is no work anywhere.
+ *
+ * Completion is tracked with counters. A counter counts the jobs submitted
+ * with it which haven't finished yet. thread_pool_wait() runs other jobs
+ * until the counter reaches zero, so it can also be called from inside a job
+ * without blocking a worker. thread_pool_then() registers a continuation,
+ * which is a job that is submitted when the counter reaches zero.
+ *
+ * @code
+ * struct thread_pool_counter_t counter;
+ * thread_pool_counter_init(&counter);
+ * thread_pool_submit(pool, load_map, map, &counter);
+ * thread_pool_submit(pool, load_sounds, sounds, &counter);
+ * thread_pool_wait(pool, &counter);
+ * @endcode
+ * @{
+ */
+
+#ifndef UTIL_THREAD_POOL_H
+#define UTIL_THREAD_POOL_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+
+#ifdef ENABLE_THREAD_POOL
+
+C_HEADER_BEGIN
+
+struct thread_pool_t;
+
+typedef void (*thread_pool_func)(void* arg);
+typedef void (*thread_pool_range_func)(void* arg, uint32_t begin, uint32_t end);
+
+struct thread_pool_counter_t
+{
+    volatile uint32_t pending;
+    volatile uint32_t lock;
+    /* continuation, func is NULL if there is none */
+    thread_pool_func then_func;
+    void* then_arg;
+    struct thread_pool_counter_t* then_counter;
+};
+
+/*!
+ * @brief Creates a thread pool and starts its workers.
+ * @param[in] worker_count The number of worker threads. If 0, one worker per
+ * processor is started.
+ * @return Returns the new thread pool, or NULL on failure.
+ */
+UTIL_PUBLIC_API struct thread_pool_t*
+thread_pool_create(uint32_t worker_count);
+
+/*!
+ * @brief Waits for all submitted jobs to finish, including jobs they submit
+ * in turn, then stops the workers and frees the pool.
+ * @warning Must not be called from a job, and no jobs may be submitted from
+ * outside the pool while this runs.
+ */
+UTIL_PUBLIC_API void
+thread_pool_destroy(struct thread_pool_t* pool);
+
+/*!
+ * @brief Returns the number of worker threads.
+ */
+UTIL_PUBLIC_API uint32_t
+thread_pool_worker_count(const struct thread_pool_t* pool);
+
+/*!
+ * @brief Initialises a counter to zero.
+ */
+UTIL_PUBLIC_API void
+thread_pool_counter_init(struct thread_pool_counter_t* counter);
+
+/*!
+ * @brief Schedules func(arg) to run on the pool.
+ * @param[in] counter Incremented now and decremented when the job has
+ * finished. Can be NULL.
+ * @note If called from a job and the worker's deque is full, the job runs
+ * immediately in the calling thread instead.
+ */
+UTIL_PUBLIC_API void
+thread_pool_submit(struct thread_pool_t* pool,
+                   thread_pool_func func,
+                   void* arg,
+                   struct thread_pool_counter_t* counter);
+
+/*!
+ * @brief Schedules func(arg) to run once counter reaches zero. If it already
+ * is zero, func is submitted right away.
+ *
+ * A counter has room for one continuation. It is cleared when it is
+ * submitted, after which a new one can be registered.
+ * @param[in] counter The counter to wait for.
+ * @param[in] then_counter Counter of the continuation. It is incremented
+ * immediately, so waiting on it also waits for counter. Can be NULL.
+ */
+UTIL_PUBLIC_API void
+thread_pool_then(struct thread_pool_t* pool,
+                 struct thread_pool_counter_t* counter,
+                 thread_pool_func func,
+                 void* arg,
+                 struct thread_pool_counter_t* then_counter);
+
+/*!
+ * @brief Runs jobs until the counter reaches zero. Once this returns, no
+ * thread touches the counter any more and it can be freed.
+ */
+UTIL_PUBLIC_API void
+thread_pool_wait(struct thread_pool_t* pool, struct thread_pool_counter_t* counter);
+
+/*!
+ * @brief Calls func(arg, begin, end) on sub-ranges of [begin, end) in
+ * parallel and waits for all of them.
+ *
+ * The range is split in halves recursively until a piece is no larger than
+ * grain. Halves are pushed to the deque of the worker splitting them, so idle
+ * workers steal large pieces and split them further on their own core.
+ * @param[in] grain The largest number of elements a single call handles.
+ * Pick it so one call takes at least a few microseconds.
+ */
+UTIL_PUBLIC_API void
+thread_pool_parallel_for(struct thread_pool_t* pool,
+                         uint32_t begin,
+                         uint32_t end,
+                         uint32_t grain,
+                         thread_pool_range_func func,
+                         void* arg);
+
+C_HEADER_END
+
+#endif /* ENABLE_THREAD_POOL */
+
+#endif /* UTIL_THREAD_POOL_H */
+
+/** @} */
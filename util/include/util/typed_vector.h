@@ -0,0 +1,169 @@
+/*!
+ * @file typed_vector.h
+ * @brief Generates type-specialised wrappers around @ref ordered_vector.
+ * @page typed_vector Typed Vector
+ *
+ * The generic vector functions only know the size of an element at runtime,
+ * so every access multiplies by element_size and every insertion calls
+ * memcpy() with an unknown size. This prevents the compiler from inlining
+ * and vectorising loops over the elements.
+ *
+ * DECLARE_VECTOR(name, type) emits a struct name_t and a set of inline
+ * functions which operate on elements of the given type directly:
+ * ```
+ * DECLARE_VECTOR(int_vector, int)
+ *
+ * struct int_vector_t v;
+ * int_vector_init(&v);
+ * int_vector_push(&v, 5);
+ * TYPED_VECTOR_FOR_EACH(&v, int, value)
+ *     sum += *value;
+ * TYPED_VECTOR_END_EACH
+ * int_vector_clear_free(&v);
+ * ```
+ *
+ * The generated struct wraps an ordinary ordered_vector_t, so all of the
+ * generic functions (allocators, reserve(), shrink_to_fit(), erase_if(),
+ * inline storage, ...) still work on &v.vector. Only the hot paths are
+ * specialised; growing the vector is delegated to the generic code.
+ * @{
+ */
+
+#ifndef UTIL_TYPED_VECTOR_H
+#define UTIL_TYPED_VECTOR_H
+
+#include "util/pstdint.h"
+#include "util/config.h"
+#include "util/macros.h"
+#include "util/ordered_vector.h"
+#include <string.h>
+
+/*!
+ * @brief Declares a typed vector called name_t which stores elements of the
+ * specified type, and the following functions:
+ *   + void name_init(struct name_t*)
+ *   + void name_clear(struct name_t*)
+ *   + void name_clear_free(struct name_t*)
+ *   + uint32_t name_count(const struct name_t*)
+ *   + type* name_data(const struct name_t*)
+ *   + type* name_push_emplace(struct name_t*)
+ *   + char name_push(struct name_t*, type value)
+ *   + type* name_pop(struct name_t*)
+ *   + type* name_back(const struct name_t*)
+ *   + type* name_get(const struct name_t*, uint32_t index)
+ *   + void name_erase_index(struct name_t*, uint32_t index)
+ *
+ * They behave exactly like their ordered_vector_* counterparts.
+ * @note Use this at file scope, either in a header or in a source file.
+ */
+#define DECLARE_VECTOR(name, type)                                             \
+    struct name##_t                                                            \
+    {                                                                          \
+        struct ordered_vector_t vector;                                        \
+    };                                                                         \
+                                                                               \
+    UTIL_INLINE void                                                           \
+    name##_init(struct name##_t* v)                                            \
+    {                                                                          \
+        ordered_vector_init(&v->vector, sizeof(type));                         \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE void                                                           \
+    name##_clear(struct name##_t* v)                                           \
+    {                                                                          \
+        v->vector.count = 0;                                                   \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE void                                                           \
+    name##_clear_free(struct name##_t* v)                                      \
+    {                                                                          \
+        ordered_vector_clear_free(&v->vector);                                 \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE uint32_t                                                       \
+    name##_count(const struct name##_t* v)                                     \
+    {                                                                          \
+        return v->vector.count;                                                \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE type*                                                          \
+    name##_data(const struct name##_t* v)                                      \
+    {                                                                          \
+        return (type*)v->vector.data;                                          \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE type*                                                          \
+    name##_push_emplace(struct name##_t* v)                                    \
+    {                                                                          \
+        /* growing is rare, let the generic code deal with it */               \
+        if(v->vector.count == v->vector.capacity)                              \
+            return (type*)ordered_vector_push_emplace(&v->vector);             \
+        return (type*)v->vector.data + v->vector.count++;                      \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE char                                                           \
+    name##_push(struct name##_t* v, type value)                                \
+    {                                                                          \
+        type* slot = name##_push_emplace(v);                                   \
+        if(!slot)                                                              \
+            return 0;                                                          \
+        *slot = value;                                                         \
+        return 1;                                                              \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE type*                                                          \
+    name##_pop(struct name##_t* v)                                             \
+    {                                                                          \
+        if(!v->vector.count)                                                   \
+            return NULL;                                                       \
+        return (type*)v->vector.data + --v->vector.count;                      \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE type*                                                          \
+    name##_back(const struct name##_t* v)                                      \
+    {                                                                          \
+        if(!v->vector.count)                                                   \
+            return NULL;                                                       \
+        return (type*)v->vector.data + (v->vector.count - 1);                  \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE type*                                                          \
+    name##_get(const struct name##_t* v, uint32_t index)                       \
+    {                                                                          \
+        if(index >= v->vector.count)                                           \
+            return NULL;                                                       \
+        return (type*)v->vector.data + index;                                  \
+    }                                                                          \
+                                                                               \
+    UTIL_INLINE void                                                           \
+    name##_erase_index(struct name##_t* v, uint32_t index)                     \
+    {                                                                          \
+        type* data = (type*)v->vector.data;                                    \
+        if(index >= v->vector.count)                                           \
+            return;                                                            \
+        --v->vector.count;                                                     \
+        memmove(data + index, data + index + 1,                                \
+                (v->vector.count - index) * sizeof(type));                     \
+    }
+
+/*!
+ * @brief Iterates over all elements of a typed vector. Unlike
+ * ORDERED_VECTOR_FOR_EACH, the stride is known at compile time.
+ * @param[in] v A pointer to the typed vector to iterate.
+ * @param[in] var_type The type the vector was declared with.
+ * @param[in] var The name of a temporary variable of type var_type* which
+ * points to the current element.
+ */
+#define TYPED_VECTOR_FOR_EACH(v, var_type, var) {                              \
+    var_type* var;                                                             \
+    var_type* internal_##var##_end = (var_type*)(v)->vector.data + (v)->vector.count; \
+    for(var = (var_type*)(v)->vector.data; var != internal_##var##_end; ++var) {
+
+/*!
+ * @brief Closes a for each scope previously opened by TYPED_VECTOR_FOR_EACH.
+ */
+#define TYPED_VECTOR_END_EACH }}
+
+#endif /* UTIL_TYPED_VECTOR_H */
+
+/** @} */
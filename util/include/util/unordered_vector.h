@@ -27,6 +27,11 @@
 
 C_HEADER_BEGIN
 
+struct allocator_t;
+
+/*! Capacity is multiplied by this whenever the vector runs out of space. */
+#define UNORDERED_VECTOR_DEFAULT_GROWTH_FACTOR 2.0f
+
 #define DATA_POINTER_TYPE unsigned char
 struct unordered_vector_t
 {
@@ -34,6 +39,10 @@ struct unordered_vector_t
     uint32_t capacity;           /* how many elements actually fit into the allocated space */
     uint32_t count;              /* number of elements inserted */
     DATA_POINTER_TYPE* data;     /* pointer to the contiguous section of memory */
+    const struct allocator_t* allocator; /* where data comes from. NULL means MALLOC()/FREE() */
+    float growth_factor;         /* capacity is multiplied by this when expanding */
+    DATA_POINTER_TYPE* inline_data; /* optional storage owned by the user, used before spilling to the heap */
+    uint32_t inline_capacity;    /* how many elements fit into inline_data */
 };
 
 /*!
@@ -57,6 +66,67 @@ UTIL_PUBLIC_API void
 unordered_vector_init(struct unordered_vector_t* vector,
                       const uint32_t element_size);
 
+/*!
+ * @brief Initialises an existing vector object and makes it use the specified
+ * allocator for all of its memory.
+ * @note This does **not** free existing memory. If you've pushed elements
+ * into your vector and call this, you will have created a memory leak.
+ * @param[in] vector The vector to initialise.
+ * @param[in] element_size Specifies the size in bytes of the type of data you
+ * want the vector to store. Typically one would pass sizeof(my_data_type).
+ * @param[in] allocator The allocator to use. Must outlive the vector. If NULL,
+ * the global MALLOC() and FREE() are used (same as unordered_vector_init()).
+ */
+UTIL_PUBLIC_API void
+unordered_vector_init_with_allocator(struct unordered_vector_t* vector,
+                                     const uint32_t element_size,
+                                     const struct allocator_t* allocator);
+
+/*!
+ * @brief Initialises an existing vector object so it stores its first
+ * elements in the specified buffer, and only allocates memory once it
+ * outgrows the buffer.
+ *
+ * This is intended for vectors that typically hold very few elements. The
+ * buffer is usually an array member of the struct which also contains the
+ * vector:
+ * ```
+ * struct foo_t
+ * {
+ *     struct unordered_vector_t bars;
+ *     struct bar_t bars_inline[4];
+ * };
+ * unordered_vector_init_inline(&foo->bars, sizeof(struct bar_t), foo->bars_inline, 4);
+ * ```
+ * @warning Because the vector points into the buffer, a vector initialised
+ * this way must not be copied or moved in memory together with its buffer.
+ * @param[in] vector The vector to initialise.
+ * @param[in] element_size Specifies the size in bytes of the type of data you
+ * want the vector to store. Typically one would pass sizeof(my_data_type).
+ * @param[in] buffer Storage for inline_capacity elements. Must outlive the
+ * vector. It is never freed by the vector.
+ * @param[in] inline_capacity How many elements fit into buffer.
+ */
+UTIL_PUBLIC_API void
+unordered_vector_init_inline(struct unordered_vector_t* vector,
+                             const uint32_t element_size,
+                             void* buffer,
+                             uint32_t inline_capacity);
+
+/*!
+ * @brief Same as unordered_vector_init_inline(), but once the vector outgrows
+ * the buffer, its memory comes from the specified allocator.
+ * @param[in] allocator The allocator to use. Must outlive the vector. If NULL,
+ * the global MALLOC() and FREE() are used (same as
+ * unordered_vector_init_inline()).
+ */
+UTIL_PUBLIC_API void
+unordered_vector_init_inline_with_allocator(struct unordered_vector_t* vector,
+                                            const uint32_t element_size,
+                                            void* buffer,
+                                            uint32_t inline_capacity,
+                                            const struct allocator_t* allocator);
+
 /*!
  * @brief Destroys an existing vector object and frees all memory allocated by
  * inserted elements.
@@ -82,6 +152,39 @@ unordered_vector_clear(struct unordered_vector_t* vector);
 UTIL_PUBLIC_API void
 unordered_vector_clear_free(struct unordered_vector_t* vector);
 
+/*!
+ * @brief Makes sure the vector has space for at least the specified number of
+ * elements, so that up to that many elements can be inserted without the
+ * vector re-allocating.
+ * @param[in] vector The vector to reserve memory in.
+ * @param[in] count The number of elements to reserve space for. If this is
+ * smaller than the current capacity, nothing happens.
+ * @return Returns 1 if successful, 0 if memory allocation failed. The vector
+ * is left unchanged on failure.
+ */
+UTIL_PUBLIC_API char
+unordered_vector_reserve(struct unordered_vector_t* vector, uint32_t count);
+
+/*!
+ * @brief Gives back any memory not occupied by elements. If the vector is
+ * empty, all of its memory is freed.
+ * @param[in] vector The vector to shrink.
+ * @return Returns 1 if successful, 0 if memory allocation failed. The vector
+ * is left unchanged on failure.
+ */
+UTIL_PUBLIC_API char
+unordered_vector_shrink_to_fit(struct unordered_vector_t* vector);
+
+/*!
+ * @brief Sets the factor by which the capacity grows whenever the vector runs
+ * out of space. The default is UNORDERED_VECTOR_DEFAULT_GROWTH_FACTOR.
+ * @note Smaller factors waste less memory but re-allocate more often.
+ * @param[in] vector The vector to configure.
+ * @param[in] factor Must be larger than 1.
+ */
+UTIL_PUBLIC_API void
+unordered_vector_set_growth_factor(struct unordered_vector_t* vector, float factor);
+
 /*!
  * @brief Gets the number of elements that have been inserted into the vector.
  */
@@ -59,6 +59,8 @@ yaml_load_from_stream(FILE* stream);
 
 /*!
  * @brief Destroys a loaded yaml nodeument.
+ * @note Only documents returned by yaml_create() or one of the yaml_load
+ * functions can be destroyed with this, not nodes inside of them.
  * @param node The nodeument to destroy.
  */
 UTIL_PUBLIC_API void
@@ -117,14 +119,14 @@ yaml_string_to_bool(const char* str);
 #define YAML_FOR_EACH(m_root, m_key, m_hash_var, m_node_var) {               \
     struct ptree_t* yaml_internal_##m_root_node;                             \
     if((yaml_internal_##m_root_node = yaml_get_node(m_root, m_key))) {       \
-        BSTHV_FOR_EACH(&(yaml_internal_##m_root_node)->children,             \
+        STRING_MAP_FOR_EACH(&(yaml_internal_##m_root_node)->children,        \
                      struct ptree_t,                                         \
                      m_hash_var,                                             \
                      m_node_var)
 
-#define YAML_END_EACH BSTHV_END_EACH }}
+#define YAML_END_EACH STRING_MAP_END_EACH }}
 
-#define YAML_IF_EACH_FAILED BSTHV_END_EACH } else {
+#define YAML_IF_EACH_FAILED STRING_MAP_END_EACH } else {
 
 #define YAML_ENDIF_EACH_FAILED }}
 
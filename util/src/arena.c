@@ -0,0 +1,164 @@
+#include "util/arena.h"
+#include "util/memory.h"
+#include <string.h>
+#include <assert.h>
+
+/* all allocations are rounded up to a multiple of this */
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(x) (((x) + (ARENA_ALIGNMENT - 1)) & ~((uintptr_t)ARENA_ALIGNMENT - 1))
+
+struct arena_block_t
+{
+    struct arena_block_t* next;
+    uintptr_t capacity;
+    uintptr_t used;
+};
+
+/* block header is padded so the first allocation is aligned */
+#define ARENA_HEADER_SIZE ARENA_ALIGN(sizeof(struct arena_block_t))
+#define ARENA_BLOCK_DATA(block) ((unsigned char*)(block) + ARENA_HEADER_SIZE)
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static void*
+arena_allocate_wrapper(void* user_data, uintptr_t size)
+{
+    return arena_alloc((struct arena_t*)user_data, size);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+arena_deallocate_wrapper(void* user_data, void* ptr)
+{
+    /* memory is only reclaimed when the arena is cleared */
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+arena_free_blocks(struct arena_block_t* block)
+{
+    while(block)
+    {
+        struct arena_block_t* next = block->next;
+        FREE(block);
+        block = next;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct arena_t*
+arena_create(uintptr_t block_size)
+{
+    struct arena_t* arena;
+    if(!(arena = (struct arena_t*)MALLOC(sizeof *arena, "arena_create()")))
+        return NULL;
+    arena_init(arena, block_size);
+    return arena;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+arena_init(struct arena_t* arena, uintptr_t block_size)
+{
+    assert(arena);
+    assert(block_size);
+
+    memset(arena, 0, sizeof *arena);
+    arena->block_size = ARENA_ALIGN(block_size);
+    arena->allocator.allocate = arena_allocate_wrapper;
+    arena->allocator.reallocate = NULL;
+    arena->allocator.deallocate = arena_deallocate_wrapper;
+    arena->allocator.user_data = arena;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+arena_destroy(struct arena_t* arena)
+{
+    assert(arena);
+    arena_clear_free(arena);
+    FREE(arena);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+arena_clear(struct arena_t* arena)
+{
+    assert(arena);
+
+    if(!arena->blocks)
+        return;
+
+    arena_free_blocks(arena->blocks->next);
+    arena->blocks->next = NULL;
+    arena->blocks->used = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+arena_clear_free(struct arena_t* arena)
+{
+    assert(arena);
+    arena_free_blocks(arena->blocks);
+    arena->blocks = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+static void*
+arena_alloc_impl(struct arena_t* arena, uintptr_t size, uintptr_t align)
+{
+    struct arena_block_t* block;
+    uintptr_t offset;
+    void* ptr;
+
+    assert(arena);
+
+    block = arena->blocks;
+    offset = block ? (block->used + align - 1) & ~(align - 1) : 0;
+
+    if(!block || offset + size > block->capacity)
+    {
+        uintptr_t capacity = (size > arena->block_size ? size : arena->block_size);
+        if(!(block = (struct arena_block_t*)MALLOC(ARENA_HEADER_SIZE + capacity, "arena_alloc()")))
+            return NULL;
+        block->capacity = capacity;
+        block->used = 0;
+        offset = 0;
+
+        /*
+         * Oversized blocks are linked in behind the current block so the
+         * remaining space in the current block isn't wasted.
+         */
+        if(arena->blocks && capacity > arena->block_size)
+        {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        }
+        else
+        {
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+    }
+
+    ptr = ARENA_BLOCK_DATA(block) + offset;
+    block->used = offset + size;
+    return ptr;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+arena_alloc(struct arena_t* arena, uintptr_t size)
+{
+    return arena_alloc_impl(arena, ARENA_ALIGN(size), ARENA_ALIGNMENT);
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+arena_alloc_unaligned(struct arena_t* arena, uintptr_t size)
+{
+    return arena_alloc_impl(arena, size, 1);
+}
@@ -1,12 +1,18 @@
 #include "util/bst_hashed_vector.h"
 #include "util/hash.h"
 #include "util/memory.h"
+#include "util/allocator.h"
 #include "util/string.h"
+#include "util/key_search.h"
+#include "util/string_pool.h"
 #include <string.h>
 #include <assert.h>
 
+#define BSTHV_HASHES(bsthv) ((uint32_t*)(bsthv)->hashes.data)
+#define BSTHV_CHAINS(bsthv) ((struct bsthv_value_chain_t*)(bsthv)->chains.data)
+
 /* default hash function */
-static uint32_t(*g_hash_func)(const char*, uint32_t len) = hash_jenkins_oaat;
+static uint32_t(*g_hash_func)(const char*, uint32_t len) = hash_wyhash32;
 
 /* ------------------------------------------------------------------------- */
 void
@@ -19,7 +25,7 @@ bsthv_set_string_hash_func(uint32_t(*func)(const char*, uint32_t len))
 void
 bsthv_restore_default_hash_func(void)
 {
-    g_hash_func = hash_jenkins_oaat;
+    g_hash_func = hash_wyhash32;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -29,6 +35,25 @@ bsthv_hash_string(const char* str)
     return g_hash_func(str, strlen(str));
 }
 
+/* ------------------------------------------------------------------------- */
+void
+bsthv_key_init(struct bsthv_key_t* key, const char* str)
+{
+    assert(str);
+    bsthv_key_init_n(key, str, (uint32_t)strlen(str));
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bsthv_key_init_n(struct bsthv_key_t* key, const char* str, uint32_t len)
+{
+    assert(key);
+    assert(str);
+    key->str = str;
+    key->len = len;
+    key->hash = g_hash_func(str, len);
+}
+
 /* ------------------------------------------------------------------------- */
 struct bsthv_t*
 bsthv_create(void)
@@ -43,10 +68,46 @@ bsthv_create(void)
 /* ------------------------------------------------------------------------- */
 void
 bsthv_init(struct bsthv_t* bsthv)
+{
+    bsthv_init_with_allocator(bsthv, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bsthv_init_with_allocator(struct bsthv_t* bsthv,
+                          const struct allocator_t* allocator)
 {
     assert(bsthv);
-    ordered_vector_init(&bsthv->vector, sizeof(struct bsthv_key_value_t));
+    ordered_vector_init_with_allocator(&bsthv->hashes, sizeof(uint32_t), allocator);
+    ordered_vector_init_with_allocator(&bsthv->chains, sizeof(struct bsthv_value_chain_t), allocator);
+    bsthv->key_pool = NULL;
     bsthv->count = 0;
+    bsthv->owns_key_pool = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+bsthv_set_string_pool(struct bsthv_t* bsthv, struct string_pool_t* pool)
+{
+    assert(bsthv);
+    assert(bsthv->count == 0);
+
+    if(pool == NULL)
+    {
+        if(bsthv->owns_key_pool)
+            return 1;
+        if(!(pool = string_pool_create()))
+            return 0;
+        bsthv->owns_key_pool = 1;
+    }
+    else if(bsthv->owns_key_pool)
+    {
+        string_pool_destroy(bsthv->key_pool);
+        bsthv->owns_key_pool = 0;
+    }
+
+    bsthv->key_pool = pool;
+    return 1;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -59,84 +120,122 @@ bsthv_destroy(struct bsthv_t* bsthv)
 }
 
 /* ------------------------------------------------------------------------- */
-/* algorithm taken from GNU GCC stdlibc++'s lower_bound function, line 2121 in stl_algo.h */
-/* https://gcc.gnu.org/onlinedocs/libstdc++/libstdc++-html-USERS-4.3/a02014.html */
-static struct bsthv_key_value_t*
-bsthv_find_lower_bound(const struct bsthv_t* bsthv, uint32_t hash)
+/*
+ * Returns the index of the value chain with the specified hash, or the
+ * number of hashes if it doesn't exist.
+ */
+static uint32_t
+bsthv_find_index(const struct bsthv_t* bsthv, uint32_t hash)
 {
-    uint32_t half;
-    struct bsthv_key_value_t* middle;
-    struct bsthv_key_value_t* data;
-    uint32_t len;
+    uint32_t index;
 
     assert(bsthv);
 
-    data = (struct bsthv_key_value_t*)bsthv->vector.data;
-    len = bsthv->vector.count;
+    index = key_search_lower_bound(BSTHV_HASHES(bsthv), bsthv->hashes.count, hash);
+    if(index != bsthv->hashes.count && BSTHV_HASHES(bsthv)[index] != hash)
+        return bsthv->hashes.count;
+    return index;
+}
 
-    /* if the vector has no data, return NULL */
-    if(!len)
+/* ------------------------------------------------------------------------- */
+static struct bsthv_value_chain_t*
+bsthv_find_chain(const struct bsthv_t* bsthv, uint32_t hash)
+{
+    uint32_t index = bsthv_find_index(bsthv, hash);
+    if(index == bsthv->hashes.count)
         return NULL;
+    return BSTHV_CHAINS(bsthv) + index;
+}
 
-    while(len > 0)
-    {
-        half = len >> 1;
-        middle = data + half;
-        if(middle->hash < hash)
-        {
-            data = middle;
-            ++data;
-            len = len - half - 1;
-        }
-        else
-            len = half;
-    }
+/* ------------------------------------------------------------------------- */
+/* The key isn't necessarily null terminated, it can be part of a longer string */
+static char
+bsthv_key_equals(const char* stored, const struct bsthv_key_t* key)
+{
+    if(stored == key->str)  /* interned keys */
+        return stored[key->len] == '\0';
+    return strncmp(stored, key->str, key->len) == 0 && stored[key->len] == '\0';
+}
 
-    /* if "data" is pointing outside of the valid elements in the vector, also return NULL */
-    if((intptr_t)data >= (intptr_t)bsthv->vector.data + (intptr_t)bsthv->vector.count * (intptr_t)bsthv->vector.element_size)
+/* ------------------------------------------------------------------------- */
+static char*
+bsthv_malloc_key(const struct bsthv_t* bsthv, const struct bsthv_key_t* key)
+{
+    char* buffer;
+    if(bsthv->key_pool)
+        return (char*)string_pool_intern_n(bsthv->key_pool, key->str, key->len);
+    if(!(buffer = (char*)ALLOCATOR_MALLOC(bsthv->chains.allocator, key->len + 1, "bsthv_malloc_key()")))
         return NULL;
-    else
-        return data;
+    memcpy(buffer, key->str, key->len);
+    buffer[key->len] = '\0';
+    return buffer;
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+bsthv_free_key(const struct bsthv_t* bsthv, char* key)
+{
+    assert(key);
+    if(bsthv->key_pool)
+        return;  /* freed when the pool is cleared */
+    ALLOCATOR_FREE(bsthv->chains.allocator, key);
 }
 
 /* ------------------------------------------------------------------------- */
 char
 bsthv_insert(struct bsthv_t* bsthv, const char* key, void* value)
 {
-    struct bsthv_key_value_t* new_kv;
-    uint32_t hash = bsthv_hash_string(key);
+    struct bsthv_key_t k;
+    bsthv_key_init(&k, key);
+    return bsthv_insert_hashed(bsthv, &k, value);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+bsthv_insert_hashed(struct bsthv_t* bsthv, const struct bsthv_key_t* key, void* value)
+{
+    struct bsthv_value_chain_t* new_vc;
+    uint32_t* new_hash;
+    uint32_t index;
+    uint32_t hash;
+
+    assert(bsthv);
+    assert(key);
+
+    hash = key->hash;
 
     /* get the lower bound of the insertion point */
-    struct bsthv_key_value_t* lower_bound = bsthv_find_lower_bound(bsthv, hash);
+    index = key_search_lower_bound(BSTHV_HASHES(bsthv), bsthv->hashes.count, hash);
 
     /* hash collision */
-    if(lower_bound && lower_bound->hash == hash)
+    if(index != bsthv->hashes.count && BSTHV_HASHES(bsthv)[index] == hash)
     {
         /*
          * Get to the end of the chain and make sure no existing keys match the
          * new key.
          */
-        struct bsthv_value_chain_t* vc = &lower_bound->value_chain;
+        struct bsthv_value_chain_t* vc = BSTHV_CHAINS(bsthv) + index;
         do
         {
             /* sanity check - all values in chain must have a key */
             assert(vc->key);
 
-            if(strcmp(key, vc->key) == 0)
+            if(bsthv_key_equals(vc->key, key))
                 return 0; /* key exists, abort */
 
         } while(vc->next && (vc = vc->next));
 
         /* allocate and link a new value at the end of the chain */
-        vc->next = (struct bsthv_value_chain_t*)MALLOC(sizeof *vc, "bsthv_insert()");
+        vc->next = (struct bsthv_value_chain_t*)ALLOCATOR_MALLOC(bsthv->chains.allocator, sizeof *vc, "bsthv_insert()");
         if(!vc->next)
             return 0;
         memset(vc->next, 0, sizeof *vc->next);
         /* key */
-        vc->next->key = malloc_string(key);
+        vc->next->key = bsthv_malloc_key(bsthv, key);
         if(!vc->next->key)
         {
-            FREE(vc->next);
+            ALLOCATOR_FREE(bsthv->chains.allocator, vc->next);
+            vc->next = NULL;
             return 0;
         }
         /* value */
@@ -148,24 +247,26 @@ bsthv_insert(struct bsthv_t* bsthv, const char* key, void* value)
     }
 
     /*
-     * No hash collision. Either push back or insert, depending on whether
-     * there is already data in the bsthv.
+     * No hash collision. Insert a new hash and a new chain at the same
+     * position. The vectors grow independently, so undo the first insertion
+     * if anything after it fails.
      */
-    if(!lower_bound)
-        new_kv = (struct bsthv_key_value_t*)ordered_vector_push_emplace(&bsthv->vector);
-    else
-        new_kv = ordered_vector_insert_emplace(&bsthv->vector,
-                lower_bound - (struct bsthv_key_value_t*)bsthv->vector.data);
-    if(!new_kv)
+    if(!(new_hash = (uint32_t*)ordered_vector_insert_emplace(&bsthv->hashes, index)))
+        return 0;
+    if(!(new_vc = (struct bsthv_value_chain_t*)ordered_vector_insert_emplace(&bsthv->chains, index)))
+    {
+        ordered_vector_erase_index(&bsthv->hashes, index);
         return 0;
+    }
 
-    memset(new_kv, 0, sizeof *new_kv);
-    new_kv->hash = hash;
-    new_kv->value_chain.value = value;
-    new_kv->value_chain.key = malloc_string(key);
-    if(!new_kv->value_chain.key)
+    *new_hash = hash;
+    memset(new_vc, 0, sizeof *new_vc);
+    new_vc->value = value;
+    new_vc->key = bsthv_malloc_key(bsthv, key);
+    if(!new_vc->key)
     {
-        ordered_vector_erase_element(&bsthv->vector, new_kv);
+        ordered_vector_erase_index(&bsthv->hashes, index);
+        ordered_vector_erase_index(&bsthv->chains, index);
         return 0;
     }
 
@@ -177,7 +278,6 @@ bsthv_insert(struct bsthv_t* bsthv, const char* key, void* value)
 void
 bsthv_set(struct bsthv_t* bsthv, const char* key, void* value)
 {
-    struct bsthv_key_value_t* kv;
     struct bsthv_value_chain_t* vc;
     uint32_t hash;
 
@@ -185,22 +285,20 @@ bsthv_set(struct bsthv_t* bsthv, const char* key, void* value)
     assert(key);
 
     /*
-     * Compute hash and look up the key-value object. If the returned object
-     * doesn't have the same hash as the computed hash, it means the key
-     * doesn't exist.
+     * Compute hash and look up the value chain. If no chain has the same
+     * hash as the computed hash, it means the key doesn't exist.
      */
     hash = bsthv_hash_string(key);
-    kv = bsthv_find_lower_bound(bsthv, hash);
-    if(!kv || kv->hash != hash)
+    if(!(vc = bsthv_find_chain(bsthv, hash)))
         return;
 
     /*
      * If there are no further values in the value chain, this must be the
      * value.
      */
-    if(!kv->value_chain.next)
+    if(!vc->next)
     {
-        kv->value_chain.value = value;
+        vc->value = value;
         return;
     }
 
@@ -208,7 +306,6 @@ bsthv_set(struct bsthv_t* bsthv, const char* key, void* value)
      * Iterate the value chain and compare each string with the key until it is
      * found. Then set the value.
      */
-    vc = &kv->value_chain;
     do
     {
         if(strcmp(key, vc->key) == 0)
@@ -224,38 +321,43 @@ bsthv_set(struct bsthv_t* bsthv, const char* key, void* value)
 void*
 bsthv_find(const struct bsthv_t* bsthv, const char* key)
 {
-    struct bsthv_key_value_t* data;
+    struct bsthv_key_t k;
+    bsthv_key_init(&k, key);
+    return bsthv_find_hashed(bsthv, &k);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Returns the entry in the value chains holding the key, or NULL */
+static struct bsthv_value_chain_t*
+bsthv_find_entry(const struct bsthv_t* bsthv, const struct bsthv_key_t* key)
+{
     struct bsthv_value_chain_t* vc;
-    uint32_t hash;
 
     assert(bsthv);
+    assert(key);
 
     /*
-     * Compute hash and look up the key-value object. If the returned object
-     * doesn't have the same hash as the computed hash, it means the key
-     * doesn't exist.
+     * Look up the value chain. If no chain has the same hash as the key, it
+     * means the key doesn't exist.
      */
-    hash = bsthv_hash_string(key);
-    data = bsthv_find_lower_bound(bsthv, hash);
-    if(!data || data->hash != hash)
+    if(!(vc = bsthv_find_chain(bsthv, key->hash)))
         return NULL;
 
     /*
      * If there is only one value in the chain then it must be the value we're
      * looking for.
      */
-    if(!data->value_chain.next)
-        return data->value_chain.value;
+    if(!vc->next)
+        return vc;
 
     /*
      * Iterate chain and string compare each key with the key we're looking for
      * until a matching key is found.
      */
-    vc = &data->value_chain;
     do
     {
-        if(strcmp(key, vc->key) == 0)
-            return vc->value;
+        if(bsthv_key_equals(vc->key, key))
+            return vc;
 
         vc = vc->next;
     } while(vc);
@@ -263,14 +365,30 @@ bsthv_find(const struct bsthv_t* bsthv, const char* key)
     return NULL;
 }
 
+/* ------------------------------------------------------------------------- */
+void*
+bsthv_find_hashed(const struct bsthv_t* bsthv, const struct bsthv_key_t* key)
+{
+    struct bsthv_value_chain_t* vc = bsthv_find_entry(bsthv, key);
+    return vc ? vc->value : NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+const char*
+bsthv_find_key_hashed(const struct bsthv_t* bsthv, const struct bsthv_key_t* key)
+{
+    struct bsthv_value_chain_t* vc = bsthv_find_entry(bsthv, key);
+    return vc ? vc->key : NULL;
+}
+
 /* ------------------------------------------------------------------------- */
 const char*
 bsthv_find_element(const struct bsthv_t* bsthv, const void* value)
 {
     assert(bsthv);
 
-    ORDERED_VECTOR_FOR_EACH(&bsthv->vector, struct bsthv_key_value_t, kv)
-        struct bsthv_value_chain_t* vc = &kv->value_chain;
+    ORDERED_VECTOR_FOR_EACH(&bsthv->chains, struct bsthv_value_chain_t, chain)
+        struct bsthv_value_chain_t* vc = chain;
         do
         {
             if(vc->value == value)
@@ -286,11 +404,11 @@ bsthv_find_element(const struct bsthv_t* bsthv, const void* value)
 void*
 bsthv_get_any_element(const struct bsthv_t* bsthv)
 {
-    struct bsthv_key_value_t* kv;
+    struct bsthv_value_chain_t* vc;
     assert(bsthv);
-    kv = (struct bsthv_key_value_t*)ordered_vector_back(&bsthv->vector);
-    if(kv)
-        return kv->value_chain.value;
+    vc = (struct bsthv_value_chain_t*)ordered_vector_back(&bsthv->chains);
+    if(vc)
+        return vc->value;
     return NULL;
 }
 
@@ -298,29 +416,33 @@ bsthv_get_any_element(const struct bsthv_t* bsthv)
 char
 bsthv_key_exists(struct bsthv_t* bsthv, const char* key)
 {
-    struct bsthv_key_value_t* data;
+    struct bsthv_key_t k;
+    bsthv_key_init(&k, key);
+    return bsthv_key_exists_hashed(bsthv, &k);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+bsthv_key_exists_hashed(const struct bsthv_t* bsthv, const struct bsthv_key_t* key)
+{
     struct bsthv_value_chain_t* vc;
-    uint32_t hash;
 
     assert(bsthv);
+    assert(key);
 
     /*
-     * Compute hash and look up the key-value object. If the returned object
-     * doesn't have the same hash as the computed hash, it means the key
-     * doesn't exist.
+     * Look up the value chain. If no chain has the same hash as the key, it
+     * means the key doesn't exist.
      */
-    hash = bsthv_hash_string(key);
-    data = bsthv_find_lower_bound(bsthv, hash);
-    if(!data || data->hash != hash)
+    if(!(vc = bsthv_find_chain(bsthv, key->hash)))
         return 0;
 
     /*
      * Iterate over chain and find the key we're looking for.
      */
-    vc = &data->value_chain;
     do
     {
-        if(strcmp(key, vc->key) == 0)
+        if(bsthv_key_equals(vc->key, key))
             return 1;
         vc = vc->next;
     } while(vc);
@@ -332,40 +454,45 @@ bsthv_key_exists(struct bsthv_t* bsthv, const char* key)
 void*
 bsthv_erase(struct bsthv_t* bsthv, const char* key)
 {
-    struct bsthv_key_value_t* kv;
+    uint32_t index;
     uint32_t hash;
 
     assert(bsthv);
     assert(key);
 
     /*
-     * Compute hash and look up the key-value object. If the returned object
-     * doesn't have the same hash as the computed hash, it means the key
-     * doesn't exist.
+     * Compute hash and look up the value chain. If no chain has the same
+     * hash as the computed hash, it means the key doesn't exist.
      */
     hash = bsthv_hash_string(key);
-    kv = bsthv_find_lower_bound(bsthv, hash);
-    if(!kv || kv->hash != hash)
+    index = bsthv_find_index(bsthv, hash);
+    if(index == bsthv->hashes.count)
         return NULL;
 
-    /* kv object exists and is valid. Remove it */
-    return bsthv_erase_key_value_object(bsthv, key, kv);
+    /* chain exists and is valid. Remove the key from it */
+    return bsthv_erase_index(bsthv, index, key);
 }
 
 /* ------------------------------------------------------------------------- */
 void*
-bsthv_erase_key_value_object(struct bsthv_t* bsthv,
-                             const char* key,
-                             struct bsthv_key_value_t* kv)
+bsthv_erase_index(struct bsthv_t* bsthv, uint32_t index, const char* key)
 {
     struct bsthv_value_chain_t* vc;
     struct bsthv_value_chain_t* parent_vc;
 
-    if(!kv->value_chain.next)
+    assert(bsthv);
+    assert(key);
+
+    if(index >= bsthv->hashes.count)
+        return NULL;
+
+    vc = BSTHV_CHAINS(bsthv) + index;
+    if(!vc->next)
     {
-        void* value = kv->value_chain.value;
-        free_string(kv->value_chain.key);
-        ordered_vector_erase_element(&bsthv->vector, kv);
+        void* value = vc->value;
+        bsthv_free_key(bsthv, vc->key);
+        ordered_vector_erase_index(&bsthv->hashes, index);
+        ordered_vector_erase_index(&bsthv->chains, index);
         --(bsthv->count);
         return value;
     }
@@ -376,15 +503,14 @@ bsthv_erase_key_value_object(struct bsthv_t* bsthv,
      * values down the chain, the next value must be copied into the vector and
      * deallocated to maintain the structure).
      */
-    vc = &kv->value_chain;
-    if(strcmp(key, kv->value_chain.key) == 0)
+    if(strcmp(key, vc->key) == 0)
     {
         struct bsthv_value_chain_t* replacement = vc->next;
         void* ret_value = vc->value;
         /* we have everything we need, free current and move replacement into its place */
-        free_string(vc->key);
+        bsthv_free_key(bsthv, vc->key);
         memcpy(vc, replacement, sizeof *vc); /* copies the next value into the bsthv's internal vector */
-        FREE(replacement);
+        ALLOCATOR_FREE(bsthv->chains.allocator, replacement);
 
         /* done */
         --(bsthv->count);
@@ -402,9 +528,9 @@ bsthv_erase_key_value_object(struct bsthv_t* bsthv,
         if(strcmp(key, vc->key) == 0)
         {
             void* value = vc->value;
-            free_string(vc->key);
+            bsthv_free_key(bsthv, vc->key);
             parent_vc->next = vc->next; /* unlink this value by linking next with parent */
-            FREE(vc);
+            ALLOCATOR_FREE(bsthv->chains.allocator, vc);
             --(bsthv->count);
             return value;
         }
@@ -436,17 +562,17 @@ static void
 bsthv_free_all_chains_and_keys(struct bsthv_t* bsthv)
 {
     assert(bsthv);
-    ORDERED_VECTOR_FOR_EACH(&bsthv->vector, struct bsthv_key_value_t, kv)
-        struct bsthv_value_chain_t* vc = kv->value_chain.next;
+    ORDERED_VECTOR_FOR_EACH(&bsthv->chains, struct bsthv_value_chain_t, chain)
+        struct bsthv_value_chain_t* vc = chain->next;
 
-        free_string(kv->value_chain.key);
+        bsthv_free_key(bsthv, chain->key);
 
         while(vc)
         {
             struct bsthv_value_chain_t* to_free = vc;
             vc = vc->next;
-            free_string(to_free->key);
-            FREE(to_free);
+            bsthv_free_key(bsthv, to_free->key);
+            ALLOCATOR_FREE(bsthv->chains.allocator, to_free);
         }
     ORDERED_VECTOR_END_EACH
 }
@@ -457,8 +583,11 @@ bsthv_clear(struct bsthv_t* bsthv)
 {
     assert(bsthv);
     bsthv_free_all_chains_and_keys(bsthv);
-    ordered_vector_clear(&bsthv->vector);
+    ordered_vector_clear(&bsthv->hashes);
+    ordered_vector_clear(&bsthv->chains);
     bsthv->count = 0;
+    if(bsthv->owns_key_pool)
+        string_pool_clear(bsthv->key_pool);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -466,7 +595,13 @@ void bsthv_clear_free(struct bsthv_t* bsthv)
 {
     assert(bsthv);
     bsthv_free_all_chains_and_keys(bsthv);
-    ordered_vector_clear_free(&bsthv->vector);
+    ordered_vector_clear_free(&bsthv->hashes);
+    ordered_vector_clear_free(&bsthv->chains);
     bsthv->count = 0;
+    if(bsthv->owns_key_pool)
+    {
+        string_pool_destroy(bsthv->key_pool);
+        bsthv->key_pool = NULL;
+        bsthv->owns_key_pool = 0;
+    }
 }
-
@@ -1,18 +1,25 @@
 #include "util/bst_vector.h"
 #include "util/memory.h"
 #include "util/string.h"
+#include "util/allocator.h"
+#include "util/key_search.h"
+#include "util/macros.h"
 #include <assert.h>
 #include <string.h>
+#include <stddef.h>
 
 const uint32_t BST_VECTOR_INVALID_HASH = (uint32_t)-1;
 
+#define BSTV_HASHES(bstv) ((uint32_t*)(bstv)->hashes.data)
+#define BSTV_VALUES(bstv) ((void**)(bstv)->values.data)
+
 /* ------------------------------------------------------------------------- */
 struct bstv_t*
 bstv_create(void)
 {
     struct bstv_t* bstv;
     if(!(bstv = (struct bstv_t*)MALLOC(sizeof *bstv, "bstv_create()")))
-    	return NULL;
+        return NULL;
     bstv_init(bstv);
     return bstv;
 }
@@ -20,9 +27,23 @@ bstv_create(void)
 /* ------------------------------------------------------------------------- */
 void
 bstv_init(struct bstv_t* bstv)
+{
+    bstv_init_with_allocator(bstv, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bstv_init_with_allocator(struct bstv_t* bstv,
+                         const struct allocator_t* allocator)
 {
     assert(bstv);
-    ordered_vector_init(&bstv->vector, sizeof(struct bstv_hash_value_t));
+    ordered_vector_init_with_allocator(&bstv->hashes, sizeof(uint32_t), allocator);
+    ordered_vector_init_with_allocator(&bstv->values, sizeof(void*), allocator);
+    bstv->eytzinger_hashes = NULL;
+    bstv->eytzinger_values = NULL;
+    bstv->eytzinger_block = NULL;
+    bstv->read_optimised = 0;
+    bstv->eytzinger_dirty = 1;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -35,119 +56,301 @@ bstv_destroy(struct bstv_t* bstv)
 }
 
 /* ------------------------------------------------------------------------- */
-/* algorithm taken from GNU GCC stdlibc++'s lower_bound function, line 2121 in stl_algo.h */
-/* https://gcc.gnu.org/onlinedocs/libstdc++/libstdc++-html-USERS-4.3/a02014.html */
-static struct bstv_hash_value_t*
-bstv_find_lower_bound(const struct bstv_t* bstv, uint32_t hash)
+/*
+ * Returns the index of the element with the specified hash, or the number
+ * of elements if it doesn't exist.
+ */
+static uint32_t
+bstv_find_index(const struct bstv_t* bstv, uint32_t hash)
 {
-    uint32_t half;
-    struct bstv_hash_value_t* middle;
-    struct bstv_hash_value_t* data;
-    uint32_t len;
+    uint32_t index;
 
     assert(bstv);
 
-    data = (struct bstv_hash_value_t*)bstv->vector.data;
-    len = bstv->vector.count;
+    index = key_search_lower_bound(BSTV_HASHES(bstv), bstv_count(bstv), hash);
+    if(index != bstv_count(bstv) && BSTV_HASHES(bstv)[index] != hash)
+        return bstv_count(bstv);
+    return index;
+}
+
+/* ------------------------------------------------------------------------- */
+static uint32_t
+bstv_count_trailing_zeros(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(x);
+#else
+    uint32_t n = 0;
+    while(!(x & 1))
+    {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+bstv_eytzinger_free(struct bstv_t* bstv)
+{
+    if(bstv->eytzinger_block)
+        ALLOCATOR_FREE(bstv->hashes.allocator, bstv->eytzinger_block);
+    bstv->eytzinger_block = NULL;
+    bstv->eytzinger_hashes = NULL;
+    bstv->eytzinger_values = NULL;
+    bstv->eytzinger_dirty = 1;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * An in-order traversal of the implicit tree (children of k are 2k and
+ * 2k+1) visits the nodes in sorted order, so assigning the sorted elements
+ * in that order produces the Eytzinger layout.
+ */
+static uint32_t
+bstv_eytzinger_fill(struct bstv_t* bstv, uint32_t i, uint32_t k)
+{
+    if(k <= bstv_count(bstv))
+    {
+        i = bstv_eytzinger_fill(bstv, i, 2 * k);
+        bstv->eytzinger_hashes[k] = BSTV_HASHES(bstv)[i];
+        bstv->eytzinger_values[k] = BSTV_VALUES(bstv)[i];
+        ++i;
+        i = bstv_eytzinger_fill(bstv, i, 2 * k + 1);
+    }
+    return i;
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+bstv_eytzinger_rebuild(struct bstv_t* bstv)
+{
+    uintptr_t hash_count;
+    void* block;
+
+    bstv_eytzinger_free(bstv);
+
+    /*
+     * The hash array is aligned to a cache line so that the 16 descendants
+     * of node k four levels down (16k to 16k+15) share one cache line. The
+     * hash count is rounded up to an even number to keep the value array
+     * pointer aligned.
+     */
+    hash_count = (bstv_count(bstv) + 2) & ~(uintptr_t)1;
+    block = ALLOCATOR_MALLOC(bstv->hashes.allocator,
+                             63 + hash_count * sizeof(uint32_t) + (bstv_count(bstv) + 1) * sizeof(void*),
+                             "bstv_eytzinger_rebuild()");
+    if(!block)
+        return 0;
+
+    bstv->eytzinger_block = block;
+    bstv->eytzinger_hashes = (uint32_t*)(((uintptr_t)block + 63) & ~(uintptr_t)63);
+    bstv->eytzinger_values = (void**)(bstv->eytzinger_hashes + hash_count);
+    bstv_eytzinger_fill(bstv, 0, 1);
+    bstv->eytzinger_dirty = 0;
+
+    return 1;
+}
 
-    /* if the vector has no data, return NULL */
-    if(!len)
-    	return NULL;
+/* ------------------------------------------------------------------------- */
+/*
+ * Returns 1 if lookups can use the Eytzinger index, rebuilding it first if
+ * the vectors were modified.
+ */
+static char
+bstv_eytzinger_ready(const struct bstv_t* bstv)
+{
+    if(!bstv->read_optimised)
+        return 0;
+    if(!bstv->eytzinger_dirty)
+        return 1;
+    /* lazily rebuilding the index doesn't change the logical contents */
+    return bstv_eytzinger_rebuild((struct bstv_t*)bstv);
+}
 
-    while(len > 0)
+/* ------------------------------------------------------------------------- */
+/*
+ * Returns the index of the node holding the hash, or 0 if it doesn't exist.
+ */
+static uint32_t
+bstv_eytzinger_search(const struct bstv_t* bstv, uint32_t hash)
+{
+    const uint32_t* hashes = bstv->eytzinger_hashes;
+    uint32_t n = bstv_count(bstv);
+    uint32_t k = 1;
+
+    /* branchless descent, the comparison result selects the child */
+    while(k <= n)
     {
-    	half = len >> 1;
-    	middle = data + half;
-    	if(middle->hash < hash)
-    	{
-    		data = middle;
-    		++data;
-    		len = len - half - 1;
-    	}
-    	else
-    		len = half;
+        UTIL_PREFETCH(hashes + 16 * k);
+        k = 2 * k + (hashes[k] < hash);
     }
 
-    /* if "data" is pointing outside of the valid elements in the vector, also return NULL */
-    if((intptr_t)data >= (intptr_t)bstv->vector.data + (intptr_t)bstv->vector.count * (intptr_t)bstv->vector.element_size)
-    	return NULL;
-    else
-    	return data;
+    /*
+     * The path taken is encoded in the bits of k, where a 1 means "went
+     * right". The lower bound is the node where we last went left, so strip
+     * the trailing ones plus one more bit.
+     */
+    k >>= bstv_count_trailing_zeros(~k) + 1;
+    if(k == 0 || hashes[k] != hash)
+        return 0;
+    return k;
 }
 
 /* ------------------------------------------------------------------------- */
 char
 bstv_insert(struct bstv_t* bstv, uint32_t hash, void* value)
 {
-    struct bstv_hash_value_t* emplaced_data;
-    struct bstv_hash_value_t* lower_bound;
+    uint32_t index;
+    uint32_t* emplaced_hash;
+    void** emplaced_value;
 
     assert(bstv);
 
     /* don't insert reserved hashes */
     if(hash == BST_VECTOR_INVALID_HASH)
-    	return 0;
+        return 0;
 
     /* lookup location in bstv to insert */
-    lower_bound = bstv_find_lower_bound(bstv, hash);
-    if(lower_bound && lower_bound->hash == hash)
-    	return 0;
+    index = key_search_lower_bound(BSTV_HASHES(bstv), bstv_count(bstv), hash);
+    if(index != bstv_count(bstv) && BSTV_HASHES(bstv)[index] == hash)
+        return 0;
+
+    /* the vectors grow independently, undo the first if the second fails */
+    if(!(emplaced_hash = (uint32_t*)ordered_vector_insert_emplace(&bstv->hashes, index)))
+        return 0;
+    if(!(emplaced_value = (void**)ordered_vector_insert_emplace(&bstv->values, index)))
+    {
+        ordered_vector_erase_index(&bstv->hashes, index);
+        return 0;
+    }
 
-    /* either push back or insert, depending on whether there is already data
-     * in the bstv */
-    if(!lower_bound)
-    	emplaced_data = (struct bstv_hash_value_t*)ordered_vector_push_emplace(&bstv->vector);
-    else
-    	emplaced_data = ordered_vector_insert_emplace(&bstv->vector,
-    					  lower_bound - (struct bstv_hash_value_t*)bstv->vector.data);
+    *emplaced_hash = hash;
+    *emplaced_value = value;
+    bstv->eytzinger_dirty = 1;
 
-    if(!emplaced_data)
-    	return 0;
+    return 1;
+}
 
-    memset(emplaced_data, 0, sizeof *emplaced_data);
-    emplaced_data->hash = hash;
-    emplaced_data->value = value;
+/* ------------------------------------------------------------------------- */
+char
+bstv_build_from_unsorted(struct bstv_t* bstv,
+                         const struct bstv_hash_value_t* pairs,
+                         uint32_t count)
+{
+    struct ordered_vector_t sorted;
+    struct ordered_vector_t hashes;
+    struct ordered_vector_t values;
+    struct bstv_hash_value_t* read;
+    struct bstv_hash_value_t* end;
 
+    assert(bstv);
+    assert(pairs || !count);
+
+    /*
+     * Sort into separate vectors so the bstv is left untouched if any
+     * allocation fails.
+     */
+    ordered_vector_init_with_allocator(&sorted,
+                                       sizeof(struct bstv_hash_value_t),
+                                       bstv->hashes.allocator);
+    ordered_vector_init_with_allocator(&hashes, sizeof(uint32_t), bstv->hashes.allocator);
+    ordered_vector_init_with_allocator(&values, sizeof(void*), bstv->values.allocator);
+    hashes.growth_factor = bstv->hashes.growth_factor;
+    values.growth_factor = bstv->values.growth_factor;
+    if(count)
+    {
+        if(!ordered_vector_reserve(&sorted, count))
+            return 0;
+        memcpy(sorted.data, pairs, count * sizeof(struct bstv_hash_value_t));
+        sorted.count = count;
+    }
+
+    /* stable, so the first of several equal hashes stays in front */
+    if(!ordered_vector_radix_sort_u32(&sorted, offsetof(struct bstv_hash_value_t, hash)))
+        goto sort_failed;
+
+    if(!ordered_vector_reserve(&hashes, count))
+        goto sort_failed;
+    if(!ordered_vector_reserve(&values, count))
+        goto reserve_values_failed;
+
+    /* split into the two vectors, dropping duplicates and reserved hashes */
+    read = (struct bstv_hash_value_t*)sorted.data;
+    end = read + sorted.count;
+    for(; read != end; ++read)
+    {
+        if(read->hash == BST_VECTOR_INVALID_HASH)
+            break; /* sorts last, nothing valid follows */
+        if(hashes.count && ((uint32_t*)hashes.data)[hashes.count - 1] == read->hash)
+            continue;
+        ((uint32_t*)hashes.data)[hashes.count++] = read->hash;
+        ((void**)values.data)[values.count++] = read->value;
+    }
+    ordered_vector_clear_free(&sorted);
+
+    ordered_vector_clear_free(&bstv->hashes);
+    ordered_vector_clear_free(&bstv->values);
+    bstv->hashes = hashes;
+    bstv->values = values;
+    bstv->eytzinger_dirty = 1;
     return 1;
+
+    reserve_values_failed : ordered_vector_clear_free(&hashes);
+    sort_failed           : ordered_vector_clear_free(&sorted);
+    return 0;
 }
 
 /* ------------------------------------------------------------------------- */
 void
 bstv_set(struct bstv_t* bstv, uint32_t hash, void* value)
 {
-    struct bstv_hash_value_t* data;
+    uint32_t index;
 
     assert(bstv);
 
-    data = bstv_find_lower_bound(bstv, hash);
-    if(data && data->hash == hash)
-    	data->value = value;
+    index = bstv_find_index(bstv, hash);
+    if(index == bstv_count(bstv))
+        return;
+
+    BSTV_VALUES(bstv)[index] = value;
+    /* the layout doesn't change, so patch the index instead of rebuilding */
+    if(bstv->read_optimised && !bstv->eytzinger_dirty)
+        bstv->eytzinger_values[bstv_eytzinger_search(bstv, hash)] = value;
 }
 
 /* ------------------------------------------------------------------------- */
 void*
 bstv_find(const struct bstv_t* bstv, uint32_t hash)
 {
-    struct bstv_hash_value_t* data;
+    uint32_t index;
 
     assert(bstv);
 
-    data = bstv_find_lower_bound(bstv, hash);
-    if(!data || data->hash != hash)
-    	return NULL;
-    return data->value;
+    if(bstv_eytzinger_ready(bstv))
+    {
+        uint32_t k = bstv_eytzinger_search(bstv, hash);
+        return k ? bstv->eytzinger_values[k] : NULL;
+    }
+
+    index = bstv_find_index(bstv, hash);
+    if(index == bstv_count(bstv))
+        return NULL;
+    return BSTV_VALUES(bstv)[index];
 }
 
 /* ------------------------------------------------------------------------- */
 uint32_t
 bstv_find_element(const struct bstv_t* bstv, const void* value)
 {
+    uint32_t i;
+
     assert(bstv);
 
-    ORDERED_VECTOR_FOR_EACH(&bstv->vector, struct bstv_hash_value_t, kv)
-    	if(kv->value == value)
-    		return kv->hash;
-    ORDERED_VECTOR_END_EACH
+    for(i = 0; i != bstv_count(bstv); ++i)
+        if(BSTV_VALUES(bstv)[i] == value)
+            return BSTV_HASHES(bstv)[i];
     return BST_VECTOR_INVALID_HASH;
 }
 
@@ -155,11 +358,11 @@ bstv_find_element(const struct bstv_t* bstv, const void* value)
 void*
 bstv_get_any_element(const struct bstv_t* bstv)
 {
-    struct bstv_hash_value_t* kv;
+    void** value;
     assert(bstv);
-    kv = (struct bstv_hash_value_t*)ordered_vector_back(&bstv->vector);
-    if(kv)
-    	return kv->value;
+    value = (void**)ordered_vector_back(&bstv->values);
+    if(value)
+        return *value;
     return NULL;
 }
 
@@ -167,65 +370,88 @@ bstv_get_any_element(const struct bstv_t* bstv)
 char
 bstv_hash_exists(struct bstv_t* bstv, uint32_t hash)
 {
-    struct bstv_hash_value_t* data;
-
     assert(bstv);
 
-    data = bstv_find_lower_bound(bstv, hash);
-    if(data && data->hash == hash)
-    	return 1;
-    return 0;
+    if(bstv_eytzinger_ready(bstv))
+        return bstv_eytzinger_search(bstv, hash) != 0;
+
+    return bstv_find_index(bstv, hash) != bstv_count(bstv);
 }
 
 /* ------------------------------------------------------------------------- */
 uint32_t
 bstv_find_unused_hash(struct bstv_t* bstv)
 {
-    uint32_t i = 0;
+    uint32_t lo, hi;
 
     assert(bstv);
 
-    BSTV_FOR_EACH(bstv, void, key, value)
-    	if(i != key)
-    		break;
-    	++i;
-    BSTV_END_EACH
-    return i;
+    /*
+     * The hashes are sorted and unique, so hashes[i] >= i. Every hash below
+     * the first unused one is equal to its index, every hash after it is
+     * greater, which means the first unused hash can be bisected for.
+     */
+    lo = 0;
+    hi = bstv_count(bstv);
+    while(lo != hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if(BSTV_HASHES(bstv)[mid] == mid)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
 }
 
 /* ------------------------------------------------------------------------- */
 void*
 bstv_erase(struct bstv_t* bstv, uint32_t hash)
 {
-    void* value;
-    struct bstv_hash_value_t* data;
+    uint32_t index;
 
     assert(bstv);
 
-    data = bstv_find_lower_bound(bstv, hash);
-    if(!data || data->hash != hash)
-    	return NULL;
+    index = bstv_find_index(bstv, hash);
+    if(index == bstv_count(bstv))
+        return NULL;
 
-    value = data->value;
-    ordered_vector_erase_element(&bstv->vector, (DATA_POINTER_TYPE*)data);
-    return value;
+    return bstv_erase_index(bstv, index);
 }
 
 /* ------------------------------------------------------------------------- */
 void*
 bstv_erase_element(struct bstv_t* bstv, void* value)
 {
-    void* data;
-    uint32_t hash;
+    uint32_t i;
 
     assert(bstv);
 
-    hash = bstv_find_element(bstv, value);
-    if(hash == BST_VECTOR_INVALID_HASH)
-    	return NULL;
+    for(i = 0; i != bstv_count(bstv); ++i)
+        if(BSTV_VALUES(bstv)[i] == value)
+        {
+            bstv_erase_index(bstv, i);
+            return value;
+        }
 
-    data = bstv_find_lower_bound(bstv, hash);
-    ordered_vector_erase_element(&bstv->vector, (DATA_POINTER_TYPE*)data);
+    return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+bstv_erase_index(struct bstv_t* bstv, uint32_t index)
+{
+    void* value;
+
+    assert(bstv);
+
+    if(index >= bstv_count(bstv))
+        return NULL;
+
+    value = BSTV_VALUES(bstv)[index];
+    ordered_vector_erase_index(&bstv->hashes, index);
+    ordered_vector_erase_index(&bstv->values, index);
+    bstv->eytzinger_dirty = 1;
 
     return value;
 }
@@ -235,12 +461,34 @@ void
 bstv_clear(struct bstv_t* bstv)
 {
     assert(bstv);
-    ordered_vector_clear(&bstv->vector);
+    ordered_vector_clear(&bstv->hashes);
+    ordered_vector_clear(&bstv->values);
+    bstv->eytzinger_dirty = 1;
 }
 
 /* ------------------------------------------------------------------------- */
 void bstv_clear_free(struct bstv_t* bstv)
 {
     assert(bstv);
-    ordered_vector_clear_free(&bstv->vector);
+    ordered_vector_clear_free(&bstv->hashes);
+    ordered_vector_clear_free(&bstv->values);
+    bstv_eytzinger_free(bstv);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+bstv_optimise_for_reads(struct bstv_t* bstv)
+{
+    assert(bstv);
+    bstv->read_optimised = 1;
+    return bstv_eytzinger_rebuild(bstv);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bstv_disable_read_optimisation(struct bstv_t* bstv)
+{
+    assert(bstv);
+    bstv->read_optimised = 0;
+    bstv_eytzinger_free(bstv);
 }
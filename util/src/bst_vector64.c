@@ -0,0 +1,203 @@
+#include "util/bst_vector64.h"
+#include "util/memory.h"
+#include <assert.h>
+
+#define BSTV64_ENTRIES(bstv) ((struct bstv64_key_value_t*)(bstv)->vector.data)
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+/*
+ * Returns the index of the first element whose key is not less than the
+ * specified key.
+ */
+static uint32_t
+bstv64_lower_bound(const struct bstv64_t* bstv, uint64_t key)
+{
+    const struct bstv64_key_value_t* entries = BSTV64_ENTRIES(bstv);
+    uint32_t first = 0;
+    uint32_t count = bstv64_count(bstv);
+
+    while(count)
+    {
+        uint32_t half = count / 2;
+        if(entries[first + half].key < key)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+            count = half;
+    }
+
+    return first;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Returns the index of the element with the specified key, or the number
+ * of elements if it doesn't exist.
+ */
+static uint32_t
+bstv64_find_index(const struct bstv64_t* bstv, uint64_t key)
+{
+    uint32_t index = bstv64_lower_bound(bstv, key);
+    if(index != bstv64_count(bstv) && BSTV64_ENTRIES(bstv)[index].key != key)
+        return bstv64_count(bstv);
+    return index;
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct bstv64_t*
+bstv64_create(void)
+{
+    struct bstv64_t* bstv;
+    if(!(bstv = (struct bstv64_t*)MALLOC(sizeof *bstv, "bstv64_create()")))
+        return NULL;
+    bstv64_init(bstv);
+    return bstv;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bstv64_init(struct bstv64_t* bstv)
+{
+    bstv64_init_with_allocator(bstv, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bstv64_init_with_allocator(struct bstv64_t* bstv,
+                           const struct allocator_t* allocator)
+{
+    assert(bstv);
+    ordered_vector_init_with_allocator(&bstv->vector,
+                                       sizeof(struct bstv64_key_value_t),
+                                       allocator);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bstv64_destroy(struct bstv64_t* bstv)
+{
+    assert(bstv);
+    bstv64_clear_free(bstv);
+    FREE(bstv);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+bstv64_insert(struct bstv64_t* bstv, uint64_t key, void* value)
+{
+    uint32_t index;
+    struct bstv64_key_value_t* emplaced;
+
+    assert(bstv);
+
+    /* don't insert reserved keys */
+    if(key == BST_VECTOR64_INVALID_KEY)
+        return 0;
+
+    index = bstv64_lower_bound(bstv, key);
+    if(index != bstv64_count(bstv) && BSTV64_ENTRIES(bstv)[index].key == key)
+        return 0;
+
+    if(!(emplaced = (struct bstv64_key_value_t*)ordered_vector_insert_emplace(&bstv->vector, index)))
+        return 0;
+    emplaced->key = key;
+    emplaced->value = value;
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bstv64_set(struct bstv64_t* bstv, uint64_t key, void* value)
+{
+    uint32_t index;
+
+    assert(bstv);
+
+    index = bstv64_find_index(bstv, key);
+    if(index != bstv64_count(bstv))
+        BSTV64_ENTRIES(bstv)[index].value = value;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+bstv64_find(const struct bstv64_t* bstv, uint64_t key)
+{
+    uint32_t index;
+
+    assert(bstv);
+
+    index = bstv64_find_index(bstv, key);
+    if(index == bstv64_count(bstv))
+        return NULL;
+    return BSTV64_ENTRIES(bstv)[index].value;
+}
+
+/* ------------------------------------------------------------------------- */
+uint64_t
+bstv64_find_element(const struct bstv64_t* bstv, const void* value)
+{
+    uint32_t i;
+
+    assert(bstv);
+
+    for(i = 0; i != bstv64_count(bstv); ++i)
+        if(BSTV64_ENTRIES(bstv)[i].value == value)
+            return BSTV64_ENTRIES(bstv)[i].key;
+    return BST_VECTOR64_INVALID_KEY;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+bstv64_key_exists(const struct bstv64_t* bstv, uint64_t key)
+{
+    assert(bstv);
+    return bstv64_find_index(bstv, key) != bstv64_count(bstv);
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+bstv64_erase(struct bstv64_t* bstv, uint64_t key)
+{
+    assert(bstv);
+    return bstv64_erase_index(bstv, bstv64_find_index(bstv, key));
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+bstv64_erase_index(struct bstv64_t* bstv, uint32_t index)
+{
+    void* value;
+
+    assert(bstv);
+
+    if(index >= bstv64_count(bstv))
+        return NULL;
+
+    value = BSTV64_ENTRIES(bstv)[index].value;
+    ordered_vector_erase_index(&bstv->vector, index);
+
+    return value;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bstv64_clear(struct bstv64_t* bstv)
+{
+    assert(bstv);
+    ordered_vector_clear(&bstv->vector);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+bstv64_clear_free(struct bstv64_t* bstv)
+{
+    assert(bstv);
+    ordered_vector_clear_free(&bstv->vector);
+}
@@ -2,6 +2,10 @@
 #include "util/string.h"
 #include <string.h>
 
+#if defined(_MSC_VER) && defined(_M_X64)
+#   include <intrin.h>
+#endif
+
 /*
  * Shift operations in C are only defined for shift values which are
  * not negative and smaller than sizeof(value) * CHAR_BIT.
@@ -41,6 +45,158 @@ hash_jenkins_oaat(const char* message, uint32_t len)
     return hash;
 }
 
+/* ------------------------------------------------------------------------- */
+/* wyhash */
+/* ------------------------------------------------------------------------- */
+
+static uint64_t g_hash_seed = 0;
+
+static const uint64_t g_wyhash_secret[4] = {
+    UINT64_C(0x2d358dccaa6c78a5),
+    UINT64_C(0x8bb84b93962eacc9),
+    UINT64_C(0x4b33a62ed433d4a3),
+    UINT64_C(0x4d5a2da51de1aa47)
+};
+
+/* ------------------------------------------------------------------------- */
+/* Computes the 128-bit product of a and b, stores the low half in a and the
+ * high half in b */
+static void
+wyhash_mum(uint64_t* a, uint64_t* b)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = *a;
+    r *= *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t lo, hi;
+    uint64_t c = t < rl;
+    lo = t + (rm1 << 32);
+    c += lo < t;
+    hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    *a = lo;
+    *b = hi;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+static uint64_t
+wyhash_mix(uint64_t a, uint64_t b)
+{
+    wyhash_mum(&a, &b);
+    return a ^ b;
+}
+
+/* ------------------------------------------------------------------------- */
+/* memcpy() instead of a cast so unaligned keys are fine. Compilers turn this
+ * into a single load */
+static uint64_t
+wyhash_read8(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+/* ------------------------------------------------------------------------- */
+static uint64_t
+wyhash_read4(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+/* ------------------------------------------------------------------------- */
+uint64_t
+hash_wyhash64(const void* key, uint32_t len, uint64_t seed)
+{
+    const uint8_t* p = (const uint8_t*)key;
+    const uint64_t* secret = g_wyhash_secret;
+    uint64_t a, b;
+
+    seed ^= wyhash_mix(seed ^ secret[0], secret[1]);
+
+    if(len <= 16)
+    {
+        if(len >= 4)
+        {
+            /* Two overlapping pairs of 4 byte reads cover 4-16 bytes */
+            uint32_t shift = (len >> 3) << 2;
+            a = (wyhash_read4(p) << 32) | wyhash_read4(p + shift);
+            b = (wyhash_read4(p + len - 4) << 32) | wyhash_read4(p + len - 4 - shift);
+        }
+        else if(len > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        }
+        else
+            a = b = 0;
+    }
+    else
+    {
+        uint32_t i = len;
+        if(i > 48)
+        {
+            /* Three independent lanes so the multiplications can overlap */
+            uint64_t see1 = seed, see2 = seed;
+            do
+            {
+                seed = wyhash_mix(wyhash_read8(p) ^ secret[1], wyhash_read8(p + 8) ^ seed);
+                see1 = wyhash_mix(wyhash_read8(p + 16) ^ secret[2], wyhash_read8(p + 24) ^ see1);
+                see2 = wyhash_mix(wyhash_read8(p + 32) ^ secret[3], wyhash_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while(i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while(i > 16)
+        {
+            seed = wyhash_mix(wyhash_read8(p) ^ secret[1], wyhash_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wyhash_read8(p + i - 16);
+        b = wyhash_read8(p + i - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    wyhash_mum(&a, &b);
+    return wyhash_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+hash_wyhash32(const char* key, uint32_t len)
+{
+    uint64_t hash = hash_wyhash64(key, len, g_hash_seed);
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+/* ------------------------------------------------------------------------- */
+void
+hash_set_seed(uint64_t seed)
+{
+    g_hash_seed = seed;
+}
+
+/* ------------------------------------------------------------------------- */
+uint64_t
+hash_get_seed(void)
+{
+    return g_hash_seed;
+}
+
 /* ------------------------------------------------------------------------- */
 const char* sha256_get_next_chunk(const char* message,
                                          uint32_t len,
@@ -0,0 +1,544 @@
+#include "util/hashmap.h"
+#include "util/hash.h"
+#include "util/memory.h"
+#include "util/allocator.h"
+#include <string.h>
+#include <assert.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define HASHMAP_SSE2
+#   include <emmintrin.h>
+#endif
+
+#define HASHMAP_NOT_FOUND 0xFFFFFFFF
+
+/* top 7 bits are stored in the control byte, the low bits select the group */
+#define HASHMAP_H2(hash) ((uint8_t)((hash) >> 25))
+
+/* at most 7/8 of the slots are used before the table grows */
+#define HASHMAP_MAX_LOAD(capacity) ((capacity) - (capacity) / 8)
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+/* ------------------------------------------------------------------------- */
+/* The key isn't necessarily null terminated, it can be part of a longer string */
+static char
+hashmap_key_equals(const char* stored, const struct hashmap_key_t* key)
+{
+    return strncmp(stored, key->str, key->len) == 0 && stored[key->len] == '\0';
+}
+
+/* ------------------------------------------------------------------------- */
+static uint32_t
+hashmap_count_trailing_zeros(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(x);
+#else
+    uint32_t n = 0;
+    while(!(x & 1))
+    {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+/* Returns a bit for each control byte in the group equal to the specified byte */
+static uint32_t
+hashmap_group_match(const uint8_t* group, uint8_t byte)
+{
+#if defined(HASHMAP_SSE2)
+    __m128i ctrl = _mm_load_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+#else
+    uint32_t mask = 0;
+    uint32_t i;
+    for(i = 0; i != HASHMAP_GROUP_WIDTH; ++i)
+        if(group[i] == byte)
+            mask |= (uint32_t)1 << i;
+    return mask;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+/* Returns a bit for each empty or deleted slot in the group */
+static uint32_t
+hashmap_group_match_free(const uint8_t* group)
+{
+#if defined(HASHMAP_SSE2)
+    /* both empty and deleted have the sign bit set */
+    return (uint32_t)_mm_movemask_epi8(_mm_load_si128((const __m128i*)group));
+#else
+    uint32_t mask = 0;
+    uint32_t i;
+    for(i = 0; i != HASHMAP_GROUP_WIDTH; ++i)
+        if(group[i] & HASHMAP_CTRL_FREE_BIT)
+            mask |= (uint32_t)1 << i;
+    return mask;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Returns the slot holding the specified key, or HASHMAP_NOT_FOUND.
+ *
+ * Groups are probed in triangular order, which visits every group exactly
+ * once when the number of groups is a power of two.
+ */
+static uint32_t
+hashmap_find_slot(const struct hashmap_t* map, const struct hashmap_key_t* key)
+{
+    uint32_t group_mask, group, step;
+    uint32_t hash = key->hash;
+    uint8_t h2 = HASHMAP_H2(hash);
+
+    if(map->capacity == 0)
+        return HASHMAP_NOT_FOUND;
+
+    group_mask = map->capacity / HASHMAP_GROUP_WIDTH - 1;
+    group = hash & group_mask;
+    for(step = 0; step <= group_mask; ++step)
+    {
+        uint32_t base = group * HASHMAP_GROUP_WIDTH;
+        uint32_t matches = hashmap_group_match(map->ctrl + base, h2);
+        while(matches)
+        {
+            uint32_t slot = base + hashmap_count_trailing_zeros(matches);
+            if(map->slots[slot].hash == hash && hashmap_key_equals(map->slots[slot].key, key))
+                return slot;
+            matches &= matches - 1;
+        }
+
+        /* the key would have been inserted into this group if it existed */
+        if(hashmap_group_match(map->ctrl + base, HASHMAP_CTRL_EMPTY))
+            return HASHMAP_NOT_FOUND;
+
+        group = (group + step + 1) & group_mask;
+    }
+
+    return HASHMAP_NOT_FOUND;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Returns the first empty or deleted slot on the probe sequence of the
+ * specified hash. The table must have at least one free slot.
+ */
+static uint32_t
+hashmap_find_free_slot(const uint8_t* ctrl, uint32_t capacity, uint32_t hash)
+{
+    uint32_t group_mask = capacity / HASHMAP_GROUP_WIDTH - 1;
+    uint32_t group = hash & group_mask;
+    uint32_t step = 0;
+
+    while(1)
+    {
+        uint32_t base = group * HASHMAP_GROUP_WIDTH;
+        uint32_t free_slots = hashmap_group_match_free(ctrl + base);
+        if(free_slots)
+            return base + hashmap_count_trailing_zeros(free_slots);
+
+        ++step;
+        group = (group + step) & group_mask;
+        assert(step <= group_mask);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Allocates a table with the new capacity and moves all elements into it.
+ * This also gets rid of all tombstones. The stored hashes are used, so no
+ * keys are rehashed.
+ */
+static char
+hashmap_resize(struct hashmap_t* map, uint32_t new_capacity)
+{
+    void* block;
+    uint8_t* ctrl;
+    struct hashmap_slot_t* slots;
+    uint32_t i;
+
+    assert(new_capacity >= HASHMAP_GROUP_WIDTH);
+    assert((new_capacity & (new_capacity - 1)) == 0);
+    assert(HASHMAP_MAX_LOAD(new_capacity) >= map->count);
+
+    /*
+     * Slots come first so they stay aligned. The control bytes come last and
+     * are aligned to the group width for aligned SSE2 loads.
+     */
+    block = ALLOCATOR_MALLOC(map->allocator,
+                             (sizeof(struct hashmap_slot_t) + 1) * new_capacity + HASHMAP_GROUP_WIDTH - 1,
+                             "hashmap_resize()");
+    if(!block)
+        return 0;
+
+    slots = (struct hashmap_slot_t*)block;
+    ctrl = (uint8_t*)(((uintptr_t)(slots + new_capacity) + HASHMAP_GROUP_WIDTH - 1)
+                      & ~(uintptr_t)(HASHMAP_GROUP_WIDTH - 1));
+    memset(ctrl, HASHMAP_CTRL_EMPTY, new_capacity);
+
+    for(i = 0; i != map->capacity; ++i)
+    {
+        uint32_t slot;
+        if(map->ctrl[i] & HASHMAP_CTRL_FREE_BIT)
+            continue;
+
+        slot = hashmap_find_free_slot(ctrl, new_capacity, map->slots[i].hash);
+        ctrl[slot] = HASHMAP_H2(map->slots[i].hash);
+        slots[slot] = map->slots[i];
+    }
+
+    if(map->block)
+        ALLOCATOR_FREE(map->allocator, map->block);
+
+    map->block = block;
+    map->ctrl = ctrl;
+    map->slots = slots;
+    map->capacity = new_capacity;
+    map->growth_left = HASHMAP_MAX_LOAD(new_capacity) - map->count;
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+hashmap_free_keys(struct hashmap_t* map)
+{
+    uint32_t i;
+    for(i = 0; i != map->capacity; ++i)
+        if(!(map->ctrl[i] & HASHMAP_CTRL_FREE_BIT))
+            ALLOCATOR_FREE(map->allocator, map->slots[i].key);
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+void
+hashmap_key_init(struct hashmap_key_t* key, const char* str)
+{
+    assert(str);
+    hashmap_key_init_n(key, str, (uint32_t)strlen(str));
+}
+
+/* ------------------------------------------------------------------------- */
+void
+hashmap_key_init_n(struct hashmap_key_t* key, const char* str, uint32_t len)
+{
+    assert(key);
+    assert(str);
+    key->str = str;
+    key->len = len;
+    key->hash = hash_wyhash32(str, len);
+}
+
+/* ------------------------------------------------------------------------- */
+struct hashmap_t*
+hashmap_create(void)
+{
+    struct hashmap_t* map;
+    if(!(map = (struct hashmap_t*)MALLOC(sizeof *map, "hashmap_create()")))
+        return NULL;
+    hashmap_init(map);
+    return map;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+hashmap_init(struct hashmap_t* map)
+{
+    hashmap_init_with_allocator(map, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+hashmap_init_with_allocator(struct hashmap_t* map,
+                            const struct allocator_t* allocator)
+{
+    assert(map);
+    memset(map, 0, sizeof *map);
+    map->allocator = allocator;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+hashmap_destroy(struct hashmap_t* map)
+{
+    assert(map);
+    hashmap_clear_free(map);
+    FREE(map);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+hashmap_reserve(struct hashmap_t* map, uint32_t count)
+{
+    uint32_t new_capacity;
+
+    assert(map);
+
+    if(count <= map->count + map->growth_left)
+        return 1;
+
+    new_capacity = map->capacity ? map->capacity : HASHMAP_GROUP_WIDTH;
+    while(HASHMAP_MAX_LOAD(new_capacity) < count)
+        new_capacity *= 2;
+    return hashmap_resize(map, new_capacity);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+hashmap_insert(struct hashmap_t* map, const char* key, void* value)
+{
+    struct hashmap_key_t k;
+    hashmap_key_init(&k, key);
+    return hashmap_insert_hashed(map, &k, value);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+hashmap_insert_hashed(struct hashmap_t* map, const struct hashmap_key_t* key, void* value)
+{
+    char* key_copy;
+    uint32_t slot;
+
+    assert(map);
+    assert(key);
+
+    if(hashmap_find_slot(map, key) != HASHMAP_NOT_FOUND)
+        return 0;
+
+    if(!(key_copy = (char*)ALLOCATOR_MALLOC(map->allocator, key->len + 1, "hashmap_insert()")))
+        return 0;
+    memcpy(key_copy, key->str, key->len);
+    key_copy[key->len] = '\0';
+
+    if(map->growth_left == 0)
+    {
+        /*
+         * Either the table is full, or it is full of tombstones. In the
+         * second case rehashing at the same size is enough to reclaim them.
+         */
+        uint32_t new_capacity = map->capacity ? map->capacity : HASHMAP_GROUP_WIDTH;
+        if(map->count + 1 > HASHMAP_MAX_LOAD(new_capacity) / 2)
+            new_capacity = map->capacity ? map->capacity * 2 : HASHMAP_GROUP_WIDTH;
+        if(!hashmap_resize(map, new_capacity))
+        {
+            ALLOCATOR_FREE(map->allocator, key_copy);
+            return 0;
+        }
+    }
+
+    slot = hashmap_find_free_slot(map->ctrl, map->capacity, key->hash);
+    if(map->ctrl[slot] == HASHMAP_CTRL_EMPTY)
+        --map->growth_left;
+    map->ctrl[slot] = HASHMAP_H2(key->hash);
+    map->slots[slot].hash = key->hash;
+    map->slots[slot].key = key_copy;
+    map->slots[slot].value = value;
+    ++map->count;
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+hashmap_set(struct hashmap_t* map, const char* key, void* value)
+{
+    struct hashmap_key_t k;
+    uint32_t slot;
+
+    assert(map);
+
+    hashmap_key_init(&k, key);
+    slot = hashmap_find_slot(map, &k);
+    if(slot != HASHMAP_NOT_FOUND)
+        map->slots[slot].value = value;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+hashmap_find(const struct hashmap_t* map, const char* key)
+{
+    struct hashmap_key_t k;
+    hashmap_key_init(&k, key);
+    return hashmap_find_hashed(map, &k);
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+hashmap_find_hashed(const struct hashmap_t* map, const struct hashmap_key_t* key)
+{
+    uint32_t slot;
+
+    assert(map);
+    assert(key);
+
+    slot = hashmap_find_slot(map, key);
+    if(slot == HASHMAP_NOT_FOUND)
+        return NULL;
+    return map->slots[slot].value;
+}
+
+/* ------------------------------------------------------------------------- */
+const char*
+hashmap_find_key_hashed(const struct hashmap_t* map, const struct hashmap_key_t* key)
+{
+    uint32_t slot;
+
+    assert(map);
+    assert(key);
+
+    slot = hashmap_find_slot(map, key);
+    if(slot == HASHMAP_NOT_FOUND)
+        return NULL;
+    return map->slots[slot].key;
+}
+
+/* ------------------------------------------------------------------------- */
+const char*
+hashmap_find_element(const struct hashmap_t* map, const void* value)
+{
+    uint32_t i;
+
+    assert(map);
+
+    for(i = 0; i != map->capacity; ++i)
+        if(!(map->ctrl[i] & HASHMAP_CTRL_FREE_BIT) && map->slots[i].value == value)
+            return map->slots[i].key;
+
+    return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+hashmap_get_any_element(const struct hashmap_t* map)
+{
+    uint32_t i;
+
+    assert(map);
+
+    for(i = 0; i != map->capacity; ++i)
+        if(!(map->ctrl[i] & HASHMAP_CTRL_FREE_BIT))
+            return map->slots[i].value;
+
+    return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+hashmap_key_exists(const struct hashmap_t* map, const char* key)
+{
+    struct hashmap_key_t k;
+    hashmap_key_init(&k, key);
+    return hashmap_key_exists_hashed(map, &k);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+hashmap_key_exists_hashed(const struct hashmap_t* map, const struct hashmap_key_t* key)
+{
+    assert(map);
+    assert(key);
+
+    return hashmap_find_slot(map, key) != HASHMAP_NOT_FOUND;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+hashmap_erase(struct hashmap_t* map, const char* key)
+{
+    struct hashmap_key_t k;
+    uint32_t slot;
+
+    assert(map);
+
+    hashmap_key_init(&k, key);
+    slot = hashmap_find_slot(map, &k);
+    if(slot == HASHMAP_NOT_FOUND)
+        return NULL;
+    return hashmap_erase_slot(map, slot);
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+hashmap_erase_element(struct hashmap_t* map, void* value)
+{
+    uint32_t i;
+
+    assert(map);
+
+    for(i = 0; i != map->capacity; ++i)
+        if(!(map->ctrl[i] & HASHMAP_CTRL_FREE_BIT) && map->slots[i].value == value)
+            return hashmap_erase_slot(map, i);
+
+    return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+hashmap_erase_slot(struct hashmap_t* map, uint32_t slot)
+{
+    const uint8_t* group;
+
+    assert(map);
+    assert(slot < map->capacity);
+    assert(!(map->ctrl[slot] & HASHMAP_CTRL_FREE_BIT));
+
+    /*
+     * Lookups stop at the first group with an empty slot. If this group
+     * already has one, no lookup ever continued past it, so the slot can be
+     * marked empty again. Otherwise it has to become a tombstone.
+     */
+    group = map->ctrl + (slot & ~(uint32_t)(HASHMAP_GROUP_WIDTH - 1));
+    if(hashmap_group_match(group, HASHMAP_CTRL_EMPTY))
+    {
+        map->ctrl[slot] = HASHMAP_CTRL_EMPTY;
+        ++map->growth_left;
+    }
+    else
+        map->ctrl[slot] = HASHMAP_CTRL_DELETED;
+
+    ALLOCATOR_FREE(map->allocator, map->slots[slot].key);
+    --map->count;
+
+    return map->slots[slot].value;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+hashmap_clear(struct hashmap_t* map)
+{
+    assert(map);
+
+    if(map->capacity == 0)
+        return;
+
+    hashmap_free_keys(map);
+    memset(map->ctrl, HASHMAP_CTRL_EMPTY, map->capacity);
+    map->count = 0;
+    map->growth_left = HASHMAP_MAX_LOAD(map->capacity);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+hashmap_clear_free(struct hashmap_t* map)
+{
+    assert(map);
+
+    if(map->block)
+    {
+        hashmap_free_keys(map);
+        ALLOCATOR_FREE(map->allocator, map->block);
+    }
+
+    map->block = NULL;
+    map->ctrl = NULL;
+    map->slots = NULL;
+    map->capacity = 0;
+    map->count = 0;
+    map->growth_left = 0;
+}
@@ -0,0 +1,353 @@
+#include "util/heap.h"
+#include "util/memory.h"
+#include <assert.h>
+
+/* number of children per node */
+#define HEAP_ARITY 4
+
+/* set in the positions entry of unused handles */
+#define HEAP_FREE_BIT       0x80000000u
+/* stored in place of the next unused handle at the end of the free list */
+#define HEAP_FREE_LIST_END  0x7FFFFFFFu
+
+#define HEAP_NODES(heap)     ((struct heap_node_t*)(heap)->nodes.data)
+#define HEAP_POSITIONS(heap) ((uint32_t*)(heap)->positions.data)
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static void
+heap_sift_up(struct heap_t* heap, uint32_t i)
+{
+    struct heap_node_t* nodes = HEAP_NODES(heap);
+    uint32_t* positions = HEAP_POSITIONS(heap);
+    struct heap_node_t node = nodes[i];
+
+    while(i > 0)
+    {
+        uint32_t parent = (i - 1) / HEAP_ARITY;
+        if(nodes[parent].priority <= node.priority)
+            break;
+        nodes[i] = nodes[parent];
+        positions[nodes[i].handle] = i;
+        i = parent;
+    }
+
+    nodes[i] = node;
+    positions[node.handle] = i;
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+heap_sift_down(struct heap_t* heap, uint32_t i)
+{
+    struct heap_node_t* nodes = HEAP_NODES(heap);
+    uint32_t* positions = HEAP_POSITIONS(heap);
+    uint32_t count = heap_count(heap);
+    struct heap_node_t node = nodes[i];
+
+    while(1)
+    {
+        uint32_t first = i * HEAP_ARITY + 1;
+        uint32_t last, best, child;
+
+        if(first >= count)
+            break;
+        last = (count - first > HEAP_ARITY) ? first + HEAP_ARITY : count;
+
+        best = first;
+        for(child = first + 1; child < last; ++child)
+            if(nodes[child].priority < nodes[best].priority)
+                best = child;
+
+        if(nodes[best].priority >= node.priority)
+            break;
+        nodes[i] = nodes[best];
+        positions[nodes[i].handle] = i;
+        i = best;
+    }
+
+    nodes[i] = node;
+    positions[node.handle] = i;
+}
+
+/* ------------------------------------------------------------------------- */
+/* restores the heap property after the priority of node i was changed */
+static void
+heap_fix(struct heap_t* heap, uint32_t i)
+{
+    if(i > 0 && HEAP_NODES(heap)[i].priority < HEAP_NODES(heap)[(i - 1) / HEAP_ARITY].priority)
+        heap_sift_up(heap, i);
+    else
+        heap_sift_down(heap, i);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+heap_release_handle(struct heap_t* heap, heap_handle_t handle)
+{
+    uint32_t next = (heap->free_handle == HEAP_INVALID_HANDLE) ?
+        HEAP_FREE_LIST_END : heap->free_handle;
+    HEAP_POSITIONS(heap)[handle] = HEAP_FREE_BIT | next;
+    heap->free_handle = handle;
+}
+
+/* ------------------------------------------------------------------------- */
+static void*
+heap_erase_index(struct heap_t* heap, uint32_t i)
+{
+    struct heap_node_t* nodes = HEAP_NODES(heap);
+    uint32_t last = heap_count(heap) - 1;
+    void* value = nodes[i].value;
+
+    heap_release_handle(heap, nodes[i].handle);
+    if(i != last)
+    {
+        nodes[i] = nodes[last];
+        ordered_vector_pop(&heap->nodes);
+        heap_fix(heap, i);
+    }
+    else
+        ordered_vector_pop(&heap->nodes);
+
+    return value;
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct heap_t*
+heap_create(void)
+{
+    struct heap_t* heap;
+    if(!(heap = (struct heap_t*)MALLOC(sizeof *heap, "heap_create()")))
+        return NULL;
+    heap_init(heap);
+    return heap;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+heap_init(struct heap_t* heap)
+{
+    heap_init_with_allocator(heap, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+heap_init_with_allocator(struct heap_t* heap,
+                         const struct allocator_t* allocator)
+{
+    assert(heap);
+    ordered_vector_init_with_allocator(&heap->nodes, sizeof(struct heap_node_t), allocator);
+    ordered_vector_init_with_allocator(&heap->positions, sizeof(uint32_t), allocator);
+    heap->free_handle = HEAP_INVALID_HANDLE;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+heap_destroy(struct heap_t* heap)
+{
+    assert(heap);
+    heap_clear_free(heap);
+    FREE(heap);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+heap_clear(struct heap_t* heap)
+{
+    assert(heap);
+    ordered_vector_clear(&heap->nodes);
+    ordered_vector_clear(&heap->positions);
+    heap->free_handle = HEAP_INVALID_HANDLE;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+heap_clear_free(struct heap_t* heap)
+{
+    assert(heap);
+    ordered_vector_clear_free(&heap->nodes);
+    ordered_vector_clear_free(&heap->positions);
+    heap->free_handle = HEAP_INVALID_HANDLE;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+heap_reserve(struct heap_t* heap, uint32_t count)
+{
+    assert(heap);
+    if(!ordered_vector_reserve(&heap->nodes, count))
+        return 0;
+    return ordered_vector_reserve(&heap->positions, count);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+heap_push(struct heap_t* heap, int64_t priority, void* value, heap_handle_t* handle)
+{
+    struct heap_node_t* node;
+    heap_handle_t new_handle;
+
+    assert(heap);
+
+    if(!(node = (struct heap_node_t*)ordered_vector_push_emplace(&heap->nodes)))
+        return 0;
+
+    if(heap->free_handle != HEAP_INVALID_HANDLE)
+    {
+        uint32_t next;
+        new_handle = heap->free_handle;
+        next = HEAP_POSITIONS(heap)[new_handle] & ~HEAP_FREE_BIT;
+        heap->free_handle = (next == HEAP_FREE_LIST_END) ? HEAP_INVALID_HANDLE : next;
+    }
+    else
+    {
+        if(heap->positions.count == HEAP_FREE_LIST_END ||
+           !ordered_vector_push_emplace(&heap->positions))
+        {
+            ordered_vector_pop(&heap->nodes);
+            return 0;
+        }
+        new_handle = heap->positions.count - 1;
+    }
+
+    node->priority = priority;
+    node->value = value;
+    node->handle = new_handle;
+    heap_sift_up(heap, heap_count(heap) - 1);
+
+    if(handle)
+        *handle = new_handle;
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+heap_pop(struct heap_t* heap)
+{
+    assert(heap);
+    if(heap_count(heap) == 0)
+        return NULL;
+    return heap_erase_index(heap, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+heap_peek(const struct heap_t* heap)
+{
+    assert(heap);
+    if(heap_count(heap) == 0)
+        return NULL;
+    return HEAP_NODES(heap)[0].value;
+}
+
+/* ------------------------------------------------------------------------- */
+int64_t
+heap_peek_priority(const struct heap_t* heap)
+{
+    assert(heap);
+    assert(heap_count(heap) > 0);
+    return HEAP_NODES(heap)[0].priority;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+heap_contains(const struct heap_t* heap, heap_handle_t handle)
+{
+    assert(heap);
+    return handle < heap->positions.count &&
+        !(HEAP_POSITIONS(heap)[handle] & HEAP_FREE_BIT);
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+heap_get(const struct heap_t* heap, heap_handle_t handle)
+{
+    assert(heap_contains(heap, handle));
+    return HEAP_NODES(heap)[HEAP_POSITIONS(heap)[handle]].value;
+}
+
+/* ------------------------------------------------------------------------- */
+int64_t
+heap_get_priority(const struct heap_t* heap, heap_handle_t handle)
+{
+    assert(heap_contains(heap, handle));
+    return HEAP_NODES(heap)[HEAP_POSITIONS(heap)[handle]].priority;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+heap_decrease_priority(struct heap_t* heap, heap_handle_t handle, int64_t priority)
+{
+    uint32_t i;
+
+    assert(heap_contains(heap, handle));
+
+    i = HEAP_POSITIONS(heap)[handle];
+    assert(priority <= HEAP_NODES(heap)[i].priority);
+    HEAP_NODES(heap)[i].priority = priority;
+    heap_sift_up(heap, i);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+heap_set_priority(struct heap_t* heap, heap_handle_t handle, int64_t priority)
+{
+    uint32_t i;
+
+    assert(heap_contains(heap, handle));
+
+    i = HEAP_POSITIONS(heap)[handle];
+    HEAP_NODES(heap)[i].priority = priority;
+    heap_fix(heap, i);
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+heap_erase(struct heap_t* heap, heap_handle_t handle)
+{
+    assert(heap_contains(heap, handle));
+    return heap_erase_index(heap, HEAP_POSITIONS(heap)[handle]);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+heap_build(struct heap_t* heap,
+           const struct heap_item_t* items,
+           uint32_t count,
+           heap_handle_t* handles)
+{
+    struct heap_node_t* nodes;
+    uint32_t i;
+
+    assert(heap);
+    assert(items || !count);
+
+    if(count >= HEAP_FREE_LIST_END)
+        return 0;
+    if(!heap_reserve(heap, count))
+        return 0;
+
+    /* handles are assigned in array order, so handle i belongs to items[i] */
+    heap_clear(heap);
+    nodes = HEAP_NODES(heap);
+    for(i = 0; i != count; ++i)
+    {
+        nodes[i].priority = items[i].priority;
+        nodes[i].value = items[i].value;
+        nodes[i].handle = i;
+        HEAP_POSITIONS(heap)[i] = i;
+        if(handles)
+            handles[i] = i;
+    }
+    heap->nodes.count = count;
+    heap->positions.count = count;
+
+    /* sift down every node that has children, starting with the last one */
+    for(i = count > 1 ? (count - 2) / HEAP_ARITY + 1 : 0; i-- > 0;)
+        heap_sift_down(heap, i);
+
+    return 1;
+}
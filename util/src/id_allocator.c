@@ -0,0 +1,226 @@
+#include "util/id_allocator.h"
+#include "util/memory.h"
+#include <string.h>
+#include <assert.h>
+
+#define ID_ALLOCATOR_FULL_WORD 0xFFFFFFFFu
+/* IDs stay below this, so the capacity and every valid ID fit into 32 bits */
+#define ID_ALLOCATOR_MAX_CAPACITY 0x80000000u
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static uint32_t
+id_allocator_count_trailing_ones(uint32_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(~word);
+#else
+    uint32_t n = 0;
+    while(word & 1)
+    {
+        word >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+/* Returns the bits of a word of used[] which lie in the range [first, last] */
+static uint32_t
+id_allocator_range_mask(uint32_t word, uint32_t first, uint32_t last)
+{
+    uint32_t lo = (word == first / 32) ? first % 32 : 0;
+    uint32_t hi = (word == last / 32) ? last % 32 : 31;
+    return (ID_ALLOCATOR_FULL_WORD >> (31 - hi)) & (ID_ALLOCATOR_FULL_WORD << lo);
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+id_allocator_grow(struct id_allocator_t* ids, uint32_t min_capacity)
+{
+    uint32_t new_capacity = ids->capacity ? ids->capacity : ID_ALLOCATOR_IDS_PER_BLOCK;
+    uint32_t* used;
+    uint32_t* full;
+
+    if(min_capacity > ID_ALLOCATOR_MAX_CAPACITY)
+        return 0;
+    while(new_capacity < min_capacity)
+        new_capacity *= 2;
+
+    /*
+     * If the second allocation fails, the first array is just larger than it
+     * needs to be. The capacity is only updated once both succeeded.
+     */
+    if(!(used = (uint32_t*)REALLOC(ids->used, new_capacity / 8, "id_allocator_grow()")))
+        return 0;
+    ids->used = used;
+    if(!(full = (uint32_t*)REALLOC(ids->full, new_capacity / ID_ALLOCATOR_IDS_PER_BLOCK * 4, "id_allocator_grow()")))
+        return 0;
+    ids->full = full;
+
+    memset(used + ids->capacity / 32, 0, (new_capacity - ids->capacity) / 8);
+    memset(full + ids->capacity / ID_ALLOCATOR_IDS_PER_BLOCK, 0,
+           (new_capacity - ids->capacity) / ID_ALLOCATOR_IDS_PER_BLOCK * 4);
+    ids->capacity = new_capacity;
+
+    return 1;
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct id_allocator_t*
+id_allocator_create(void)
+{
+    struct id_allocator_t* ids;
+    if(!(ids = (struct id_allocator_t*)MALLOC(sizeof *ids, "id_allocator_create()")))
+        return NULL;
+    id_allocator_init(ids);
+    return ids;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+id_allocator_init(struct id_allocator_t* ids)
+{
+    assert(ids);
+    memset(ids, 0, sizeof *ids);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+id_allocator_destroy(struct id_allocator_t* ids)
+{
+    assert(ids);
+    id_allocator_clear_free(ids);
+    FREE(ids);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+id_allocator_clear(struct id_allocator_t* ids)
+{
+    assert(ids);
+    if(ids->capacity)
+    {
+        memset(ids->used, 0, ids->capacity / 8);
+        memset(ids->full, 0, ids->capacity / ID_ALLOCATOR_IDS_PER_BLOCK * 4);
+    }
+    ids->count = 0;
+    ids->first_free_block = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+id_allocator_clear_free(struct id_allocator_t* ids)
+{
+    assert(ids);
+    /* used[] may have been allocated by a failed grow while full[] wasn't */
+    if(ids->used)
+        FREE(ids->used);
+    if(ids->full)
+        FREE(ids->full);
+    id_allocator_init(ids);
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+id_allocator_alloc(struct id_allocator_t* ids)
+{
+    uint32_t blocks, block, word, bit;
+
+    assert(ids);
+
+    /* skip over full blocks. Every block is only skipped once until an ID in
+     * it is released */
+    blocks = ids->capacity / ID_ALLOCATOR_IDS_PER_BLOCK;
+    for(block = ids->first_free_block; block != blocks; ++block)
+        if(ids->full[block] != ID_ALLOCATOR_FULL_WORD)
+            break;
+    ids->first_free_block = block;
+
+    if(block == blocks)
+        if(!id_allocator_grow(ids, ids->capacity + 1))
+            return ID_ALLOCATOR_INVALID_ID;
+
+    word = block * 32 + id_allocator_count_trailing_ones(ids->full[block]);
+    bit = id_allocator_count_trailing_ones(ids->used[word]);
+
+    ids->used[word] |= (uint32_t)1 << bit;
+    if(ids->used[word] == ID_ALLOCATOR_FULL_WORD)
+        ids->full[block] |= (uint32_t)1 << (word % 32);
+    ++ids->count;
+
+    return word * 32 + bit;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+id_allocator_reserve(struct id_allocator_t* ids, uint32_t first, uint32_t count)
+{
+    uint32_t last, word;
+
+    assert(ids);
+
+    if(count == 0)
+        return 1;
+    if(first >= ID_ALLOCATOR_MAX_CAPACITY || count > ID_ALLOCATOR_MAX_CAPACITY - first)
+        return 0;
+    last = first + count - 1;
+
+    if(last >= ids->capacity)
+        if(!id_allocator_grow(ids, last + 1))
+            return 0;
+
+    /* fail without changing anything if any of the IDs are taken */
+    for(word = first / 32; word <= last / 32; ++word)
+        if(ids->used[word] & id_allocator_range_mask(word, first, last))
+            return 0;
+
+    for(word = first / 32; word <= last / 32; ++word)
+    {
+        ids->used[word] |= id_allocator_range_mask(word, first, last);
+        if(ids->used[word] == ID_ALLOCATOR_FULL_WORD)
+            ids->full[word / 32] |= (uint32_t)1 << (word % 32);
+    }
+    ids->count += count;
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+id_allocator_release(struct id_allocator_t* ids, uint32_t id)
+{
+    uint32_t word, block, mask;
+
+    assert(ids);
+
+    if(!id_allocator_is_used(ids, id))
+        return 0;
+
+    word = id / 32;
+    block = word / 32;
+    mask = (uint32_t)1 << (id % 32);
+
+    ids->used[word] &= ~mask;
+    ids->full[block] &= ~((uint32_t)1 << (word % 32));
+    if(block < ids->first_free_block)
+        ids->first_free_block = block;
+    --ids->count;
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+id_allocator_is_used(const struct id_allocator_t* ids, uint32_t id)
+{
+    assert(ids);
+
+    if(id >= ids->capacity)
+        return 0;
+    return (ids->used[id / 32] >> (id % 32)) & 1;
+}
@@ -0,0 +1,104 @@
+#include "util/intrusive_list.h"
+#include <assert.h>
+
+/* ------------------------------------------------------------------------- */
+void
+ilist_init(struct ilist_t* list)
+{
+    assert(list);
+    list->front = NULL;
+    list->back = NULL;
+    list->count = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ilist_push_front(struct ilist_t* list, struct ilist_link_t* link)
+{
+    assert(list);
+    assert(link);
+
+    link->prev = NULL;
+    link->next = list->front;
+    if(list->front)
+        list->front->prev = link;
+    else
+        list->back = link;
+    list->front = link;
+    ++list->count;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ilist_push_back(struct ilist_t* list, struct ilist_link_t* link)
+{
+    assert(list);
+    assert(link);
+
+    link->next = NULL;
+    link->prev = list->back;
+    if(list->back)
+        list->back->next = link;
+    else
+        list->front = link;
+    list->back = link;
+    ++list->count;
+}
+
+/* ------------------------------------------------------------------------- */
+struct ilist_link_t*
+ilist_pop_front(struct ilist_t* list)
+{
+    struct ilist_link_t* link;
+    assert(list);
+    if((link = list->front))
+        ilist_erase(list, link);
+    return link;
+}
+
+/* ------------------------------------------------------------------------- */
+struct ilist_link_t*
+ilist_pop_back(struct ilist_t* list)
+{
+    struct ilist_link_t* link;
+    assert(list);
+    if((link = list->back))
+        ilist_erase(list, link);
+    return link;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ilist_erase(struct ilist_t* list, struct ilist_link_t* link)
+{
+    assert(list);
+    assert(link);
+    assert(list->count > 0);
+
+    if(link->prev)
+        link->prev->next = link->next;
+    else
+    {
+        assert(list->front == link);
+        list->front = link->next;
+    }
+
+    if(link->next)
+        link->next->prev = link->prev;
+    else
+    {
+        assert(list->back == link);
+        list->back = link->prev;
+    }
+
+    link->prev = NULL;
+    link->next = NULL;
+    --list->count;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ilist_clear(struct ilist_t* list)
+{
+    ilist_init(list);
+}
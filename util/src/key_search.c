@@ -0,0 +1,278 @@
+#include "util/key_search.h"
+#include <assert.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#       define KEY_SEARCH_HAVE_SIMD
+#       include <immintrin.h>
+#       if defined(_MSC_VER)
+#           include <intrin.h>
+#       endif
+#   endif
+#endif
+
+/*
+ * GCC and clang only allow intrinsics in functions compiled for the matching
+ * instruction set. This enables it for a single function, so the rest of the
+ * library doesn't require the CPU to support it.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#   define KEY_SEARCH_TARGET(x) __attribute__((target(x)))
+#else
+#   define KEY_SEARCH_TARGET(x)
+#endif
+
+typedef uint32_t (*key_search_func)(const uint32_t* keys, uint32_t count, uint32_t key);
+
+static uint32_t key_search_resolve(const uint32_t* keys, uint32_t count, uint32_t key);
+
+static key_search_func g_search = key_search_resolve;
+static key_search_impl_e g_impl = KEY_SEARCH_AUTO;
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static uint32_t
+key_search_count_trailing_ones(uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(~mask);
+#else
+    uint32_t n = 0;
+    while(mask & 1)
+    {
+        mask >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Bisects until at most KEY_SEARCH_LINEAR_THRESHOLD keys remain. Returns the
+ * index of the first remaining key and writes the remaining count back.
+ */
+static uint32_t
+key_search_narrow(const uint32_t* keys, uint32_t* count, uint32_t key)
+{
+    uint32_t base = 0;
+    uint32_t len = *count;
+
+    while(len > KEY_SEARCH_LINEAR_THRESHOLD)
+    {
+        uint32_t half = len >> 1;
+        if(keys[base + half] < key)
+        {
+            base += half + 1;
+            len -= half + 1;
+        }
+        else
+            len = half;
+    }
+
+    *count = len;
+    return base;
+}
+
+/* ------------------------------------------------------------------------- */
+/* algorithm taken from GNU GCC stdlibc++'s lower_bound function, line 2121 in stl_algo.h */
+/* https://gcc.gnu.org/onlinedocs/libstdc++/libstdc++-html-USERS-4.3/a02014.html */
+static uint32_t
+key_search_scalar(const uint32_t* keys, uint32_t count, uint32_t key)
+{
+    uint32_t base = 0;
+
+    while(count > 0)
+    {
+        uint32_t half = count >> 1;
+        if(keys[base + half] < key)
+        {
+            base += half + 1;
+            count -= half + 1;
+        }
+        else
+            count = half;
+    }
+
+    return base;
+}
+
+#if defined(KEY_SEARCH_HAVE_SIMD)
+
+/* ------------------------------------------------------------------------- */
+/*
+ * SSE2 and AVX2 only have signed comparisons. Flipping the sign bit of both
+ * operands turns an unsigned comparison into a signed one.
+ *
+ * Because the keys are sorted, the lanes where key < needle always form a
+ * prefix of the mask. The first lane which isn't set is the lower bound.
+ */
+KEY_SEARCH_TARGET("sse2") static uint32_t
+key_search_sse2(const uint32_t* keys, uint32_t count, uint32_t key)
+{
+    __m128i bias, needle;
+    uint32_t base, i;
+
+    base = key_search_narrow(keys, &count, key);
+    keys += base;
+
+    bias = _mm_set1_epi32((int)0x80000000);
+    needle = _mm_xor_si128(_mm_set1_epi32((int)key), bias);
+    for(i = 0; i + 4 <= count; i += 4)
+    {
+        __m128i k = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(keys + i)), bias);
+        uint32_t mask = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(needle, k)));
+        if(mask != 0xF)
+            return base + i + key_search_count_trailing_ones(mask);
+    }
+
+    for(; i != count; ++i)
+        if(keys[i] >= key)
+            break;
+    return base + i;
+}
+
+/* ------------------------------------------------------------------------- */
+KEY_SEARCH_TARGET("avx2") static uint32_t
+key_search_avx2(const uint32_t* keys, uint32_t count, uint32_t key)
+{
+    __m256i bias, needle;
+    uint32_t base, i;
+
+    base = key_search_narrow(keys, &count, key);
+    keys += base;
+
+    bias = _mm256_set1_epi32((int)0x80000000);
+    needle = _mm256_xor_si256(_mm256_set1_epi32((int)key), bias);
+    for(i = 0; i + 8 <= count; i += 8)
+    {
+        __m256i k = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + i)), bias);
+        uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, k)));
+        if(mask != 0xFF)
+            return base + i + key_search_count_trailing_ones(mask);
+    }
+
+    for(; i != count; ++i)
+        if(keys[i] >= key)
+            break;
+    return base + i;
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+key_search_cpu_supports(key_search_impl_e impl)
+{
+#   if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    switch(impl)
+    {
+        case KEY_SEARCH_SSE2 : return __builtin_cpu_supports("sse2") != 0;
+        case KEY_SEARCH_AVX2 : return __builtin_cpu_supports("avx2") != 0;
+        default              : return 1;
+    }
+#   else
+    int info[4];
+    switch(impl)
+    {
+        case KEY_SEARCH_SSE2 :
+            __cpuid(info, 1);
+            return (info[3] & (1 << 26)) != 0;
+
+        case KEY_SEARCH_AVX2 :
+            /* the OS must also save the YMM registers on context switches */
+            __cpuid(info, 1);
+            if(!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)))
+                return 0;
+            if((_xgetbv(0) & 6) != 6)
+                return 0;
+            __cpuid(info, 0);
+            if(info[0] < 7)
+                return 0;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+
+        default : return 1;
+    }
+#   endif
+}
+
+#endif /* KEY_SEARCH_HAVE_SIMD */
+
+/* ------------------------------------------------------------------------- */
+static char
+key_search_select(key_search_impl_e impl)
+{
+    switch(impl)
+    {
+        case KEY_SEARCH_AUTO :
+#if defined(KEY_SEARCH_HAVE_SIMD)
+            if(key_search_select(KEY_SEARCH_AVX2))
+                return 1;
+            if(key_search_select(KEY_SEARCH_SSE2))
+                return 1;
+#endif
+            return key_search_select(KEY_SEARCH_SCALAR);
+
+        case KEY_SEARCH_SCALAR :
+            g_search = key_search_scalar;
+            break;
+
+#if defined(KEY_SEARCH_HAVE_SIMD)
+        case KEY_SEARCH_SSE2 :
+            if(!key_search_cpu_supports(KEY_SEARCH_SSE2))
+                return 0;
+            g_search = key_search_sse2;
+            break;
+
+        case KEY_SEARCH_AVX2 :
+            if(!key_search_cpu_supports(KEY_SEARCH_AVX2))
+                return 0;
+            g_search = key_search_avx2;
+            break;
+#endif
+
+        default : return 0;
+    }
+
+    g_impl = impl;
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * The first call detects the CPU and replaces the function pointer. If
+ * several threads race here they all store the same values.
+ */
+static uint32_t
+key_search_resolve(const uint32_t* keys, uint32_t count, uint32_t key)
+{
+    key_search_select(KEY_SEARCH_AUTO);
+    return g_search(keys, count, key);
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+uint32_t
+key_search_lower_bound(const uint32_t* keys, uint32_t count, uint32_t key)
+{
+    assert(keys || !count);
+    return g_search(keys, count, key);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+key_search_set_impl(key_search_impl_e impl)
+{
+    return key_search_select(impl);
+}
+
+/* ------------------------------------------------------------------------- */
+key_search_impl_e
+key_search_get_impl(void)
+{
+    if(g_impl == KEY_SEARCH_AUTO)
+        key_search_select(KEY_SEARCH_AUTO);
+    return g_impl;
+}
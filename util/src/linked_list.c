@@ -4,6 +4,7 @@
 #include <assert.h>
 #include "util/linked_list.h"
 #include "util/memory.h"
+#include "util/allocator.h"
 
 /* ------------------------------------------------------------------------- */
 struct list_t*
@@ -24,6 +25,15 @@ list_init(struct list_t* list)
     memset(list, 0, sizeof(struct list_t));
 }
 
+/* ------------------------------------------------------------------------- */
+void
+list_init_with_allocator(struct list_t* list,
+                         const struct allocator_t* allocator)
+{
+    list_init(list);
+    list->allocator = allocator;
+}
+
 /* ------------------------------------------------------------------------- */
 void
 list_destroy(struct list_t* list)
@@ -44,12 +54,25 @@ list_clear(struct list_t* list)
     while((current = list->tail))
     {
     	list->tail = list->tail->next;
-    	FREE(current);
+    	ALLOCATOR_FREE(list->allocator, current);
+    }
+    while((current = list->free_nodes))
+    {
+    	list->free_nodes = current->next;
+    	ALLOCATOR_FREE(list->allocator, current);
     }
     list->head = NULL;
     list->count = 0;
 }
 
+/* ------------------------------------------------------------------------- */
+static void
+list_release_node(struct list_t* list, struct list_node_t* node)
+{
+    node->next = list->free_nodes;
+    list->free_nodes = node;
+}
+
 /* ------------------------------------------------------------------------- */
 struct list_node_t*
 list_push(struct list_t* list, void* data)
@@ -58,8 +81,9 @@ list_push(struct list_t* list, void* data)
 
     assert(list);
 
-    node = (struct list_node_t*)MALLOC(sizeof(struct list_node_t), "list_push()");
-    if(!node)
+    if((node = list->free_nodes))
+    	list->free_nodes = node->next;
+    else if(!(node = (struct list_node_t*)ALLOCATOR_MALLOC(list->allocator, sizeof(struct list_node_t), "list_push()")))
     {
     	fprintf(stderr, "malloc() failed in list_push() -- not enough memory\n");
     	return NULL;
@@ -100,7 +124,7 @@ list_pop(struct list_t* list)
     	list->tail = NULL;      /* tail no longer exists */
 
     data = node->data;
-    FREE(node);
+    list_release_node(list, node);
     --list->count;
 
     return data;
@@ -131,7 +155,7 @@ list_erase_node(struct list_t* list, struct list_node_t* node)
     	list->head = prev;  /* head was pointing at current noid - point to previous */
 
     data = node->data;
-    FREE(node);
+    list_release_node(list, node);
     --list->count;
     return data;
 }
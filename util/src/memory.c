@@ -1,5 +1,5 @@
 #include "util/memory.h"
-#include "util/bst_vector.h"
+#include "util/bst_vector64.h"
 #include "util/backtrace.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -7,53 +7,51 @@
 #include <assert.h>
 
 #define BACKTRACE_OMIT_COUNT 2
+/* The report keeps its key/value pairs in a single array. It is allocated in
+ * memory_init() and only freed in memory_deinit(). */
+#define REPORT_ALLOCATIONS 1
 
 #ifdef ENABLE_MEMORY_DEBUGGING
 static uintptr_t allocations = 0;
 static uintptr_t deallocations = 0;
 static uintptr_t ignore_bstv_malloc = 0;
-static struct bstv_t report;
+static struct bstv64_t report;
 
 #   ifdef ENABLE_MEMORY_EXPLICIT_MALLOC_FAILURES
 static volatile int malloc_fail_counter = 0;
 #   endif /* ENABLE_MEMORY_EXPLICIT_MALLOC_FAILURES */
 
-/* need a mutex to make malloc_wrapper() and free_wrapper() thread safe */
+/*
+ * Need a mutex to make malloc_wrapper() and free_wrapper() thread safe.
+ * util/thread.h is always available, so any program may allocate from
+ * several threads, not just ones built with ENABLE_MULTITHREADING.
+ */
 /* NOTE: Mutex must be recursive */
-#   if defined(ENABLE_MULTITHREADING) || defined(ENABLE_MEMORY_EXPLICIT_MALLOC_FAILURES)
-#       if defined(UTIL_PLATFORM_LINUX) || defined(LIGHTSHIP_UTIL_PLATFORM_MACOSX)
-#           include <pthread.h>
-#           define MUTEX pthread_mutex_t
-#           define MUTEX_LOCK(x) pthread_mutex_lock(&(x));
-#           define MUTEX_UNLOCK(x) pthread_mutex_unlock(&(x));
-#           define MUTEX_INIT(x) do {                                           \
+#   if defined(UTIL_PLATFORM_LINUX) || defined(LIGHTSHIP_UTIL_PLATFORM_MACOSX)
+#       include <pthread.h>
+#       define MUTEX pthread_mutex_t
+#       define MUTEX_LOCK(x) pthread_mutex_lock(&(x));
+#       define MUTEX_UNLOCK(x) pthread_mutex_unlock(&(x));
+#       define MUTEX_INIT(x) do {                                           \
                 pthread_mutexattr_t attr;                                       \
                 pthread_mutexattr_init(&attr);                                  \
                 pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);      \
                 pthread_mutex_init(&(x), &attr);                                \
                 pthread_mutexattr_destroy(&attr);                               \
             } while(0);
-#           define MUTEX_DEINIT(x) pthread_mutex_destroy(&(x));
-
-#       else /* defined(UTIL_PLATFORM_LINUX) || defined(LIGHTSHIP_UTIL_PLATFORM_MACOSX) */
-#            include <Windows.h>
-#            include <process.h>
-#           define MUTEX HANDLE
-#            define MUTEX_LOCK(x) WaitForSingleObject(x, INFINITE);
-#            define MUTEX_UNLOCK(x) ReleaseMutex(x);
-#            define MUTEX_INIT(x) do { x = CreateMutex(NULL, FALSE, NULL); } while(0);
-#            define MUTEX_DEINIT(x) CloseHandle(x);
-#       endif /* defined(UTIL_PLATFORM_LINUX) || defined(LIGHTSHIP_UTIL_PLATFORM_MACOSX) */
-
-    static MUTEX mutex;
-
-#   else /* defined(ENABLE_MULTITHREADING) || defined(ENABLE_MEMORY_EXPLICIT_MALLOC_FAILURES) */
-#       define mutex
-#       define MUTEX_LOCK(x)
-#       define MUTEX_UNLOCK(x)
-#       define MUTEX_INIT(x)
-#       define MUTEX_DEINIT(x)
-#   endif /* defined(ENABLE_MULTITHREADING) || defined(ENABLE_MEMORY_EXPLICIT_MALLOC_FAILURES) */
+#       define MUTEX_DEINIT(x) pthread_mutex_destroy(&(x));
+
+#   else /* defined(UTIL_PLATFORM_LINUX) || defined(LIGHTSHIP_UTIL_PLATFORM_MACOSX) */
+#        include <Windows.h>
+#        include <process.h>
+#       define MUTEX HANDLE
+#        define MUTEX_LOCK(x) WaitForSingleObject(x, INFINITE);
+#        define MUTEX_UNLOCK(x) ReleaseMutex(x);
+#        define MUTEX_INIT(x) do { x = CreateMutex(NULL, FALSE, NULL); } while(0);
+#        define MUTEX_DEINIT(x) CloseHandle(x);
+#   endif /* defined(UTIL_PLATFORM_LINUX) || defined(LIGHTSHIP_UTIL_PLATFORM_MACOSX) */
+
+static MUTEX mutex;
 
 struct report_info_t
 {
@@ -78,9 +76,9 @@ memory_init(void)
      * would be wrong in the case of MALLOC() never being called.
      */
     ignore_bstv_malloc = 1;
-        bstv_init(&report);
-        bstv_insert(&report, 0, NULL);
-        bstv_erase(&report, 0);
+        bstv64_init(&report);
+        bstv64_insert(&report, 0, NULL);
+        bstv64_erase(&report, 0);
     ignore_bstv_malloc = 0;
 
     MUTEX_INIT(mutex)
@@ -149,16 +147,15 @@ malloc_wrapper_debug(uintptr_t size, const char* msg)
 #   endif
 
             /* insert into bstv */
-            if(!bstv_insert(&report, (uintptr_t)p, info))
+            if(!bstv64_insert(&report, (uint64_t)(uintptr_t)p, info))
             {
                 fprintf(stderr,
-                "[memory] WARNING: Hash collision occurred when inserting\n"
-                "into memory report bstv. On 64-bit systems the pointers are\n"
-                "truncated to 32-bit unsigned integers, so even though\n"
-                "it's rare, collisions can happen.\n\n"
+                "[memory] WARNING: Failed to insert allocation into memory\n"
+                "report. Either the report ran out of memory or the address\n"
+                "is already being tracked, which means it was handed out\n"
+                "twice without being freed.\n\n"
                 "The matching call to FREE() will generate a warning saying\n"
-                "something is being freed that was never allocated. This is to\n"
-                "be expected and can be ignored.\n");
+                "something is being freed that was never allocated.\n");
 #   ifdef ENABLE_MEMORY_BACKTRACE
                 {
                     char** bt;
@@ -208,12 +205,69 @@ malloc_wrapper_debug(uintptr_t size, const char* msg)
 
 /* ------------------------------------------------------------------------- */
 void*
-malloc_wrapper(uintptr_t size, const char* msg)
+realloc_wrapper_debug(void* ptr, uintptr_t size, const char* msg)
 {
-    void* mem = malloc(size);
-    if(mem == NULL)
-        fprintf(stderr, "%s", msg);
-    return mem;
+    void* p;
+    struct report_info_t* info;
+
+    if(!ptr)
+        return malloc_wrapper_debug(size, msg);
+
+    MUTEX_LOCK(mutex)
+
+#   ifdef ENABLE_MEMORY_EXPLICIT_MALLOC_FAILURES
+    if(malloc_fail_counter && !ignore_bstv_malloc)
+    {
+        /* fail when counter reaches 1 */
+        if(malloc_fail_counter == 1)
+        {
+            MUTEX_UNLOCK(mutex)
+            return NULL;
+        }
+        else
+            --malloc_fail_counter;
+    }
+#   endif
+
+    if(!(p = realloc_wrapper(ptr, size, msg)))
+    {
+        MUTEX_UNLOCK(mutex)
+        return NULL;
+    }
+
+    /*
+     * Move the allocation record to the new location. Inserting into the
+     * report may allocate memory, so set flag to ignore those calls.
+     */
+    if(!ignore_bstv_malloc)
+    {
+        ignore_bstv_malloc = 1;
+        if((info = (struct report_info_t*)bstv64_erase(&report, (uint64_t)(uintptr_t)ptr)))
+        {
+            info->location = (uintptr_t)p;
+            info->size = size;
+            if(!bstv64_insert(&report, (uint64_t)(uintptr_t)p, info))
+            {
+                fprintf(stderr,
+                "[memory] WARNING: Failed to insert allocation into memory\n"
+                "report after realloc(). The matching call to FREE() will\n"
+                "generate a warning saying something is being freed that was\n"
+                "never allocated.\n");
+#   ifdef ENABLE_MEMORY_BACKTRACE
+                if(info->backtrace)
+                    free(info->backtrace);
+#   endif
+                free(info);
+            }
+        }
+        else
+            fprintf(stderr, "  WARNING: Reallocating something that was never allocated\n");
+        ignore_bstv_malloc = 0;
+    }
+
+    MUTEX_UNLOCK(mutex)
+
+    return p;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -225,7 +279,7 @@ free_wrapper_debug(void* ptr)
     /* find matching allocation and remove from bstv */
     if(!ignore_bstv_malloc)
     {
-        struct report_info_t* info = (struct report_info_t*)bstv_erase(&report, (uintptr_t)ptr);
+        struct report_info_t* info = (struct report_info_t*)bstv64_erase(&report, (uint64_t)(uintptr_t)ptr);
         if(info)
         {
 #   ifdef ENABLE_MEMORY_BACKTRACE
@@ -278,16 +332,16 @@ memory_deinit(void)
 {
     uintptr_t leaks;
 
-    --allocations; /* this is the single allocation still held by the report vector */
+    allocations -= REPORT_ALLOCATIONS; /* still held by the report */
 
     printf("=========================================\n");
     printf("Memory Report\n");
     printf("=========================================\n");
 
     /* report details on any allocations that were not de-allocated */
-    if(report.vector.count != 0)
+    if(bstv64_count(&report) != 0)
     {
-        BSTV_FOR_EACH(&report, struct report_info_t, key, info)
+        BSTV64_FOR_EACH(&report, struct report_info_t, key, info)
 
             printf("  un-freed memory at %p, size %p\n", (void*)info->location, (void*)info->size);
             mutated_string_and_hex_dump((void*)info->location, info->size);
@@ -304,7 +358,7 @@ memory_deinit(void)
 #   endif
             free(info);
 
-        BSTV_END_EACH
+        BSTV64_END_EACH
 
         printf("=========================================\n");
     }
@@ -321,9 +375,9 @@ memory_deinit(void)
     printf("memory leaks: %" FORMAT_UINTPTR_T "\n", leaks);
     printf("=========================================\n");
 
-    ++allocations; /* this is the single allocation still held by the report vector */
+    allocations += REPORT_ALLOCATIONS; /* freed by bstv64_clear_free() below */
     ignore_bstv_malloc = 1;
-    bstv_clear_free(&report);
+    bstv64_clear_free(&report);
 
     MUTEX_DEINIT(mutex)
 
@@ -363,6 +417,26 @@ uintptr_t memory_deinit(void) { return 0; }
 
 #endif /* ENABLE_MEMORY_DEBUGGING */
 
+/* ------------------------------------------------------------------------- */
+void*
+malloc_wrapper(uintptr_t size, const char* msg)
+{
+    void* mem = malloc(size);
+    if(mem == NULL)
+        fprintf(stderr, "%s", msg);
+    return mem;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+realloc_wrapper(void* ptr, uintptr_t size, const char* msg)
+{
+    void* mem = realloc(ptr, size);
+    if(mem == NULL)
+        fprintf(stderr, "%s", msg);
+    return mem;
+}
+
 /* ------------------------------------------------------------------------- */
 void
 mutated_string_and_hex_dump(void* data, intptr_t length_in_bytes)
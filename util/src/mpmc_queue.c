@@ -0,0 +1,289 @@
+#include "util/mpmc_queue.h"
+#include "util/atomic.h"
+#include "util/thread.h"
+#include "util/memory.h"
+#include <string.h>
+#include <assert.h>
+
+/*
+ * Each cell starts with its sequence number, followed by the element. The
+ * header is 8 bytes so the element stays 8 byte aligned.
+ *
+ * For a cell at position pos, sequence == pos means it is free to be written,
+ * sequence == pos + 1 means it holds an element to be read. After reading,
+ * the consumer sets it to pos + capacity, which is the position the cell is
+ * written at next time around.
+ */
+#define CELL_HEADER_SIZE 8
+#define CELL(queue, pos) ((queue)->cells + (uintptr_t)((pos) & (queue)->mask) * (queue)->cell_size)
+#define CELL_SEQUENCE(cell) ((volatile uint32_t*)(cell))
+#define CELL_DATA(cell) ((cell) + CELL_HEADER_SIZE)
+
+/*
+ * How many times the blocking functions retry before going to sleep. The
+ * thread yields between retries, so the thread it waits for gets a chance to
+ * run even if they share a core.
+ */
+#define SPIN_COUNT 16
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static char
+push(struct mpmc_queue_t* queue, const void* data)
+{
+    unsigned char* cell;
+    uint32_t pos = ATOMIC_LOAD_RELAXED(&queue->enqueue_pos);
+
+    while(1)
+    {
+        int32_t diff;
+        cell = CELL(queue, pos);
+        diff = (int32_t)(ATOMIC_LOAD_ACQUIRE(CELL_SEQUENCE(cell)) - pos);
+        if(diff == 0)
+        {
+            if(ATOMIC_CAS(&queue->enqueue_pos, pos, pos + 1))
+                break;
+        }
+        else if(diff < 0)
+            return 0; /* the consumers haven't freed this cell yet, full */
+        pos = ATOMIC_LOAD_RELAXED(&queue->enqueue_pos);
+    }
+
+    memcpy(CELL_DATA(cell), data, queue->element_size);
+    ATOMIC_STORE_RELEASE(CELL_SEQUENCE(cell), pos + 1);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+pop(struct mpmc_queue_t* queue, void* data)
+{
+    unsigned char* cell;
+    uint32_t pos = ATOMIC_LOAD_RELAXED(&queue->dequeue_pos);
+
+    while(1)
+    {
+        int32_t diff;
+        cell = CELL(queue, pos);
+        diff = (int32_t)(ATOMIC_LOAD_ACQUIRE(CELL_SEQUENCE(cell)) - (pos + 1));
+        if(diff == 0)
+        {
+            if(ATOMIC_CAS(&queue->dequeue_pos, pos, pos + 1))
+                break;
+        }
+        else if(diff < 0)
+            return 0; /* nothing written here yet, empty */
+        pos = ATOMIC_LOAD_RELAXED(&queue->dequeue_pos);
+    }
+
+    memcpy(data, CELL_DATA(cell), queue->element_size);
+    ATOMIC_STORE_RELEASE(CELL_SEQUENCE(cell), pos + queue->mask + 1);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * A sleeping thread increments its counter and then checks the queue again
+ * while holding the mutex. The fence stops the load of the counter from
+ * moving before the push or pop that was just made, so either the sleeper
+ * sees the change or we see the sleeper.
+ */
+static void
+wake_one(struct mpmc_queue_t* queue, volatile uint32_t* waiting, struct cond_t* cond)
+{
+    ATOMIC_FENCE();
+    if(ATOMIC_LOAD_RELAXED(waiting) == 0)
+        return;
+    mutex_lock(queue->mutex);
+    cond_signal(cond);
+    mutex_unlock(queue->mutex);
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct mpmc_queue_t*
+mpmc_queue_create(uint32_t element_size, uint32_t capacity)
+{
+    struct mpmc_queue_t* queue;
+
+    if(!(queue = (struct mpmc_queue_t*)MALLOC(sizeof *queue, "mpmc_queue_create()")))
+        return NULL;
+
+    if(!mpmc_queue_init(queue, element_size, capacity))
+    {
+        FREE(queue);
+        return NULL;
+    }
+
+    return queue;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+mpmc_queue_init(struct mpmc_queue_t* queue, uint32_t element_size, uint32_t capacity)
+{
+    uint32_t i;
+
+    assert(queue);
+    assert(element_size > 0);
+    assert(capacity <= 0x80000000u);
+
+    memset(queue, 0, sizeof *queue);
+    queue->element_size = element_size;
+    queue->cell_size = (CELL_HEADER_SIZE + element_size + 7) & ~(uint32_t)7;
+    for(queue->mask = 1; queue->mask + 1 < capacity; queue->mask = (queue->mask << 1) | 1) {}
+
+    if(!(queue->cells = (unsigned char*)MALLOC((uintptr_t)(queue->mask + 1) * queue->cell_size,
+                                               "mpmc_queue_init()")))
+        goto alloc_cells_failed;
+    if(!(queue->mutex = mutex_create()))
+        goto create_mutex_failed;
+    if(!(queue->not_empty = cond_create()))
+        goto create_not_empty_failed;
+    if(!(queue->not_full = cond_create()))
+        goto create_not_full_failed;
+
+    for(i = 0; i != queue->mask + 1; ++i)
+        *CELL_SEQUENCE(CELL(queue, i)) = i;
+
+    return 1;
+
+    create_not_full_failed   : cond_destroy(queue->not_empty);
+    create_not_empty_failed  : mutex_destroy(queue->mutex);
+    create_mutex_failed      : FREE(queue->cells);
+    alloc_cells_failed       : return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mpmc_queue_destroy(struct mpmc_queue_t* queue)
+{
+    assert(queue);
+    mpmc_queue_clear_free(queue);
+    FREE(queue);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mpmc_queue_clear_free(struct mpmc_queue_t* queue)
+{
+    assert(queue);
+    assert(queue->consumers_waiting == 0);
+    assert(queue->producers_waiting == 0);
+
+    cond_destroy(queue->not_full);
+    cond_destroy(queue->not_empty);
+    mutex_destroy(queue->mutex);
+    FREE(queue->cells);
+    queue->cells = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+mpmc_queue_try_enqueue(struct mpmc_queue_t* queue, const void* data)
+{
+    assert(queue);
+    assert(data);
+
+    if(ATOMIC_LOAD_RELAXED(&queue->closed) || !push(queue, data))
+        return 0;
+    wake_one(queue, &queue->consumers_waiting, queue->not_empty);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+mpmc_queue_try_dequeue(struct mpmc_queue_t* queue, void* data)
+{
+    assert(queue);
+    assert(data);
+
+    if(!pop(queue, data))
+        return 0;
+    wake_one(queue, &queue->producers_waiting, queue->not_full);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+mpmc_queue_enqueue(struct mpmc_queue_t* queue, const void* data)
+{
+    char result = 0;
+    int spin;
+
+    for(spin = 0; spin != SPIN_COUNT; ++spin)
+    {
+        if(mpmc_queue_try_enqueue(queue, data))
+            return 1;
+        if(ATOMIC_LOAD_RELAXED(&queue->closed))
+            return 0;
+        thread_yield();
+    }
+
+    mutex_lock(queue->mutex);
+    ATOMIC_FETCH_ADD(&queue->producers_waiting, 1);
+    while(!queue->closed && !(result = push(queue, data)))
+        cond_wait(queue->not_full, queue->mutex);
+    ATOMIC_FETCH_ADD(&queue->producers_waiting, (uint32_t)-1);
+    mutex_unlock(queue->mutex);
+
+    if(result)
+        wake_one(queue, &queue->consumers_waiting, queue->not_empty);
+    return result;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+mpmc_queue_dequeue(struct mpmc_queue_t* queue, void* data)
+{
+    char result;
+    int spin;
+
+    for(spin = 0; spin != SPIN_COUNT; ++spin)
+    {
+        if(mpmc_queue_try_dequeue(queue, data))
+            return 1;
+        thread_yield();
+    }
+
+    mutex_lock(queue->mutex);
+    ATOMIC_FETCH_ADD(&queue->consumers_waiting, 1);
+    while(!(result = pop(queue, data)) && !queue->closed)
+        cond_wait(queue->not_empty, queue->mutex);
+    ATOMIC_FETCH_ADD(&queue->consumers_waiting, (uint32_t)-1);
+    mutex_unlock(queue->mutex);
+
+    if(result)
+        wake_one(queue, &queue->producers_waiting, queue->not_full);
+    return result;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mpmc_queue_close(struct mpmc_queue_t* queue)
+{
+    assert(queue);
+
+    mutex_lock(queue->mutex);
+    ATOMIC_STORE_RELEASE(&queue->closed, 1);
+    cond_broadcast(queue->not_empty);
+    cond_broadcast(queue->not_full);
+    mutex_unlock(queue->mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+mpmc_queue_count(const struct mpmc_queue_t* queue)
+{
+    uint32_t dequeue_pos, enqueue_pos;
+
+    assert(queue);
+
+    dequeue_pos = ATOMIC_LOAD_ACQUIRE(&queue->dequeue_pos);
+    enqueue_pos = ATOMIC_LOAD_ACQUIRE(&queue->enqueue_pos);
+
+    /* a consumer can overtake the snapshot of enqueue_pos */
+    return (int32_t)(enqueue_pos - dequeue_pos) < 0 ? 0 : enqueue_pos - dequeue_pos;
+}
@@ -3,6 +3,7 @@
 #include <assert.h>
 #include "util/ordered_vector.h"
 #include "util/memory.h"
+#include "util/allocator.h"
 
 /* ----------------------------------------------------------------------------
  * Static functions
@@ -11,11 +12,15 @@
 /*!
  * @brief Expands the underlying memory.
  *
- * This implementation will expand the memory by a factor of 2 each time this
- * is called. All elements are copied into the new section of memory.
+ * This implementation will expand the memory by the vector's growth factor
+ * each time this is called. If the allocator supports it, the memory is
+ * resized with realloc() so large buffers can grow in place. Otherwise all
+ * elements are copied into a new section of memory.
  * @param[in] insertion_index Set to -1 if no space should be made for element
  * insertion. Otherwise this parameter specifies the index of the element to
  * "evade" when re-allocating all other elements.
+ * @param[in] insertion_count How many elements of space to leave at the
+ * insertion index. Ignored if insertion_index is -1.
  * @param[in] target_size If set to 0, target size is calculated automatically.
  * Otherwise the vector will expand to the specified target size.
  * @note No checks are performed to make sure the target size is large enough.
@@ -23,8 +28,23 @@
 static char
 ordered_vector_expand(struct ordered_vector_t *vector,
                       uintptr_t insertion_index,
+                      uint32_t insertion_count,
                       uint32_t target_size);
 
+/*!
+ * @brief Calculates the capacity the vector should grow to next.
+ */
+static uint32_t
+ordered_vector_grown_capacity(const struct ordered_vector_t* vector);
+
+/*!
+ * @brief LSD radix sort on a 4 or 8 byte unsigned key at the specified offset.
+ */
+static char
+ordered_vector_radix_sort(struct ordered_vector_t* vector,
+                          uint32_t key_offset,
+                          uint32_t key_size);
+
 /* ----------------------------------------------------------------------------
  * Exported functions
  * ------------------------------------------------------------------------- */
@@ -45,6 +65,34 @@ ordered_vector_init(struct ordered_vector_t* vector, const uint32_t element_size
     assert(vector);
     memset(vector, 0, sizeof(struct ordered_vector_t));
     vector->element_size = element_size;
+    vector->growth_factor = ORDERED_VECTOR_DEFAULT_GROWTH_FACTOR;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ordered_vector_init_with_allocator(struct ordered_vector_t* vector,
+                                   const uint32_t element_size,
+                                   const struct allocator_t* allocator)
+{
+    ordered_vector_init(vector, element_size);
+    vector->allocator = allocator;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ordered_vector_init_inline(struct ordered_vector_t* vector,
+                           const uint32_t element_size,
+                           void* buffer,
+                           uint32_t inline_capacity)
+{
+    assert(buffer);
+    assert(inline_capacity);
+
+    ordered_vector_init(vector, element_size);
+    vector->inline_data = (DATA_POINTER_TYPE*)buffer;
+    vector->inline_capacity = inline_capacity;
+    vector->data = vector->inline_data;
+    vector->capacity = inline_capacity;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -74,12 +122,84 @@ ordered_vector_clear_free(struct ordered_vector_t* vector)
 {
     assert(vector);
 
-    if(vector->data)
-        FREE(vector->data);
+    if(vector->data && vector->data != vector->inline_data)
+        ALLOCATOR_FREE(vector->allocator, vector->data);
 
-    vector->data = NULL;
+    /* falls back to inline storage, if any */
+    vector->data = vector->inline_data;
     vector->count = 0;
-    vector->capacity = 0;
+    vector->capacity = vector->inline_capacity;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+ordered_vector_reserve(struct ordered_vector_t* vector, uint32_t count)
+{
+    assert(vector);
+
+    if(count <= vector->capacity)
+        return 1;
+    return ordered_vector_expand(vector, -1, 0, count);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+ordered_vector_shrink_to_fit(struct ordered_vector_t* vector)
+{
+    DATA_POINTER_TYPE* new_data;
+
+    assert(vector);
+
+    if(vector->count == vector->capacity)
+        return 1;
+
+    if(vector->count == 0)
+    {
+        ordered_vector_clear_free(vector);
+        return 1;
+    }
+
+    /* inline storage can't shrink */
+    if(vector->data == vector->inline_data)
+        return 1;
+
+    /* move back into inline storage if the elements fit */
+    if(vector->count <= vector->inline_capacity)
+    {
+        memcpy(vector->inline_data, vector->data, vector->count * vector->element_size);
+        ALLOCATOR_FREE(vector->allocator, vector->data);
+        vector->data = vector->inline_data;
+        vector->capacity = vector->inline_capacity;
+        return 1;
+    }
+
+    if(ALLOCATOR_CAN_REALLOC(vector->allocator))
+    {
+        new_data = (DATA_POINTER_TYPE*)ALLOCATOR_REALLOC(vector->allocator, vector->data, vector->count * vector->element_size, "ordered_vector_shrink_to_fit()");
+        if(!new_data)
+            return 0;
+    }
+    else
+    {
+        new_data = (DATA_POINTER_TYPE*)ALLOCATOR_MALLOC(vector->allocator, vector->count * vector->element_size, "ordered_vector_shrink_to_fit()");
+        if(!new_data)
+            return 0;
+        memcpy(new_data, vector->data, vector->count * vector->element_size);
+        ALLOCATOR_FREE(vector->allocator, vector->data);
+    }
+
+    vector->data = new_data;
+    vector->capacity = vector->count;
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ordered_vector_set_growth_factor(struct ordered_vector_t* vector, float factor)
+{
+    assert(vector);
+    assert(factor > 1.0f);
+    vector->growth_factor = factor;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -91,7 +211,7 @@ ordered_vector_push_emplace(struct ordered_vector_t* vector)
     assert(vector);
 
     if(vector->count == vector->capacity)
-        if(!ordered_vector_expand(vector, -1, 0))
+        if(!ordered_vector_expand(vector, -1, 0, 0))
             return NULL;
     data = vector->data + (vector->element_size * vector->count);
     ++(vector->count);
@@ -127,7 +247,7 @@ ordered_vector_push_vector(struct ordered_vector_t* vector, struct ordered_vecto
 
     /* make sure there's enough space in the target vector */
     if(vector->count + source_vector->count > vector->capacity)
-        if(!ordered_vector_expand(vector, -1, vector->count + source_vector->count))
+        if(!ordered_vector_expand(vector, -1, 0, vector->count + source_vector->count))
             return 0;
 
     /* copy data */
@@ -183,7 +303,7 @@ ordered_vector_insert_emplace(struct ordered_vector_t* vector, uint32_t index)
     /* re-allocate? */
     if(vector->count == vector->capacity)
     {
-        if(!ordered_vector_expand(vector, index, 0))
+        if(!ordered_vector_expand(vector, index, 1, 0))
             return NULL;
     }
     else
@@ -217,6 +337,68 @@ ordered_vector_insert(struct ordered_vector_t* vector, uint32_t index, void* dat
     return 1;
 }
 
+/* ------------------------------------------------------------------------- */
+void*
+ordered_vector_insert_range_emplace(struct ordered_vector_t* vector,
+                                    uint32_t index,
+                                    uint32_t count)
+{
+    assert(vector);
+
+    if(index > vector->count || count == 0)
+        return NULL;
+
+    /* guard against the element counter overflowing */
+    if(count > (uint32_t)-1 - vector->count)
+        return NULL;
+
+    /* re-allocate? */
+    if(vector->count + count > vector->capacity)
+    {
+        /* grow by the usual factor, unless the range needs even more space */
+        uint32_t target_count = ordered_vector_grown_capacity(vector);
+        if(target_count < vector->count + count)
+            target_count = vector->count + count;
+        if(!ordered_vector_expand(vector, index, count, target_count))
+            return NULL;
+    }
+    else
+    {
+        /* shift all elements up by count in one move to make space */
+        uint32_t total_size = vector->count * vector->element_size;
+        uint32_t offset = vector->element_size * index;
+        memmove((void*)((intptr_t)vector->data + offset + count * vector->element_size),
+                (void*)((intptr_t)vector->data + offset),
+                total_size - offset);
+    }
+
+    /* return pointer to memory of first new element */
+    vector->count += count;
+    return (void*)(vector->data + index * vector->element_size);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+ordered_vector_insert_range(struct ordered_vector_t* vector,
+                            uint32_t index,
+                            const void* data,
+                            uint32_t count)
+{
+    void* emplaced;
+
+    assert(vector);
+    assert(data);
+
+    if(count == 0)
+        return 1;
+
+    emplaced = ordered_vector_insert_range_emplace(vector, index, count);
+    if(!emplaced)
+        return 0;
+    memcpy(emplaced, data, count * vector->element_size);
+    return 1;
+}
+
 /* ------------------------------------------------------------------------- */
 void
 ordered_vector_erase_index(struct ordered_vector_t* vector, uint32_t index)
@@ -262,6 +444,108 @@ ordered_vector_erase_element(struct ordered_vector_t* vector, void* element)
     --vector->count;
 }
 
+/* ------------------------------------------------------------------------- */
+void
+ordered_vector_erase_range(struct ordered_vector_t* vector,
+                           uint32_t begin_index,
+                           uint32_t end_index)
+{
+    assert(vector);
+
+    if(end_index > vector->count)
+        end_index = vector->count;
+    if(begin_index >= end_index)
+        return;
+
+    /* shift everything after the range down in one move */
+    if(end_index != vector->count)
+    {
+        memmove(vector->data + begin_index * vector->element_size,
+                vector->data + end_index * vector->element_size,
+                (vector->count - end_index) * vector->element_size);
+    }
+    vector->count -= end_index - begin_index;
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+ordered_vector_erase_if(struct ordered_vector_t* vector,
+                        ordered_vector_predicate_func predicate,
+                        void* user_data)
+{
+    DATA_POINTER_TYPE* read;
+    DATA_POINTER_TYPE* write;
+    DATA_POINTER_TYPE* end;
+    uint32_t erased;
+
+    assert(vector);
+    assert(predicate);
+
+    if(!vector->count)
+        return 0;
+
+    /* elements before the first match stay where they are */
+    end = vector->data + vector->count * vector->element_size;
+    for(read = vector->data; read != end; read += vector->element_size)
+        if(predicate(read, user_data))
+            break;
+
+    /*
+     * "read" always points at an element being erased at the start of each
+     * iteration. Collect the run of kept elements following it and move the
+     * whole run down to the write position in one go.
+     */
+    write = read;
+    while(read != end)
+    {
+        DATA_POINTER_TYPE* run_begin;
+
+        read += vector->element_size;
+        run_begin = read;
+        while(read != end && !predicate(read, user_data))
+            read += vector->element_size;
+
+        if(read != run_begin)
+        {
+            memmove(write, run_begin, read - run_begin);
+            write += read - run_begin;
+        }
+    }
+
+    erased = (uint32_t)((end - write) / vector->element_size);
+    vector->count -= erased;
+    return erased;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ordered_vector_sort(struct ordered_vector_t* vector,
+                    ordered_vector_compare_func compare)
+{
+    assert(vector);
+    assert(compare);
+
+    if(vector->count < 2)
+        return;
+    qsort(vector->data, vector->count, vector->element_size, compare);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+ordered_vector_radix_sort_u32(struct ordered_vector_t* vector,
+                              uint32_t key_offset)
+{
+    return ordered_vector_radix_sort(vector, key_offset, sizeof(uint32_t));
+}
+
+/* ------------------------------------------------------------------------- */
+char
+ordered_vector_radix_sort_u64(struct ordered_vector_t* vector,
+                              uint32_t key_offset)
+{
+    return ordered_vector_radix_sort(vector, key_offset, sizeof(uint64_t));
+}
+
 /* ------------------------------------------------------------------------- */
 void*
 ordered_vector_get_element(struct ordered_vector_t* vector, uint32_t index)
@@ -279,17 +563,18 @@ ordered_vector_get_element(struct ordered_vector_t* vector, uint32_t index)
 static char
 ordered_vector_expand(struct ordered_vector_t *vector,
                       uintptr_t insertion_index,
+                      uint32_t insertion_count,
                       uint32_t target_count)
 {
     uintptr_t new_count;
     DATA_POINTER_TYPE* old_data;
     DATA_POINTER_TYPE* new_data;
 
-    /* expand by factor 2, or adopt target count if it is not 0 */
+    /* expand by growth factor, or adopt target count if it is not 0 */
     if(target_count)
         new_count = target_count;
     else
-        new_count = vector->capacity << 1;
+        new_count = ordered_vector_grown_capacity(vector);
 
     /*
      * If vector hasn't allocated anything yet, just allocated the requested
@@ -297,17 +582,41 @@ ordered_vector_expand(struct ordered_vector_t *vector,
      */
     if(!vector->data)
     {
-        new_count = (new_count == 0 ? 2 : new_count);
-        vector->data = MALLOC(new_count * vector->element_size, "ordered_vector_expand()");
+        vector->data = ALLOCATOR_MALLOC(vector->allocator, new_count * vector->element_size, "ordered_vector_expand()");
         if(!vector->data)
             return 0;
         vector->capacity = new_count;
         return 1;
     }
 
+    /*
+     * Resize in place if possible. The C library is free to extend the block
+     * or remap its pages instead of copying. Space for insertion is made
+     * afterwards by shifting the tail of the vector.
+     */
+    if(ALLOCATOR_CAN_REALLOC(vector->allocator) && vector->data != vector->inline_data)
+    {
+        new_data = (DATA_POINTER_TYPE*)ALLOCATOR_REALLOC(vector->allocator, vector->data, new_count * vector->element_size, "ordered_vector_expand()");
+        if(!new_data)
+            return 0;
+
+        if(insertion_index != (uintptr_t)-1 && insertion_index < vector->count)
+        {
+            uint32_t offset = vector->element_size * insertion_index;
+            uint32_t total_size = vector->element_size * vector->count;
+            memmove((void*)((intptr_t)new_data + offset + insertion_count * vector->element_size),
+                    (void*)((intptr_t)new_data + offset),
+                    total_size - offset);
+        }
+
+        vector->data = new_data;
+        vector->capacity = new_count;
+        return 1;
+    }
+
     /* prepare for reallocating data */
     old_data = vector->data;
-    new_data = (DATA_POINTER_TYPE*)MALLOC(new_count * vector->element_size, "ordered_vector_expand()");
+    new_data = (DATA_POINTER_TYPE*)ALLOCATOR_MALLOC(vector->allocator, new_count * vector->element_size, "ordered_vector_expand()");
     if(!new_data)
         return 0;
 
@@ -315,22 +624,141 @@ ordered_vector_expand(struct ordered_vector_t *vector,
     if(insertion_index == (uintptr_t)-1 || insertion_index >= new_count)
         memcpy(new_data, old_data, vector->count * vector->element_size);
 
-    /* keep space for one element at the insertion index */
+    /* keep space for insertion_count elements at the insertion index */
     else
     {
         /* copy old data up until right before insertion offset */
         uint32_t offset = vector->element_size * insertion_index;
         uint32_t total_size = vector->element_size * vector->count;
         memcpy(new_data, old_data, offset);
-        /* copy the remaining amount of old data shifted one element ahead */
-        memcpy((void*)((intptr_t)new_data + offset + vector->element_size),
+        /* copy the remaining amount of old data shifted insertion_count elements ahead */
+        memcpy((void*)((intptr_t)new_data + offset + insertion_count * vector->element_size),
                (void*)((intptr_t)old_data + offset),
                total_size - offset);
     }
 
     vector->data = new_data;
     vector->capacity = new_count;
-    FREE(old_data);
+    if(old_data != vector->inline_data)
+        ALLOCATOR_FREE(vector->allocator, old_data);
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+static uint32_t
+ordered_vector_grown_capacity(const struct ordered_vector_t* vector)
+{
+    float factor = vector->growth_factor;
+    uint32_t new_capacity;
+
+    /* vectors that were zero-initialised instead of initialised with init() */
+    if(factor <= 1.0f)
+        factor = ORDERED_VECTOR_DEFAULT_GROWTH_FACTOR;
+    new_capacity = (uint32_t)(vector->capacity * factor);
+
+    /* small capacities multiplied by small factors may not grow at all */
+    if(new_capacity <= vector->capacity)
+        new_capacity = vector->capacity + 1;
+    if(new_capacity < 2)
+        new_capacity = 2;
+    return new_capacity;
+}
+
+/* ------------------------------------------------------------------------- */
+static uint64_t
+ordered_vector_read_key(const DATA_POINTER_TYPE* element, uint32_t key_size)
+{
+    /* memcpy() because the key is not necessarily aligned */
+    if(key_size == sizeof(uint32_t))
+    {
+        uint32_t key;
+        memcpy(&key, element, sizeof key);
+        return key;
+    }
+    else
+    {
+        uint64_t key;
+        memcpy(&key, element, sizeof key);
+        return key;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+ordered_vector_radix_sort(struct ordered_vector_t* vector,
+                          uint32_t key_offset,
+                          uint32_t key_size)
+{
+    uint32_t histogram[sizeof(uint64_t)][256];
+    DATA_POINTER_TYPE* src;
+    DATA_POINTER_TYPE* dst;
+    DATA_POINTER_TYPE* scratch;
+    DATA_POINTER_TYPE* element;
+    DATA_POINTER_TYPE* end;
+    uint32_t pass, i;
+
+    assert(vector);
+    assert(key_offset + key_size <= vector->element_size);
+
+    if(vector->count < 2)
+        return 1;
+
+    scratch = (DATA_POINTER_TYPE*)ALLOCATOR_MALLOC(vector->allocator,
+                                                   vector->count * vector->element_size,
+                                                   "ordered_vector_radix_sort()");
+    if(!scratch)
+        return 0;
+
+    /* build the histograms of all passes in a single read over the data */
+    memset(histogram, 0, sizeof histogram);
+    end = vector->data + vector->count * vector->element_size;
+    for(element = vector->data; element != end; element += vector->element_size)
+    {
+        uint64_t key = ordered_vector_read_key(element + key_offset, key_size);
+        for(pass = 0; pass != key_size; ++pass)
+            ++histogram[pass][(key >> (pass * 8)) & 0xFF];
+    }
+
+    src = vector->data;
+    dst = scratch;
+    for(pass = 0; pass != key_size; ++pass)
+    {
+        uint32_t offset = 0;
+        uint64_t key;
+
+        /* if every key has the same byte here, this pass wouldn't move anything */
+        key = ordered_vector_read_key(src + key_offset, key_size);
+        if(histogram[pass][(key >> (pass * 8)) & 0xFF] == vector->count)
+            continue;
+
+        /* turn counts into starting offsets */
+        for(i = 0; i != 256; ++i)
+        {
+            uint32_t count = histogram[pass][i];
+            histogram[pass][i] = offset;
+            offset += count;
+        }
+
+        end = src + vector->count * vector->element_size;
+        for(element = src; element != end; element += vector->element_size)
+        {
+            uint32_t bucket;
+            key = ordered_vector_read_key(element + key_offset, key_size);
+            bucket = (uint32_t)(key >> (pass * 8)) & 0xFF;
+            memcpy(dst + histogram[pass][bucket]++ * vector->element_size,
+                   element, vector->element_size);
+        }
+
+        element = src;
+        src = dst;
+        dst = element;
+    }
+
+    /* after an odd number of passes the result is in the scratch buffer */
+    if(src != vector->data)
+        memcpy(vector->data, src, vector->count * vector->element_size);
 
+    ALLOCATOR_FREE(vector->allocator, scratch);
     return 1;
 }
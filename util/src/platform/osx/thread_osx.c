@@ -0,0 +1,184 @@
+#include "util/thread.h"
+#include "util/memory.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <assert.h>
+
+struct thread_t
+{
+    pthread_t handle;
+    thread_func func;
+    void* arg;
+};
+
+/* ------------------------------------------------------------------------- */
+static void*
+thread_entry(void* arg)
+{
+    struct thread_t* thread = (struct thread_t*)arg;
+    thread->func(thread->arg);
+    return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+struct thread_t*
+thread_create(thread_func func, void* arg)
+{
+    struct thread_t* thread;
+
+    assert(func);
+
+    if(!(thread = (struct thread_t*)MALLOC(sizeof *thread, "thread_create()")))
+        return NULL;
+    thread->func = func;
+    thread->arg = arg;
+    if(pthread_create(&thread->handle, NULL, thread_entry, thread) != 0)
+    {
+        FREE(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_join(struct thread_t* thread)
+{
+    assert(thread);
+    pthread_join(thread->handle, NULL);
+    FREE(thread);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_yield(void)
+{
+    sched_yield();
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_sleep(uint32_t milliseconds)
+{
+    struct timespec time;
+    time.tv_sec = milliseconds / 1000;
+    time.tv_nsec = (long)(milliseconds % 1000) * 1000000;
+    /* continue sleeping if a signal interrupted us */
+    while(nanosleep(&time, &time) != 0 && errno == EINTR) {}
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+thread_cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (uint32_t)count;
+}
+
+/* ------------------------------------------------------------------------- */
+struct mutex_t
+{
+    pthread_mutex_t handle;
+};
+
+struct cond_t
+{
+    pthread_cond_t handle;
+};
+
+/* ------------------------------------------------------------------------- */
+struct mutex_t*
+mutex_create(void)
+{
+    struct mutex_t* mutex;
+
+    if(!(mutex = (struct mutex_t*)MALLOC(sizeof *mutex, "mutex_create()")))
+        return NULL;
+    if(pthread_mutex_init(&mutex->handle, NULL) != 0)
+    {
+        FREE(mutex);
+        return NULL;
+    }
+
+    return mutex;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mutex_destroy(struct mutex_t* mutex)
+{
+    assert(mutex);
+    pthread_mutex_destroy(&mutex->handle);
+    FREE(mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mutex_lock(struct mutex_t* mutex)
+{
+    assert(mutex);
+    pthread_mutex_lock(&mutex->handle);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mutex_unlock(struct mutex_t* mutex)
+{
+    assert(mutex);
+    pthread_mutex_unlock(&mutex->handle);
+}
+
+/* ------------------------------------------------------------------------- */
+struct cond_t*
+cond_create(void)
+{
+    struct cond_t* cond;
+
+    if(!(cond = (struct cond_t*)MALLOC(sizeof *cond, "cond_create()")))
+        return NULL;
+    if(pthread_cond_init(&cond->handle, NULL) != 0)
+    {
+        FREE(cond);
+        return NULL;
+    }
+
+    return cond;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+cond_destroy(struct cond_t* cond)
+{
+    assert(cond);
+    pthread_cond_destroy(&cond->handle);
+    FREE(cond);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+cond_wait(struct cond_t* cond, struct mutex_t* mutex)
+{
+    assert(cond);
+    assert(mutex);
+    pthread_cond_wait(&cond->handle, &mutex->handle);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+cond_signal(struct cond_t* cond)
+{
+    assert(cond);
+    pthread_cond_signal(&cond->handle);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+cond_broadcast(struct cond_t* cond)
+{
+    assert(cond);
+    pthread_cond_broadcast(&cond->handle);
+}
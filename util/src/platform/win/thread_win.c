@@ -0,0 +1,170 @@
+#include "util/thread.h"
+#include "util/memory.h"
+#include <windows.h>
+#include <assert.h>
+
+struct thread_t
+{
+    HANDLE handle;
+    thread_func func;
+    void* arg;
+};
+
+/* ------------------------------------------------------------------------- */
+static DWORD WINAPI
+thread_entry(LPVOID arg)
+{
+    struct thread_t* thread = (struct thread_t*)arg;
+    thread->func(thread->arg);
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+struct thread_t*
+thread_create(thread_func func, void* arg)
+{
+    struct thread_t* thread;
+
+    assert(func);
+
+    if(!(thread = (struct thread_t*)MALLOC(sizeof *thread, "thread_create()")))
+        return NULL;
+    thread->func = func;
+    thread->arg = arg;
+    if(!(thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL)))
+    {
+        FREE(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_join(struct thread_t* thread)
+{
+    assert(thread);
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    FREE(thread);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_yield(void)
+{
+    SwitchToThread();
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_sleep(uint32_t milliseconds)
+{
+    Sleep(milliseconds);
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+thread_cpu_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors < 1 ? 1 : (uint32_t)info.dwNumberOfProcessors;
+}
+
+/* ------------------------------------------------------------------------- */
+/* condition variables need Windows Vista or later */
+struct mutex_t
+{
+    CRITICAL_SECTION handle;
+};
+
+struct cond_t
+{
+    CONDITION_VARIABLE handle;
+};
+
+/* ------------------------------------------------------------------------- */
+struct mutex_t*
+mutex_create(void)
+{
+    struct mutex_t* mutex;
+
+    if(!(mutex = (struct mutex_t*)MALLOC(sizeof *mutex, "mutex_create()")))
+        return NULL;
+    InitializeCriticalSection(&mutex->handle);
+
+    return mutex;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mutex_destroy(struct mutex_t* mutex)
+{
+    assert(mutex);
+    DeleteCriticalSection(&mutex->handle);
+    FREE(mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mutex_lock(struct mutex_t* mutex)
+{
+    assert(mutex);
+    EnterCriticalSection(&mutex->handle);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+mutex_unlock(struct mutex_t* mutex)
+{
+    assert(mutex);
+    LeaveCriticalSection(&mutex->handle);
+}
+
+/* ------------------------------------------------------------------------- */
+struct cond_t*
+cond_create(void)
+{
+    struct cond_t* cond;
+
+    if(!(cond = (struct cond_t*)MALLOC(sizeof *cond, "cond_create()")))
+        return NULL;
+    InitializeConditionVariable(&cond->handle);
+
+    return cond;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+cond_destroy(struct cond_t* cond)
+{
+    assert(cond);
+    FREE(cond);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+cond_wait(struct cond_t* cond, struct mutex_t* mutex)
+{
+    assert(cond);
+    assert(mutex);
+    SleepConditionVariableCS(&cond->handle, &mutex->handle, INFINITE);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+cond_signal(struct cond_t* cond)
+{
+    assert(cond);
+    WakeConditionVariable(&cond->handle);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+cond_broadcast(struct cond_t* cond)
+{
+    assert(cond);
+    WakeAllConditionVariable(&cond->handle);
+}
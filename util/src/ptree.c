@@ -1,5 +1,6 @@
 #include "util/ptree.h"
 #include "util/memory.h"
+#include "util/allocator.h"
 #include "util/string.h"
 #include <string.h>
 #include <assert.h>
@@ -9,28 +10,80 @@ const char ptree_node_delim = '.';
 /* ------------------------------------------------------------------------- */
 /*
  * Initialises an existing node by setting its value, its parent, and
- * initialising its container for future children.
+ * initialising its container for future children. The allocator is stored in
+ * the children container and is also the allocator the node itself was
+ * allocated with (if it was allocated by ptree_create() or ptree_add_node()).
  */
 static void
-ptree_init_node(struct ptree_t* node, struct ptree_t* parent, void* value)
+ptree_init_node(struct ptree_t* node,
+    			struct ptree_t* parent,
+    			void* value,
+    			const struct allocator_t* allocator)
 {
     memset(node, 0, sizeof *node);
-    bsthv_init(&node->children);
+    string_map_init_with_allocator(&node->children, allocator);
     node->parent = parent;
     node->value = value;
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Inserts a node into the parent's children and makes the node reference the
+ * parent's copy of its key. Knowing its own key lets a node be found in and
+ * removed from its parent without scanning all of the parent's children.
+ */
+static char
+ptree_link_child(struct ptree_t* parent, const char* key, struct ptree_t* node)
+{
+    struct string_map_key_t k;
+
+    string_map_key_init(&k, key);
+    if(!string_map_insert_hashed(&parent->children, &k, node))
+    	return 0;
+
+    node->parent = parent;
+    node->key = string_map_find_key_hashed(&parent->children, &k);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Removes a node from its parent's children. The node itself is not freed.
+ */
+static void
+ptree_unlink_child(struct ptree_t* node)
+{
+    void* erased;
+
+    if(!node->parent)
+    	return;
+
+    erased = string_map_erase(&node->parent->children, node->key);
+    assert(erased == node);
+    (void)erased;
+
+    node->parent = NULL;
+    node->key = NULL;
+}
+
 /*
  * Allocates a new root node with the key name "root". This function will
  * call ptree_init_ptree() to initialise the node.
  */
 struct ptree_t*
 ptree_create(void* value)
+{
+    return ptree_create_with_allocator(value, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+struct ptree_t*
+ptree_create_with_allocator(void* value, const struct allocator_t* allocator)
 {
     struct ptree_t* tree;
-    if(!(tree = (struct ptree_t*)MALLOC(sizeof(struct ptree_t), "ptree_create()")))
+    if(!(tree = (struct ptree_t*)ALLOCATOR_MALLOC(allocator, sizeof(struct ptree_t), "ptree_create()")))
     	return NULL;
-    ptree_init(tree, value);
+    ptree_init_with_allocator(tree, value, allocator);
     return tree;
 }
 
@@ -41,10 +94,19 @@ ptree_create(void* value)
  */
 void
 ptree_init(struct ptree_t* tree, void* value)
+{
+    ptree_init_with_allocator(tree, value, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ptree_init_with_allocator(struct ptree_t* tree,
+    					  void* value,
+    					  const struct allocator_t* allocator)
 {
     assert(tree);
 
-    ptree_init_node(tree, NULL, value);
+    ptree_init_node(tree, NULL, value, allocator);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -55,20 +117,19 @@ ptree_init(struct ptree_t* tree, void* value)
 void
 ptree_destroy(struct ptree_t* tree)
 {
+    const struct allocator_t* allocator;
+
     assert(tree);
 
+    allocator = string_map_allocator(&tree->children);
     ptree_destroy_keep_root(tree);
-    FREE(tree);
+    ALLOCATOR_FREE(allocator, tree);
 }
 
 static const char*
 ptree_get_node_key(const struct ptree_t* node)
 {
-    const char* key;
-    if(node->parent && (key = bsthv_find_element(&node->parent->children, node)))
-    	return key;
-    else
-    	return "root";
+    return node->key ? node->key : "root";
 }
 
 /* ------------------------------------------------------------------------- */
@@ -81,11 +142,11 @@ static void
 ptree_destroy_children_recurse(struct ptree_t* tree)
 {
     /* destroy all children recursively */
-    BSTHV_FOR_EACH(&tree->children, struct ptree_t, key, child)
+    STRING_MAP_FOR_EACH(&tree->children, struct ptree_t, key, child)
     	ptree_destroy_children_recurse(child);
-    	FREE(child);
-    BSTHV_END_EACH
-    bsthv_clear_free(&tree->children);
+    	ALLOCATOR_FREE(string_map_allocator(&child->children), child);
+    STRING_MAP_END_EACH
+    string_map_clear_free(&tree->children);
 
     /* free the data of this node, if specified */
     if(tree->value)
@@ -117,8 +178,7 @@ ptree_destroy_keep_root(struct ptree_t* tree)
      * If tree has parent, detach by removing ourselves from the parent's list
      * of children.
      */
-    if(tree->parent)
-    	bsthv_erase_element(&tree->parent->children, tree);
+    ptree_unlink_child(tree);
 
     /* recursively destroy children of detached node */
     ptree_destroy_children_recurse(tree);
@@ -129,16 +189,17 @@ static struct ptree_t*
 ptree_add_node(struct ptree_t* tree, const char* key, void* value)
 {
     struct ptree_t* child;
-    if(!(child = (struct ptree_t*)MALLOC(sizeof(struct ptree_t), "ptree_add_node()")))
+    const struct allocator_t* allocator = string_map_allocator(&tree->children);
+    if(!(child = (struct ptree_t*)ALLOCATOR_MALLOC(allocator, sizeof(struct ptree_t), "ptree_add_node()")))
     	return NULL;
 
-    if(!bsthv_insert(&tree->children, key, child))
+    ptree_init_node(child, NULL, value, allocator);
+    if(!ptree_link_child(tree, key, child))
     {
-    	FREE(child);
+    	ALLOCATOR_FREE(allocator, child);
     	return NULL;
     }
 
-    ptree_init_node(child, tree, value);
     return child;
 }
 
@@ -196,7 +257,7 @@ ptree_set(struct ptree_t* root, const char* key, void* value)
     child_node_key = strtok_r_portable(key_tok, ptree_node_delim, &saveptr);
 
     /* store current child count so we can tell if malloc failed */
-    child_count = bsthv_count(&root->children);
+    child_count = string_map_count(&root->children);
 
     /*
      * Recursively fills in any middle nodes until the end node is reached and
@@ -210,10 +271,10 @@ ptree_set(struct ptree_t* root, const char* key, void* value)
     /*
      * If the node wasn't added successfully and the children of root were
      * modified, undo all changes.
-     * Note that ptree_get_node() uses malloc() because of strtok. Use
-     * ptree_get_node_no_depth() instead.
+     * child_node_key is the first segment of the key, so there is no need
+     * to walk the path with ptree_get_node().
      */
-    if(!node && bsthv_count(&root->children) != child_count)
+    if(!node && string_map_count(&root->children) != child_count)
     {
     	if((node = ptree_get_node_no_depth(root, child_node_key)))
     		ptree_destroy(node);
@@ -233,6 +294,9 @@ ptree_set(struct ptree_t* root, const char* key, void* value)
 char
 ptree_set_parent(struct ptree_t* node, struct ptree_t* parent, const char* key)
 {
+    struct ptree_t* old_parent;
+    const char* old_key;
+
     assert(node);
     assert(key);
 
@@ -246,18 +310,29 @@ ptree_set_parent(struct ptree_t* node, struct ptree_t* parent, const char* key)
     	 */
     	if(node == parent || ptree_node_is_child_of(parent, node))
     		return 0;
+    }
 
-    	/* insert into parent */
-    	if(!bsthv_insert(&parent->children, key, node))
+    /*
+     * Insert into the new parent before removing from the current parent, so
+     * nothing changes if insertion fails. The current key stays valid until
+     * it is erased.
+     */
+    old_parent = node->parent;
+    old_key = node->key;
+    if(parent)
+    {
+    	if(!ptree_link_child(parent, key, node))
     		return 0;
     }
+    else
+    {
+    	node->parent = NULL;
+    	node->key = NULL;
+    }
 
     /* remove from current parent */
-    if(node->parent)
-    	bsthv_erase_element(&node->parent->children, node);
-
-    /* set new parent */
-    node->parent = parent;
+    if(old_parent)
+    	string_map_erase(&old_parent->children, old_key);
 
     return 1;
 }
@@ -286,17 +361,17 @@ ptree_clean(struct ptree_t* root)
 
     assert(root);
 
-    BSTHV_FOR_EACH(&root->children, struct ptree_t, key, child)
+    STRING_MAP_FOR_EACH(&root->children, struct ptree_t, key, child)
     	count += ptree_clean(child);
-    	if(bsthv_count(&child->children) == 0 && child->value == NULL)
+    	if(string_map_count(&child->children) == 0 && child->value == NULL)
     	{
-    		bsthv_clear_free(&child->children);
-    		FREE(child);
-    		BSTHV_ERASE_CURRENT_ITEM_IN_FOR_LOOP(&root->children, key, child);
+    		string_map_clear_free(&child->children);
+    		ALLOCATOR_FREE(string_map_allocator(&child->children), child);
+    		STRING_MAP_ERASE_CURRENT_ITEM_IN_FOR_LOOP(&root->children, key, child);
 
     		++count;
     	}
-    BSTHV_END_EACH
+    STRING_MAP_END_EACH
 
     return count;
 }
@@ -329,6 +404,11 @@ ptree_set_free_func(struct ptree_t* node, ptree_free_func func)
     node->free_value = func;
 }
 
+/* ------------------------------------------------------------------------- */
+static struct ptree_t*
+ptree_duplicate_tree_with_allocator(const struct ptree_t* source_node,
+    								const struct allocator_t* allocator);
+
 /* ------------------------------------------------------------------------- */
 static char
 ptree_duplicate_children_into_existing_node_recurse(struct ptree_t* target,
@@ -349,13 +429,13 @@ ptree_duplicate_children_into_existing_node_recurse(struct ptree_t* target,
     }
 
     /* iterate over all children of source and duplicate them */
-    BSTHV_FOR_EACH(&source->children, struct ptree_t, key, node)
+    STRING_MAP_FOR_EACH(&source->children, struct ptree_t, key, node)
     	struct ptree_t* child;
     	if(!(child = ptree_add_node(target, key, NULL)))
     		return 0;  /* duplicate key error */
     	if(!ptree_duplicate_children_into_existing_node_recurse(child, node))
     		return 0;  /* some other error, propagate */
-    BSTHV_END_EACH
+    STRING_MAP_END_EACH
 
     return 1;
 }
@@ -364,71 +444,69 @@ char
 ptree_duplicate_children_into_existing_node(struct ptree_t* target,
     										const struct ptree_t* source)
 {
-    struct bsthv_t temp;
+    struct string_map_t temp;
 
     assert(target);
     assert(source);
 
     /*
      * In order to avoid circular copying, store all copied children in a
-     * temporary bsthv before inserting them into the actual target tree.
+     * temporary map before inserting them into the actual target tree.
      */
-    bsthv_init(&temp);
-    BSTHV_FOR_EACH(&source->children, struct ptree_t, key, node)
+    string_map_init(&temp);
+    STRING_MAP_FOR_EACH(&source->children, struct ptree_t, key, node)
 
     	/* try to duplicate node and insert into temp map */
-    	struct ptree_t* duplicate = ptree_duplicate_tree(node);
+    	struct ptree_t* duplicate = ptree_duplicate_tree_with_allocator(
+    		node, string_map_allocator(&target->children));
     	if(!duplicate)
     	{
     		/* destroy temp nodes and clean up */
-    		BSTHV_FOR_EACH(&temp, struct ptree_t, k, dirty_node)
+    		STRING_MAP_FOR_EACH(&temp, struct ptree_t, k, dirty_node)
     			ptree_destroy(dirty_node);
-    		BSTHV_END_EACH
-    		bsthv_clear_free(&temp);
+    		STRING_MAP_END_EACH
+    		string_map_clear_free(&temp);
     		return 0;
     	}
-    	if(!bsthv_insert(&temp, key, duplicate))
+    	if(!string_map_insert(&temp, key, duplicate))
     	{
     		/* destroy temp nodes and clean up */
     		ptree_destroy(duplicate);
-    		BSTHV_FOR_EACH(&temp, struct ptree_t, h, dirty_node)
+    		STRING_MAP_FOR_EACH(&temp, struct ptree_t, h, dirty_node)
     			ptree_destroy(dirty_node);
-    		BSTHV_END_EACH
-    		bsthv_clear_free(&temp);
+    		STRING_MAP_END_EACH
+    		string_map_clear_free(&temp);
     		return 0;
     	}
-    BSTHV_END_EACH
+    STRING_MAP_END_EACH
 
     /*
      * Free to insert children of temp tree into target node. No need to check
      * for cycles, they aren't possible.
      */
-    BSTHV_FOR_EACH(&temp, struct ptree_t, key, node)
-    	node->parent = target;
-
+    STRING_MAP_FOR_EACH(&temp, struct ptree_t, key, node)
     	/*
     	 * If we encounter a duplicate key, revert all insertions.
     	 */
-    	if(!bsthv_insert(&target->children, key, node))
+    	if(!ptree_link_child(target, key, node))
     	{
-    		BSTHV_FOR_EACH(&temp, struct ptree_t, k, dirty_node)
+    		STRING_MAP_FOR_EACH(&temp, struct ptree_t, k, dirty_node)
     			if(node == dirty_node)
     				goto break_erase_temp_for_each;
-    			/* if this assert fails, something seriously went wrong */
-    			assert(dirty_node == bsthv_erase(&target->children, k));
-    		BSTHV_END_EACH
+    			ptree_unlink_child(dirty_node);
+    		STRING_MAP_END_EACH
     		break_erase_temp_for_each:
 
     		/* destroy temp nodes and clean up */
-    		BSTHV_FOR_EACH(&temp, struct ptree_t, h, dirty_node)
+    		STRING_MAP_FOR_EACH(&temp, struct ptree_t, h, dirty_node)
     			ptree_destroy(dirty_node);
-    		BSTHV_END_EACH
-    		bsthv_clear_free(&temp);
+    		STRING_MAP_END_EACH
+    		string_map_clear_free(&temp);
     		return 0;
     	}
-    BSTHV_END_EACH
+    STRING_MAP_END_EACH
 
-    bsthv_clear_free(&temp);
+    string_map_clear_free(&temp);
 
     return 1;
 }
@@ -437,16 +515,24 @@ ptree_duplicate_children_into_existing_node(struct ptree_t* target,
 struct ptree_t*
 ptree_duplicate_tree(const struct ptree_t* source_node)
 {
-    struct ptree_t* new_root;
-
     assert(source_node);
+    return ptree_duplicate_tree_with_allocator(source_node,
+    										   string_map_allocator(&source_node->children));
+}
+
+/* ------------------------------------------------------------------------- */
+static struct ptree_t*
+ptree_duplicate_tree_with_allocator(const struct ptree_t* source_node,
+    								const struct allocator_t* allocator)
+{
+    struct ptree_t* new_root;
 
     /*
      * Create a new root, into which source_node is copied.
      * Note that the value is being set to NULL, but will be overwritten
      * in ptree_duplicate_children_into_existing_node().
      */
-    new_root = ptree_create(NULL);
+    new_root = ptree_create_with_allocator(NULL, allocator);
     if(!new_root)
     	return NULL;
 
@@ -467,47 +553,42 @@ ptree_get_node_no_depth(const struct ptree_t* tree, const char* key)
 {
     assert(tree);
     assert(key);
-    return bsthv_find(&tree->children, key);
+    return string_map_find(&tree->children, key);
 }
 
 /* ------------------------------------------------------------------------- */
-static struct ptree_t*
-ptree_get_node_recurse(const struct ptree_t* tree, char** saveptr)
-{
-    /*
-     * Get next token, hash, and search in current node. If the tree is NULL
-     * or if there are no more tokens, then we've found the node we're looking
-     * for.
-     */
-    char* token;
-    if((token = strtok_r_portable(NULL, ptree_node_delim, saveptr)) && tree)
-    {
-    	struct ptree_t* child;
-    	child = bsthv_find(&tree->children, token);
-    	return ptree_get_node_recurse(child, saveptr);
-    } else
-    	return (struct ptree_t*)tree;
-}
-
+/*
+ * Walks the path one segment at a time. Each segment is hashed in place, so
+ * unlike ptree_set() this doesn't have to copy and tokenise the key.
+ */
 struct ptree_t*
 ptree_get_node(const struct ptree_t* tree, const char* key)
 {
-    struct ptree_t* result;
-    char* saveptr;
-    char* key_iter;
+    struct string_map_key_t segment;
+    const char* end;
 
     assert(tree);
     assert(key);
 
-    /* prepare key for tokenisation */
-    key_iter = cat_strings(2, "n.", key); /* root key name is ignored, but must exist */
-    if(!key_iter)
-    	return NULL;
-    strtok_r_portable(key_iter, ptree_node_delim, &saveptr);
+    while(tree)
+    {
+    	uint32_t len;
+    	end = strchr(key, ptree_node_delim);
+    	len = end ? (uint32_t)(end - key) : (uint32_t)strlen(key);
+
+    	/* an empty segment ends the path */
+    	if(len == 0)
+    		break;
+
+    	string_map_key_init_n(&segment, key, len);
+    	tree = string_map_find_hashed(&tree->children, &segment);
+
+    	if(!end)
+    		break;
+    	key = end + 1;
+    }
 
-    result = ptree_get_node_recurse(tree, &saveptr);
-    free_string(key_iter);
-    return result;
+    return (struct ptree_t*)tree;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -517,10 +598,10 @@ ptree_node_is_child_of(const struct ptree_t* node,
 {
     assert(tree);
 
-    BSTHV_FOR_EACH(&tree->children, struct ptree_t, key, n)
+    STRING_MAP_FOR_EACH(&tree->children, struct ptree_t, key, n)
     	if(n == node || ptree_node_is_child_of(node, n))
     		return 1;
-    BSTHV_END_EACH
+    STRING_MAP_END_EACH
 
     return 0;
 }
@@ -542,9 +623,9 @@ ptree_print_impl(const struct ptree_t* tree, uint32_t depth)
     printf("key: \"%s\", val: %s\n", ptree_get_node_key(tree), value);
 
     /* print children */
-    BSTHV_FOR_EACH(&tree->children, struct ptree_t, key, child)
+    STRING_MAP_FOR_EACH(&tree->children, struct ptree_t, key, child)
     	ptree_print_impl(child, depth+1);
-    BSTHV_END_EACH
+    STRING_MAP_END_EACH
 }
 
 void
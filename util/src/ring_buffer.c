@@ -1,8 +1,102 @@
 #include "util/ring_buffer.h"
+#include "util/atomic.h"
 #include "util/memory.h"
+#include <string.h>
 #include <assert.h>
 
+/* these are only configurable when multithreading is enabled */
+#ifndef RING_BUFFER_FIXED_SIZE
+#   define RING_BUFFER_FIXED_SIZE 4096
+#endif
+#ifndef RING_BUFFER_MAX_SIZE
+#   define RING_BUFFER_MAX_SIZE 262144
+#endif
+
+/*
+ * Positions are free running and only masked when accessing an element, so
+ * tail - head is always the number of elements, even after wrapping around.
+ */
+struct ring_buffer_segment_t
+{
+    volatile uint32_t head;     /* next element to read, written by the consumer */
+    char head_pad[UTIL_CACHE_LINE_SIZE - sizeof(uint32_t)];
+    volatile uint32_t tail;     /* next element to write, written by the producer */
+    char tail_pad[UTIL_CACHE_LINE_SIZE - sizeof(uint32_t)];
+    /* set by the producer after its last write to this segment */
+    struct ring_buffer_segment_t* volatile next;
+    uint32_t mask;              /* capacity - 1 */
+    /* the elements follow */
+};
+
+#define SEGMENT_DATA(segment) ((unsigned char*)((segment) + 1))
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static uint32_t
+round_up_pow2(uint32_t x)
+{
+    uint32_t p = 1;
+    while(p < x)
+        p <<= 1;
+    return p;
+}
+
 /* ------------------------------------------------------------------------- */
+static struct ring_buffer_segment_t*
+segment_create(uint32_t capacity, uint32_t element_size)
+{
+    struct ring_buffer_segment_t* segment = (struct ring_buffer_segment_t*)
+        MALLOC(sizeof(struct ring_buffer_segment_t) + (uintptr_t)capacity * element_size,
+               "ring_buffer_segment_create()");
+    if(!segment)
+        return NULL;
+    segment->head = 0;
+    segment->tail = 0;
+    segment->next = NULL;
+    segment->mask = capacity - 1;
+    return segment;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Called by the consumer when the current read segment looks empty. If the
+ * producer has moved on to a newer segment and nothing is left in the old
+ * one, switches to the newer segment.
+ * Returns the number of elements available in the (possibly new) segment.
+ */
+static uint32_t
+ring_buffer_refresh_read(struct ring_buffer_t* rb)
+{
+    while(1)
+    {
+        struct ring_buffer_segment_t* segment = rb->read_segment;
+        struct ring_buffer_segment_t* next;
+        uint32_t head = segment->head;
+
+        rb->cached_tail = ATOMIC_LOAD_ACQUIRE(&segment->tail);
+        if(rb->cached_tail != head)
+            return rb->cached_tail - head;
+
+        if(!(next = ATOMIC_LOAD_ACQUIRE(&segment->next)))
+            return 0;
+
+        /*
+         * The producer wrote its last elements to this segment before
+         * publishing next, so now the tail is final.
+         */
+        rb->cached_tail = ATOMIC_LOAD_ACQUIRE(&segment->tail);
+        if(rb->cached_tail != head)
+            return rb->cached_tail - head;
+
+        rb->read_segment = next;
+        FREE(segment);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
 struct ring_buffer_t*
 ring_buffer_create(uint32_t element_size)
 {
@@ -12,18 +106,51 @@ ring_buffer_create(uint32_t element_size)
     if((rb = (struct ring_buffer_t*)MALLOC(sizeof *rb, "ring_buffer_create()")) == NULL)
         return NULL;
 
-    ring_buffer_init(rb, element_size);
+    if(!ring_buffer_init(rb, element_size))
+    {
+        FREE(rb);
+        return NULL;
+    }
 
     return rb;
 }
 
 /* ------------------------------------------------------------------------- */
-void
+char
 ring_buffer_init(struct ring_buffer_t* rb, uint32_t element_size)
 {
-    unordered_vector_init(&rb->vector, element_size);
-    rb->read = 0;
-    rb->write = 1;
+    assert(element_size > 0);
+    return ring_buffer_init_with_capacity(rb, element_size, RING_BUFFER_FIXED_SIZE / element_size);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+ring_buffer_init_with_capacity(struct ring_buffer_t* rb,
+                               uint32_t element_size,
+                               uint32_t capacity)
+{
+    assert(rb);
+    assert(element_size > 0);
+    assert(capacity <= 0x80000000u);
+
+    capacity = round_up_pow2(capacity);
+    rb->element_size = element_size;
+    rb->max_capacity = capacity;
+#ifdef ENABLE_RING_BUFFER_REALLOC
+    while(rb->max_capacity <= 0x40000000u &&
+          (uintptr_t)rb->max_capacity * 2 * element_size <= RING_BUFFER_MAX_SIZE)
+        rb->max_capacity *= 2;
+#endif
+
+    if(!(rb->read_segment = segment_create(capacity, element_size)))
+        return 0;
+    rb->write_segment = rb->read_segment;
+    rb->cached_head = 0;
+    rb->cached_tail = 0;
+    rb->read_count = 0;
+    rb->write_count = 0;
+
+    return 1;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -39,14 +166,243 @@ ring_buffer_destroy(struct ring_buffer_t* rb)
 void
 ring_buffer_clear(struct ring_buffer_t* rb)
 {
-    unordered_vector_clear(&rb->vector);
-    rb->read = 0;
-    rb->write = 1;
+    assert(rb);
+
+    while(rb->read_segment != rb->write_segment)
+    {
+        struct ring_buffer_segment_t* next = rb->read_segment->next;
+        FREE(rb->read_segment);
+        rb->read_segment = next;
+    }
+    rb->write_segment->head = 0;
+    rb->write_segment->tail = 0;
+    rb->cached_head = 0;
+    rb->cached_tail = 0;
+    rb->read_count = 0;
+    rb->write_count = 0;
 }
 
 /* ------------------------------------------------------------------------- */
 void
 ring_buffer_clear_free(struct ring_buffer_t* rb)
 {
-    unordered_vector_clear_free(&rb->vector);
+    assert(rb);
+
+    while(rb->read_segment)
+    {
+        struct ring_buffer_segment_t* next = rb->read_segment->next;
+        FREE(rb->read_segment);
+        rb->read_segment = next;
+    }
+    rb->write_segment = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+ring_buffer_count(const struct ring_buffer_t* rb)
+{
+    uint32_t read_count;
+
+    assert(rb);
+
+    /*
+     * The segments can't be walked here because the consumer frees drained
+     * ones. Instead each side publishes how many elements it has handled.
+     * Both only ever increase, so loading the read count first guarantees
+     * the write count isn't older than it.
+     */
+    read_count = ATOMIC_LOAD_ACQUIRE(&rb->read_count);
+    return ATOMIC_LOAD_ACQUIRE(&rb->write_count) - read_count;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+ring_buffer_reserve(struct ring_buffer_t* rb, uint32_t count, uint32_t* reserved)
+{
+    struct ring_buffer_segment_t* segment;
+    uint32_t tail, capacity, free_count, contiguous;
+
+    assert(rb);
+    assert(reserved);
+
+    segment = rb->write_segment;
+    tail = segment->tail;
+    capacity = segment->mask + 1;
+
+    free_count = capacity - (tail - rb->cached_head);
+    if(free_count < count)
+    {
+        rb->cached_head = ATOMIC_LOAD_ACQUIRE(&segment->head);
+        free_count = capacity - (tail - rb->cached_head);
+    }
+
+    if(free_count == 0)
+    {
+#ifdef ENABLE_RING_BUFFER_REALLOC
+        struct ring_buffer_segment_t* bigger;
+        if(capacity >= rb->max_capacity)
+            return NULL;
+        if(!(bigger = segment_create(capacity * 2, rb->element_size)))
+            return NULL;
+
+        /* the consumer switches over once it has drained the old segment */
+        ATOMIC_STORE_RELEASE(&segment->next, bigger);
+        rb->write_segment = segment = bigger;
+        rb->cached_head = 0;
+        tail = 0;
+        capacity *= 2;
+        free_count = capacity;
+#else
+        return NULL;
+#endif
+    }
+
+    contiguous = capacity - (tail & segment->mask);
+    if(free_count > contiguous)
+        free_count = contiguous;
+    *reserved = count < free_count ? count : free_count;
+    if(*reserved == 0)
+        return NULL;
+
+    return SEGMENT_DATA(segment) + (uintptr_t)(tail & segment->mask) * rb->element_size;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ring_buffer_commit(struct ring_buffer_t* rb, uint32_t count)
+{
+    struct ring_buffer_segment_t* segment;
+
+    assert(rb);
+
+    segment = rb->write_segment;
+    ATOMIC_STORE_RELEASE(&segment->tail, segment->tail + count);
+    ATOMIC_STORE_RELEASE(&rb->write_count, rb->write_count + count);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+ring_buffer_enqueue(struct ring_buffer_t* rb, const void* data)
+{
+    uint32_t reserved;
+    void* slot;
+
+    if(!(slot = ring_buffer_reserve(rb, 1, &reserved)))
+        return 0;
+    memcpy(slot, data, rb->element_size);
+    ring_buffer_commit(rb, 1);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+ring_buffer_enqueue_n(struct ring_buffer_t* rb, const void* data, uint32_t count)
+{
+    const unsigned char* src = (const unsigned char*)data;
+    uint32_t written = 0;
+
+    /* at most two rounds without growing, the second after wrapping around */
+    while(written != count)
+    {
+        uint32_t reserved;
+        void* slot;
+
+        if(!(slot = ring_buffer_reserve(rb, count - written, &reserved)))
+            break;
+        memcpy(slot, src, (uintptr_t)reserved * rb->element_size);
+        ring_buffer_commit(rb, reserved);
+        src += (uintptr_t)reserved * rb->element_size;
+        written += reserved;
+    }
+
+    return written;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+ring_buffer_peek_n(struct ring_buffer_t* rb, uint32_t count, uint32_t* available)
+{
+    struct ring_buffer_segment_t* segment;
+    uint32_t head, used, contiguous;
+
+    assert(rb);
+    assert(available);
+
+    segment = rb->read_segment;
+    head = segment->head;
+    used = rb->cached_tail - head;
+    if(used < count)
+    {
+        used = ring_buffer_refresh_read(rb);
+        segment = rb->read_segment;
+        head = segment->head;
+    }
+
+    contiguous = segment->mask + 1 - (head & segment->mask);
+    if(used > contiguous)
+        used = contiguous;
+    *available = count < used ? count : used;
+    if(*available == 0)
+        return NULL;
+
+    return SEGMENT_DATA(segment) + (uintptr_t)(head & segment->mask) * rb->element_size;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+ring_buffer_consume(struct ring_buffer_t* rb, uint32_t count)
+{
+    struct ring_buffer_segment_t* segment;
+
+    assert(rb);
+
+    segment = rb->read_segment;
+    assert(count <= rb->cached_tail - segment->head);
+    ATOMIC_STORE_RELEASE(&segment->head, segment->head + count);
+    ATOMIC_STORE_RELEASE(&rb->read_count, rb->read_count + count);
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+ring_buffer_peek(struct ring_buffer_t* rb)
+{
+    uint32_t available;
+    return ring_buffer_peek_n(rb, 1, &available);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+ring_buffer_dequeue(struct ring_buffer_t* rb, void* data)
+{
+    uint32_t available;
+    void* slot;
+
+    if(!(slot = ring_buffer_peek_n(rb, 1, &available)))
+        return 0;
+    memcpy(data, slot, rb->element_size);
+    ring_buffer_consume(rb, 1);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+ring_buffer_dequeue_n(struct ring_buffer_t* rb, void* data, uint32_t count)
+{
+    unsigned char* dst = (unsigned char*)data;
+    uint32_t read = 0;
+
+    while(read != count)
+    {
+        uint32_t available;
+        void* slot;
+
+        if(!(slot = ring_buffer_peek_n(rb, count - read, &available)))
+            break;
+        memcpy(dst, slot, (uintptr_t)available * rb->element_size);
+        ring_buffer_consume(rb, available);
+        dst += (uintptr_t)available * rb->element_size;
+        read += available;
+    }
+
+    return read;
 }
@@ -0,0 +1,239 @@
+#include "util/slot_map.h"
+#include "util/memory.h"
+#include <string.h>
+#include <assert.h>
+
+#define SLOT_MAP_INDEX_MASK (SLOT_MAP_MAX_SLOTS - 1)
+#define SLOT_MAP_GENERATION_MASK ((uint32_t)-1 >> SLOT_MAP_INDEX_BITS)
+#define SLOT_MAP_NO_FREE_SLOT ((uint32_t)-1)
+
+struct slot_map_slot_t
+{
+    uint32_t dense_index; /* where the element lives, or the next free slot */
+    uint32_t generation;  /* incremented every time the slot is freed */
+};
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static slot_map_handle_t
+slot_map_make_handle(uint32_t slot_index, uint32_t generation)
+{
+    return (generation << SLOT_MAP_INDEX_BITS) | slot_index;
+}
+
+/* ------------------------------------------------------------------------- */
+static struct slot_map_slot_t*
+slot_map_lookup_slot(const struct slot_map_t* map, slot_map_handle_t handle)
+{
+    struct slot_map_slot_t* slot;
+    uint32_t slot_index = handle & SLOT_MAP_INDEX_MASK;
+
+    if(slot_index >= map->slots.count)
+        return NULL;
+
+    slot = (struct slot_map_slot_t*)map->slots.data + slot_index;
+    if(slot->generation != (handle >> SLOT_MAP_INDEX_BITS))
+        return NULL;
+
+    return slot;
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct slot_map_t*
+slot_map_create(uint32_t element_size)
+{
+    struct slot_map_t* map;
+    if(!(map = (struct slot_map_t*)MALLOC(sizeof *map, "slot_map_create()")))
+        return NULL;
+    slot_map_init(map, element_size);
+    return map;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+slot_map_init(struct slot_map_t* map, uint32_t element_size)
+{
+    assert(map);
+    unordered_vector_init(&map->dense, element_size);
+    unordered_vector_init(&map->dense_to_slot, sizeof(uint32_t));
+    unordered_vector_init(&map->slots, sizeof(struct slot_map_slot_t));
+    map->free_head = SLOT_MAP_NO_FREE_SLOT;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+slot_map_destroy(struct slot_map_t* map)
+{
+    assert(map);
+    slot_map_clear_free(map);
+    FREE(map);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+slot_map_clear(struct slot_map_t* map)
+{
+    uint32_t i;
+
+    assert(map);
+
+    /* free every slot still in use so its handles become stale */
+    for(i = 0; i != map->dense_to_slot.count; ++i)
+    {
+        uint32_t slot_index = ((uint32_t*)map->dense_to_slot.data)[i];
+        struct slot_map_slot_t* slot = (struct slot_map_slot_t*)map->slots.data + slot_index;
+        slot->generation = (slot->generation + 1) & SLOT_MAP_GENERATION_MASK;
+        if(slot->generation == 0)
+            slot->generation = 1;
+        slot->dense_index = map->free_head;
+        map->free_head = slot_index;
+    }
+
+    unordered_vector_clear(&map->dense);
+    unordered_vector_clear(&map->dense_to_slot);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+slot_map_clear_free(struct slot_map_t* map)
+{
+    assert(map);
+    unordered_vector_clear_free(&map->dense);
+    unordered_vector_clear_free(&map->dense_to_slot);
+    unordered_vector_clear_free(&map->slots);
+    map->free_head = SLOT_MAP_NO_FREE_SLOT;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+slot_map_insert_emplace(struct slot_map_t* map, slot_map_handle_t* handle)
+{
+    struct slot_map_slot_t* slot;
+    uint32_t slot_index;
+    uint32_t* back_reference;
+    void* element;
+
+    assert(map);
+    assert(handle);
+
+    /* get a slot, either from the free list or by making a new one */
+    if(map->free_head != SLOT_MAP_NO_FREE_SLOT)
+    {
+        slot_index = map->free_head;
+        slot = (struct slot_map_slot_t*)map->slots.data + slot_index;
+    }
+    else
+    {
+        if(map->slots.count >= SLOT_MAP_MAX_SLOTS)
+            return NULL;
+        slot_index = map->slots.count;
+        if(!(slot = (struct slot_map_slot_t*)unordered_vector_push_emplace(&map->slots)))
+            return NULL;
+        slot->generation = 1;
+        /* park the new slot in the free list in case the next steps fail */
+        slot->dense_index = SLOT_MAP_NO_FREE_SLOT;
+        map->free_head = slot_index;
+    }
+
+    /* make space for the element and its back reference */
+    if(!(element = unordered_vector_push_emplace(&map->dense)))
+        return NULL;
+    if(!(back_reference = (uint32_t*)unordered_vector_push_emplace(&map->dense_to_slot)))
+    {
+        unordered_vector_pop(&map->dense);
+        return NULL;
+    }
+
+    /* nothing can fail any more, take the slot out of the free list */
+    map->free_head = slot->dense_index;
+    slot->dense_index = map->dense.count - 1;
+    *back_reference = slot_index;
+
+    *handle = slot_map_make_handle(slot_index, slot->generation);
+    return element;
+}
+
+/* ------------------------------------------------------------------------- */
+slot_map_handle_t
+slot_map_insert(struct slot_map_t* map, const void* data)
+{
+    slot_map_handle_t handle;
+    void* element;
+
+    assert(map);
+    assert(data);
+
+    if(!(element = slot_map_insert_emplace(map, &handle)))
+        return SLOT_MAP_INVALID_HANDLE;
+    memcpy(element, data, map->dense.element_size);
+    return handle;
+}
+
+/* ------------------------------------------------------------------------- */
+void*
+slot_map_get(const struct slot_map_t* map, slot_map_handle_t handle)
+{
+    struct slot_map_slot_t* slot;
+
+    assert(map);
+
+    if(!(slot = slot_map_lookup_slot(map, handle)))
+        return NULL;
+    return map->dense.data + slot->dense_index * map->dense.element_size;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+slot_map_erase(struct slot_map_t* map, slot_map_handle_t handle)
+{
+    struct slot_map_slot_t* slot;
+    uint32_t dense_index;
+    uint32_t last_index;
+
+    assert(map);
+
+    if(!(slot = slot_map_lookup_slot(map, handle)))
+        return 0;
+
+    /*
+     * The last element is moved into the gap, so the slot referring to it
+     * must be updated.
+     */
+    dense_index = slot->dense_index;
+    last_index = map->dense.count - 1;
+    if(dense_index != last_index)
+    {
+        uint32_t moved_slot = ((uint32_t*)map->dense_to_slot.data)[last_index];
+        ((struct slot_map_slot_t*)map->slots.data)[moved_slot].dense_index = dense_index;
+    }
+    unordered_vector_erase_index(&map->dense, dense_index);
+    unordered_vector_erase_index(&map->dense_to_slot, dense_index);
+
+    /* invalidate all handles to this slot and put it into the free list */
+    slot->generation = (slot->generation + 1) & SLOT_MAP_GENERATION_MASK;
+    if(slot->generation == 0)
+        slot->generation = 1;
+    slot->dense_index = map->free_head;
+    map->free_head = handle & SLOT_MAP_INDEX_MASK;
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+slot_map_handle_t
+slot_map_get_handle(const struct slot_map_t* map, uint32_t dense_index)
+{
+    uint32_t slot_index;
+
+    assert(map);
+
+    if(dense_index >= map->dense_to_slot.count)
+        return SLOT_MAP_INVALID_HANDLE;
+
+    slot_index = ((uint32_t*)map->dense_to_slot.data)[dense_index];
+    return slot_map_make_handle(slot_index,
+        ((struct slot_map_slot_t*)map->slots.data)[slot_index].generation);
+}
@@ -0,0 +1,190 @@
+#include "util/soa_vector.h"
+#include "util/allocator.h"
+#include "util/memory.h"
+#include <string.h>
+#include <assert.h>
+
+#define SOA_VECTOR_ALIGN(x) (((x) + (SOA_VECTOR_ALIGNMENT - 1)) & ~((uintptr_t)SOA_VECTOR_ALIGNMENT - 1))
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static uintptr_t
+soa_vector_block_size(const struct soa_vector_t* vector, uint32_t capacity)
+{
+    uint32_t i;
+    /* extra space so the first column can be aligned */
+    uintptr_t size = SOA_VECTOR_ALIGNMENT - 1;
+    for(i = 0; i != vector->column_count; ++i)
+        size += SOA_VECTOR_ALIGN((uintptr_t)vector->element_sizes[i] * capacity);
+    return size;
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+soa_vector_resize(struct soa_vector_t* vector, uint32_t new_capacity)
+{
+    void* new_block;
+    unsigned char* column;
+    uint32_t i;
+
+    assert(new_capacity >= vector->count);
+
+    /*
+     * All columns move at once, so there is no point trying to realloc()
+     * the block. Allocate a new one and copy each column into it.
+     */
+    new_block = ALLOCATOR_MALLOC(vector->allocator,
+                                 soa_vector_block_size(vector, new_capacity),
+                                 "soa_vector_resize()");
+    if(!new_block)
+        return 0;
+
+    column = (unsigned char*)SOA_VECTOR_ALIGN((uintptr_t)new_block);
+    for(i = 0; i != vector->column_count; ++i)
+    {
+        if(vector->count)
+            memcpy(column, vector->columns[i], vector->element_sizes[i] * vector->count);
+        vector->columns[i] = column;
+        column += SOA_VECTOR_ALIGN((uintptr_t)vector->element_sizes[i] * new_capacity);
+    }
+
+    if(vector->block)
+        ALLOCATOR_FREE(vector->allocator, vector->block);
+    vector->block = new_block;
+    vector->capacity = new_capacity;
+
+    return 1;
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct soa_vector_t*
+soa_vector_create(uint32_t column_count, const uint32_t* element_sizes)
+{
+    struct soa_vector_t* vector;
+    if(!(vector = (struct soa_vector_t*)MALLOC(sizeof *vector, "soa_vector_create()")))
+        return NULL;
+    soa_vector_init(vector, column_count, element_sizes);
+    return vector;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+soa_vector_init(struct soa_vector_t* vector,
+                uint32_t column_count,
+                const uint32_t* element_sizes)
+{
+    soa_vector_init_with_allocator(vector, column_count, element_sizes, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+soa_vector_init_with_allocator(struct soa_vector_t* vector,
+                               uint32_t column_count,
+                               const uint32_t* element_sizes,
+                               const struct allocator_t* allocator)
+{
+    uint32_t i;
+
+    assert(vector);
+    assert(element_sizes);
+    assert(column_count > 0 && column_count <= SOA_VECTOR_MAX_COLUMNS);
+
+    memset(vector, 0, sizeof *vector);
+    vector->column_count = column_count;
+    vector->allocator = allocator;
+    for(i = 0; i != column_count; ++i)
+    {
+        assert(element_sizes[i]);
+        vector->element_sizes[i] = element_sizes[i];
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+void
+soa_vector_destroy(struct soa_vector_t* vector)
+{
+    assert(vector);
+    soa_vector_clear_free(vector);
+    FREE(vector);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+soa_vector_clear(struct soa_vector_t* vector)
+{
+    assert(vector);
+    vector->count = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+soa_vector_clear_free(struct soa_vector_t* vector)
+{
+    uint32_t i;
+
+    assert(vector);
+
+    if(vector->block)
+        ALLOCATOR_FREE(vector->allocator, vector->block);
+    vector->block = NULL;
+    for(i = 0; i != vector->column_count; ++i)
+        vector->columns[i] = NULL;
+    vector->count = 0;
+    vector->capacity = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+soa_vector_reserve(struct soa_vector_t* vector, uint32_t count)
+{
+    assert(vector);
+
+    if(count <= vector->capacity)
+        return 1;
+    return soa_vector_resize(vector, count);
+}
+
+/* ------------------------------------------------------------------------- */
+char
+soa_vector_push_emplace(struct soa_vector_t* vector)
+{
+    assert(vector);
+
+    if(vector->count == vector->capacity)
+    {
+        uint32_t new_capacity = (uint32_t)(vector->capacity * SOA_VECTOR_DEFAULT_GROWTH_FACTOR);
+        if(new_capacity <= vector->capacity)
+            new_capacity = vector->capacity + 1;
+        if(!soa_vector_resize(vector, new_capacity))
+            return 0;
+    }
+
+    ++vector->count;
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+soa_vector_erase_index(struct soa_vector_t* vector, uint32_t index)
+{
+    uint32_t i;
+
+    assert(vector);
+
+    if(index >= vector->count)
+        return;
+
+    --vector->count;
+    if(index == vector->count)
+        return;
+
+    for(i = 0; i != vector->column_count; ++i)
+    {
+        uint32_t size = vector->element_sizes[i];
+        unsigned char* column = (unsigned char*)vector->columns[i];
+        memcpy(column + index * size, column + vector->count * size, size);
+    }
+}
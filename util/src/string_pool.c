@@ -0,0 +1,171 @@
+#include "util/string_pool.h"
+#include "util/hash.h"
+#include "util/memory.h"
+#include <string.h>
+#include <assert.h>
+
+/* size of the arena blocks holding the strings */
+#define STRING_POOL_BLOCK_SIZE 1024
+#define STRING_POOL_MIN_CAPACITY 16
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static struct string_pool_slot_t*
+string_pool_find_slot(const struct string_pool_t* pool,
+                      const char* str,
+                      uint32_t len,
+                      uint32_t hash)
+{
+    uint32_t mask = pool->capacity - 1;
+    uint32_t i = hash & mask;
+
+    /* the table is never more than half full, so this always terminates */
+    while(1)
+    {
+        struct string_pool_slot_t* slot = &pool->slots[i];
+        if(slot->str == NULL)
+            return slot;
+        if(slot->hash == hash && slot->len == len && memcmp(slot->str, str, len) == 0)
+            return slot;
+        i = (i + 1) & mask;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+string_pool_grow(struct string_pool_t* pool)
+{
+    struct string_pool_slot_t* old_slots = pool->slots;
+    uint32_t old_capacity = pool->capacity;
+    uint32_t new_capacity = old_capacity ? old_capacity * 2 : STRING_POOL_MIN_CAPACITY;
+    uint32_t i;
+
+    struct string_pool_slot_t* new_slots = (struct string_pool_slot_t*)
+        MALLOC(sizeof(struct string_pool_slot_t) * new_capacity, "string_pool_grow()");
+    if(!new_slots)
+        return 0;
+    memset(new_slots, 0, sizeof(struct string_pool_slot_t) * new_capacity);
+
+    pool->slots = new_slots;
+    pool->capacity = new_capacity;
+    for(i = 0; i != old_capacity; ++i)
+    {
+        if(old_slots[i].str == NULL)
+            continue;
+        *string_pool_find_slot(pool, old_slots[i].str, old_slots[i].len, old_slots[i].hash) = old_slots[i];
+    }
+
+    if(old_slots)
+        FREE(old_slots);
+    return 1;
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct string_pool_t*
+string_pool_create(void)
+{
+    struct string_pool_t* pool;
+    if(!(pool = (struct string_pool_t*)MALLOC(sizeof *pool, "string_pool_create()")))
+        return NULL;
+    string_pool_init(pool);
+    return pool;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+string_pool_init(struct string_pool_t* pool)
+{
+    assert(pool);
+    arena_init(&pool->arena, STRING_POOL_BLOCK_SIZE);
+    pool->slots = NULL;
+    pool->capacity = 0;
+    pool->count = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+string_pool_destroy(struct string_pool_t* pool)
+{
+    assert(pool);
+    string_pool_clear_free(pool);
+    FREE(pool);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+string_pool_clear(struct string_pool_t* pool)
+{
+    assert(pool);
+    arena_clear(&pool->arena);
+    if(pool->slots)
+        memset(pool->slots, 0, sizeof(struct string_pool_slot_t) * pool->capacity);
+    pool->count = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+string_pool_clear_free(struct string_pool_t* pool)
+{
+    assert(pool);
+    arena_clear_free(&pool->arena);
+    if(pool->slots)
+        FREE(pool->slots);
+    pool->slots = NULL;
+    pool->capacity = 0;
+    pool->count = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+const char*
+string_pool_intern(struct string_pool_t* pool, const char* str)
+{
+    assert(str);
+    return string_pool_intern_n(pool, str, (uint32_t)strlen(str));
+}
+
+/* ------------------------------------------------------------------------- */
+const char*
+string_pool_intern_n(struct string_pool_t* pool, const char* str, uint32_t len)
+{
+    struct string_pool_slot_t* slot;
+    uint32_t hash;
+    char* copy;
+
+    assert(pool);
+    assert(str);
+
+    if((pool->count + 1) * 2 > pool->capacity)
+        if(!string_pool_grow(pool))
+            return NULL;
+
+    hash = (uint32_t)hash_wyhash64(str, len, 0);
+    slot = string_pool_find_slot(pool, str, len, hash);
+    if(slot->str)
+        return slot->str;
+
+    if(!(copy = (char*)arena_alloc_unaligned(&pool->arena, len + 1)))
+        return NULL;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    slot->str = copy;
+    slot->hash = hash;
+    slot->len = len;
+    ++pool->count;
+    return copy;
+}
+
+/* ------------------------------------------------------------------------- */
+const char*
+string_pool_find_n(const struct string_pool_t* pool, const char* str, uint32_t len)
+{
+    assert(pool);
+    assert(str);
+
+    if(pool->count == 0)
+        return NULL;
+    return string_pool_find_slot(pool, str, len, (uint32_t)hash_wyhash64(str, len, 0))->str;
+}
@@ -0,0 +1,572 @@
+#include "util/thread_pool.h"
+
+#ifdef ENABLE_THREAD_POOL
+
+#include "util/atomic.h"
+#include "util/macros.h"
+#include "util/memory.h"
+#include "util/mpmc_queue.h"
+#include "util/thread.h"
+#include <string.h>
+#include <assert.h>
+
+/* number of jobs each worker's deque can hold, must be a power of two */
+#define DEQUE_CAPACITY 4096
+/* number of jobs waiting to be picked up from outside the pool */
+#define INJECTOR_CAPACITY 1024
+/* how many rounds an idle worker looks for work before going to sleep */
+#define IDLE_SPIN_COUNT 64
+
+struct parallel_for_t
+{
+    thread_pool_range_func func;
+    void* arg;
+    uint32_t grain;
+};
+
+/*
+ * A job is either a plain function call (func != NULL) or a piece of a
+ * parallel_for() (range != NULL).
+ */
+struct job_t
+{
+    thread_pool_func func;
+    void* arg;
+    struct parallel_for_t* range;
+    uint32_t begin;
+    uint32_t end;
+    struct thread_pool_counter_t* counter;
+};
+
+/*
+ * Chase-Lev deque. The owning worker pushes and pops at the bottom, any
+ * other thread steals from the top. Positions are free running and masked
+ * on access.
+ *
+ * A thief copies a job out before claiming it with a CAS on top. If the CAS
+ * fails the copy may be torn by the owner reusing the slot, but it is then
+ * discarded without being looked at.
+ */
+struct worker_t
+{
+    volatile uint32_t top;
+    char top_pad[UTIL_CACHE_LINE_SIZE - sizeof(uint32_t)];
+    volatile uint32_t bottom;
+    char bottom_pad[UTIL_CACHE_LINE_SIZE - sizeof(uint32_t)];
+    struct job_t jobs[DEQUE_CAPACITY];
+    struct thread_pool_t* pool;
+    struct thread_t* thread;
+    uint32_t rand_state;
+};
+
+struct thread_pool_t
+{
+    struct worker_t* workers;
+    uint32_t worker_count;
+    struct mpmc_queue_t injector;
+    struct mutex_t* mutex;
+    struct cond_t* wake;
+    volatile uint32_t sleepers;
+    volatile uint32_t shutdown;
+};
+
+/* the worker the calling thread is, or NULL if it isn't one */
+static UTIL_THREAD_LOCAL struct worker_t* g_current_worker;
+
+/* ----------------------------------------------------------------------------
+ * Static functions
+ * ------------------------------------------------------------------------- */
+static char
+deque_push(struct worker_t* worker, const struct job_t* job)
+{
+    uint32_t bottom = ATOMIC_LOAD_RELAXED(&worker->bottom);
+    uint32_t top = ATOMIC_LOAD_ACQUIRE(&worker->top);
+    if(bottom - top >= DEQUE_CAPACITY)
+        return 0;
+    worker->jobs[bottom & (DEQUE_CAPACITY - 1)] = *job;
+    ATOMIC_STORE_RELEASE(&worker->bottom, bottom + 1);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+deque_pop(struct worker_t* worker, struct job_t* job)
+{
+    uint32_t bottom = ATOMIC_LOAD_RELAXED(&worker->bottom) - 1;
+    uint32_t top;
+    char result = 1;
+
+    /* claim the bottom slot before looking at what thieves are doing */
+    ATOMIC_STORE_RELAXED(&worker->bottom, bottom);
+    ATOMIC_FENCE();
+    top = ATOMIC_LOAD_RELAXED(&worker->top);
+
+    if((int32_t)(bottom - top) < 0)
+    {
+        /* empty */
+        ATOMIC_STORE_RELAXED(&worker->bottom, bottom + 1);
+        return 0;
+    }
+
+    *job = worker->jobs[bottom & (DEQUE_CAPACITY - 1)];
+    if(bottom != top)
+        return 1;
+
+    /* last job, race the thieves for it */
+    if(!ATOMIC_CAS(&worker->top, top, top + 1))
+        result = 0;
+    ATOMIC_STORE_RELAXED(&worker->bottom, bottom + 1);
+    return result;
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+deque_steal(struct worker_t* worker, struct job_t* job)
+{
+    uint32_t top = ATOMIC_LOAD_ACQUIRE(&worker->top);
+    uint32_t bottom;
+
+    ATOMIC_FENCE();
+    bottom = ATOMIC_LOAD_ACQUIRE(&worker->bottom);
+    if((int32_t)(bottom - top) <= 0)
+        return 0;
+
+    *job = worker->jobs[top & (DEQUE_CAPACITY - 1)];
+    return ATOMIC_CAS(&worker->top, top, top + 1);
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+deque_is_empty(struct worker_t* worker)
+{
+    return (int32_t)(ATOMIC_LOAD_ACQUIRE(&worker->bottom) - ATOMIC_LOAD_ACQUIRE(&worker->top)) <= 0;
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+counter_lock(struct thread_pool_counter_t* counter)
+{
+    while(!ATOMIC_CAS(&counter->lock, 0, 1))
+        thread_yield();
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+counter_unlock(struct thread_pool_counter_t* counter)
+{
+    ATOMIC_STORE_RELEASE(&counter->lock, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+wake_sleeper(struct thread_pool_t* pool)
+{
+    /* see mpmc_queue.c for why the fence is needed */
+    ATOMIC_FENCE();
+    if(ATOMIC_LOAD_RELAXED(&pool->sleepers) == 0)
+        return;
+    mutex_lock(pool->mutex);
+    cond_signal(pool->wake);
+    mutex_unlock(pool->mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+static void run_job(struct thread_pool_t* pool, struct job_t* job);
+
+/* ------------------------------------------------------------------------- */
+/* submits a job whose counter has already been incremented */
+static void
+push_job(struct thread_pool_t* pool, struct job_t* job)
+{
+    struct worker_t* worker = g_current_worker;
+
+    if(worker && worker->pool == pool)
+    {
+        if(!deque_push(worker, job))
+        {
+            run_job(pool, job);
+            return;
+        }
+    }
+    else
+        mpmc_queue_enqueue(&pool->injector, job);
+
+    wake_sleeper(pool);
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+counter_finish(struct thread_pool_t* pool, struct thread_pool_counter_t* counter)
+{
+    while(1)
+    {
+        struct job_t then;
+        uint32_t pending = ATOMIC_LOAD_ACQUIRE(&counter->pending);
+
+        assert(pending > 0);
+        if(pending != 1)
+        {
+            if(ATOMIC_CAS(&counter->pending, pending, pending - 1))
+                return;
+            continue;
+        }
+
+        /*
+         * About to reach zero, so the continuation has to be taken. The lock
+         * keeps thread_pool_then() from registering one at the same time,
+         * and keeps thread_pool_wait() from returning until we are done with
+         * the counter.
+         */
+        counter_lock(counter);
+        if(!ATOMIC_CAS(&counter->pending, 1, 0))
+        {
+            /* someone submitted another job with this counter, try again */
+            counter_unlock(counter);
+            continue;
+        }
+        then.func = counter->then_func;
+        then.arg = counter->then_arg;
+        then.range = NULL;
+        then.counter = counter->then_counter;
+        counter->then_func = NULL;
+        counter_unlock(counter);
+
+        if(then.func)
+            push_job(pool, &then);
+        return;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+run_job(struct thread_pool_t* pool, struct job_t* job)
+{
+    if(job->range)
+    {
+        /* keep the left half, give the right half to whoever wants it */
+        while(job->end - job->begin > job->range->grain)
+        {
+            struct job_t right = *job;
+            right.begin = job->begin + (job->end - job->begin) / 2;
+            job->end = right.begin;
+            ATOMIC_FETCH_ADD(&job->counter->pending, 1);
+            push_job(pool, &right);
+        }
+        job->range->func(job->range->arg, job->begin, job->end);
+    }
+    else
+        job->func(job->arg);
+
+    if(job->counter)
+        counter_finish(pool, job->counter);
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+find_job(struct thread_pool_t* pool, struct worker_t* self, struct job_t* job)
+{
+    uint32_t i, start;
+
+    if(self && deque_pop(self, job))
+        return 1;
+    if(mpmc_queue_try_dequeue(&pool->injector, job))
+        return 1;
+
+    /* start at a random victim so thieves don't all pick on the same one */
+    if(self)
+    {
+        self->rand_state ^= self->rand_state << 13;
+        self->rand_state ^= self->rand_state >> 17;
+        self->rand_state ^= self->rand_state << 5;
+        start = self->rand_state;
+    }
+    else
+        start = 0;
+
+    for(i = 0; i != pool->worker_count; ++i)
+    {
+        struct worker_t* victim = &pool->workers[(start + i) % pool->worker_count];
+        if(victim != self && deque_steal(victim, job))
+            return 1;
+    }
+
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+static char
+work_available(struct thread_pool_t* pool)
+{
+    uint32_t i;
+    if(mpmc_queue_count(&pool->injector))
+        return 1;
+    for(i = 0; i != pool->worker_count; ++i)
+        if(!deque_is_empty(&pool->workers[i]))
+            return 1;
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+static void
+worker_main(void* arg)
+{
+    struct worker_t* self = (struct worker_t*)arg;
+    struct thread_pool_t* pool = self->pool;
+    uint32_t idle = 0;
+
+    g_current_worker = self;
+
+    while(1)
+    {
+        struct job_t job;
+
+        if(find_job(pool, self, &job))
+        {
+            run_job(pool, &job);
+            idle = 0;
+            continue;
+        }
+
+        /* only stop once everything has been run */
+        if(ATOMIC_LOAD_ACQUIRE(&pool->shutdown))
+            break;
+
+        if(++idle < IDLE_SPIN_COUNT)
+        {
+            thread_yield();
+            continue;
+        }
+
+        mutex_lock(pool->mutex);
+        ATOMIC_FETCH_ADD(&pool->sleepers, 1);
+        if(!work_available(pool) && !pool->shutdown)
+            cond_wait(pool->wake, pool->mutex);
+        ATOMIC_FETCH_ADD(&pool->sleepers, (uint32_t)-1);
+        mutex_unlock(pool->mutex);
+        idle = 0;
+    }
+
+    g_current_worker = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Workers exit once they find no more work. A job still running can only
+ * push to its own worker's deque, which that worker empties before it looks
+ * at the flag again.
+ */
+static void
+stop_workers(struct thread_pool_t* pool, uint32_t started)
+{
+    uint32_t i;
+
+    mutex_lock(pool->mutex);
+    ATOMIC_STORE_RELEASE(&pool->shutdown, 1);
+    cond_broadcast(pool->wake);
+    mutex_unlock(pool->mutex);
+
+    for(i = 0; i != started; ++i)
+        thread_join(pool->workers[i].thread);
+}
+
+/* ----------------------------------------------------------------------------
+ * Exported functions
+ * ------------------------------------------------------------------------- */
+struct thread_pool_t*
+thread_pool_create(uint32_t worker_count)
+{
+    struct thread_pool_t* pool;
+    uint32_t i;
+
+    if(worker_count == 0)
+        worker_count = thread_cpu_count();
+
+    if(!(pool = (struct thread_pool_t*)MALLOC(sizeof *pool, "thread_pool_create()")))
+        goto alloc_pool_failed;
+    memset(pool, 0, sizeof *pool);
+
+    if(!(pool->workers = (struct worker_t*)MALLOC(sizeof(struct worker_t) * worker_count,
+                                                  "thread_pool_create()")))
+        goto alloc_workers_failed;
+    if(!mpmc_queue_init(&pool->injector, sizeof(struct job_t), INJECTOR_CAPACITY))
+        goto init_injector_failed;
+    if(!(pool->mutex = mutex_create()))
+        goto create_mutex_failed;
+    if(!(pool->wake = cond_create()))
+        goto create_cond_failed;
+
+    pool->worker_count = worker_count;
+    for(i = 0; i != worker_count; ++i)
+    {
+        struct worker_t* worker = &pool->workers[i];
+        worker->top = 0;
+        worker->bottom = 0;
+        worker->pool = pool;
+        worker->rand_state = 2463534242u + i * 7919u;
+    }
+
+    for(i = 0; i != worker_count; ++i)
+        if(!(pool->workers[i].thread = thread_create(worker_main, &pool->workers[i])))
+            goto start_workers_failed;
+
+    return pool;
+
+    start_workers_failed     : stop_workers(pool, i);
+                               cond_destroy(pool->wake);
+    create_cond_failed       : mutex_destroy(pool->mutex);
+    create_mutex_failed      : mpmc_queue_clear_free(&pool->injector);
+    init_injector_failed     : FREE(pool->workers);
+    alloc_workers_failed     : FREE(pool);
+    alloc_pool_failed        : return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_pool_destroy(struct thread_pool_t* pool)
+{
+    assert(pool);
+    assert(g_current_worker == NULL || g_current_worker->pool != pool);
+
+    stop_workers(pool, pool->worker_count);
+    cond_destroy(pool->wake);
+    mutex_destroy(pool->mutex);
+    mpmc_queue_clear_free(&pool->injector);
+    FREE(pool->workers);
+    FREE(pool);
+}
+
+/* ------------------------------------------------------------------------- */
+uint32_t
+thread_pool_worker_count(const struct thread_pool_t* pool)
+{
+    assert(pool);
+    return pool->worker_count;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_pool_counter_init(struct thread_pool_counter_t* counter)
+{
+    assert(counter);
+    memset(counter, 0, sizeof *counter);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_pool_submit(struct thread_pool_t* pool,
+                   thread_pool_func func,
+                   void* arg,
+                   struct thread_pool_counter_t* counter)
+{
+    struct job_t job;
+
+    assert(pool);
+    assert(func);
+
+    job.func = func;
+    job.arg = arg;
+    job.range = NULL;
+    job.counter = counter;
+    if(counter)
+        ATOMIC_FETCH_ADD(&counter->pending, 1);
+
+    push_job(pool, &job);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_pool_then(struct thread_pool_t* pool,
+                 struct thread_pool_counter_t* counter,
+                 thread_pool_func func,
+                 void* arg,
+                 struct thread_pool_counter_t* then_counter)
+{
+    struct job_t job;
+
+    assert(pool);
+    assert(counter);
+    assert(func);
+
+    if(then_counter)
+        ATOMIC_FETCH_ADD(&then_counter->pending, 1);
+
+    counter_lock(counter);
+    if(ATOMIC_LOAD_ACQUIRE(&counter->pending) != 0)
+    {
+        assert(counter->then_func == NULL);
+        counter->then_func = func;
+        counter->then_arg = arg;
+        counter->then_counter = then_counter;
+        counter_unlock(counter);
+        return;
+    }
+    counter_unlock(counter);
+
+    job.func = func;
+    job.arg = arg;
+    job.range = NULL;
+    job.counter = then_counter;
+    push_job(pool, &job);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_pool_wait(struct thread_pool_t* pool, struct thread_pool_counter_t* counter)
+{
+    struct worker_t* self = g_current_worker;
+
+    assert(pool);
+    assert(counter);
+
+    if(self && self->pool != pool)
+        self = NULL;
+
+    while(ATOMIC_LOAD_ACQUIRE(&counter->pending) != 0 || ATOMIC_LOAD_ACQUIRE(&counter->lock) != 0)
+    {
+        struct job_t job;
+        if(find_job(pool, self, &job))
+            run_job(pool, &job);
+        else
+            thread_yield();
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+void
+thread_pool_parallel_for(struct thread_pool_t* pool,
+                         uint32_t begin,
+                         uint32_t end,
+                         uint32_t grain,
+                         thread_pool_range_func func,
+                         void* arg)
+{
+    struct parallel_for_t range;
+    struct thread_pool_counter_t counter;
+    struct job_t job;
+
+    assert(pool);
+    assert(func);
+    assert(begin <= end);
+
+    if(begin == end)
+        return;
+
+    range.func = func;
+    range.arg = arg;
+    range.grain = grain ? grain : 1;
+    thread_pool_counter_init(&counter);
+
+    /* the calling thread splits and runs the first piece itself */
+    job.func = NULL;
+    job.arg = NULL;
+    job.range = &range;
+    job.begin = begin;
+    job.end = end;
+    job.counter = &counter;
+    counter.pending = 1;
+    run_job(pool, &job);
+
+    thread_pool_wait(pool, &counter);
+}
+
+#endif /* ENABLE_THREAD_POOL */
@@ -4,6 +4,7 @@
 #include <assert.h>
 #include "util/unordered_vector.h"
 #include "util/memory.h"
+#include "util/allocator.h"
 
 /* ----------------------------------------------------------------------------
  * Static functions
@@ -12,15 +13,20 @@
 /*!
  * @brief Expands the underlying memory.
  *
- * This implementation will expand the memory by a factor of 2 each time this
- * is called. All elements are copied into the new section of memory.
+ * This implementation will expand the memory by the vector's growth factor
+ * each time this is called. If the allocator supports it, the memory is
+ * resized with realloc() so large buffers can grow in place. Otherwise all
+ * elements are copied into a new section of memory.
  * @param [in] insertion_index Set to -1 if no space should be made for element
  * insertion. Otherwise this parameter specifies the index of the element to
  * "evade" when re-allocating all other elements.
+ * @param[in] target_size If set to 0, target size is calculated automatically.
+ * Otherwise the vector will expand to the specified target size.
  */
 static void*
 unordered_vector_expand(struct unordered_vector_t* vector,
-                        uint32_t insertion_index);
+                        uint32_t insertion_index,
+                        uint32_t target_size);
 
 /* ----------------------------------------------------------------------------
  * Exported functions
@@ -44,6 +50,45 @@ unordered_vector_init(struct unordered_vector_t* vector, const uint32_t element_
 
     memset(vector, 0, sizeof(struct unordered_vector_t));
     vector->element_size = element_size;
+    vector->growth_factor = UNORDERED_VECTOR_DEFAULT_GROWTH_FACTOR;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+unordered_vector_init_with_allocator(struct unordered_vector_t* vector,
+                                     const uint32_t element_size,
+                                     const struct allocator_t* allocator)
+{
+    unordered_vector_init(vector, element_size);
+    vector->allocator = allocator;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+unordered_vector_init_inline(struct unordered_vector_t* vector,
+                             const uint32_t element_size,
+                             void* buffer,
+                             uint32_t inline_capacity)
+{
+    unordered_vector_init_inline_with_allocator(vector, element_size, buffer, inline_capacity, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+void
+unordered_vector_init_inline_with_allocator(struct unordered_vector_t* vector,
+                                            const uint32_t element_size,
+                                            void* buffer,
+                                            uint32_t inline_capacity,
+                                            const struct allocator_t* allocator)
+{
+    assert(buffer);
+    assert(inline_capacity);
+
+    unordered_vector_init_with_allocator(vector, element_size, allocator);
+    vector->inline_data = (DATA_POINTER_TYPE*)buffer;
+    vector->inline_capacity = inline_capacity;
+    vector->data = vector->inline_data;
+    vector->capacity = inline_capacity;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -74,11 +119,84 @@ unordered_vector_clear_free(struct unordered_vector_t* vector)
 {
     assert(vector);
 
-    if(vector->data)
-        FREE(vector->data);
-    vector->data = NULL;
+    if(vector->data && vector->data != vector->inline_data)
+        ALLOCATOR_FREE(vector->allocator, vector->data);
+
+    /* falls back to inline storage, if any */
+    vector->data = vector->inline_data;
     vector->count = 0;
-    vector->capacity = 0;
+    vector->capacity = vector->inline_capacity;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+unordered_vector_reserve(struct unordered_vector_t* vector, uint32_t count)
+{
+    assert(vector);
+
+    if(count <= vector->capacity)
+        return 1;
+    return unordered_vector_expand(vector, -1, count) != NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+char
+unordered_vector_shrink_to_fit(struct unordered_vector_t* vector)
+{
+    DATA_POINTER_TYPE* new_data;
+
+    assert(vector);
+
+    if(vector->count == vector->capacity)
+        return 1;
+
+    if(vector->count == 0)
+    {
+        unordered_vector_clear_free(vector);
+        return 1;
+    }
+
+    /* inline storage can't shrink */
+    if(vector->data == vector->inline_data)
+        return 1;
+
+    /* move back into inline storage if the elements fit */
+    if(vector->count <= vector->inline_capacity)
+    {
+        memcpy(vector->inline_data, vector->data, vector->count * vector->element_size);
+        ALLOCATOR_FREE(vector->allocator, vector->data);
+        vector->data = vector->inline_data;
+        vector->capacity = vector->inline_capacity;
+        return 1;
+    }
+
+    if(ALLOCATOR_CAN_REALLOC(vector->allocator))
+    {
+        new_data = (DATA_POINTER_TYPE*)ALLOCATOR_REALLOC(vector->allocator, vector->data, vector->count * vector->element_size, "unordered_vector_shrink_to_fit()");
+        if(!new_data)
+            return 0;
+    }
+    else
+    {
+        new_data = (DATA_POINTER_TYPE*)ALLOCATOR_MALLOC(vector->allocator, vector->count * vector->element_size, "unordered_vector_shrink_to_fit()");
+        if(!new_data)
+            return 0;
+        memcpy(new_data, vector->data, vector->count * vector->element_size);
+        ALLOCATOR_FREE(vector->allocator, vector->data);
+    }
+
+    vector->data = new_data;
+    vector->capacity = vector->count;
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+void
+unordered_vector_set_growth_factor(struct unordered_vector_t* vector, float factor)
+{
+    assert(vector);
+    assert(factor > 1.0f);
+    vector->growth_factor = factor;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -92,7 +210,7 @@ unordered_vector_push_emplace(struct unordered_vector_t* vector)
 
     if(vector->count == vector->capacity)
     {
-        data = unordered_vector_expand(vector, -1);
+        data = unordered_vector_expand(vector, -1, 0);
         if(!data)
         {
             fprintf(stderr, "malloc() failed in unordered_vector_push_emplace() -- out of memory\n");
@@ -209,32 +327,72 @@ unordered_vector_get_element(struct unordered_vector_t* vector, uint32_t index)
  * ------------------------------------------------------------------------- */
 static void*
 unordered_vector_expand(struct unordered_vector_t* vector,
-                        uint32_t insertion_index)
+                        uint32_t insertion_index,
+                        uint32_t target_size)
 {
     uint32_t new_size;
+    float factor;
     DATA_POINTER_TYPE* old_data;
     DATA_POINTER_TYPE* new_data;
 
-    /* expand by factor 2 */
-    new_size = vector->capacity << 1;
+    /* expand by growth factor, or adopt target size if it is not 0 */
+    if(target_size)
+        new_size = target_size;
+    else
+    {
+        /* vectors that were zero-initialised instead of initialised with init() */
+        factor = vector->growth_factor;
+        if(factor <= 1.0f)
+            factor = UNORDERED_VECTOR_DEFAULT_GROWTH_FACTOR;
+        new_size = (uint32_t)(vector->capacity * factor);
+        /* small capacities multiplied by small factors may not grow at all */
+        if(new_size <= vector->capacity)
+            new_size = vector->capacity + 1;
+        if(new_size < 2)
+            new_size = 2;
+    }
 
     /*
-     * If vector hasn't allocated anything yet, allocate the first two elements
+     * If vector hasn't allocated anything yet, allocate the requested amount
      * and return
      */
-    if(new_size == 0)
+    if(!vector->data)
     {
-        new_size = 2;
-        vector->data = MALLOC(vector->element_size * new_size, "unordered_vector_expand()");
+        vector->data = ALLOCATOR_MALLOC(vector->allocator, vector->element_size * new_size, "unordered_vector_expand()");
         if(!vector->data)
             return NULL;
         vector->capacity = new_size;
         return vector->data;
     }
 
+    /*
+     * Resize in place if possible. The C library is free to extend the block
+     * or remap its pages instead of copying. Space for insertion is made
+     * afterwards by shifting the tail of the vector.
+     */
+    if(ALLOCATOR_CAN_REALLOC(vector->allocator) && vector->data != vector->inline_data)
+    {
+        new_data = (DATA_POINTER_TYPE*)ALLOCATOR_REALLOC(vector->allocator, vector->data, vector->element_size * new_size, "unordered_vector_expand()");
+        if(!new_data)
+            return NULL;
+
+        if(insertion_index != (uint32_t)-1 && insertion_index < vector->count)
+        {
+            uint32_t offset = vector->element_size * insertion_index;
+            uint32_t total_size = vector->element_size * vector->count;
+            memmove((void*)((intptr_t)new_data + offset + vector->element_size),
+                    (void*)((intptr_t)new_data + offset),
+                    total_size - offset);
+        }
+
+        vector->capacity = new_size;
+        vector->data = new_data;
+        return vector->data;
+    }
+
     /* prepare for reallocating data */
     old_data = vector->data;
-    new_data = (DATA_POINTER_TYPE*)MALLOC(vector->element_size * new_size, "unordered_vector_expand()");
+    new_data = (DATA_POINTER_TYPE*)ALLOCATOR_MALLOC(vector->allocator, vector->element_size * new_size, "unordered_vector_expand()");
     if(!new_data)
         return NULL;
 
@@ -256,7 +414,8 @@ unordered_vector_expand(struct unordered_vector_t* vector,
     }
     vector->capacity = new_size;
     vector->data = new_data;
-    FREE(old_data);
+    if(old_data != vector->inline_data)
+        ALLOCATOR_FREE(vector->allocator, old_data);
 
     return vector->data;
 }
@@ -1,17 +1,28 @@
 #include "yaml/yaml.h"
 #include "util/yaml.h"
-#include "util/linked_list.h"
+#include "util/intrusive_list.h"
 #include "util/memory.h"
 #include "util/string.h"
 #include "util/ptree.h"
 #include "util/unordered_vector.h"
 #include <assert.h>
+#include <stddef.h>
 
 #ifdef UTIL_PLATFORM_MACOSX
 #   include "util/platform/osx/fmemopen.h"
 #endif
 
-static struct list_t g_open_docs;
+/*
+ * Documents are allocated together with the link that keeps them in the list
+ * of open documents, so destroying one doesn't have to search the list.
+ */
+struct yaml_doc_t
+{
+    struct ptree_t tree;
+    struct ilist_link_t link;
+};
+
+static struct ilist_t g_open_docs;
 
 static char
 yaml_load_into_ptree(struct ptree_t* tree,
@@ -28,25 +39,28 @@ yaml_free_node_value_func(char* value);
 static void
 yaml_init_node(struct ptree_t* node);
 
+static struct ptree_t*
+yaml_doc_create(void);
+
 /* ------------------------------------------------------------------------- */
 void
 yaml_init(void)
 {
-    list_init(&g_open_docs);
+    ilist_init(&g_open_docs);
 }
 
 /* ------------------------------------------------------------------------- */
 void
 yaml_deinit(void)
 {
-    list_clear(&g_open_docs);
+    ilist_clear(&g_open_docs);
 }
 
 /* ------------------------------------------------------------------------- */
 struct ptree_t*
 yaml_create(void)
 {
-    return ptree_create(NULL);
+    return yaml_doc_create();
 }
 
 /* ------------------------------------------------------------------------- */
@@ -113,7 +127,7 @@ yaml_load_from_stream(FILE* stream)
     for(;;)
     {
     	/* parse file and load into tree */
-    	if(!(doc = ptree_create(NULL)))
+    	if(!(doc = yaml_doc_create()))
     		break;
     	yaml_init_node(doc);
     	if(!yaml_load_into_ptree(doc, doc, &parser, 0))
@@ -122,10 +136,6 @@ yaml_load_from_stream(FILE* stream)
     		break;
     	}
 
-    	/* add to open documents */
-    	if(!list_push(&g_open_docs, doc))
-    		break;
-
     	yaml_parser_delete(&parser);
 
     	return doc;
@@ -134,7 +144,7 @@ yaml_load_from_stream(FILE* stream)
     /* clean up */
     yaml_parser_delete(&parser);
     if(doc)
-    	ptree_destroy(doc);
+    	yaml_destroy(doc);
 
     return NULL;
 }
@@ -143,9 +153,14 @@ yaml_load_from_stream(FILE* stream)
 void
 yaml_destroy(struct ptree_t* doc)
 {
+    struct yaml_doc_t* yaml_doc;
+
     assert(doc);
-    ptree_destroy(doc);
-    list_erase_element(&g_open_docs, doc);
+
+    yaml_doc = (struct yaml_doc_t*)((char*)doc - offsetof(struct yaml_doc_t, tree));
+    ilist_erase(&g_open_docs, &yaml_doc->link);
+    ptree_destroy_keep_root(doc);
+    FREE(yaml_doc);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -200,6 +215,18 @@ yaml_set_value(struct ptree_t* doc, const char* key, const char* value)
     return node;
 }
 
+/* ------------------------------------------------------------------------- */
+static struct ptree_t*
+yaml_doc_create(void)
+{
+    struct yaml_doc_t* doc;
+    if(!(doc = (struct yaml_doc_t*)MALLOC(sizeof *doc, "yaml_doc_create()")))
+    	return NULL;
+    ptree_init(&doc->tree, NULL);
+    ilist_push_back(&g_open_docs, &doc->link);
+    return &doc->tree;
+}
+
 /* ------------------------------------------------------------------------- */
 static void
 yaml_init_node(struct ptree_t* node)